@@ -15,13 +15,24 @@
  * @param tail2: pointer to tail pointer of second number
  * @param head3: pointer to head pointer of result (will be created)
  * @param tail3: pointer to tail pointer of result (will be created)
- * @return: SUCCESS on success
+ * @return: SUCCESS on success, FAILURE if out of memory or over the memory
+ *          budget (result left empty)
  */
 int add_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3)
 {
     int carry = 0;      // Carry from previous digit addition (0 or 1)
     int digit_sum;      // Sum of current digits plus carry
+    int status = SUCCESS;
+
+    // Step 0: Fail fast if the sum (one digit longer at most) cannot fit in the memory budget
+    if (mem_limit() != 0)
+    {
+        int len1 = get_list_length(*head1), len2 = get_list_length(*head2);
+        if (mem_check(((size_t)((len1 > len2) ? len1 : len2) + 1) * MEM_NODE_BYTES) == FAILURE)
+            return FAILURE;
+    }
+    TRACE_BEGIN("add_number", NULL, 0);
 
     // Step 1: Start from tail (rightmost digits) and work backwards
     // Double linked list allows us to traverse backwards easily
@@ -33,6 +44,7 @@ int add_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     while (temp1 != NULL || temp2 != NULL)
     {
         digit_sum = carry;  // Start with carry from previous addition
+        STATS_ADD(digit_ops, 1);
 
         // Add digit from first number (if available)
         if (temp1 != NULL)
@@ -49,16 +61,43 @@ int add_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
 
         // Store result digit and calculate new carry (handles sum > 9)
-        update_result_add(head3, tail3, digit_sum, &carry);
+        status = update_result_add(head3, tail3, digit_sum, &carry);
+        if (status == FAILURE)
+            break; // Out of memory
     }
 
     // Step 3: If there's a final carry, add it as a new digit (e.g., 99 + 1 = 100)
-    if (carry != 0)
+    if (status == SUCCESS && carry != 0)
+        status = dl_insert_first(head3, tail3, carry); // Insert carry as most significant digit
+    if (status == FAILURE)
+        dl_delete_list(head3, tail3); // Out of memory: drop the partial sum
+
+    TRACE_END();
+    return status; // SUCCESS once the addition is complete
+}
+
+/**
+ * Signed addition: h3 = sign1 * |a| + sign2 * |b|
+ * @param head1: head of |a| (only read)
+ * @param sign1: sign of a (+1 or -1)
+ * @param head2: head of |b| (only read)
+ * @param sign2: sign applied to b (negated for a subtraction)
+ * @param sign3: receives the sign of the result
+ * @return: SUCCESS, or FAILURE if out of memory or over the memory budget
+ */
+int add_signed_number(Dlist *head1, Dlist *tail1, int sign1, Dlist *head2, Dlist *tail2, int sign2,
+                      Dlist **head3, Dlist **tail3, int *sign3)
+{
+    if (sign1 == sign2) // Same sign: add magnitudes, keep the sign
     {
-        dl_insert_first(head3, tail3, carry); // Insert carry as most significant digit
+        *sign3 = sign1;
+        return add_number(&head1, &tail1, &head2, &tail2, head3, tail3);
     }
-
-    return SUCCESS; // Addition completed successfully
+    int is_negative = sub_number(&head1, &tail1, &head2, &tail2, head3, tail3, NULL, NULL);
+    if (is_negative == FAILURE)
+        return FAILURE;
+    *sign3 = (sign1 == 1) ? (is_negative ? -1 : 1) : (is_negative ? 1 : -1);
+    return SUCCESS;
 }
 
 /**
@@ -69,7 +108,7 @@ int add_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
  * @param tail: pointer to tail pointer of result list
  * @param result: sum of digits plus carry (may be > 9)
  * @param carry: pointer to carry variable (will be updated)
- * @return: SUCCESS
+ * @return: SUCCESS, or FAILURE if the digit could not be stored
  */
 int update_result_add(Dlist **head, Dlist **tail, int result, int *carry)
 {
@@ -17,14 +17,24 @@
  * @param tail3: pointer to tail pointer of result (will be created)
  * @param op1: original string of first operand (for comparison)
  * @param op2: original string of second operand (for comparison)
- * @return: 0 if result is positive, 1 if result is negative
+ * @return: 0 if result is positive, 1 if result is negative, FAILURE if out of
+ *          memory or over the memory budget (result left empty)
  */
 int sub_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3, char *op1, char *op2)
 {
+    TRACE_BEGIN("sub_number", NULL, 0);
     // Step 1: Compare numbers and swap if head1 < head2
     // This ensures we always subtract smaller from larger (to avoid negative intermediate results)
     int is_negative = compare_numbers(head1, tail1, head2, tail2, op1, op2); // Compare and swap if needed
+
+    // Fail fast if the difference (as long as the larger number) cannot fit in the memory budget
+    if (mem_limit() != 0 &&
+        mem_check((size_t)get_list_length(*head1) * MEM_NODE_BYTES) == FAILURE)
+    {
+        TRACE_END();
+        return FAILURE;
+    }
     
     // Step 2: Start from tail (rightmost digits) and work backwards
     // Double linked list allows us to traverse backwards easily
@@ -39,6 +49,7 @@ int sub_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     while (temp1 != NULL) // Process all digits of first number
     {
         // Get current digits
+        STATS_ADD(digit_ops, 1);
         digit1 = temp1->data; // Digit from first number
         digit2 = (temp2 != NULL) ? temp2->data : 0; // Digit from second number (0 if exhausted)
 
@@ -60,7 +71,12 @@ int sub_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         result_digit = digit1 - digit2;
         
         // Store result (insert at beginning since we're building result from right to left)
-        dl_insert_first(head3, tail3, result_digit);
+        if (dl_insert_first(head3, tail3, result_digit) == FAILURE)
+        {
+            dl_delete_list(head3, tail3); // Out of memory: drop the partial difference
+            TRACE_END();
+            return FAILURE;
+        }
 
         // Move to previous digits (leftward)
         temp1 = temp1->prev; // Move to previous digit in first number
@@ -70,6 +86,7 @@ int sub_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
 
     // Step 4: Remove leading zeros from result (e.g., 000123 becomes 123)
     trim_leading_zeroes(head3, tail3);
+    TRACE_END();
 
     // Return whether result is negative (1 if negative, 0 if positive)
     return is_negative;
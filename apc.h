@@ -4,12 +4,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 /* ============================================================================
  * CONSTANTS
  * ============================================================================ */
 #define SUCCESS 0
 #define FAILURE -1
+#define FILE_OPEN_ERROR -2  // Operand file could not be opened or mapped
+#define MEMORY_ERROR -3     // Out of memory or over the memory budget
+#define ZERO_DENOMINATOR -4 // Fraction p/q with q = 0
 
 /* ============================================================================
  * TYPE DEFINITIONS
@@ -39,6 +43,9 @@ int dl_delete_first(Dlist **head, Dlist **tail);           // Delete first node
 int dl_delete_list(Dlist **head, Dlist **tail);             // Delete entire list
 void print_list(Dlist *head);                               // Print list
 void print_list_formatted(Dlist *head, Dlist *tail);        // Print with formatting
+char *list_to_string(Dlist *head, int is_negative);         // Plain digits as new string (caller frees)
+char *format_list(Dlist *head, int is_negative, int grouped, size_t *length);  // Text in one buffer
+int write_number(FILE *out, Dlist *head, int is_negative, int grouped);  // One fwrite
 int get_list_length(Dlist *head);                          // Count nodes
 int get_formatted_width(Dlist *head, int has_minus);        // Calculate display width of formatted number
 int get_string_display_width(const char *str);               // Calculate display width of string (emojis count as 1)
@@ -51,7 +58,13 @@ void print_padded_line(int max_width, int content_width);    // Print padding an
  * INPUT PARSING
  * Convert string representation to double linked list
  * ============================================================================ */
-int stored_num(Dlist **head, Dlist **tail, char *data);  // Returns sign (+1 or -1)
+int is_valid_number(const char *str);                    // 1 if "[-]digits", 0 otherwise
+int check_number(const char *str, size_t *bad_offset);   // Same, reports the first invalid byte
+int stored_num(Dlist **head, Dlist **tail, char *data);  // Returns sign (+1 or -1); list empty if out of memory
+int stored_num_buffer(Dlist **head, Dlist **tail, const char *data, size_t length,
+                      int *sign, size_t *bad_offset);     // Validate + store in one pass
+int load_number_file(const char *path, Dlist **head, Dlist **tail,
+                     int *sign, size_t *bad_offset);      // Operand from file (mmap)
 
 /* ============================================================================
  * ARITHMETIC OPERATIONS
@@ -60,11 +73,15 @@ int stored_num(Dlist **head, Dlist **tail, char *data);  // Returns sign (+1 or
 int add_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3);
 int sub_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
-               Dlist **head3, Dlist **tail3, char *op1, char *op2);
+               Dlist **head3, Dlist **tail3, char *op1, char *op2);  // 0/1 = sign, FAILURE if out of memory
 int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3);
+int mul_number_sharded(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                       Dlist **head3, Dlist **tail3, int shards); // Forks: single-threaded callers only
 int div_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3, Dlist **remainder_head, Dlist **remainder_tail, char ch);
+int add_signed_number(Dlist *head1, Dlist *tail1, int sign1, Dlist *head2, Dlist *tail2, int sign2,
+                      Dlist **head3, Dlist **tail3, int *sign3);  // s1 |a| + s2 |b|, operands only read
 
 /* ============================================================================
  * HELPER FUNCTIONS
@@ -84,8 +101,403 @@ void swap_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2);
 
 // Division helpers
 int is_greater_or_equal(Dlist *head1, Dlist *head2);  // Compare two numbers
-void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
-                    Dlist **result_head, Dlist **result_tail);  // Subtract two lists
-void copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail);  // Copy a list
+int subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                   Dlist **result_head, Dlist **result_tail);  // Subtract two lists
+int copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail);  // Copy a list
+
+/* ============================================================================
+ * BINARY NUMBER FORMAT (.apcn)
+ * Versioned header + raw limbs; loading maps the file and uses limbs in place
+ * ============================================================================ */
+#define APCN_VERSION        1           // Current format version
+#define APCN_DECIMAL_BASE   100000000   // Limb base: 8 decimal digits per limb
+#define APCN_DECIMAL_DIGITS 8           // Decimal digits per limb
+
+/* ----------------------------------------------------------------------------
+ * mapped_number: read-only view of a binary number file
+ * limbs points straight into the mapping (least significant limb first)
+ * ---------------------------------------------------------------------------- */
+typedef struct mapped_number
+{
+    int sign;               // +1 or -1
+    const uint32_t *limbs;  // Payload limbs (each < APCN_DECIMAL_BASE)
+    size_t count;           // Number of limbs
+    void *map;              // Mapping to release (NULL for map_number_buffer)
+    size_t map_length;      // Size of the mapping
+    uint32_t *owned;        // Byte swapped copy on big endian hosts, else NULL
+} mapped_number;
+
+int is_binary_number(const void *data, size_t length);             // Starts with "APCN"?
+int save_number(const char *path, Dlist *head, Dlist *tail, int sign);  // Write .apcn file
+int map_number(const char *path, mapped_number *num);              // mmap + validate
+int map_number_buffer(const void *data, size_t length, mapped_number *num);  // Validate image
+void unmap_number(mapped_number *num);                             // Release a view
+int mapped_to_list(const mapped_number *num, Dlist **head, Dlist **tail);  // Limbs -> Dlist
+int print_mapped_number(const mapped_number *num, FILE *out);      // Decimal text, one write
+
+/* ============================================================================
+ * MEMORY BUDGET (--mem-limit)
+ * Live/peak accounting of digit nodes and arithmetic buffers, process wide
+ * ============================================================================ */
+#define MEM_NODE_BYTES 32   // Heap footprint of one Dlist node (24 bytes + malloc header)
+
+int parse_size(const char *text, size_t *bytes);   // "4096", "512M", "2G"
+size_t mem_limit(void);                             // Limit in bytes (0 = none; APC_MEM_LIMIT)
+void mem_set_limit(size_t bytes);                   // Replace the limit
+int mem_charge(size_t bytes);                       // Count bytes as live, FAILURE if over the limit
+void mem_uncharge(size_t bytes);                    // Release bytes counted by mem_charge
+int mem_check(size_t bytes);                        // Would an estimate fit right now?
+size_t mem_live(void);                              // Bytes counted now
+size_t mem_peak(void);                              // Most bytes counted at once
+
+/* ============================================================================
+ * LARGE BUFFERS AND NODE SLABS (--numa)
+ * Huge-page mappings for big limb buffers and for the Dlist node slabs
+ * ============================================================================ */
+#define BIG_ALLOC_THRESHOLD (2UL << 20)  // Buffers from here on get their own mapping
+
+enum numa_mode
+{
+    NUMA_DEFAULT,       // Kernel policy (first touch unless numactl says otherwise)
+    NUMA_LOCAL,         // Node of the thread that first touches the memory
+    NUMA_INTERLEAVE     // Pages spread round all online nodes
+};
+
+int parse_numa_mode(const char *text, int *mode);  // "local", "interleave" or "off"
+void big_set_numa(int mode);                        // Placement of new large mappings (APC_NUMA)
+void big_track(int on);                             // Measure huge pages of freed buffers
+void *big_alloc(size_t bytes, int zeroed);          // Limb buffer (huge-page mapping when large)
+void big_free(void *buffer, size_t bytes);          // Release a big_alloc buffer
+void big_usage(size_t *buffers, size_t *resident, size_t *huge);  // Huge-page hit counters
+Dlist *node_alloc(void);                            // One Dlist node from a slab
+void node_free(Dlist *node);                        // Return a node to this thread's free list
+
+/* ============================================================================
+ * STATISTICS (--stats)
+ * Compiled in only with -DAPC_STATS (make STATS=1); otherwise the STATS_*
+ * macros expand to nothing and cost nothing
+ * ============================================================================ */
+typedef enum stats_phase
+{
+    PHASE_PARSE,        // Operands -> lists
+    PHASE_COMPUTE,      // The arithmetic itself
+    PHASE_FORMAT,       // Box, digits and output
+    PHASE_COUNT
+} stats_phase;
+
+/* ----------------------------------------------------------------------------
+ * apc_stats: counters of one thread, or of the whole process once flushed
+ * ---------------------------------------------------------------------------- */
+typedef struct apc_stats
+{
+    uint64_t allocations;           // Dlist nodes allocated
+    uint64_t frees;                 // Dlist nodes freed
+    int64_t live_nodes;             // Nodes alive now (process wide)
+    int64_t peak_nodes;             // Most nodes alive at once (process wide)
+    uint64_t digit_ops;             // Digit steps in the Dlist add/sub/mul/div loops
+    uint64_t limb_ops;              // Limb products in limbs.c
+    uint64_t div_rounds;            // Subtraction rounds in div_number
+    uint64_t phase_ns[PHASE_COUNT]; // Wall time per phase
+} apc_stats;
+
+#ifdef APC_STATS
+extern __thread apc_stats thread_stats;
+void stats_node_alloc(void);
+void stats_node_free(void);
+#define STATS_ADD(field, n)             (thread_stats.field += (uint64_t)(n))
+#define STATS_NODE_ALLOC()              stats_node_alloc()
+#define STATS_NODE_FREE()               stats_node_free()
+#define STATS_PHASE_BEGIN(start)        uint64_t start = stats_clock()
+#define STATS_PHASE_END(phase, start)   (thread_stats.phase_ns[phase] += stats_clock() - (start))
+#else
+#define STATS_ADD(field, n)             ((void)0)
+#define STATS_NODE_ALLOC()              ((void)0)
+#define STATS_NODE_FREE()               ((void)0)
+#define STATS_PHASE_BEGIN(start)        ((void)0)
+#define STATS_PHASE_END(phase, start)   ((void)0)
+#endif
+
+int stats_enabled(void);                  // 1 if compiled with APC_STATS
+uint64_t stats_clock(void);               // CLOCK_MONOTONIC in ns
+void stats_flush(void);                   // Add this thread's counters to the process total
+void stats_print(FILE *out, int json);    // Process totals as text or JSON
+
+/* ============================================================================
+ * TRACING (--trace)
+ * Chrome trace JSON timeline of parse, dispatch, recursion and formatting
+ * spans, per thread. Off unless trace_start was called; a TRACE_* call then
+ * costs a single test of trace_active.
+ * ============================================================================ */
+extern int trace_active;
+
+#define TRACE_BEGIN(name, arg_name, arg) \
+    do { if (trace_active) trace_begin(name, arg_name, (int64_t)(arg)); } while (0)
+#define TRACE_END() \
+    do { if (trace_active) trace_end(NULL, 0); } while (0)
+#define TRACE_END_ARG(arg_name, arg) \
+    do { if (trace_active) trace_end(arg_name, (int64_t)(arg)); } while (0)
+
+void trace_start(const char *path);                                  // Start recording
+void trace_begin(const char *name, const char *arg_name, int64_t arg); // Open a span
+void trace_end(const char *arg_name, int64_t arg);                   // Close the innermost span
+int trace_finish(void);                                              // Write the JSON file
+
+/* ============================================================================
+ * ALGORITHM THRESHOLDS
+ * Crossovers between algorithm tiers; defaults come from apc_thresholds.h
+ * (written by make tune), each can be overridden with an environment variable
+ * ============================================================================ */
+typedef enum threshold_id
+{
+    THRESHOLD_MUL_LIMB,     // Digits: mul_number switches from digit schoolbook to limbs
+    THRESHOLD_KARATSUBA,    // Limbs: limb_mul switches from schoolbook to Karatsuba
+    THRESHOLD_DIV_LIMB,     // Digits: div_number switches from repeated subtraction to Knuth D
+    THRESHOLD_HGCD,         // Limbs: gcd switches from Lehmer to half-GCD
+    THRESHOLD_COUNT
+} threshold_id;
+
+size_t get_threshold(threshold_id id);                // Current value (env overrides applied)
+void set_threshold(threshold_id id, size_t value);    // Used by the tuner
+const char *threshold_name(threshold_id id);          // Environment variable name
+
+/* ============================================================================
+ * LIMB ARITHMETIC
+ * Contiguous little endian limb arrays in base 10^8 or 2^32 (see limbs.c)
+ * ============================================================================ */
+typedef uint32_t limb_t;
+
+#define LIMB_DECIMAL_BASE   100000000ULL    // 8 decimal digits per limb
+#define LIMB_DECIMAL_DIGITS 8
+#define LIMB_BINARY_BASE    4294967296ULL   // 2^32: one machine word per limb
+
+size_t limb_normalize(const limb_t *a, size_t n);                   // Length without top zeros
+int limb_cmp(const limb_t *a, size_t an, const limb_t *b, size_t bn);  // -1, 0, 1
+limb_t limb_add(limb_t *r, const limb_t *a, size_t an,
+                const limb_t *b, size_t bn, uint64_t base);         // r = a + b, returns carry
+limb_t limb_sub(limb_t *r, const limb_t *a, size_t an,
+                const limb_t *b, size_t bn, uint64_t base);         // r = a - b, returns borrow
+limb_t limb_mul_1(limb_t *r, const limb_t *a, size_t n, limb_t m,
+                  limb_t add, uint64_t base);                       // r = a * m + add
+limb_t limb_addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t m, uint64_t base);  // r += a * m
+limb_t limb_divmod_1(limb_t *q, const limb_t *a, size_t n, limb_t d, uint64_t base);  // Returns a % d
+int limb_mul(limb_t *r, const limb_t *a, size_t an,
+             const limb_t *b, size_t bn, uint64_t base);            // r = a * b (an + bn limbs)
+int limb_mullo(limb_t *r, const limb_t *a, const limb_t *b,
+               size_t n, uint64_t base);                            // r = a * b mod base^n
+int limb_divmod(limb_t *q, limb_t *r, const limb_t *a, size_t an,
+                const limb_t *b, size_t bn, uint64_t base);         // q = a / b, r = a % b
+limb_t *list_to_limbs(Dlist *head, Dlist *tail, size_t *count);     // Digits -> decimal limbs
+int limbs_to_list(const limb_t *limbs, size_t count, Dlist **head, Dlist **tail);  // And back
+
+/* ============================================================================
+ * RADIX CONVERSION
+ * Divide-and-conquer decimal <-> binary limb conversion in O(M(n) log n)
+ * ============================================================================ */
+#define RADIX_MAX_LEVELS    40      // power[i] covers 2^i source limbs
+#ifndef RADIX_THRESHOLD
+#define RADIX_THRESHOLD     32      // Source limbs; quadratic conversion below this
+#endif
+
+/* ----------------------------------------------------------------------------
+ * radix_cache: powers of the source base held in the target base
+ * power[i] = source_base^(2^i); filled on demand, owned by the caller so
+ * conversions share no global state and repeated conversions reuse the tree
+ * ---------------------------------------------------------------------------- */
+typedef struct radix_cache
+{
+    uint64_t target_base;               // Base the powers are written in
+    limb_t *power[RADIX_MAX_LEVELS];    // Cached powers (NULL until needed)
+    size_t length[RADIX_MAX_LEVELS];    // Limb count of each power
+} radix_cache;
+
+void radix_cache_init(radix_cache *cache, uint64_t target_base);
+void radix_cache_free(radix_cache *cache);
+int radix_convert(const limb_t *src, size_t n, uint64_t source_base, radix_cache *cache,
+                  limb_t **result, size_t *result_count);         // Result base = cache base
+limb_t *list_to_binary(Dlist *head, Dlist *tail, radix_cache *cache, size_t *count);  // Digits -> 2^32 limbs
+int binary_to_list(const limb_t *limbs, size_t count, Dlist **head, Dlist **tail);      // And back
+
+/* ============================================================================
+ * MODULAR EXPONENTIATION
+ * Montgomery (odd moduli) or multiply + divide (even moduli) on base 2^32
+ * limbs, sliding window or constant-time fixed window (see powmod.c)
+ * ============================================================================ */
+int limb_powmod(limb_t *r, const limb_t *a, size_t an, const limb_t *e, size_t en,
+                const limb_t *m, size_t mn, int constant_time);    // r = a^e mod m (mn limbs)
+int powmod_number(Dlist *base_head, Dlist *base_tail, int base_sign,
+                  Dlist *exp_head, Dlist *exp_tail, Dlist *mod_head, Dlist *mod_tail,
+                  int constant_time, Dlist **head3, Dlist **tail3);  // Result in [0, mod)
+
+/* ============================================================================
+ * GREATEST COMMON DIVISOR
+ * Binary GCD on words, Lehmer below THRESHOLD_HGCD limbs, half-GCD above
+ * it, all on base 2^32 limbs (see gcd.c)
+ * ============================================================================ */
+int limb_gcd(limb_t *g, size_t *gn, const limb_t *a, size_t an,
+             const limb_t *b, size_t bn);                          // g: max(an, bn) limbs
+int gcd_number(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+               Dlist **head3, Dlist **tail3);                       // gcd(|a|, |b|)
+int xgcd_number(Dlist *head1, Dlist *tail1, int sign1, Dlist *head2, Dlist *tail2, int sign2,
+                Dlist **g_head, Dlist **g_tail, Dlist **s_head, Dlist **s_tail, int *s_sign,
+                Dlist **t_head, Dlist **t_tail, int *t_sign);       // s*a + t*b = g
+
+/* ============================================================================
+ * INTEGER ROOTS
+ * Division-free Newton iteration for the inverse root with precision
+ * doubling, then an exact floor correction (see root.c)
+ * ============================================================================ */
+int root_number(Dlist *head1, Dlist *tail1, int sign1, uint32_t k,
+                Dlist **root_head, Dlist **root_tail, int *root_sign,
+                Dlist **rem_head, Dlist **rem_tail, int *rem_sign);  // root^k + rem = N
+
+/* ============================================================================
+ * FACTORIALS
+ * Prime swing and Kummer exponents over a sieve, multiplied in a balanced
+ * product tree whose top levels run on threads (see factorial.c)
+ * ============================================================================ */
+#define FACT_MAX_N 4294967295ULL  // Largest n accepted (factors fit 32 bits)
+
+int factorial_number(uint64_t n, Dlist **head3, Dlist **tail3);             // n!
+int binomial_number(uint64_t n, uint64_t k, Dlist **head3, Dlist **tail3);  // C(n, k)
+int primorial_number(uint64_t n, Dlist **head3, Dlist **tail3);             // Product of primes <= n
+
+/* ============================================================================
+ * VECTORIZED INGEST
+ * SIMD digit validation and ASCII -> limb conversion (see ingest.c)
+ * ============================================================================ */
+size_t scan_digits(const char *data, size_t length);  // Offset of first non-digit, or length
+size_t scan_digits_string(const char *str);           // Same for a '\0' terminated string
+void digits_to_limbs(const char *digits, size_t n, limb_t *limbs);  // (n + 7) / 8 limbs
+
+/* ============================================================================
+ * OUT-OF-CORE STREAMING
+ * Add/subtract/compare text files chunk by chunk with bounded memory
+ * ============================================================================ */
+int stream_add_sub(const char *path1, char operator, const char *path2, const char *out_path);
+int stream_compare(const char *path1, const char *path2, int *result);  // -1, 0, 1
+
+/* ============================================================================
+ * SHARDED MULTIPLICATION (--shards=N)
+ * Block products of one large multiplication in forked worker processes,
+ * exchanged through a POSIX shared memory segment (see shard.c). Forks, so
+ * only for single-threaded callers: there is no process-wide setting
+ * ============================================================================ */
+#define SHARD_MIN_LIMBS 4096    // Shorter operand limbs below which one process is faster
+#define SHARD_MAX_WORKERS 64    // Most workers --shards accepts
+
+size_t shard_bytes(size_t an, size_t bn, int shards);  // Shared segment size
+int shard_mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn,
+              uint64_t base, int shards);           // r = a * b over worker processes
+
+/* ============================================================================
+ * RESULT VERIFICATION (--verify)
+ * Residues modulo 9, 11 and three random primes near 2^62, in one linear
+ * pass per number (see verify.c)
+ * ============================================================================ */
+#define VERIFY_MODULI 5     // 9, 11 and three random 62-bit primes
+
+/* ----------------------------------------------------------------------------
+ * verify_check: moduli of one check and the residues of both operands
+ * ---------------------------------------------------------------------------- */
+typedef struct verify_check
+{
+    uint64_t modulus[VERIFY_MODULI];
+    uint64_t a[VERIFY_MODULI];      // First operand (signed value) mod each modulus
+    uint64_t b[VERIFY_MODULI];      // Second operand
+} verify_check;
+
+void verify_begin(verify_check *check, Dlist *head1, int sign1,
+                  Dlist *head2, int sign2);                         // Before the operation
+int verify_result(const verify_check *check, char op, Dlist *head3, int sign3,
+                  Dlist *rem_head, int rem_sign, Dlist *divisor_head,
+                  uint64_t *bad_modulus);                           // SUCCESS or FAILURE
+
+/* ============================================================================
+ * RESULT WINDOWS (--low=K, --high=K)
+ * Last or first K digits and the digit count of a product or quotient,
+ * from short and truncated products (see window.c)
+ * ============================================================================ */
+int window_number(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2, char op, char side,
+                  size_t k, Dlist **head3, Dlist **tail3, uint64_t *digits);  // side 'l' or 'h'
+
+/* ============================================================================
+ * REDUCTIONS
+ * Sum (wide carry-free accumulator) and product (pairwise product tree) of
+ * the numbers in a text file, straight from text to limbs (see reduce.c)
+ * ============================================================================ */
+int reduce_file(const char *path, char op, Dlist **head3, Dlist **tail3, int *sign3,
+                size_t *count, size_t *bad_line);  // op '+' or 'x'; "-" reads stdin
+
+/* ============================================================================
+ * RATIONAL NUMBERS
+ * Fractions over the Dlist integers, reduced lazily: only once a result
+ * outgrows RAT_REDUCE_FACTOR times its operands' reduced size (see rational.c)
+ * ============================================================================ */
+#define RAT_REDUCE_FACTOR 2     // Growth over the reduced size that triggers a gcd
+#define RAT_REDUCE_SLACK 64     // Digits of growth always tolerated (small fractions)
+
+/* ----------------------------------------------------------------------------
+ * rational: sign * num / den with den > 0, not necessarily in lowest terms
+ * ---------------------------------------------------------------------------- */
+typedef struct rational
+{
+    Dlist *num_head, *num_tail;     // |numerator|
+    Dlist *den_head, *den_tail;     // Denominator (never zero)
+    int sign;                       // +1 or -1 (+1 for zero)
+    size_t reduced_length;          // Digits (num + den) at the last reduction
+} rational;
+
+void rat_init(rational *q);                             // Empty fraction
+void rat_free(rational *q);                             // Free both lists
+int rat_parse(rational *q, const char *text, size_t length,
+              size_t *bad_offset);                      // "[-]p[/[-]q]", ZERO_DENOMINATOR if q = 0
+int rat_normalize(rational *q);                         // Lowest terms
+int rat_op(rational *r, const rational *a, char op,
+           const rational *b);                          // op '+', '-', 'x', '/'
+
+/* ============================================================================
+ * FIXED-POINT DECIMALS (--scale=N)
+ * "[-]digits[.digits]" operands and results with N fraction digits; long
+ * quotients come from a Newton reciprocal and two products (see fixed.c)
+ * ============================================================================ */
+#define RECIP_MIN_LIMBS 96      // Divisor and quotient limbs below which Knuth division is faster
+
+typedef enum round_mode
+{
+    ROUND_DOWN,         // Toward zero (default, like integer division)
+    ROUND_UP,           // Away from zero
+    ROUND_FLOOR,        // Toward minus infinity
+    ROUND_CEILING,      // Toward plus infinity
+    ROUND_HALF_UP,      // Nearest, ties away from zero
+    ROUND_HALF_DOWN,    // Nearest, ties toward zero
+    ROUND_HALF_EVEN     // Nearest, ties to an even last digit
+} round_mode;
+
+/* ----------------------------------------------------------------------------
+ * fixed_value: sign * digits / 10^scale
+ * ---------------------------------------------------------------------------- */
+typedef struct fixed_value
+{
+    Dlist *head, *tail;     // All digits, point removed (no leading zeros)
+    int sign;               // +1 or -1 (+1 for zero)
+    size_t scale;           // How many of the digits follow the point
+} fixed_value;
+
+int parse_round_mode(const char *text, round_mode *mode);    // "down", "half-even", ...
+const char *round_mode_name(round_mode mode);               // And back
+void fixed_init(fixed_value *x);                            // Empty value
+void fixed_free(fixed_value *x);                            // Free the digits
+int fixed_parse(fixed_value *x, const char *text, size_t length,
+                size_t *bad_offset);                        // "[-]digits[.digits]"
+int fixed_op(fixed_value *r, const fixed_value *a, char op, const fixed_value *b,
+             size_t scale, round_mode mode);                // op '+', '-', 'x', '/'
+size_t fixed_length(Dlist *head, int sign, size_t scale);   // Characters write_fixed writes
+int write_fixed(FILE *out, Dlist *head, int sign, size_t scale);  // "[-]int.frac"
+
+/* ============================================================================
+ * BATCH EVALUATION
+ * Evaluate a file of "operand1 operator operand2" lines on worker threads
+ * ============================================================================ */
+int run_batch(const char *path, int num_threads, FILE *out);  // Results in input order
 
 #endif // APC_H
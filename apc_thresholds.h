@@ -0,0 +1,14 @@
+#ifndef APC_THRESHOLDS_H
+#define APC_THRESHOLDS_H
+
+/* ============================================================================
+ * ALGORITHM THRESHOLDS
+ * Generated by apc_tune (make tune) on 2026-10-18 - do not edit by hand
+ * Override at run time with the environment variable of the same name
+ * ============================================================================ */
+#define APC_MUL_LIMB_THRESHOLD   12    // Digits (shorter operand)
+#define APC_KARATSUBA_THRESHOLD  64    // Limbs
+#define APC_DIV_LIMB_THRESHOLD   2     // Digits (dividend)
+#define APC_HGCD_THRESHOLD       8000  // Limbs (binary, smaller operand)
+
+#endif // APC_THRESHOLDS_H
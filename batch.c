@@ -0,0 +1,619 @@
+#include "apc.h"
+#include "libapc.h"
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * PARALLEL BATCH EVALUATION
+ * Evaluates a file of independent operations ("operand1 operator operand2",
+ * one per line) across several worker threads.
+ *
+ * Scheduling: every worker owns a deque of tasks. The reader hands tasks out
+ * round-robin; a worker pops from the bottom of its own deque and, when that is
+ * empty, steals from the top of another worker's deque. A single huge
+ * multiplication therefore only blocks its own worker - the small tasks queued
+ * behind it are stolen by idle workers.
+ *
+ * Ordering: results land in a bounded reorder buffer indexed by sequence
+ * number and are written out strictly in input order by the reading thread.
+ * When the buffer is full, reading pauses until the oldest result is written.
+ * ============================================================================ */
+
+#define BATCH_WINDOW_PER_THREAD 1024  // Reorder buffer slots per worker thread
+#define BATCH_DEQUE_CAPACITY    1024  // Initial capacity of each worker deque
+
+/* ----------------------------------------------------------------------------
+ * batch_task: one line of the input file
+ * ---------------------------------------------------------------------------- */
+typedef struct batch_task
+{
+    long seq;            // Line number (position in output)
+    char *line;          // Owned copy of the line (operands point into it)
+    char *operand1;      // First operand string
+    char *operand2;      // Second operand string
+    char *operand3;      // Third operand string (functions only)
+    char operator;       // Operation character (+, -, x, /)
+    char *function;      // Function name ("powmod", "gcd", ...), NULL for "operand1 operator operand2"
+} batch_task;
+
+/* ----------------------------------------------------------------------------
+ * batch_deque: per-worker double ended task queue (ring buffer)
+ * Owner uses the bottom end, thieves use the top end
+ * ---------------------------------------------------------------------------- */
+typedef struct batch_deque
+{
+    pthread_mutex_t lock;   // Protects the ring buffer
+    batch_task **tasks;     // Ring buffer of task pointers
+    long capacity;          // Number of slots in the ring buffer
+    long top;               // Index of oldest task (steal end)
+    long bottom;            // One past the newest task (owner end)
+} batch_deque;
+
+/* ----------------------------------------------------------------------------
+ * batch_slot: one entry of the reorder buffer
+ * ---------------------------------------------------------------------------- */
+typedef struct batch_slot
+{
+    int ready;      // 1 once the worker has stored the result
+    char *text;     // Result line (without newline)
+} batch_slot;
+
+/* ----------------------------------------------------------------------------
+ * batch_pool: shared state of one batch run
+ * ---------------------------------------------------------------------------- */
+typedef struct batch_pool
+{
+    int num_workers;            // Number of worker threads
+    batch_deque *deques;        // One deque per worker
+
+    pthread_mutex_t lock;       // Protects queued, shutdown and the reorder buffer
+    pthread_cond_t work_cond;   // Signalled when a task is queued or on shutdown
+    pthread_cond_t done_cond;   // Signalled when a result is stored
+    long queued;                // Tasks sitting in deques not yet claimed by a worker
+    int shutdown;               // 1 when no more tasks will arrive
+
+    batch_slot *window;         // Reorder buffer
+    long window_size;           // Number of slots in the reorder buffer
+} batch_pool;
+
+/* ----------------------------------------------------------------------------
+ * batch_worker: argument of one worker thread
+ * ---------------------------------------------------------------------------- */
+typedef struct batch_worker
+{
+    batch_pool *pool;   // Shared pool
+    int id;             // Index of the worker's own deque
+} batch_worker;
+
+/* ============================================================================
+ * DEQUE OPERATIONS
+ * ============================================================================ */
+
+/**
+ * Push a task at the bottom (owner end) of a deque, growing it if full
+ * @param deque: deque to push into
+ * @param task: task to push
+ * @return: SUCCESS, or FAILURE if the deque could not grow
+ */
+static int deque_push(batch_deque *deque, batch_task *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom - deque->top == deque->capacity) // Ring buffer is full
+    {
+        long new_capacity = deque->capacity * 2;
+        batch_task **grown = malloc(new_capacity * sizeof(batch_task *));
+        if (grown == NULL)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return FAILURE;
+        }
+        for (long i = deque->top; i < deque->bottom; i++) // Keep the same logical indexes
+            grown[i % new_capacity] = deque->tasks[i % deque->capacity];
+        free(deque->tasks);
+        deque->tasks = grown;
+        deque->capacity = new_capacity;
+    }
+    deque->tasks[deque->bottom % deque->capacity] = task;
+    deque->bottom++;
+    pthread_mutex_unlock(&deque->lock);
+    return SUCCESS;
+}
+
+/**
+ * Pop the newest task from the bottom (owner end) of a deque
+ * @param deque: worker's own deque
+ * @return: task, or NULL if the deque is empty
+ */
+static batch_task *deque_pop(batch_deque *deque)
+{
+    batch_task *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom > deque->top)
+    {
+        deque->bottom--;
+        task = deque->tasks[deque->bottom % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/**
+ * Steal the oldest task from the top (thief end) of another worker's deque
+ * @param deque: victim deque
+ * @return: task, or NULL if the deque is empty
+ */
+static batch_task *deque_steal(batch_deque *deque)
+{
+    batch_task *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom > deque->top)
+    {
+        task = deque->tasks[deque->top % deque->capacity];
+        deque->top++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/* ============================================================================
+ * TASK EVALUATION
+ * ============================================================================ */
+
+/**
+ * Number of operands of a batch function
+ * @return: 3 for powmod, 2 for gcd, xgcd, iroot and binomial, 1 for isqrt,
+ *          factorial and primorial, 0 if name is not a function
+ */
+static int function_operands(const char *name)
+{
+    if (strcmp(name, "powmod") == 0)
+        return 3;
+    if (strcmp(name, "gcd") == 0 || strcmp(name, "xgcd") == 0 || strcmp(name, "iroot") == 0 ||
+        strcmp(name, "binomial") == 0)
+        return 2;
+    if (strcmp(name, "isqrt") == 0 || strcmp(name, "factorial") == 0 || strcmp(name, "primorial") == 0)
+        return 1;
+    return 0;
+}
+
+/**
+ * Split a batch line into operand1, operator and operand2 (in place),
+ * or into a function name and its operands ("powmod base exponent modulus",
+ * "gcd a b", "xgcd a b", "isqrt n", "iroot n k", "factorial n", "binomial n k",
+ * "primorial n")
+ * @param task: task whose line is parsed
+ * @return: SUCCESS if the line has the right fields, FAILURE otherwise
+ */
+static int parse_task_line(batch_task *task)
+{
+    char *save = NULL;
+    char *op1 = strtok_r(task->line, " \t\r\n", &save);
+    int operands = (op1 != NULL) ? function_operands(op1) : 0;
+    if (operands > 0)
+    {
+        task->function = op1;
+        task->operand1 = strtok_r(NULL, " \t\r\n", &save);
+        if (operands >= 2)
+            task->operand2 = strtok_r(NULL, " \t\r\n", &save);
+        if (operands == 3)
+            task->operand3 = strtok_r(NULL, " \t\r\n", &save);
+        if (task->operand1 == NULL || (operands >= 2 && task->operand2 == NULL) ||
+            (operands == 3 && task->operand3 == NULL) || strtok_r(NULL, " \t\r\n", &save) != NULL)
+            return FAILURE;
+        return SUCCESS;
+    }
+    char *op = strtok_r(NULL, " \t\r\n", &save);
+    char *op2 = strtok_r(NULL, " \t\r\n", &save);
+
+    if (op1 == NULL || op == NULL || op2 == NULL || strtok_r(NULL, " \t\r\n", &save) != NULL)
+        return FAILURE; // Missing or extra fields
+    if (strlen(op) != 1)
+        return FAILURE; // Operator must be a single character
+
+    task->operand1 = op1;
+    task->operand2 = op2;
+    task->operator = (op[0] == 'X') ? 'x' : op[0];
+    return SUCCESS;
+}
+
+/**
+ * Build an "error: ..." result line
+ * @param message: error description
+ * @return: newly allocated string
+ */
+static char *error_text(const char *message)
+{
+    size_t size = strlen(message) + 8;
+    char *text = malloc(size);
+    if (text != NULL)
+        snprintf(text, size, "error: %s", message);
+    return text;
+}
+
+/**
+ * Format a library number as a newly allocated string
+ * @param num: number to format
+ * @return: newly allocated string, NULL if out of memory
+ */
+static char *number_text(const apc_num *num)
+{
+    size_t size = apc_format_length(num) + 1;
+    char *text = malloc(size);
+    if (text != NULL && apc_format(num, text, size) != APC_OK)
+    {
+        free(text);
+        text = NULL;
+    }
+    return text;
+}
+
+/**
+ * Format several numbers as one newly allocated space separated string
+ * @param nums: numbers to format
+ * @param count: number of entries in nums
+ * @return: newly allocated string, NULL if out of memory
+ */
+static char *numbers_text(apc_num *const *nums, int count)
+{
+    char *parts[3] = { NULL, NULL, NULL };
+    size_t size = 0;
+    int ok = 1;
+    for (int i = 0; i < count; i++)
+    {
+        parts[i] = number_text(nums[i]);
+        if (parts[i] == NULL)
+            ok = 0;
+        else
+            size += strlen(parts[i]) + 1;
+    }
+    char *text = ok ? malloc(size) : NULL;
+    if (text != NULL)
+    {
+        text[0] = '\0';
+        for (int i = 0; i < count; i++)
+        {
+            if (i > 0)
+                strcat(text, " ");
+            strcat(text, parts[i]);
+        }
+    }
+    for (int i = 0; i < count; i++)
+        free(parts[i]);
+    return text;
+}
+
+/**
+ * Read a small operand (root degree, factorial argument) as a word
+ * @return: its value, or ULONG_MAX (rejected by the library) if it is not
+ *          a non-negative number that fits
+ */
+static unsigned long word_operand(const char *text)
+{
+    char *end;
+    unsigned long value = strtoul(text, &end, 10);
+    if (*end != '\0' || text[0] == '-')
+        return ULONG_MAX;
+    return value;
+}
+
+/**
+ * Evaluate one task and format its result as a single line
+ * Division results are written as "quotient remainder", xgcd as "g s t",
+ * roots as "root remainder"
+ * @param task: task to evaluate
+ * @return: newly allocated result line (NULL only if out of memory)
+ */
+static char *evaluate_task(batch_task *task)
+{
+    if (parse_task_line(task) == FAILURE)
+        return error_text("expected 'operand1 operator operand2', 'powmod base exponent modulus', "
+                          "'gcd a b', 'xgcd a b', 'isqrt n', 'iroot n k', 'factorial n', "
+                          "'binomial n k' or 'primorial n'");
+
+    apc_num *a = NULL, *b = NULL, *c = NULL, *result = NULL, *remainder = NULL;
+    char *text = NULL;
+    int status = apc_init(&a);
+    if (status == APC_OK) status = apc_init(&b);
+    if (status == APC_OK) status = apc_init(&c);
+    if (status == APC_OK) status = apc_init(&result);
+    if (status == APC_OK) status = apc_init(&remainder);
+    TRACE_BEGIN("parse", NULL, 0);
+    if (status == APC_OK && (apc_parse(a, task->operand1) != APC_OK ||
+                             (task->operand2 != NULL && apc_parse(b, task->operand2) != APC_OK) ||
+                             (task->operand3 != NULL && apc_parse(c, task->operand3) != APC_OK)))
+    {
+        text = error_text("invalid operand");
+        status = APC_ERR_PARSE;
+    }
+    TRACE_END();
+
+    if (status == APC_OK && task->function != NULL)
+    {
+        apc_num *outputs[3] = { result, remainder, c }; // xgcd: g, s, t
+        int output_count = 1;
+        if (strcmp(task->function, "powmod") == 0)
+            status = apc_powmod(result, a, b, c);
+        else if (strcmp(task->function, "gcd") == 0)
+            status = apc_gcd(result, a, b);
+        else if (strcmp(task->function, "isqrt") == 0 || strcmp(task->function, "iroot") == 0)
+        {
+            unsigned long k = (task->operand2 != NULL) ? word_operand(task->operand2) : 2;
+            status = apc_iroot(result, remainder, a, k);
+            output_count = 2;
+        }
+        else if (strcmp(task->function, "factorial") == 0)
+            status = apc_factorial(result, word_operand(task->operand1));
+        else if (strcmp(task->function, "binomial") == 0)
+            status = apc_binomial(result, word_operand(task->operand1), word_operand(task->operand2));
+        else if (strcmp(task->function, "primorial") == 0)
+            status = apc_primorial(result, word_operand(task->operand1));
+        else
+        {
+            status = apc_xgcd(result, remainder, c, a, b);
+            output_count = 3;
+        }
+        text = (status == APC_OK) ? numbers_text(outputs, output_count) : error_text(apc_strerror(status));
+    }
+    else if (status == APC_OK)
+    {
+        switch (task->operator)
+        {
+            case '+': status = apc_add(result, a, b); break;
+            case '-': status = apc_sub(result, a, b); break;
+            case 'x': status = apc_mul(result, a, b); break;
+            case '/': status = apc_divmod(result, remainder, a, b); break;
+            default:
+                text = error_text("invalid operation");
+                status = APC_ERR_INVALID;
+                break;
+        }
+        if (status == APC_OK && task->operator == '/')
+        {
+            apc_num *outputs[2] = { result, remainder };
+            text = numbers_text(outputs, 2);
+        }
+        else if (status == APC_OK)
+            text = number_text(result);
+        else if (text == NULL)
+            text = error_text(apc_strerror(status));
+    }
+    else if (text == NULL)
+        text = error_text(apc_strerror(status));
+
+    apc_free(a);
+    apc_free(b);
+    apc_free(c);
+    apc_free(result);
+    apc_free(remainder);
+    return text;
+}
+
+/* ============================================================================
+ * WORKER THREADS
+ * ============================================================================ */
+
+/**
+ * Take a task: own deque first, then steal round the other workers
+ * Caller must not hold pool->lock
+ * @param pool: shared pool
+ * @param id: index of the calling worker
+ * @return: task, or NULL if every deque was empty
+ */
+static batch_task *take_task(batch_pool *pool, int id)
+{
+    batch_task *task = deque_pop(&pool->deques[id]);
+    for (int i = 1; task == NULL && i < pool->num_workers; i++)
+        task = deque_steal(&pool->deques[(id + i) % pool->num_workers]);
+    return task;
+}
+
+/**
+ * Worker thread body: evaluate tasks until shutdown and all deques are drained
+ * @param arg: batch_worker describing this thread
+ * @return: NULL
+ */
+static void *batch_worker_main(void *arg)
+{
+    batch_worker *worker = arg;
+    batch_pool *pool = worker->pool;
+
+    while (1)
+    {
+        // Sleep until some deque holds a task (or the batch is over), then
+        // claim one under the lock: a task is pushed before queued counts it,
+        // so every claim is backed by a task no other worker can take
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->shutdown)
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->queued == 0 && pool->shutdown)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+
+        batch_task *task = take_task(pool, worker->id);
+        if (task == NULL)
+            continue; // Not reached: the claim above reserved a task
+
+        TRACE_BEGIN("line", "line", task->seq + 1);
+        char *text = evaluate_task(task);
+        TRACE_END();
+
+        // Publish the result into its reorder slot
+        pthread_mutex_lock(&pool->lock);
+        batch_slot *slot = &pool->window[task->seq % pool->window_size];
+        slot->text = text;
+        slot->ready = 1;
+        pthread_cond_broadcast(&pool->done_cond);
+        pthread_mutex_unlock(&pool->lock);
+
+        free(task->line);
+        free(task);
+    }
+    return NULL;
+}
+
+/**
+ * Wait for the result with sequence number seq and write it to out
+ * @param pool: shared pool
+ * @param seq: sequence number of the oldest unwritten result
+ * @param out: output stream
+ */
+static void emit_result(batch_pool *pool, long seq, FILE *out)
+{
+    batch_slot *slot = &pool->window[seq % pool->window_size];
+
+    pthread_mutex_lock(&pool->lock);
+    while (!slot->ready)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    char *text = slot->text;
+    slot->text = NULL;
+    slot->ready = 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (text != NULL)
+        fprintf(out, "%s\n", text);
+    else
+        fprintf(out, "error: out of memory\n");
+    free(text);
+}
+
+/* ============================================================================
+ * BATCH DRIVER
+ * ============================================================================ */
+
+/**
+ * Evaluate every line of a batch file in parallel, writing results in input order
+ * @param path: batch file path ("-" reads standard input)
+ * @param num_threads: worker threads to use (0 = one per online CPU)
+ * @param out: stream receiving one result line per input line
+ * @return: SUCCESS, or FAILURE if the file cannot be read or setup fails
+ */
+int run_batch(const char *path, int num_threads, FILE *out)
+{
+    FILE *in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (in == NULL)
+        return FAILURE;
+
+    if (num_threads <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (cpus > 0) ? (int)cpus : 1;
+    }
+
+    // Step 1: Set up the pool, one deque per worker
+    batch_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.num_workers = num_threads;
+    pool.window_size = (long)num_threads * BATCH_WINDOW_PER_THREAD;
+    pool.deques = calloc(num_threads, sizeof(batch_deque));
+    pool.window = calloc(pool.window_size, sizeof(batch_slot));
+    batch_worker *workers = calloc(num_threads, sizeof(batch_worker));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    if (pool.deques == NULL || pool.window == NULL || workers == NULL || threads == NULL)
+    {
+        free(pool.deques);
+        free(pool.window);
+        free(workers);
+        free(threads);
+        if (in != stdin)
+            fclose(in);
+        return FAILURE;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work_cond, NULL);
+    pthread_cond_init(&pool.done_cond, NULL);
+
+    int started = 0; // Number of worker threads actually running
+    int status = SUCCESS;
+    for (int i = 0; i < num_threads; i++)
+    {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].capacity = BATCH_DEQUE_CAPACITY;
+        pool.deques[i].tasks = malloc(BATCH_DEQUE_CAPACITY * sizeof(batch_task *));
+        if (pool.deques[i].tasks == NULL)
+            status = FAILURE;
+    }
+    for (int i = 0; status == SUCCESS && i < num_threads; i++)
+    {
+        workers[i].pool = &pool;
+        workers[i].id = i;
+        if (pthread_create(&threads[i], NULL, batch_worker_main, &workers[i]) != 0)
+            status = FAILURE;
+        else
+            started++;
+    }
+
+    // Step 2: Read lines, hand them out round-robin, write results in order
+    long next_seq = 0;      // Sequence number of the next line read
+    long next_emit = 0;     // Sequence number of the next result written
+    char *line = NULL;
+    size_t line_capacity = 0;
+
+    while (status == SUCCESS && getline(&line, &line_capacity, in) != -1)
+    {
+        // Reorder buffer full: write out the oldest result first
+        while (next_seq - next_emit >= pool.window_size)
+            emit_result(&pool, next_emit++, out);
+
+        batch_task *task = calloc(1, sizeof(batch_task));
+        char *copy = (task != NULL) ? strdup(line) : NULL;
+        if (copy == NULL)
+        {
+            free(task);
+            status = FAILURE;
+            break;
+        }
+        task->seq = next_seq++;
+        task->line = copy;
+
+        if (deque_push(&pool.deques[task->seq % num_threads], task) == FAILURE)
+        {
+            free(copy);
+            free(task);
+            next_seq--;
+            status = FAILURE;
+            break;
+        }
+        pthread_mutex_lock(&pool.lock);
+        pool.queued++;
+        pthread_cond_signal(&pool.work_cond);
+        pthread_mutex_unlock(&pool.lock);
+    }
+    free(line);
+
+    // Step 3: No more input - let the workers drain and write the tail
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.work_cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    if (started > 0)
+    {
+        while (next_emit < next_seq)
+            emit_result(&pool, next_emit++, out);
+    }
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    fflush(out);
+
+    // Step 4: Clean up
+    for (int i = 0; i < num_threads; i++)
+    {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+        free(pool.deques[i].tasks);
+    }
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.work_cond);
+    pthread_cond_destroy(&pool.done_cond);
+    free(pool.deques);
+    free(pool.window);
+    free(workers);
+    free(threads);
+    if (in != stdin)
+        fclose(in);
+    return status;
+}
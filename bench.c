@@ -0,0 +1,496 @@
+#include "apc.h"
+#include <math.h>
+#include <time.h>
+
+/* ============================================================================
+ * BENCHMARK SUITE
+ * Times every operation over operand sizes from 10 to 10^7 digits and prints
+ * median / p90 / p99 timings and ns per digit as a table, CSV and JSON.
+ *
+ *   ./apc_bench [--max-digits=N] [--reps=N] [--budget=SECONDS] [--seed=N]
+ *               [--ops=add,sub,mul,div,lmul,ldiv] [--csv=FILE] [--json=FILE]
+ *               [--compare=BASELINE.csv] [--tolerance=PERCENT]
+ *
+ * Operands come from a seeded splitmix64 generator, so every run measures the
+ * same numbers. Each operation runs in two shapes: "balanced" (equal lengths;
+ * for division the divisor has half the digits) and "unbalanced" (second
+ * operand 10x shorter). The limb tiers (lmul, ldiv) time limb_mul and
+ * limb_divmod on base 10^8 limbs of the same sizes.
+ *
+ * Sizes grow 10x at a time. A size is skipped once the previous size's median,
+ * scaled by the operation's growth rate, predicts more than --budget seconds
+ * for the whole case, so quadratic operations stop early instead of running
+ * for hours.
+ *
+ * --compare reads a CSV written by an earlier run and flags every case whose
+ * median is more than --tolerance percent slower (exit status 1).
+ * ============================================================================ */
+
+#define BENCH_MAX_SAMPLES 101
+
+/* ----------------------------------------------------------------------------
+ * bench_op: one operation under test
+ * ---------------------------------------------------------------------------- */
+typedef struct bench_op
+{
+    const char *name;       // Name used in reports and --ops
+    double growth;          // Time exponent in the operand size (for skipping)
+} bench_op;
+
+static const bench_op bench_ops[] =
+{
+    { "add",  1.0 },
+    { "sub",  1.0 },
+    { "mul",  2.0 },
+    { "div",  2.0 },
+    { "lmul", 1.585 },  // Karatsuba
+    { "ldiv", 2.0 },
+};
+#define BENCH_OP_COUNT (int)(sizeof(bench_ops) / sizeof(bench_ops[0]))
+
+/* ----------------------------------------------------------------------------
+ * bench_result: statistics of one (operation, shape, size) case
+ * ---------------------------------------------------------------------------- */
+typedef struct bench_result
+{
+    const char *op;
+    const char *shape;
+    size_t digits1, digits2;
+    int reps;
+    double median_ns, p90_ns, p99_ns, min_ns;
+    double ns_per_digit;    // Median over the total input digits
+} bench_result;
+
+/* ============================================================================
+ * OPERAND GENERATION
+ * ============================================================================ */
+
+/**
+ * splitmix64: small, fast, and the same sequence on every platform
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Build a random number with exactly `digits` digits (no leading zero)
+ * @return: SUCCESS or FAILURE (out of memory)
+ */
+static int random_operand(size_t digits, uint64_t *state, Dlist **head, Dlist **tail)
+{
+    *head = NULL;
+    *tail = NULL;
+    uint64_t bits = 0;
+    int left = 0;
+    for (size_t i = 0; i < digits; i++)
+    {
+        if (left == 0)
+        {
+            bits = next_random(state);
+            left = 19; // 19 decimal digits per 64-bit draw
+        }
+        int digit = (int)(bits % 10);
+        bits /= 10;
+        left--;
+        if (i == 0 && digit == 0)
+            digit = 1 + (int)(next_random(state) % 9);
+        if (dl_insert_last(head, tail, digit) == FAILURE)
+        {
+            dl_delete_list(head, tail);
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentile of sorted samples
+ */
+static double percentile(const double *sorted, int count, double p)
+{
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * Run an operation once and return its time in nanoseconds
+ * Operands are only read; the result is freed outside the timed region
+ * @return: elapsed ns, or -1 on failure
+ */
+static double run_once(const char *op, Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+                       const limb_t *limbs1, size_t count1, const limb_t *limbs2, size_t count2)
+{
+    Dlist *h1 = head1, *t1 = tail1, *h2 = head2, *t2 = tail2; // sub_number may swap these
+    Dlist *head3 = NULL, *tail3 = NULL;
+    Dlist *remainder_head = NULL, *remainder_tail = NULL;
+    int status = SUCCESS;
+    double start, elapsed;
+
+    if (op[0] == 'l') // Limb tiers: allocate outside the timed region
+    {
+        size_t out_count = count1 + count2;
+        limb_t *out = malloc(out_count * sizeof(limb_t));
+        limb_t *rem = malloc(count2 * sizeof(limb_t));
+        if (out == NULL || rem == NULL)
+        {
+            free(out);
+            free(rem);
+            return -1;
+        }
+        start = now_ns();
+        if (strcmp(op, "lmul") == 0)
+            status = limb_mul(out, limbs1, count1, limbs2, count2, LIMB_DECIMAL_BASE);
+        else
+            status = limb_divmod(out, rem, limbs1, count1, limbs2, count2, LIMB_DECIMAL_BASE);
+        elapsed = now_ns() - start;
+        free(out);
+        free(rem);
+        return (status == SUCCESS) ? elapsed : -1;
+    }
+
+    start = now_ns();
+    if (strcmp(op, "add") == 0)
+        status = add_number(&h1, &t1, &h2, &t2, &head3, &tail3);
+    else if (strcmp(op, "sub") == 0)
+        sub_number(&h1, &t1, &h2, &t2, &head3, &tail3, NULL, NULL);
+    else if (strcmp(op, "mul") == 0)
+        status = mul_number(&h1, &t1, &h2, &t2, &head3, &tail3);
+    else
+        status = div_number(&h1, &t1, &h2, &t2, &head3, &tail3,
+                            &remainder_head, &remainder_tail, '/');
+    elapsed = now_ns() - start;
+
+    dl_delete_list(&head3, &tail3);
+    dl_delete_list(&remainder_head, &remainder_tail);
+    return (status == SUCCESS) ? elapsed : -1;
+}
+
+/**
+ * Time one case: fresh deterministic operands, `reps` timed runs
+ * (fewer once a single run passes one second, never fewer than 3)
+ * @return: SUCCESS or FAILURE
+ */
+static int bench_case(const char *op, const char *shape, size_t digits1, size_t digits2,
+                      int reps, uint64_t seed, bench_result *result)
+{
+    uint64_t state = seed ^ (digits1 * 0x100000001B3ULL) ^ digits2;
+    Dlist *head1, *tail1, *head2, *tail2;
+    if (random_operand(digits1, &state, &head1, &tail1) == FAILURE)
+        return FAILURE;
+    if (random_operand(digits2, &state, &head2, &tail2) == FAILURE)
+    {
+        dl_delete_list(&head1, &tail1);
+        return FAILURE;
+    }
+
+    limb_t *limbs1 = NULL, *limbs2 = NULL;
+    size_t count1 = 0, count2 = 0;
+    if (op[0] == 'l')
+    {
+        limbs1 = list_to_limbs(head1, tail1, &count1);
+        limbs2 = list_to_limbs(head2, tail2, &count2);
+    }
+
+    double samples[BENCH_MAX_SAMPLES];
+    int taken = 0;
+    int status = SUCCESS;
+    if (op[0] == 'l' && (limbs1 == NULL || limbs2 == NULL))
+        status = FAILURE;
+    else
+        run_once(op, head1, tail1, head2, tail2, limbs1, count1, limbs2, count2); // Warm-up
+    while (status == SUCCESS && taken < reps)
+    {
+        double ns = run_once(op, head1, tail1, head2, tail2, limbs1, count1, limbs2, count2);
+        if (ns < 0)
+            status = FAILURE;
+        else
+            samples[taken++] = ns;
+        if (ns > 1e9 && taken >= 3)
+            break; // Slow case: three samples are enough
+    }
+
+    free(limbs1);
+    free(limbs2);
+    dl_delete_list(&head1, &tail1);
+    dl_delete_list(&head2, &tail2);
+    if (status == FAILURE)
+        return FAILURE;
+
+    qsort(samples, (size_t)taken, sizeof(double), compare_doubles);
+    result->op = op;
+    result->shape = shape;
+    result->digits1 = digits1;
+    result->digits2 = digits2;
+    result->reps = taken;
+    result->median_ns = percentile(samples, taken, 50);
+    result->p90_ns = percentile(samples, taken, 90);
+    result->p99_ns = percentile(samples, taken, 99);
+    result->min_ns = samples[0];
+    result->ns_per_digit = result->median_ns / (double)(digits1 + digits2);
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * REPORTS
+ * ============================================================================ */
+
+static void write_csv(FILE *out, const bench_result *results, int count)
+{
+    fprintf(out, "op,shape,digits1,digits2,reps,median_ns,p90_ns,p99_ns,min_ns,ns_per_digit\n");
+    for (int i = 0; i < count; i++)
+    {
+        const bench_result *r = &results[i];
+        fprintf(out, "%s,%s,%zu,%zu,%d,%.0f,%.0f,%.0f,%.0f,%.4f\n", r->op, r->shape,
+                r->digits1, r->digits2, r->reps, r->median_ns, r->p90_ns, r->p99_ns,
+                r->min_ns, r->ns_per_digit);
+    }
+}
+
+static void write_json(FILE *out, const bench_result *results, int count)
+{
+    fprintf(out, "[\n");
+    for (int i = 0; i < count; i++)
+    {
+        const bench_result *r = &results[i];
+        fprintf(out, "  {\"op\": \"%s\", \"shape\": \"%s\", \"digits1\": %zu, \"digits2\": %zu, "
+                "\"reps\": %d, \"median_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, "
+                "\"min_ns\": %.0f, \"ns_per_digit\": %.4f}%s\n", r->op, r->shape, r->digits1,
+                r->digits2, r->reps, r->median_ns, r->p90_ns, r->p99_ns, r->min_ns,
+                r->ns_per_digit, (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+/**
+ * Write a report to a file
+ * @return: SUCCESS or FAILURE (file could not be written)
+ */
+static int save_report(const char *path, void (*writer)(FILE *, const bench_result *, int),
+                       const bench_result *results, int count)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+        return FAILURE;
+    writer(out, results, count);
+    return (fclose(out) == 0) ? SUCCESS : FAILURE;
+}
+
+/**
+ * Compare medians against a baseline CSV and print one line per matching case
+ * @param tolerance: allowed slowdown in percent before a case is flagged
+ * @return: number of regressions, or -1 if the baseline cannot be read
+ */
+static int compare_baseline(const char *path, const bench_result *results, int count,
+                            double tolerance)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL)
+        return -1;
+
+    int regressions = 0;
+    char line[512];
+    printf("\n%-5s %-10s %10s %10s %14s %14s %8s\n",
+           "op", "shape", "digits1", "digits2", "base_ns", "now_ns", "change");
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        char op[16], shape[16];
+        size_t digits1, digits2;
+        int reps;
+        double median;
+        if (sscanf(line, "%15[^,],%15[^,],%zu,%zu,%d,%lf", op, shape, &digits1, &digits2,
+                   &reps, &median) != 6)
+            continue; // Header or foreign line
+        for (int i = 0; i < count; i++)
+        {
+            const bench_result *r = &results[i];
+            if (strcmp(r->op, op) != 0 || strcmp(r->shape, shape) != 0 ||
+                r->digits1 != digits1 || r->digits2 != digits2)
+                continue;
+            double change = (median > 0) ? (r->median_ns / median - 1.0) * 100.0 : 0.0;
+            int regressed = change > tolerance;
+            regressions += regressed;
+            printf("%-5s %-10s %10zu %10zu %14.0f %14.0f %+7.1f%%%s\n", op, shape, digits1,
+                   digits2, median, r->median_ns, change, regressed ? "  REGRESSION" : "");
+        }
+    }
+    fclose(in);
+    return regressions;
+}
+
+/* ============================================================================
+ * MAIN FUNCTION
+ * ============================================================================ */
+
+/**
+ * Is `name` listed in a comma separated list?
+ */
+static int list_contains(const char *list, const char *name)
+{
+    size_t length = strlen(name);
+    for (const char *p = list; *p != '\0';)
+    {
+        const char *end = strchr(p, ',');
+        size_t item = (end != NULL) ? (size_t)(end - p) : strlen(p);
+        if (item == length && strncmp(p, name, length) == 0)
+            return 1;
+        p += item + (end != NULL);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_digits = 10000000;
+    int reps = 11;
+    double budget = 10.0;           // Seconds allowed per case (prediction)
+    uint64_t seed = 20251107;
+    double tolerance = 10.0;        // Percent
+    const char *ops = "add,sub,mul,div,lmul,ldiv";
+    const char *csv_path = NULL, *json_path = NULL, *baseline_path = NULL;
+
+    // Step 1: Options
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--max-digits=", 13) == 0)
+            max_digits = strtoull(argv[i] + 13, NULL, 10);
+        else if (strncmp(argv[i], "--reps=", 7) == 0)
+            reps = atoi(argv[i] + 7);
+        else if (strncmp(argv[i], "--budget=", 9) == 0)
+            budget = atof(argv[i] + 9);
+        else if (strncmp(argv[i], "--seed=", 7) == 0)
+            seed = strtoull(argv[i] + 7, NULL, 10);
+        else if (strncmp(argv[i], "--ops=", 6) == 0)
+            ops = argv[i] + 6;
+        else if (strncmp(argv[i], "--csv=", 6) == 0)
+            csv_path = argv[i] + 6;
+        else if (strncmp(argv[i], "--json=", 7) == 0)
+            json_path = argv[i] + 7;
+        else if (strncmp(argv[i], "--compare=", 10) == 0)
+            baseline_path = argv[i] + 10;
+        else if (strncmp(argv[i], "--tolerance=", 12) == 0)
+            tolerance = atof(argv[i] + 12);
+        else
+        {
+            printf("📝 Usage: %s [--max-digits=N] [--reps=N] [--budget=SECONDS] [--seed=N]\n"
+                   "          [--ops=add,sub,mul,div,lmul,ldiv] [--csv=FILE] [--json=FILE]\n"
+                   "          [--compare=BASELINE.csv] [--tolerance=PERCENT]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1)
+        reps = 1;
+    if (reps > BENCH_MAX_SAMPLES)
+        reps = BENCH_MAX_SAMPLES;
+
+    // Step 2: Every operation x shape x size, smallest first
+    size_t capacity = 256;
+    int count = 0;
+    bench_result *results = malloc(capacity * sizeof(bench_result));
+    if (results == NULL)
+        return 1;
+    static const char *shapes[] = { "balanced", "unbalanced" };
+
+    printf("%-5s %-10s %10s %10s %5s %14s %14s %14s %10s\n", "op", "shape", "digits1", "digits2",
+           "reps", "median_ns", "p90_ns", "p99_ns", "ns/digit");
+    for (int o = 0; o < BENCH_OP_COUNT; o++)
+    {
+        const bench_op *op = &bench_ops[o];
+        if (!list_contains(ops, op->name))
+            continue;
+        for (int s = 0; s < 2; s++)
+        {
+            double last_ns = 0;
+            for (size_t digits = 10; digits <= max_digits; digits *= 10)
+            {
+                // Predict this size from the previous one; stop when over budget
+                double single = last_ns * pow(10.0, op->growth);
+                double predicted = single * ((single > 1e9) ? 4 : reps + 1); // Warm-up included
+                if (last_ns > 0 && predicted > budget * 1e9)
+                    break;
+
+                size_t digits2 = (s == 0) ? ((strcmp(op->name, "div") == 0 ||
+                                              strcmp(op->name, "ldiv") == 0) ? digits / 2 : digits)
+                                          : digits / 10;
+                if (digits2 == 0)
+                    digits2 = 1;
+                if (count == (int)capacity)
+                {
+                    capacity *= 2;
+                    bench_result *bigger = realloc(results, capacity * sizeof(bench_result));
+                    if (bigger == NULL)
+                        break;
+                    results = bigger;
+                }
+                if (bench_case(op->name, shapes[s], digits, digits2, reps, seed,
+                               &results[count]) == FAILURE)
+                {
+                    printf("⚠️ %s %s %zu digits: out of memory, stopping this series\n",
+                           op->name, shapes[s], digits);
+                    break;
+                }
+                const bench_result *r = &results[count++];
+                printf("%-5s %-10s %10zu %10zu %5d %14.0f %14.0f %14.0f %10.3f\n", r->op, r->shape,
+                       r->digits1, r->digits2, r->reps, r->median_ns, r->p90_ns, r->p99_ns,
+                       r->ns_per_digit);
+                fflush(stdout);
+                last_ns = r->median_ns;
+            }
+        }
+    }
+
+    // Step 3: Reports and baseline comparison
+    int exit_code = 0;
+    if (csv_path != NULL && save_report(csv_path, write_csv, results, count) == FAILURE)
+    {
+        printf("❌ Error: cannot write '%s'\n", csv_path);
+        exit_code = 1;
+    }
+    if (json_path != NULL && save_report(json_path, write_json, results, count) == FAILURE)
+    {
+        printf("❌ Error: cannot write '%s'\n", json_path);
+        exit_code = 1;
+    }
+    if (baseline_path != NULL)
+    {
+        int regressions = compare_baseline(baseline_path, results, count, tolerance);
+        if (regressions < 0)
+        {
+            printf("❌ Error: cannot read baseline '%s'\n", baseline_path);
+            exit_code = 1;
+        }
+        else if (regressions > 0)
+        {
+            printf("⚠️ %d case(s) more than %.1f%% slower than the baseline\n", regressions, tolerance);
+            exit_code = 1;
+        }
+        else
+            printf("✅ No regressions beyond %.1f%%\n", tolerance);
+    }
+    free(results);
+    return exit_code;
+}
@@ -0,0 +1,482 @@
+#include "apc.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * LARGE BUFFERS AND NODE SLABS
+ * Limb buffers of BIG_ALLOC_THRESHOLD bytes or more get a mapping of their
+ * own: aligned to a 2 MiB huge page, rounded up to whole huge pages, marked
+ * MADV_HUGEPAGE and, with --numa, bound by mbind to the node of the thread
+ * that touches it first (local) or spread over every node (interleave).
+ * Smaller buffers keep using malloc.
+ *
+ * Dlist nodes come from 2 MiB slabs allocated the same way, so a 100M digit
+ * list spans a few thousand huge pages instead of 100M scattered heap
+ * chunks. Each thread keeps a cache of at most NODE_CACHE_MAX free nodes
+ * plus a range of fresh ones; it takes NODE_BATCH at a time from the shared
+ * pool (a range when the slab has no given-back node) and gives NODE_BATCH
+ * back once it holds more (nodes freed by another thread than the one that
+ * allocated them included), and all of them when it exits. The pool keeps
+ * free nodes per slab, found from a node by masking its address (slabs are
+ * 2 MiB aligned), and unmaps a slab as soon as all its nodes are back,
+ * keeping NODE_EMPTY_KEEP empty slabs for the next job. So after a large
+ * job the process holds at most the caches and one spare slab, not its
+ * peak. The memory budget still counts MEM_NODE_BYTES per live node.
+ *
+ * Every large mapping is followed by one PROT_NONE guard page so the kernel
+ * never merges two of them; that keeps the huge-page count of each buffer
+ * readable from /proc/self/smaps (only while big_track is on).
+ * ============================================================================ */
+
+#define HUGE_PAGE_BYTES (2UL << 20)     // x86-64 / arm64 transparent huge page
+#define NODE_SLAB_BYTES HUGE_PAGE_BYTES // One huge page of Dlist nodes
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3               // From <numaif.h>, which libnuma ships
+#endif
+#ifndef MPOL_LOCAL
+#define MPOL_LOCAL      4
+#endif
+
+static int numa_mode = NUMA_DEFAULT;    // Placement for new large mappings
+static int numa_loaded;                 // Set once APC_NUMA has been read
+static int huge_tracking;               // Measure huge pages of each large buffer when freed
+static size_t huge_freed_bytes;         // Bytes of large buffers measured when freed
+static size_t huge_freed_backed;        // Of those, bytes that were in huge pages
+static size_t huge_buffers;             // Large mappings made so far
+
+#define NODE_BATCH      4096            // Nodes moved between a thread cache and the pool at once
+#define NODE_CACHE_MAX  (2 * NODE_BATCH) // Most free nodes one thread keeps
+#define NODE_EMPTY_KEEP 1               // Empty slabs the pool keeps mapped
+
+/* ----------------------------------------------------------------------------
+ * node_slab: header at the start of each node slab (pool state, node_lock)
+ * ---------------------------------------------------------------------------- */
+typedef struct node_slab
+{
+    struct node_slab *prev;     // Neighbours in the list of slabs with free nodes
+    struct node_slab *next;
+    Dlist *free;                // Nodes given back, linked by next
+    char *unused;               // Nodes never handed out start here
+    size_t free_count;          // Given back plus never handed out
+} node_slab;
+
+#define NODE_SLAB_FIRST ((sizeof(node_slab) + sizeof(Dlist) - 1) / sizeof(Dlist) * sizeof(Dlist))
+#define NODE_SLAB_NODES ((NODE_SLAB_BYTES - NODE_SLAB_FIRST) / sizeof(Dlist))
+
+static pthread_mutex_t node_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t node_once = PTHREAD_ONCE_INIT;
+static pthread_key_t node_key;          // Only there to run node_thread_exit
+static node_slab *node_partial;         // Slabs with free nodes (node_lock)
+static size_t node_empty;               // Of those, slabs with every node free (node_lock)
+static __thread Dlist *node_cache;      // Free nodes of this thread, linked by next
+static __thread size_t node_cached;     // Length of node_cache
+static __thread char *slab_next;        // Fresh nodes reserved for this thread (not in node_cached)
+static __thread char *slab_end;
+static __thread int node_registered;    // node_thread_exit will run for this thread
+
+/**
+ * Parse a --numa= value
+ * @param text: "local", "interleave" or "off"
+ * @param mode: receives NUMA_LOCAL, NUMA_INTERLEAVE or NUMA_DEFAULT
+ * @return: SUCCESS, or FAILURE if the text is none of these
+ */
+int parse_numa_mode(const char *text, int *mode)
+{
+    if (text == NULL)
+        return FAILURE;
+    if (strcmp(text, "local") == 0)
+        *mode = NUMA_LOCAL;
+    else if (strcmp(text, "interleave") == 0)
+        *mode = NUMA_INTERLEAVE;
+    else if (strcmp(text, "off") == 0)
+        *mode = NUMA_DEFAULT;
+    else
+        return FAILURE;
+    return SUCCESS;
+}
+
+/**
+ * Placement of the large mappings made from now on (--numa; overrides APC_NUMA)
+ * @param mode: NUMA_DEFAULT (kernel policy), NUMA_LOCAL or NUMA_INTERLEAVE
+ */
+void big_set_numa(int mode)
+{
+    __atomic_store_n(&numa_mode, mode, __ATOMIC_RELAXED);
+    __atomic_store_n(&numa_loaded, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Current placement, read from APC_NUMA on first use
+ */
+static int numa_current(void)
+{
+    if (!__atomic_load_n(&numa_loaded, __ATOMIC_ACQUIRE))
+    {
+        int mode = NUMA_DEFAULT;
+        if (parse_numa_mode(getenv("APC_NUMA"), &mode) == FAILURE)
+            mode = NUMA_DEFAULT; // Unset or malformed: kernel policy
+        int unset = NUMA_DEFAULT; // Keep a mode set meanwhile by big_set_numa
+        __atomic_compare_exchange_n(&numa_mode, &unset, mode, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        __atomic_store_n(&numa_loaded, 1, __ATOMIC_RELEASE);
+    }
+    return __atomic_load_n(&numa_mode, __ATOMIC_RELAXED);
+}
+
+/**
+ * Measure the huge pages of every large buffer when it is freed (--mem-report)
+ * @param on: nonzero to measure
+ */
+void big_track(int on)
+{
+    __atomic_store_n(&huge_tracking, on, __ATOMIC_RELAXED);
+}
+
+/**
+ * Apply the NUMA placement to a new mapping (best effort: ignored where
+ * mbind is missing or the machine has a single node)
+ */
+static void place_mapping(void *start, size_t bytes)
+{
+    int mode = numa_current();
+    if (mode == NUMA_DEFAULT)
+        return;
+
+#ifdef SYS_mbind
+    unsigned long nodes = 0; // Nodes 0-63, from /sys (e.g. "0-1" or "0,2")
+    if (mode == NUMA_INTERLEAVE)
+    {
+        FILE *file = fopen("/sys/devices/system/node/online", "r");
+        unsigned first, last;
+        int n;
+        while (file != NULL && (n = fscanf(file, "%u-%u", &first, &last)) >= 1)
+        {
+            if (n == 1)
+                last = first;
+            for (unsigned node = first; node <= last && node < 64; node++)
+                nodes |= 1UL << node;
+            if (fgetc(file) != ',')
+                break;
+        }
+        if (file != NULL)
+            fclose(file);
+        if (nodes == 0)
+            return;
+        syscall(SYS_mbind, start, bytes, MPOL_INTERLEAVE, &nodes, 64UL, 0U);
+    }
+    else
+        syscall(SYS_mbind, start, bytes, MPOL_LOCAL, NULL, 0UL, 0U);
+#else
+    (void)start;
+    (void)bytes;
+#endif
+}
+
+/**
+ * Map memory for a large buffer: huge-page aligned and sized, with a guard
+ * page after it
+ * @param bytes: size wanted
+ * @return: zero-filled memory, or NULL
+ */
+static void *map_huge(size_t bytes)
+{
+    size_t length = (bytes + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    // Step 1: Reserve enough to align, then trim the excess on both sides
+    size_t reserve = length + HUGE_PAGE_BYTES + page;
+    char *raw = mmap(NULL, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    char *start = (char *)(((uintptr_t)raw + HUGE_PAGE_BYTES - 1) & ~(uintptr_t)(HUGE_PAGE_BYTES - 1));
+    char *end = start + length + page; // Data, then the guard page
+    if (start > raw)
+        munmap(raw, (size_t)(start - raw));
+    if (raw + reserve > end)
+        munmap(end, (size_t)(raw + reserve - end));
+    mprotect(start + length, page, PROT_NONE);
+
+    // Step 2: Ask for huge pages and the NUMA placement before the first touch
+#ifdef MADV_HUGEPAGE
+    madvise(start, length, MADV_HUGEPAGE);
+#endif
+    place_mapping(start, length);
+    __atomic_add_fetch(&huge_buffers, 1, __ATOMIC_RELAXED);
+    return start;
+}
+
+/**
+ * Resident and huge-page kilobytes of mappings in /proc/self/smaps
+ * @param start: the mapping starting at this address, or NULL for every
+ *               mapping marked MADV_HUGEPAGE ("hg" in VmFlags)
+ * @param rss_kb: receives the resident kilobytes
+ * @param huge_kb: receives the kilobytes in huge pages
+ */
+static void smaps_usage(const void *start, size_t *rss_kb, size_t *huge_kb)
+{
+    *rss_kb = *huge_kb = 0;
+    FILE *file = fopen("/proc/self/smaps", "r");
+    if (file == NULL)
+        return;
+
+    char line[512];
+    size_t rss = 0, huge = 0;
+    int selected = 0; // start given: this mapping is the one
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long from, to;
+        size_t kb;
+        if (sscanf(line, "%lx-%lx ", &from, &to) == 2 && strchr(line, '-') < strchr(line, ' '))
+        {
+            rss = huge = 0; // Header of the next mapping
+            selected = (start != NULL && from == (uintptr_t)start);
+        }
+        else if (sscanf(line, "Rss: %zu kB", &kb) == 1)
+            rss = kb;
+        else if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+            huge = kb;
+        else if (strncmp(line, "VmFlags:", 8) == 0 &&
+                 (selected || (start == NULL && strstr(line, " hg") != NULL)))
+        {
+            *rss_kb += rss;
+            *huge_kb += huge;
+            if (selected)
+                break;
+        }
+    }
+    fclose(file);
+}
+
+/**
+ * Allocate a limb buffer (large ones get their own huge-page mapping)
+ * @param bytes: size wanted
+ * @param zeroed: nonzero to get zero-filled memory
+ * @return: buffer to release with big_free(buffer, bytes), or NULL
+ */
+void *big_alloc(size_t bytes, int zeroed)
+{
+    if (bytes < BIG_ALLOC_THRESHOLD)
+        return zeroed ? calloc(1, bytes) : malloc(bytes);
+    return map_huge(bytes); // Fresh mappings are always zero-filled
+}
+
+/**
+ * Release a buffer from big_alloc
+ * @param buffer: buffer to free (NULL is ignored)
+ * @param bytes: the size it was allocated with
+ */
+void big_free(void *buffer, size_t bytes)
+{
+    if (buffer == NULL)
+        return;
+    if (bytes < BIG_ALLOC_THRESHOLD)
+    {
+        free(buffer);
+        return;
+    }
+    size_t length = (bytes + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+    if (__atomic_load_n(&huge_tracking, __ATOMIC_RELAXED))
+    {
+        size_t rss_kb, huge_kb;
+        smaps_usage(buffer, &rss_kb, &huge_kb);
+        __atomic_add_fetch(&huge_freed_bytes, rss_kb * 1024, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&huge_freed_backed, huge_kb * 1024, __ATOMIC_RELAXED);
+    }
+    munmap(buffer, length + (size_t)sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Huge-page use of the large mappings
+ * @param buffers: receives how many large mappings were made (slabs included)
+ * @param resident: receives their resident bytes (freed buffers as measured
+ *                  when freed, while big_track was on, plus live mappings)
+ * @param huge: receives the part of resident that was in huge pages
+ */
+void big_usage(size_t *buffers, size_t *resident, size_t *huge)
+{
+    size_t rss_kb, huge_kb;
+    smaps_usage(NULL, &rss_kb, &huge_kb);
+    *buffers = __atomic_load_n(&huge_buffers, __ATOMIC_RELAXED);
+    *resident = __atomic_load_n(&huge_freed_bytes, __ATOMIC_RELAXED) + rss_kb * 1024;
+    *huge = __atomic_load_n(&huge_freed_backed, __ATOMIC_RELAXED) + huge_kb * 1024;
+}
+
+/* ----------------------------------------------------------------------------
+ * Dlist node slabs
+ * ---------------------------------------------------------------------------- */
+
+/**
+ * Unlink a slab from the list of slabs with free nodes (node_lock held)
+ */
+static void slab_unlink(node_slab *slab)
+{
+    if (slab->prev != NULL)
+        slab->prev->next = slab->next;
+    else
+        node_partial = slab->next;
+    if (slab->next != NULL)
+        slab->next->prev = slab->prev;
+}
+
+/**
+ * Give up to count nodes of this thread's cache back to their slabs, and
+ * unmap every slab that gets all its nodes back beyond NODE_EMPTY_KEEP
+ * @param count: nodes to give back
+ */
+static void node_flush(size_t count)
+{
+    pthread_mutex_lock(&node_lock);
+    for (; count > 0 && node_cache != NULL; count--)
+    {
+        Dlist *node = node_cache;
+        node_cache = node->next;
+        node_cached--;
+        node_slab *slab = (node_slab *)((uintptr_t)node & ~(uintptr_t)(NODE_SLAB_BYTES - 1));
+        node->next = slab->free;
+        slab->free = node;
+        if (slab->free_count++ == 0) // Had none free: back on the list
+        {
+            slab->prev = NULL;
+            slab->next = node_partial;
+            if (node_partial != NULL)
+                node_partial->prev = slab;
+            node_partial = slab;
+        }
+        if (slab->free_count == NODE_SLAB_NODES)
+        {
+            if (node_empty < NODE_EMPTY_KEEP)
+                node_empty++;
+            else
+            {
+                slab_unlink(slab);
+                big_free(slab, NODE_SLAB_BYTES);
+            }
+        }
+    }
+    pthread_mutex_unlock(&node_lock);
+}
+
+/**
+ * Thread exit: give every cached node back to the pool
+ */
+static void node_thread_exit(void *unused)
+{
+    (void)unused;
+    for (; slab_next != NULL && slab_next < slab_end; slab_next += sizeof(Dlist), node_cached++)
+    {
+        Dlist *node = (Dlist *)slab_next;
+        node->next = node_cache;
+        node_cache = node;
+    }
+    node_flush(node_cached);
+}
+
+/**
+ * Create the key whose destructor is node_thread_exit
+ */
+static void node_key_create(void)
+{
+    pthread_key_create(&node_key, node_thread_exit);
+}
+
+/**
+ * Make sure node_thread_exit runs when the calling thread exits
+ */
+static void node_register(void)
+{
+    pthread_once(&node_once, node_key_create);
+    pthread_setspecific(node_key, &node_registered); // Any non-NULL value
+    node_registered = 1;
+}
+
+/**
+ * Refill the empty cache and range with up to NODE_BATCH nodes from one slab
+ * of the pool, mapping a new slab when no slab has a free node
+ * @return: SUCCESS, or FAILURE if no memory could be mapped
+ */
+static int node_refill(void)
+{
+    if (!node_registered)
+        node_register();
+    pthread_mutex_lock(&node_lock);
+    if (node_partial == NULL)
+    {
+        pthread_mutex_unlock(&node_lock);
+        node_slab *slab = map_huge(NODE_SLAB_BYTES);
+        if (slab == NULL)
+            return FAILURE;
+        slab->prev = slab->next = NULL;
+        slab->free = NULL;
+        slab->unused = (char *)slab + NODE_SLAB_FIRST;
+        slab->free_count = NODE_SLAB_NODES;
+        pthread_mutex_lock(&node_lock);
+        slab->next = node_partial;
+        if (node_partial != NULL)
+            node_partial->prev = slab;
+        node_partial = slab;
+        node_empty++;
+    }
+
+    // Given-back nodes first; fresh ones are reserved as one range, handed out
+    // by bumping slab_next. A slab that runs out leaves the list
+    node_slab *slab = node_partial;
+    if (slab->free_count == NODE_SLAB_NODES)
+        node_empty--;
+    if (slab->free == NULL)
+    {
+        size_t count = (slab->free_count < NODE_BATCH) ? slab->free_count : NODE_BATCH;
+        slab_next = slab->unused;
+        slab_end = slab_next + count * sizeof(Dlist);
+        slab->unused = slab_end;
+        slab->free_count -= count;
+    }
+    for (; node_cached < NODE_BATCH && slab->free != NULL; slab->free_count--, node_cached++)
+    {
+        Dlist *node = slab->free;
+        slab->free = node->next;
+        node->next = node_cache;
+        node_cache = node;
+    }
+    if (slab->free_count == 0)
+        slab_unlink(slab);
+    pthread_mutex_unlock(&node_lock);
+    return SUCCESS;
+}
+
+/**
+ * Allocate one Dlist node (fields uninitialized)
+ * @return: node to release with node_free, or NULL
+ */
+Dlist *node_alloc(void)
+{
+    Dlist *node = node_cache;
+    if (node != NULL)
+    {
+        node_cache = node->next;
+        node_cached--;
+        return node;
+    }
+    if (slab_next == slab_end && node_refill() == FAILURE)
+        return NULL;
+    if (node_cache != NULL) // Refilled with given-back nodes
+        return node_alloc();
+    node = (Dlist *)slab_next;
+    slab_next += sizeof(Dlist);
+    return node;
+}
+
+/**
+ * Release a node from node_alloc (any thread may free any node)
+ * @param node: node to free
+ */
+void node_free(Dlist *node)
+{
+    if (!node_registered)
+        node_register(); // Cached nodes are handed back even if this thread never allocated
+    node->next = node_cache;
+    node_cache = node;
+    if (++node_cached > NODE_CACHE_MAX)
+        node_flush(NODE_BATCH);
+}
@@ -44,21 +44,27 @@ int is_greater_or_equal(Dlist *head1, Dlist *head2)
  * @param src_head: head of source list to copy
  * @param dest_head: pointer to head pointer of destination (will be created)
  * @param dest_tail: pointer to tail pointer of destination (will be created)
+ * @return: SUCCESS, or FAILURE if out of memory (destination left empty)
  */
-void copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail)
+int copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail)
 {
     *dest_head = NULL; // Initialize destination
     *dest_tail = NULL;
 
     if (src_head == NULL)
-        return; // Nothing to copy if source is NULL
+        return SUCCESS; // Nothing to copy if source is NULL
 
     Dlist *current = src_head; // Start from source's head
     while (current != NULL) // Copy all digits
     {
-        dl_insert_last(dest_head, dest_tail, current->data); // Copy each digit
+        if (dl_insert_last(dest_head, dest_tail, current->data) == FAILURE) // Copy each digit
+        {
+            dl_delete_list(dest_head, dest_tail); // Never leave a partial copy
+            return FAILURE;
+        }
         current = current->next; // Move to next digit
     }
+    return SUCCESS;
 }
 
 /**
@@ -70,9 +76,10 @@ void copy_list(Dlist *src_head, Dlist **dest_head, Dlist **dest_tail)
  * @param tail2: pointer to tail pointer of second number
  * @param result_head: pointer to head pointer of result (will be cleared and filled)
  * @param result_tail: pointer to tail pointer of result (will be cleared and filled)
+ * @return: SUCCESS, or FAILURE if out of memory (result left empty)
  */
-void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
-                    Dlist **result_head, Dlist **result_tail)
+int subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                   Dlist **result_head, Dlist **result_tail)
 {
     // Clear result first (start with empty result)
     dl_delete_list(result_head, result_tail); // Clear existing digits
@@ -87,6 +94,7 @@ void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
 
     while (temp1 != NULL) // Process all digits of first number
     {
+        STATS_ADD(digit_ops, 1);
         digit1 = temp1->data; // Get digit from first number
         digit2 = (temp2 != NULL) ? temp2->data : 0; // Get digit from second number (0 if exhausted)
 
@@ -103,7 +111,11 @@ void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
 
         res_digit = digit1 - digit2; // Calculate result digit
-        dl_insert_first(result_head, result_tail, res_digit); // Store result (building from right to left)
+        if (dl_insert_first(result_head, result_tail, res_digit) == FAILURE) // Store result (building from right to left)
+        {
+            dl_delete_list(result_head, result_tail);
+            return FAILURE;
+        }
 
         temp1 = temp1->prev; // Move to previous digit (leftward)
         if (temp2 != NULL)
@@ -111,6 +123,60 @@ void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     }
 
     trim_leading_zeroes(result_head, result_tail); // Remove leading zeros from result
+    return SUCCESS;
+}
+
+/**
+ * Divide large operands on base 10^8 limbs (Knuth algorithm D)
+ * @param ch: '/' stores the quotient in head3, '%' the remainder
+ * @return: SUCCESS, or FAILURE on memory allocation error
+ */
+static int div_limbs(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+                     Dlist **head3, Dlist **tail3, Dlist **remainder_head, Dlist **remainder_tail,
+                     char ch)
+{
+    size_t count1 = 0, count2 = 0;
+    TRACE_BEGIN("to_limbs", NULL, 0);
+    limb_t *limbs1 = list_to_limbs(head1, tail1, &count1);
+    limb_t *limbs2 = list_to_limbs(head2, tail2, &count2);
+    TRACE_END();
+    int status = (limbs1 != NULL && limbs2 != NULL) ? SUCCESS : FAILURE;
+    limb_t *quotient = NULL, *remainder = NULL;
+    size_t quotient_count = (count1 >= count2) ? count1 - count2 + 1 : 1;
+    // Operands, quotient, remainder and limb_divmod's scaled copy (an + 1 + bn)
+    size_t charged = (2 * count1 + 3 * count2 + quotient_count + 1) * sizeof(limb_t);
+
+    if (status == SUCCESS)
+        status = mem_charge(charged); // FAILURE if over the memory budget
+    if (status == FAILURE)
+        charged = 0;
+    if (status == SUCCESS)
+    {
+        quotient = big_alloc(quotient_count * sizeof(limb_t), 1);
+        remainder = big_alloc(count2 * sizeof(limb_t), 1);
+        if (quotient == NULL || remainder == NULL)
+            status = FAILURE;
+    }
+    if (status == SUCCESS) // Caller made sure dividend >= divisor > 0
+        status = limb_divmod(quotient, remainder, limbs1, count1, limbs2, count2, LIMB_DECIMAL_BASE);
+    TRACE_BEGIN("to_list", NULL, 0);
+    if (status == SUCCESS)
+        status = limbs_to_list(remainder, count2, remainder_head, remainder_tail);
+    if (status == SUCCESS)
+    {
+        if (ch == '%')
+            status = copy_list(*remainder_head, head3, tail3);
+        else
+            status = limbs_to_list(quotient, quotient_count, head3, tail3);
+    }
+    TRACE_END();
+
+    free(limbs1);
+    free(limbs2);
+    big_free(quotient, quotient_count * sizeof(limb_t));
+    big_free(remainder, count2 * sizeof(limb_t));
+    mem_uncharge(charged);
+    return status;
 }
 
 /* ============================================================================
@@ -122,6 +188,8 @@ void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
 /**
  * Divide first number by second number
  * Algorithm: Long division (like division done by hand)
+ * Dividends of THRESHOLD_DIV_LIMB digits or more are divided on limbs
+ * instead (see div_limbs)
  * 
  * @param head1: pointer to head pointer of dividend
  * @param tail1: pointer to tail pointer of dividend
@@ -132,19 +200,29 @@ void subtract_lists(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
  * @param remainder_head: pointer to head pointer of remainder (will be created)
  * @param remainder_tail: pointer to tail pointer of remainder (will be created)
  * @param ch: operation character ('/' for division, '%' for modulus)
- * @return: SUCCESS on success, FAILURE if division by zero
+ * @return: SUCCESS on success, FAILURE if division by zero, out of memory or
+ *          over the memory budget (callers tell these apart with is_zero)
  */
 int div_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3, Dlist **remainder_head, Dlist **remainder_tail, char ch)
 {
     // Step 1: Check for division by zero (cannot divide by zero)
+    // Nothing is printed here - the caller decides how to report the error
     if (*head2 == NULL || ((*head2)->data == 0 && (*head2)->next == NULL))
     {
-        printf("❌ Division by zero error!\n");
-        printf("⚠️ Cannot divide by zero. Please use a non-zero divisor.\n");
         return FAILURE; // Return error if divisor is zero
     }
 
+    // Fail fast if quotient, remainder and the working partials cannot fit in the memory budget
+    if (mem_limit() != 0)
+    {
+        size_t len1 = (size_t)get_list_length(*head1), len2 = (size_t)get_list_length(*head2);
+        if (mem_check((len1 + 4 * (len2 + 1)) * MEM_NODE_BYTES) == FAILURE)
+            return FAILURE;
+    }
+
+    TRACE_BEGIN("div_number", "digits", get_list_length(*head1));
+
     // Clear result and remainder containers (start fresh)
     dl_delete_list(head3, tail3); // Clear quotient
     dl_delete_list(remainder_head, remainder_tail); // Clear remainder
@@ -152,21 +230,40 @@ int div_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     // Step 2: Check if dividend < divisor (result is 0, remainder is dividend)
     if (!is_greater_or_equal(*head1, *head2)) // If dividend is smaller than divisor
     {
+        int status;
         // Dividend is smaller: quotient is 0, remainder is dividend
         if (ch == '%') // Modulus operation requested
         {
             // For modulus, result is the dividend itself (remainder when dividing by larger number)
-            copy_list(*head1, head3, tail3); // Copy dividend to result
+            status = copy_list(*head1, head3, tail3); // Copy dividend to result
         }
         else // Regular division
         {
             // For division, quotient is 0 (smaller number divided by larger number)
-            dl_insert_last(head3, tail3, 0); // Quotient is zero
+            status = dl_insert_last(head3, tail3, 0); // Quotient is zero
         }
         
         // Remainder is the dividend (when dividend < divisor, remainder = dividend)
-        copy_list(*head1, remainder_head, remainder_tail); // Copy dividend to remainder
-        return SUCCESS; // Return success (no actual division needed)
+        if (status == SUCCESS)
+            status = copy_list(*head1, remainder_head, remainder_tail); // Copy dividend to remainder
+        if (status == FAILURE)
+            dl_delete_list(head3, tail3); // Out of memory: no partial results
+        TRACE_END();
+        return status; // No actual division needed
+    }
+
+    // Large dividends: Knuth D on limbs instead (crossover measured by make tune)
+    if ((size_t)get_list_length(*head1) >= get_threshold(THRESHOLD_DIV_LIMB))
+    {
+        int status = div_limbs(*head1, *tail1, *head2, *tail2, head3, tail3,
+                               remainder_head, remainder_tail, ch);
+        if (status == FAILURE)
+        {
+            dl_delete_list(head3, tail3); // Out of memory: no partial results
+            dl_delete_list(remainder_head, remainder_tail);
+        }
+        TRACE_END();
+        return status;
     }
 
     // Step 3: Perform long division (dividend >= divisor)
@@ -176,45 +273,51 @@ int div_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
 
     // Process dividend digit by digit from left to right (like long division)
     Dlist *dividend_ptr = *head1; // Pointer to current digit in dividend
+    int status = SUCCESS; // Becomes FAILURE if memory runs out
 
-    while (dividend_ptr != NULL) // Process all digits of dividend
+    while (dividend_ptr != NULL && status == SUCCESS) // Process all digits of dividend
     {
         // Bring down next digit from dividend (like bringing down in long division)
-        dl_insert_last(&current_partial_head, &current_partial_tail, dividend_ptr->data); // Add next digit
+        status = dl_insert_last(&current_partial_head, &current_partial_tail, dividend_ptr->data); // Add next digit
         trim_leading_zeroes(&current_partial_head, &current_partial_tail); // Remove any leading zeros
 
         // If current partial is still less than divisor, quotient digit is 0
-        if (!is_greater_or_equal(current_partial_head, *head2)) // Partial < divisor
+        if (status == FAILURE || !is_greater_or_equal(current_partial_head, *head2)) // Partial < divisor
         {
-            dl_insert_last(head3, tail3, 0); // Quotient digit is 0
+            if (status == SUCCESS)
+                status = dl_insert_last(head3, tail3, 0); // Quotient digit is 0
             dividend_ptr = dividend_ptr->next; // Move to next digit
             continue; // Skip to next iteration
         }
 
         // Find quotient digit by repeatedly subtracting divisor (count how many times divisor fits)
+        TRACE_BEGIN("quotient_digit", NULL, 0);
         int quotient_digit = 0; // Will count how many times divisor fits
         Dlist *temp_result_head = NULL; // Temporary storage for subtraction result
         Dlist *temp_result_tail = NULL;
 
         // Keep subtracting divisor from current_partial until it's smaller
-        while (is_greater_or_equal(current_partial_head, *head2)) // While partial >= divisor
+        while (status == SUCCESS && is_greater_or_equal(current_partial_head, *head2)) // While partial >= divisor
         {
+            STATS_ADD(div_rounds, 1);
             // Subtract divisor from current_partial
-            subtract_lists(&current_partial_head, &current_partial_tail, head2, tail2,
-                          &temp_result_head, &temp_result_tail); // Perform subtraction
+            status = subtract_lists(&current_partial_head, &current_partial_tail, head2, tail2,
+                                    &temp_result_head, &temp_result_tail); // Perform subtraction
 
-            // Update current_partial with the result
+            // Update current_partial with the result (moved, not copied)
             dl_delete_list(&current_partial_head, &current_partial_tail); // Free old partial
-            copy_list(temp_result_head, &current_partial_head, &current_partial_tail); // Copy result to partial
+            current_partial_head = temp_result_head;
+            current_partial_tail = temp_result_tail;
+            temp_result_head = temp_result_tail = NULL; // Ready for the next subtraction
 
             quotient_digit++; // Increment quotient digit (one more subtraction)
-            
-            // Clean up temp result for next iteration
-            dl_delete_list(&temp_result_head, &temp_result_tail);
         }
 
+        TRACE_END_ARG("rounds", quotient_digit);
+
         // Store quotient digit (how many times divisor fit into partial)
-        dl_insert_last(head3, tail3, quotient_digit);
+        if (status == SUCCESS)
+            status = dl_insert_last(head3, tail3, quotient_digit);
         dividend_ptr = dividend_ptr->next; // Move to next digit in dividend
     }
 
@@ -222,19 +325,30 @@ int div_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     trim_leading_zeroes(head3, tail3);
 
     // Step 5: Store remainder (current_partial is the final remainder after all divisions)
-    copy_list(current_partial_head, remainder_head, remainder_tail); // Copy remainder
+    if (status == SUCCESS)
+    {
+        *remainder_head = current_partial_head; // Moved, not copied
+        *remainder_tail = current_partial_tail;
+        current_partial_head = current_partial_tail = NULL;
+    }
     trim_leading_zeroes(remainder_head, remainder_tail); // Remove leading zeros from remainder
 
     // Step 6: Handle modulus operation - replace quotient with remainder
-    if (ch == '%') // If modulus operation was requested
+    if (ch == '%' && status == SUCCESS) // If modulus operation was requested
     {
         // Clear quotient and copy remainder to result (modulus returns remainder, not quotient)
         dl_delete_list(head3, tail3); // Clear quotient
-        copy_list(*remainder_head, head3, tail3); // Copy remainder to result
+        status = copy_list(*remainder_head, head3, tail3); // Copy remainder to result
     }
 
     // Clean up temporary variables
     dl_delete_list(&current_partial_head, &current_partial_tail); // Free working partial
+    if (status == FAILURE)
+    {
+        dl_delete_list(head3, tail3); // Out of memory: no partial results
+        dl_delete_list(remainder_head, remainder_tail);
+    }
 
-    return SUCCESS; // Division completed successfully
+    TRACE_END();
+    return status; // SUCCESS once the division is complete
 }
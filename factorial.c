@@ -0,0 +1,609 @@
+#include "apc.h"
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * FACTORIALS
+ * n!, C(n, k) and n# (primorial) on base 2^32 limbs.
+ *
+ * All three are products of many small factors, the worst shape for a chain
+ * of products (a huge number times a small one, over and over). Instead the
+ * factors are collected as prime powers, packed into 64-bit words at the
+ * leaves, and multiplied in a balanced product tree: every product joins
+ * two numbers of about the same size, where Karatsuba pays off. The top
+ * levels of the tree fork threads, one per online CPU.
+ *
+ * n! uses the prime swing: n! = (n/2)!^2 * swing(n), where the swing
+ * (n! / (n/2)!^2) is a product of primes with tiny exponents read off from
+ * n / p^i. The powers of two are left out of every swing and applied as one
+ * shift at the end, n! = 2^(n - popcount(n)) * odd part.
+ * C(n, k) takes the exponent of p from Kummer's theorem (the borrows of
+ * n - k in base p); for k small next to n it is the product of the k top
+ * terms n - k + 1 ... n with the primes of k! divided out of them, which
+ * needs a sieve up to k only. n# is the product of the primes up to n.
+ * ============================================================================ */
+
+#define FACT_SMALL_LIMIT 24     // Odd parts of smaller factorials fit a word
+#define FACT_LEAF_WORDS  16     // Product tree leaves: words multiplied one by one
+#define FACT_FORK_WORDS  512    // Smaller subtrees stay on the calling thread
+#define FACT_MAX_DEPTH   6      // Fork levels: up to 64 threads
+#define FACT_BINOM_RATIO 64     // C(n, k) with k < n / 64: the k top terms over k!
+
+/* ----------------------------------------------------------------------------
+ * fact_num: product on binary limbs (malloc'd, counted against the budget)
+ * ---------------------------------------------------------------------------- */
+typedef struct fact_num
+{
+    limb_t *d;      // Least significant limb first
+    size_t n;       // Limbs in use
+    size_t alloc;   // Limbs allocated
+} fact_num;
+
+/* ----------------------------------------------------------------------------
+ * factor_list: word factors (small factors share a word while it fits)
+ * ---------------------------------------------------------------------------- */
+typedef struct factor_list
+{
+    uint64_t *words;
+    size_t count;
+    size_t alloc;
+} factor_list;
+
+/* ----------------------------------------------------------------------------
+ * tree_job: one subtree of the product tree (argument of a forked thread)
+ * ---------------------------------------------------------------------------- */
+typedef struct tree_job
+{
+    const uint64_t *words;  // Factors of this subtree
+    size_t count;
+    int depth;              // Levels below that may still fork
+    fact_num result;
+    int status;
+} tree_job;
+
+/* ============================================================================
+ * NUMBERS AND FACTOR LISTS
+ * ============================================================================ */
+
+static int fact_alloc(fact_num *x, size_t n)
+{
+    x->d = NULL;
+    x->n = 0;
+    x->alloc = 0;
+    if (mem_charge(n * sizeof(limb_t)) == FAILURE)
+        return FAILURE;
+    x->d = malloc(n * sizeof(limb_t));
+    if (x->d == NULL)
+    {
+        mem_uncharge(n * sizeof(limb_t));
+        return FAILURE;
+    }
+    x->alloc = n;
+    return SUCCESS;
+}
+
+static void fact_free(fact_num *x)
+{
+    free(x->d);
+    mem_uncharge(x->alloc * sizeof(limb_t));
+    x->d = NULL;
+    x->n = 0;
+    x->alloc = 0;
+}
+
+/**
+ * r = a * b (new number)
+ */
+static int fact_mul(fact_num *r, const fact_num *a, const fact_num *b)
+{
+    if (fact_alloc(r, a->n + b->n) == FAILURE)
+        return FAILURE;
+    if (limb_mul(r->d, a->d, a->n, b->d, b->n, LIMB_BINARY_BASE) == FAILURE)
+    {
+        fact_free(r);
+        return FAILURE;
+    }
+    r->n = limb_normalize(r->d, a->n + b->n);
+    return SUCCESS;
+}
+
+/**
+ * a = a * w in place (a->d has room for a->n + 2 limbs)
+ */
+static void fact_mul_word(fact_num *a, uint64_t w)
+{
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < a->n; i++)
+    {
+        carry += (unsigned __int128)a->d[i] * w;
+        a->d[i] = (limb_t)carry;
+        carry >>= 32;
+    }
+    a->d[a->n] = (limb_t)carry;
+    a->d[a->n + 1] = (limb_t)(carry >> 32);
+    a->n = limb_normalize(a->d, a->n + 2);
+}
+
+/**
+ * Append a factor, sharing the last word while the product fits
+ */
+static int factor_push(factor_list *list, uint64_t f)
+{
+    if (list->count > 0 && list->words[list->count - 1] <= UINT64_MAX / f)
+    {
+        list->words[list->count - 1] *= f;
+        return SUCCESS;
+    }
+    if (list->count == list->alloc)
+    {
+        size_t alloc = list->alloc ? list->alloc * 2 : 256;
+        if (mem_charge((alloc - list->alloc) * sizeof(uint64_t)) == FAILURE)
+            return FAILURE;
+        uint64_t *words = realloc(list->words, alloc * sizeof(uint64_t));
+        if (words == NULL)
+        {
+            mem_uncharge((alloc - list->alloc) * sizeof(uint64_t));
+            return FAILURE;
+        }
+        list->words = words;
+        list->alloc = alloc;
+    }
+    list->words[list->count++] = f;
+    return SUCCESS;
+}
+
+static void factor_free(factor_list *list)
+{
+    free(list->words);
+    mem_uncharge(list->alloc * sizeof(uint64_t));
+    list->words = NULL;
+    list->count = 0;
+    list->alloc = 0;
+}
+
+/* ============================================================================
+ * PRIME SIEVE
+ * ============================================================================ */
+
+// Odd p is prime when its bit (index p / 2) is clear
+#define SIEVE_IS_PRIME(sieve, p) (!((sieve)[(p) >> 4] & (1u << (((p) >> 1) & 7))))
+
+/**
+ * Sieve of Eratosthenes over the odd numbers up to n, one bit each
+ * @return: new bit array (size sieve_bytes(n)), NULL if out of memory
+ */
+static size_t sieve_bytes(uint64_t n)
+{
+    return (size_t)(n / 16 + 1);
+}
+
+static uint8_t *sieve_odd(uint64_t n)
+{
+    size_t bytes = sieve_bytes(n);
+    if (mem_charge(bytes) == FAILURE)
+        return NULL;
+    uint8_t *sieve = calloc(bytes, 1);
+    if (sieve == NULL)
+    {
+        mem_uncharge(bytes);
+        return NULL;
+    }
+    TRACE_BEGIN("sieve", "n", n);
+    for (uint64_t p = 3; p * p <= n; p += 2)
+    {
+        if (!SIEVE_IS_PRIME(sieve, p))
+            continue;
+        for (uint64_t m = p * p; m <= n; m += 2 * p)
+            sieve[m >> 4] |= (uint8_t)(1u << ((m >> 1) & 7));
+    }
+    TRACE_END();
+    return sieve;
+}
+
+static void sieve_free(uint8_t *sieve, uint64_t n)
+{
+    free(sieve);
+    mem_uncharge(sieve_bytes(n));
+}
+
+/* ============================================================================
+ * PRODUCT TREE
+ * ============================================================================ */
+
+static int tree_product(tree_job *job);
+
+static void *tree_thread(void *arg)
+{
+    tree_job *job = arg;
+    job->status = tree_product(job);
+    stats_flush(); // Counters of this thread would be lost otherwise
+    return NULL;
+}
+
+/**
+ * Product of job->words: leaves one word at a time, then balanced halves,
+ * the left half on a new thread while fork levels remain
+ * @return: SUCCESS, or FAILURE if out of memory (result left empty)
+ */
+static int tree_product(tree_job *job)
+{
+    // Step 1: Leaves
+    if (job->count <= FACT_LEAF_WORDS)
+    {
+        if (fact_alloc(&job->result, 2 * job->count + 2) == FAILURE)
+            return FAILURE;
+        job->result.d[0] = 1;
+        job->result.n = 1;
+        for (size_t i = 0; i < job->count; i++)
+            fact_mul_word(&job->result, job->words[i]);
+        STATS_ADD(limb_ops, job->count * job->count);
+        return SUCCESS;
+    }
+
+    // Step 2: Halves, the left one on its own thread near the root
+    size_t half = job->count / 2;
+    tree_job left = { job->words, half, job->depth - 1, { NULL, 0, 0 }, SUCCESS };
+    tree_job right = { job->words + half, job->count - half, job->depth - 1, { NULL, 0, 0 }, SUCCESS };
+    pthread_t thread;
+    int forked = (job->depth > 0 && job->count >= FACT_FORK_WORDS &&
+                  pthread_create(&thread, NULL, tree_thread, &left) == 0);
+    if (!forked)
+        left.status = tree_product(&left);
+    right.status = tree_product(&right);
+    if (forked)
+        pthread_join(thread, NULL);
+
+    // Step 3: Join them
+    int status = (left.status == SUCCESS && right.status == SUCCESS) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+        status = fact_mul(&job->result, &left.result, &right.result);
+    fact_free(&left.result);
+    fact_free(&right.result);
+    return status;
+}
+
+/**
+ * Fork levels for the online CPUs: 2^depth threads at most
+ */
+static int tree_depth(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 0;
+    while (depth < FACT_MAX_DEPTH && (1L << depth) < cpus)
+        depth++;
+    return depth;
+}
+
+/**
+ * r = product of the listed factors (1 for an empty list)
+ */
+static int list_product(const factor_list *list, fact_num *r)
+{
+    tree_job job = { list->words, list->count, tree_depth(), { NULL, 0, 0 }, SUCCESS };
+    TRACE_BEGIN("product_tree", "words", list->count);
+    int status = tree_product(&job);
+    TRACE_END();
+    *r = job.result;
+    return status;
+}
+
+/* ============================================================================
+ * PRIME SWING AND KUMMER EXPONENTS
+ * ============================================================================ */
+
+/**
+ * Odd part of the swing n! / floor(n/2)!^2: p^e for every odd prime p <= n,
+ * e = number of i >= 1 with floor(n / p^i) odd (p^e <= n, so each fits a word)
+ */
+static int swing_factors(uint64_t n, const uint8_t *sieve, factor_list *list)
+{
+    int status = SUCCESS;
+    for (uint64_t p = 3; p <= n && status == SUCCESS; p += 2)
+    {
+        if (!SIEVE_IS_PRIME(sieve, p))
+            continue;
+        if (p > n / 2)
+            status = factor_push(list, p);          // floor(n / p) = 1
+        else if (p > n / 3)
+            continue;                               // floor(n / p) = 2
+        else if (p * p > n)
+        {
+            if ((n / p) & 1)
+                status = factor_push(list, p);
+        }
+        else
+        {
+            uint64_t f = 1;
+            for (uint64_t q = n / p; q > 0; q /= p)
+            {
+                if (q & 1)
+                    f *= p;
+            }
+            if (f > 1)
+                status = factor_push(list, f);
+        }
+    }
+    return status;
+}
+
+/**
+ * Odd part of n!: oddfact(n) = oddfact(n/2)^2 * odd swing(n)
+ */
+static int odd_factorial(uint64_t n, const uint8_t *sieve, fact_num *r)
+{
+    // Step 1: Small n in one word
+    if (n < FACT_SMALL_LIMIT)
+    {
+        uint64_t f = 1;
+        for (uint64_t i = 3; i <= n; i++)
+            f *= i >> __builtin_ctzll(i);
+        if (fact_alloc(r, 2) == FAILURE)
+            return FAILURE;
+        r->d[0] = (limb_t)f;
+        r->d[1] = (limb_t)(f >> 32);
+        r->n = limb_normalize(r->d, 2);
+        return SUCCESS;
+    }
+
+    // Step 2: Half factorial squared, times the swing
+    fact_num half, square, swing;
+    factor_list list = { NULL, 0, 0 };
+    int status = odd_factorial(n / 2, sieve, &half);
+    if (status == SUCCESS)
+    {
+        status = fact_mul(&square, &half, &half);
+        fact_free(&half);
+    }
+    if (status == SUCCESS)
+    {
+        status = swing_factors(n, sieve, &list);
+        if (status == SUCCESS)
+            status = list_product(&list, &swing);
+        factor_free(&list);
+        if (status == SUCCESS)
+        {
+            status = fact_mul(r, &square, &swing);
+            fact_free(&swing);
+        }
+        fact_free(&square);
+    }
+    return status;
+}
+
+/**
+ * n! = odd part * 2^(n - popcount(n))
+ */
+static int factorial_core(uint64_t n, fact_num *r)
+{
+    uint8_t *sieve = sieve_odd(n);
+    if (sieve == NULL)
+        return FAILURE;
+    fact_num odd;
+    int status = odd_factorial(n, sieve, &odd);
+    sieve_free(sieve, n);
+
+    // Legendre: the exponent of 2 in n! is n minus the ones of n in binary
+    uint64_t shift = n - (uint64_t)__builtin_popcountll(n);
+    if (status == SUCCESS)
+    {
+        size_t limbs = (size_t)(shift / 32);
+        int bits = (int)(shift % 32);
+        status = fact_alloc(r, odd.n + limbs + 1);
+        if (status == SUCCESS)
+        {
+            memset(r->d, 0, limbs * sizeof(limb_t));
+            r->d[limbs + odd.n] = 0;
+            for (size_t i = odd.n; i-- > 0;)
+            {
+                r->d[limbs + i + 1] |= bits ? odd.d[i] >> (32 - bits) : 0;
+                r->d[limbs + i] = odd.d[i] << bits;
+            }
+            r->n = limb_normalize(r->d, odd.n + limbs + 1);
+        }
+        fact_free(&odd);
+    }
+    return status;
+}
+
+/**
+ * Whether C(n, k), k <= n - k, comes from its top terms (k small next to n)
+ */
+static int binomial_direct(uint64_t n, uint64_t k)
+{
+    return k < n / FACT_BINOM_RATIO;
+}
+
+/**
+ * C(n, k) for k < n / FACT_BINOM_RATIO: the terms n - k + 1 ... n, each prime
+ * p <= k divided out of its multiples among them as often as it divides k!
+ */
+static int binomial_terms(uint64_t n, uint64_t k, fact_num *r)
+{
+    // Step 1: The top terms (n <= FACT_MAX_N, so each fits 32 bits)
+    size_t bytes = (size_t)k * sizeof(uint32_t);
+    if (mem_charge(bytes) == FAILURE)
+        return FAILURE;
+    uint32_t *terms = malloc(bytes + 1);
+    uint8_t *sieve = (terms != NULL) ? sieve_odd(k) : NULL;
+    if (sieve == NULL)
+    {
+        free(terms);
+        mem_uncharge(bytes);
+        return FAILURE;
+    }
+    uint64_t low = n - k + 1;
+    for (uint64_t i = 0; i < k; i++)
+        terms[i] = (uint32_t)(low + i);
+
+    // Step 2: Legendre: p divides k! sum(k / p^i) times; the terms hold at least as many
+    for (uint64_t p = 2; p <= k; p += (p == 2) ? 1 : 2)
+    {
+        if (p > 2 && !SIEVE_IS_PRIME(sieve, p))
+            continue;
+        uint64_t e = 0;
+        for (uint64_t q = k / p; q > 0; q /= p)
+            e += q;
+        for (uint64_t m = (low + p - 1) / p * p; m <= n && e > 0; m += p)
+        {
+            while (e > 0 && terms[m - low] % p == 0)
+            {
+                terms[m - low] /= (uint32_t)p;
+                e--;
+            }
+        }
+    }
+    sieve_free(sieve, k);
+
+    // Step 3: Product of what is left
+    factor_list list = { NULL, 0, 0 };
+    int status = SUCCESS;
+    for (uint64_t i = 0; i < k && status == SUCCESS; i++)
+    {
+        if (terms[i] > 1)
+            status = factor_push(&list, terms[i]);
+    }
+    free(terms);
+    mem_uncharge(bytes);
+    if (status == SUCCESS)
+        status = list_product(&list, r);
+    factor_free(&list);
+    return status;
+}
+
+/**
+ * C(n, k) for k <= n: p^e for every prime p <= n, e = borrows of n - k in base p
+ */
+static int binomial_core(uint64_t n, uint64_t k, fact_num *r)
+{
+    if (k > n - k)
+        k = n - k;
+    if (binomial_direct(n, k))
+        return binomial_terms(n, k, r);
+    uint8_t *sieve = sieve_odd(n);
+    if (sieve == NULL)
+        return FAILURE;
+    factor_list list = { NULL, 0, 0 };
+    int status = SUCCESS;
+    for (uint64_t p = 2; p <= n && status == SUCCESS; p += (p == 2) ? 1 : 2)
+    {
+        if (p > 2 && !SIEVE_IS_PRIME(sieve, p))
+            continue;
+        if (p > n - k)
+            status = factor_push(&list, p);     // p divides the numerator once, never k!
+        else if (p > n / 2)
+            p = (n - k - 1) | 1;                // Skip to n - k: the quotients of n and n - k are both 1
+        else
+        {
+            uint64_t f = 1;
+            for (uint64_t qn = n / p, qk = k / p, qm = (n - k) / p; qn > 0; qn /= p, qk /= p, qm /= p)
+            {
+                if (qn - qk - qm) // One borrow at this digit
+                    f *= p;
+            }
+            if (f > 1)
+                status = factor_push(&list, f);
+        }
+    }
+    sieve_free(sieve, n);
+    if (status == SUCCESS)
+        status = list_product(&list, r);
+    factor_free(&list);
+    return status;
+}
+
+/**
+ * n# = product of the primes <= n
+ */
+static int primorial_core(uint64_t n, fact_num *r)
+{
+    uint8_t *sieve = sieve_odd(n);
+    if (sieve == NULL)
+        return FAILURE;
+    factor_list list = { NULL, 0, 0 };
+    int status = (n >= 2) ? factor_push(&list, 2) : SUCCESS;
+    for (uint64_t p = 3; p <= n && status == SUCCESS; p += 2)
+    {
+        if (SIEVE_IS_PRIME(sieve, p))
+            status = factor_push(&list, p);
+    }
+    sieve_free(sieve, n);
+    if (status == SUCCESS)
+        status = list_product(&list, r);
+    factor_free(&list);
+    return status;
+}
+
+/* ============================================================================
+ * DIGIT LIST INTERFACE
+ * ============================================================================ */
+
+/**
+ * Shared tail of the three operations: estimate check, compute, convert
+ * @param which: 'f' (n!), 'b' (C(n, k)) or 'p' (n#)
+ * @param bits: estimated bits of the result
+ */
+static int fact_number(char which, uint64_t n, uint64_t k, double bits, Dlist **head3, Dlist **tail3)
+{
+    // Fail fast if the sieve (or the top terms of a small C(n, k)), the tree and the result digits cannot fit
+    double digits = bits * 0.30103 + 1;
+    uint64_t small = (k < n - k) ? k : n - k;
+    size_t work = (which == 'b' && binomial_direct(n, small)) ? sieve_bytes(small) + (size_t)small * sizeof(uint32_t)
+                                                              : sieve_bytes(n);
+    if (bits > 1e15 ||
+        mem_check((size_t)(digits * MEM_NODE_BYTES + bits / 8 * 4) + work) == FAILURE)
+        return FAILURE;
+
+    fact_num r = { NULL, 0, 0 };
+    TRACE_BEGIN((which == 'f') ? "factorial" : (which == 'b') ? "binomial" : "primorial", "n", n);
+    int status = (which == 'f') ? factorial_core(n, &r)
+               : (which == 'b') ? binomial_core(n, k, &r)
+               : primorial_core(n, &r);
+    TRACE_END();
+    TRACE_BEGIN("to_list", NULL, 0);
+    if (status == SUCCESS)
+        status = binary_to_list(r.d, r.n, head3, tail3);
+    TRACE_END();
+    fact_free(&r);
+    return status;
+}
+
+/**
+ * n! as a double linked list (n <= FACT_MAX_N)
+ * @param head3: pointer to head pointer of result (will be created)
+ * @param tail3: pointer to tail pointer of result (will be created)
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (result left empty)
+ */
+int factorial_number(uint64_t n, Dlist **head3, Dlist **tail3)
+{
+    // Stirling: log2 n! ~ n log2(n / e)
+    double bits = (n < 2) ? 1 : (double)n * (log2((double)n) - 1.4427) + 64;
+    return fact_number('f', n, 0, bits, head3, tail3);
+}
+
+/**
+ * Binomial coefficient C(n, k) as a double linked list (0 when k > n)
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (result left empty)
+ */
+int binomial_number(uint64_t n, uint64_t k, Dlist **head3, Dlist **tail3)
+{
+    if (k > n)
+        return dl_insert_last(head3, tail3, 0);
+    uint64_t small = (k < n - k) ? k : n - k;
+    double bits = (double)small * log2((double)n + 1) + 64; // C(n, k) <= n^k
+    if (bits > (double)n + 64)
+        bits = (double)n + 64;                              // C(n, k) <= 2^n
+    return fact_number('b', n, k, bits, head3, tail3);
+}
+
+/**
+ * Primorial n# (product of the primes <= n) as a double linked list
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (result left empty)
+ */
+int primorial_number(uint64_t n, Dlist **head3, Dlist **tail3)
+{
+    return fact_number('p', n, 0, (double)n * 1.4427 + 64, head3, tail3); // log2 n# ~ n / ln 2
+}
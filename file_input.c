@@ -0,0 +1,77 @@
+#include "apc.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * FILE OPERANDS
+ * Operands written as @path are read from a file instead of argv, so their
+ * size is not limited by ARG_MAX. The file is mapped with mmap and validated
+ * and converted in a single sequential pass - no intermediate string copy.
+ * ============================================================================ */
+
+/**
+ * Load a number from a text file containing "[-]digits" (trailing newline allowed)
+ * or from a binary .apcn file (see serialize.c)
+ * @param path: path of the file
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @param sign: receives +1 or -1
+ * @param bad_offset: receives the offset of the first invalid byte (may be NULL)
+ * @return: SUCCESS, FILE_OPEN_ERROR if the file cannot be read, FAILURE if its
+ *          contents are not a valid number, MEMORY_ERROR if it does not fit in memory
+ */
+int load_number_file(const char *path, Dlist **head, Dlist **tail, int *sign, size_t *bad_offset)
+{
+    *head = NULL;
+    *tail = NULL;
+    *sign = 1;
+    if (bad_offset != NULL)
+        *bad_offset = 0;
+
+    // Step 1: Open the file and find its size
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return FILE_OPEN_ERROR;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+    {
+        close(fd);
+        return FILE_OPEN_ERROR;
+    }
+    if (info.st_size == 0)
+    {
+        close(fd);
+        return FAILURE; // Empty file is not a number
+    }
+
+    // Step 2: Map the whole file read-only (the mapping stays valid after close)
+    size_t length = (size_t)info.st_size;
+    char *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return FILE_OPEN_ERROR;
+    madvise(data, length, MADV_SEQUENTIAL); // Single forward pass: read ahead aggressively
+
+    // Step 3: Binary (.apcn) files are converted from their limbs in place,
+    // text files are validated and converted in one streaming pass
+    int status;
+    if (is_binary_number(data, length))
+    {
+        mapped_number view;
+        status = map_number_buffer(data, length, &view);
+        if (status == SUCCESS)
+        {
+            status = mapped_to_list(&view, head, tail);
+            *sign = view.sign;
+            unmap_number(&view);
+        }
+    }
+    else
+        status = stored_num_buffer(head, tail, data, length, sign, bad_offset);
+
+    munmap(data, length);
+    return status;
+}
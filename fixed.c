@@ -0,0 +1,545 @@
+#include "apc.h"
+#include <ctype.h>
+
+/* ============================================================================
+ * FIXED-POINT DECIMALS (--scale=N)
+ * Decimal operands "[-]digits[.digits]" and results with exactly N digits
+ * after the point, rounded by a selectable mode. A value is its digits as
+ * an integer plus the number of them that are fractional, so +, - and x
+ * are the integer operations followed by dropping (with rounding) or
+ * appending digits.
+ *
+ * a / b to N places is the integer quotient X / Y with X = A * 10^(N + fb)
+ * and Y = B * 10^fa (whichever power is smaller cancels). When both the
+ * divisor and the quotient are long, that quotient is taken from a
+ * reciprocal instead of long division: floor(B^(n+k) / Y) by Newton's
+ * iteration with precision doubling, each step two products plus a
+ * correction of a few units, then one product X * R and one remainder
+ * product to fix the last unit. Products are Karatsuba, so this beats the
+ * n * k limb steps of Knuth division once both sides pass RECIP_MIN_LIMBS.
+ * The exact remainder then decides the rounding.
+ * ============================================================================ */
+
+static const char *const round_names[] = {
+    "down", "up", "floor", "ceiling", "half-up", "half-down", "half-even"
+};
+
+/**
+ * Parse a rounding mode name (--round=MODE)
+ * @param mode: receives the mode
+ * @return: SUCCESS, or FAILURE if text names no mode
+ */
+int parse_round_mode(const char *text, round_mode *mode)
+{
+    for (size_t i = 0; i < sizeof(round_names) / sizeof(round_names[0]); i++)
+    {
+        if (strcmp(text, round_names[i]) == 0)
+        {
+            *mode = (round_mode)i;
+            return SUCCESS;
+        }
+    }
+    return FAILURE;
+}
+
+/**
+ * Name of a rounding mode, as --round takes it
+ */
+const char *round_mode_name(round_mode mode)
+{
+    return round_names[mode];
+}
+
+/**
+ * Whether a truncated magnitude must move one unit away from zero
+ * @param sign: sign of the exact result
+ * @param odd: last kept digit is odd
+ * @param half: dropped part against one half unit: -1 below, 0 equal, 1 above
+ * @param inexact: dropped part is nonzero
+ */
+static int round_away(round_mode mode, int sign, int odd, int half, int inexact)
+{
+    if (!inexact)
+        return 0;
+    switch (mode)
+    {
+        case ROUND_UP:        return 1;
+        case ROUND_FLOOR:     return sign == -1;
+        case ROUND_CEILING:   return sign == 1;
+        case ROUND_HALF_UP:   return half >= 0;
+        case ROUND_HALF_DOWN: return half > 0;
+        case ROUND_HALF_EVEN: return half > 0 || (half == 0 && odd);
+        default:              return 0; // ROUND_DOWN: toward zero
+    }
+}
+
+/**
+ * Empty value (no list yet)
+ */
+void fixed_init(fixed_value *x)
+{
+    x->head = x->tail = NULL;
+    x->sign = 1;
+    x->scale = 0;
+}
+
+/**
+ * Free the digits of a value
+ */
+void fixed_free(fixed_value *x)
+{
+    dl_delete_list(&x->head, &x->tail);
+    x->sign = 1;
+    x->scale = 0;
+}
+
+/**
+ * Parse "[-]digits" or "[-]digits.digits" (leading zeros allowed)
+ * @param x: value to fill (freed first)
+ * @param bad_offset: receives the first invalid byte on failure (may be NULL)
+ * @return: SUCCESS, FAILURE if invalid, MEMORY_ERROR
+ */
+int fixed_parse(fixed_value *x, const char *text, size_t length, size_t *bad_offset)
+{
+    fixed_free(x);
+    const char *point = memchr(text, '.', length);
+    size_t at = (point != NULL) ? (size_t)(point - text) : length;
+
+    // Step 1: The point needs a digit on each side
+    if (point != NULL && (at == 0 || !isdigit((unsigned char)text[at - 1]) || at + 1 >= length ||
+                          !isdigit((unsigned char)text[at + 1])))
+    {
+        if (bad_offset != NULL)
+            *bad_offset = at;
+        return FAILURE;
+    }
+
+    // Step 2: The digits without the point form the integer
+    char *digits = malloc(length + 1);
+    if (digits == NULL)
+        return MEMORY_ERROR;
+    memcpy(digits, text, at);
+    if (point != NULL)
+        memcpy(digits + at, text + at + 1, length - at - 1);
+    size_t digit_length = (point != NULL) ? length - 1 : length;
+    int status = stored_num_buffer(&x->head, &x->tail, digits, digit_length, &x->sign, bad_offset);
+    free(digits);
+    if (status == FAILURE && bad_offset != NULL && *bad_offset >= at)
+        (*bad_offset)++; // Offset within the text, past the point
+    if (status != SUCCESS)
+    {
+        fixed_free(x);
+        return status;
+    }
+    x->scale = (point != NULL) ? length - at - 1 : 0;
+    if (is_zero(x->head))
+        x->sign = 1;
+    return SUCCESS;
+}
+
+/**
+ * Printed length of a value: sign, integer part, point and scale digits
+ */
+size_t fixed_length(Dlist *head, int sign, size_t scale)
+{
+    size_t digits = (size_t)get_list_length(head);
+    size_t length = (digits > scale) ? digits : scale + 1; // "0.xxx" below one
+    return length + ((scale > 0) ? 1 : 0) + ((sign == -1 && !is_zero(head)) ? 1 : 0);
+}
+
+/**
+ * Write a value as "[-]integer.fraction" with exactly scale fraction digits
+ * @param out: stream to write to
+ * @param head: digits of |value| * 10^scale
+ * @return: SUCCESS, or FAILURE if the text could not be built or written
+ */
+int write_fixed(FILE *out, Dlist *head, int sign, size_t scale)
+{
+    size_t length = fixed_length(head, sign, scale);
+    size_t digits = (size_t)get_list_length(head);
+    char *text = malloc(length);
+    if (text == NULL)
+        return FAILURE;
+
+    // Step 1: Sign, then "0." and zeros for a value below one
+    size_t pos = 0;
+    if (sign == -1 && !is_zero(head))
+        text[pos++] = '-';
+    if (digits <= scale)
+    {
+        text[pos++] = '0';
+        if (scale > 0)
+            text[pos++] = '.';
+        memset(text + pos, '0', scale - digits);
+        pos += scale - digits;
+    }
+
+    // Step 2: The digits, with the point before the last scale of them
+    size_t left = digits;
+    for (Dlist *node = head; node != NULL; node = node->next, left--)
+    {
+        if (left == scale && digits > scale && scale > 0)
+            text[pos++] = '.';
+        text[pos++] = (char)('0' + node->data);
+    }
+
+    int status = (fwrite(text, 1, length, out) == length) ? SUCCESS : FAILURE;
+    free(text);
+    return status;
+}
+
+/**
+ * Copy |x| times 10^zeros (zero stays a single digit)
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int copy_shifted(Dlist *head, size_t zeros, Dlist **head3, Dlist **tail3)
+{
+    int status = copy_list(head, head3, tail3);
+    if (is_zero(head))
+        return status;
+    for (size_t i = 0; i < zeros && status == SUCCESS; i++)
+        status = dl_insert_last(head3, tail3, 0);
+    return status;
+}
+
+/**
+ * Move a magnitude one unit away from zero: h = h + 1
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int add_unit(Dlist **head, Dlist **tail)
+{
+    Dlist *one_head = NULL, *one_tail = NULL, *sum_head = NULL, *sum_tail = NULL;
+    Dlist *head1 = *head, *tail1 = *tail; // Local copies (may be swapped)
+    int status = dl_insert_last(&one_head, &one_tail, 1);
+    if (status == SUCCESS)
+        status = add_number(&head1, &tail1, &one_head, &one_tail, &sum_head, &sum_tail);
+    dl_delete_list(&one_head, &one_tail);
+    if (status == SUCCESS)
+    {
+        dl_delete_list(head, tail);
+        *head = sum_head;
+        *tail = sum_tail;
+    }
+    else
+        dl_delete_list(&sum_head, &sum_tail);
+    return status;
+}
+
+/**
+ * Bring a value to the given scale: append zeros, or drop digits and round
+ * @param x: value to rescale in place
+ * @return: SUCCESS, or FAILURE if out of memory (x unchanged)
+ */
+static int rescale(fixed_value *x, size_t scale, round_mode mode)
+{
+    if (x->scale <= scale)
+    {
+        Dlist *head = NULL, *tail = NULL;
+        int status = copy_shifted(x->head, scale - x->scale, &head, &tail);
+        if (status != SUCCESS)
+        {
+            dl_delete_list(&head, &tail);
+            return FAILURE;
+        }
+        dl_delete_list(&x->head, &x->tail);
+        x->head = head, x->tail = tail, x->scale = scale;
+        return SUCCESS;
+    }
+
+    // Step 1: Keep the leading digits, look at the dropped ones
+    size_t drop = x->scale - scale, length = (size_t)get_list_length(x->head);
+    size_t keep = (length > drop) ? length - drop : 0;
+    Dlist *head = NULL, *tail = NULL;
+    Dlist *node = x->head;
+    int status = SUCCESS;
+    for (size_t i = 0; i < keep && status == SUCCESS; i++, node = node->next)
+        status = dl_insert_last(&head, &tail, node->data);
+    if (status == SUCCESS && keep == 0)
+        status = dl_insert_last(&head, &tail, 0);
+
+    // Step 2: First dropped digit against 5, then any nonzero digit after it
+    // (when every digit is dropped, the first dropped digit is a leading zero)
+    int first = (length >= drop && node != NULL) ? node->data : 0;
+    int rest = 0;
+    for (Dlist *scan = (length >= drop && node != NULL) ? node->next : node; scan != NULL; scan = scan->next)
+        rest |= scan->data;
+    int half = (first > 5 || (first == 5 && rest)) ? 1 : (first == 5) ? 0 : -1;
+    if (status == SUCCESS && round_away(mode, x->sign, tail->data & 1, half, first != 0 || rest != 0))
+        status = add_unit(&head, &tail);
+    if (status != SUCCESS)
+    {
+        dl_delete_list(&head, &tail);
+        return FAILURE;
+    }
+    dl_delete_list(&x->head, &x->tail);
+    x->head = head, x->tail = tail, x->scale = scale;
+    if (is_zero(x->head))
+        x->sign = 1;
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * RECIPROCAL DIVISION
+ * ============================================================================ */
+
+/**
+ * Decimal limbs of |x| * 10^zeros (the zeros cost no digit work)
+ * @param count: receives the limb count (normalized)
+ * @param bytes: receives the allocation size for big_free
+ * @return: new limb array, NULL if out of memory
+ */
+static limb_t *shifted_limbs(Dlist *head, size_t zeros, size_t *count, size_t *bytes)
+{
+    // Whole zero limbs at the bottom, the rest of the zeros as digits
+    size_t low = zeros / LIMB_DECIMAL_DIGITS, extra = zeros % LIMB_DECIMAL_DIGITS;
+    size_t digits = (size_t)get_list_length(head) + extra;
+    size_t n = low + (digits + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS + 1;
+    *bytes = n * sizeof(limb_t);
+    limb_t *limbs = big_alloc(*bytes, 1);
+    char *text = malloc(digits);
+    if (limbs == NULL || text == NULL)
+    {
+        big_free(limbs, *bytes);
+        free(text);
+        return NULL;
+    }
+    size_t i = 0;
+    for (Dlist *node = head; node != NULL; node = node->next)
+        text[i++] = (char)('0' + node->data);
+    memset(text + i, '0', extra);
+    digits_to_limbs(text, digits, limbs + low);
+    free(text);
+    *count = limb_normalize(limbs, n);
+    return limbs;
+}
+
+/**
+ * r = floor(B^(n+k) / y) and e = B^(n+k) - r * y, B = 10^8
+ * Newton's iteration from the reciprocal to h = k / 2 + 1 limbs:
+ * r ~ r_h B^(k-h) + e_h r_h / B^(n+2h-k), short by a few units at most
+ * (the error of r_h is squared), then corrected against y
+ * @param r: k + 3 limbs
+ * @param e: n limbs
+ * @param y: divisor, n limbs, top limb nonzero
+ * @param work: 2n + 2k + 8 limbs of scratch
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int limb_recip(limb_t *r, limb_t *e, const limb_t *y, size_t n, size_t k, limb_t *work)
+{
+    size_t un = n + k + 1; // B^(n+k) has n + k + 1 limbs
+    limb_t *u = work, *t = work + un;
+    memset(r, 0, (k + 3) * sizeof(limb_t));
+
+    // Step 1: Short reciprocals by long division
+    if (k < RECIP_MIN_LIMBS)
+    {
+        memset(u, 0, un * sizeof(limb_t));
+        u[un - 1] = 1;
+        return limb_divmod(r, e, u, un, y, n, LIMB_DECIMAL_BASE);
+    }
+
+    // Step 2: Half precision, then one Newton step
+    size_t h = k / 2 + 1, shift = n + 2 * h - k;
+    size_t inner_bytes = (2 * (h + 3) + 2 * n) * sizeof(limb_t); // r_h, e_h, e_h r_h
+    limb_t *rh = big_alloc(inner_bytes, 1);
+    if (rh == NULL)
+        return FAILURE;
+    limb_t *eh = rh + h + 3, *product = eh + n; // product: n + h + 3 limbs
+    int status = limb_recip(rh, eh, y, n, h, work);
+    if (status == SUCCESS)
+        status = limb_mul(product, eh, n, rh, h + 3, LIMB_DECIMAL_BASE);
+    if (status == SUCCESS)
+    {
+        memcpy(r + (k - h), rh, (h + 3) * sizeof(limb_t)); // Fills r up to limb k + 3
+        limb_add(r, r, k + 3, product + shift, n + h + 3 - shift, LIMB_DECIMAL_BASE);
+    }
+    big_free(rh, inner_bytes);
+    if (status != SUCCESS)
+        return FAILURE;
+
+    // Step 3: Correct against y until 0 <= B^(n+k) - r y < y
+    size_t rn = limb_normalize(r, k + 3);
+    memset(t, 0, (un + 2) * sizeof(limb_t)); // r y: at most rn + n = un + 2 limbs
+    status = limb_mul(t, r, rn, y, n, LIMB_DECIMAL_BASE);
+    if (status != SUCCESS)
+        return FAILURE;
+    memset(u, 0, un * sizeof(limb_t));
+    u[un - 1] = 1;
+    static const limb_t one[1] = { 1 };
+    while (limb_cmp(t, limb_normalize(t, un + 2), u, un) > 0) // Estimate too big: r - 1
+    {
+        limb_sub(r, r, k + 3, one, 1, LIMB_DECIMAL_BASE);
+        limb_sub(t, t, un + 2, y, n, LIMB_DECIMAL_BASE);
+    }
+    limb_sub(u, u, un, t, un, LIMB_DECIMAL_BASE);
+    while (limb_cmp(u, limb_normalize(u, un), y, n) >= 0) // Estimate too small: r + 1
+    {
+        limb_add(r, r, k + 3, one, 1, LIMB_DECIMAL_BASE);
+        limb_sub(u, u, un, y, n, LIMB_DECIMAL_BASE);
+    }
+    memcpy(e, u, n * sizeof(limb_t));
+    return SUCCESS;
+}
+
+/**
+ * q = x / y, rem = x % y through the reciprocal of y (m >= n, y normalized)
+ * q = floor(x r / B^(m+1)) with r = floor(B^(m+1) / y) is short by at most
+ * two units, which the remainder x - q y shows
+ * @param q: m - n + 3 limbs
+ * @param rem: n limbs
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int limb_divmod_recip(limb_t *q, limb_t *rem, const limb_t *x, size_t m, const limb_t *y, size_t n)
+{
+    size_t k = m - n + 1;
+    size_t bytes = ((k + 3) + n + (2 * n + 2 * k + 8) + (m + k + 3) + (m + 1)) * sizeof(limb_t);
+    limb_t *r = big_alloc(bytes, 1);
+    if (r == NULL)
+        return FAILURE;
+    TRACE_BEGIN("limb_divmod_recip", "limbs", m);
+    limb_t *e = r + k + 3, *work = e + n, *product = work + 2 * n + 2 * k + 8, *left = product + m + k + 3;
+
+    // Step 1: Reciprocal, then the quotient estimate from the top of x r
+    int status = limb_recip(r, e, y, n, k, work);
+    if (status == SUCCESS)
+        status = limb_mul(product, x, m, r, limb_normalize(r, k + 3), LIMB_DECIMAL_BASE);
+    if (status == SUCCESS)
+    {
+        memset(q, 0, (k + 2) * sizeof(limb_t));
+        memcpy(q, product + m + 1, (k + 2) * sizeof(limb_t));
+    }
+
+    // Step 2: Remainder x - q y, then add the missing units
+    if (status == SUCCESS)
+    {
+        size_t qn = limb_normalize(q, k + 2);
+        memset(product, 0, (m + k + 3) * sizeof(limb_t));
+        if (qn > 0)
+            status = limb_mul(product, q, qn, y, n, LIMB_DECIMAL_BASE);
+    }
+    if (status == SUCCESS)
+    {
+        static const limb_t one[1] = { 1 };
+        memcpy(left, x, m * sizeof(limb_t));
+        left[m] = 0;
+        limb_sub(left, left, m + 1, product, limb_normalize(product, m + 1), LIMB_DECIMAL_BASE);
+        while (limb_cmp(left, limb_normalize(left, m + 1), y, n) >= 0)
+        {
+            limb_add(q, q, k + 2, one, 1, LIMB_DECIMAL_BASE);
+            limb_sub(left, left, m + 1, y, n, LIMB_DECIMAL_BASE);
+        }
+        memcpy(rem, left, n * sizeof(limb_t));
+    }
+    big_free(r, bytes);
+    TRACE_END();
+    return status;
+}
+
+/**
+ * r = a / b rounded to scale digits (b nonzero)
+ * @return: SUCCESS, or FAILURE if out of memory or over the memory budget
+ */
+static int fixed_divide(fixed_value *r, const fixed_value *a, const fixed_value *b, size_t scale, round_mode mode)
+{
+    // Step 1: X = A * 10^(scale + fb), Y = B * 10^fa, the smaller power cancelled
+    size_t zx = 0, zy = 0;
+    if (scale + b->scale >= a->scale)
+        zx = scale + b->scale - a->scale;
+    else
+        zy = a->scale - scale - b->scale;
+    size_t m = 0, n = 0, x_bytes = 0, y_bytes = 0;
+    limb_t *x = shifted_limbs(a->head, zx, &m, &x_bytes);
+    limb_t *y = shifted_limbs(b->head, zy, &n, &y_bytes);
+    size_t k = (m >= n) ? m - n + 1 : 1;
+    size_t bytes = ((k + 3) + 2 * (n + 1)) * sizeof(limb_t);
+    // Operands, quotient, remainders and the reciprocal's buffers
+    size_t charged = (2 * m + 8 * n + 7 * k + 64) * sizeof(limb_t);
+    int status = (x != NULL && y != NULL) ? mem_charge(charged) : FAILURE;
+    if (status == FAILURE)
+        charged = 0;
+    limb_t *q = (status == SUCCESS) ? big_alloc(bytes, 1) : NULL;
+    if (q == NULL)
+        status = FAILURE;
+    limb_t *rem = (q != NULL) ? q + k + 3 : NULL, *twice = (q != NULL) ? rem + n + 1 : NULL;
+
+    // Step 2: Quotient and remainder
+    if (status == SUCCESS && m < n)
+        memcpy(rem, x, m * sizeof(limb_t)); // |a| < |b|: quotient 0
+    else if (status == SUCCESS && (n < RECIP_MIN_LIMBS || k < RECIP_MIN_LIMBS))
+        status = limb_divmod(q, rem, x, m, y, n, LIMB_DECIMAL_BASE);
+    else if (status == SUCCESS)
+        status = limb_divmod_recip(q, rem, x, m, y, n);
+
+    // Step 3: Round by the remainder: 2 rem against y is the half unit test
+    if (status == SUCCESS)
+    {
+        int sign = (is_zero(a->head) || a->sign == b->sign) ? 1 : -1;
+        twice[n] = limb_add(twice, rem, n, rem, n, LIMB_DECIMAL_BASE);
+        int half = limb_cmp(twice, limb_normalize(twice, n + 1), y, n);
+        if (round_away(mode, sign, q[0] & 1, half, limb_normalize(rem, n) != 0))
+        {
+            static const limb_t one[1] = { 1 };
+            limb_add(q, q, k + 3, one, 1, LIMB_DECIMAL_BASE);
+        }
+        status = limbs_to_list(q, k + 3, &r->head, &r->tail);
+        r->sign = is_zero(r->head) ? 1 : sign;
+        r->scale = scale;
+    }
+    big_free(q, bytes);
+    big_free(x, x_bytes);
+    big_free(y, y_bytes);
+    mem_uncharge(charged);
+    return status;
+}
+
+/**
+ * r = a op b with exactly scale fraction digits
+ * @param r: result (must not be a or b; freed first)
+ * @param op: '+', '-', 'x' or '/'
+ * @param mode: how dropped digits round the last kept one
+ * @return: SUCCESS, or FAILURE on division by zero or out of memory
+ *          (callers tell these apart with is_zero, as for div_number)
+ */
+int fixed_op(fixed_value *r, const fixed_value *a, char op, const fixed_value *b, size_t scale, round_mode mode)
+{
+    fixed_free(r);
+    if (op == '/' && is_zero(b->head))
+        return FAILURE;
+    TRACE_BEGIN("fixed_op", "scale", scale);
+
+    int status;
+    if (op == '/')
+        status = fixed_divide(r, a, b, scale, mode);
+    else if (op == 'x')
+    {
+        Dlist *head1 = a->head, *tail1 = a->tail, *head2 = b->head, *tail2 = b->tail;
+        status = mul_number(&head1, &tail1, &head2, &tail2, &r->head, &r->tail);
+        r->sign = (a->sign == b->sign) ? 1 : -1;
+        r->scale = a->scale + b->scale;
+    }
+    else
+    {
+        // Align the points, then add as integers
+        size_t common = (a->scale > b->scale) ? a->scale : b->scale;
+        Dlist *head1 = NULL, *tail1 = NULL, *head2 = NULL, *tail2 = NULL;
+        status = copy_shifted(a->head, common - a->scale, &head1, &tail1);
+        if (status == SUCCESS)
+            status = copy_shifted(b->head, common - b->scale, &head2, &tail2);
+        if (status == SUCCESS)
+            status = add_signed_number(head1, tail1, a->sign, head2, tail2, (op == '-') ? -b->sign : b->sign,
+                                       &r->head, &r->tail, &r->sign);
+        dl_delete_list(&head1, &tail1);
+        dl_delete_list(&head2, &tail2);
+        r->scale = common;
+    }
+    if (status == SUCCESS && r->head == NULL)
+        status = FAILURE;
+    if (status == SUCCESS && is_zero(r->head))
+        r->sign = 1;
+    if (status == SUCCESS && op != '/')
+        status = rescale(r, scale, mode);
+    if (status != SUCCESS)
+        fixed_free(r);
+    TRACE_END();
+    return status;
+}
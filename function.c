@@ -14,10 +14,15 @@
  */
 int dl_insert_last(Dlist **head, Dlist **tail, int data)
 {
-    // Allocate memory for new node
-    Dlist *new_node = malloc(sizeof(Dlist)); // Create new node
+    // Allocate memory for new node (counted against the memory budget first)
+    if (mem_charge(MEM_NODE_BYTES) == FAILURE)
+        return FAILURE; // Over the memory limit
+    Dlist *new_node = node_alloc(); // Create new node (from this thread's slab)
     if (new_node == NULL)
+    {
+        mem_uncharge(MEM_NODE_BYTES);
         return FAILURE; // Return error if memory allocation fails
+    }
 
     // Initialize new node
     new_node->data = data; // Store the digit (0-9)
@@ -38,6 +43,7 @@ int dl_insert_last(Dlist **head, Dlist **tail, int data)
         (*tail)->next = new_node; // Link current tail's next to new node
         *tail = new_node; // Update tail to point to new node
     }
+    STATS_NODE_ALLOC();
     return SUCCESS; // Insertion successful
 }
 
@@ -50,10 +56,15 @@ int dl_insert_last(Dlist **head, Dlist **tail, int data)
  */
 int dl_insert_first(Dlist **head, Dlist **tail, int data)
 {
-    // Allocate memory for new node
-    Dlist *new_node = malloc(sizeof(Dlist)); // Create new node
+    // Allocate memory for new node (counted against the memory budget first)
+    if (mem_charge(MEM_NODE_BYTES) == FAILURE)
+        return FAILURE; // Over the memory limit
+    Dlist *new_node = node_alloc(); // Create new node (from this thread's slab)
     if (new_node == NULL)
+    {
+        mem_uncharge(MEM_NODE_BYTES);
         return FAILURE; // Return error if memory allocation fails
+    }
 
     // Initialize new node
     new_node->data = data; // Store the digit (0-9)
@@ -72,6 +83,7 @@ int dl_insert_first(Dlist **head, Dlist **tail, int data)
     
     // Update head to point to new node (new node becomes first)
     *head = new_node;
+    STATS_NODE_ALLOC();
     return SUCCESS; // Insertion successful
 }
 
@@ -103,7 +115,9 @@ int dl_delete_first(Dlist **head, Dlist **tail)
     }
 
     // Free the deleted node (prevent memory leak)
-    free(node_to_delete);
+    node_free(node_to_delete);
+    mem_uncharge(MEM_NODE_BYTES);
+    STATS_NODE_FREE();
     return SUCCESS; // Deletion successful
 }
 
@@ -124,13 +138,17 @@ int dl_delete_list(Dlist **head, Dlist **tail)
     // Traverse list and free each node (prevent memory leaks)
     Dlist *current = *head; // Start from head
     Dlist *next_node; // Will store next node pointer
+    size_t freed = 0; // Nodes returned to the memory budget below
 
     while (current != NULL) // Process all nodes
     {
         next_node = current->next;  // Save next before freeing (can't access after free)
-        free(current);               // Free current node
+        node_free(current);          // Free current node
+        STATS_NODE_FREE();
+        freed++;
         current = next_node;          // Move to next node
     }
+    mem_uncharge(freed * MEM_NODE_BYTES);
 
     // Reset head and tail pointers (list is now empty)
     *head = NULL; // Clear head pointer
@@ -154,41 +172,107 @@ void print_list(Dlist *head)
 /**
  * Print list with digit grouping for better readability
  * Groups digits in sets of 3 (e.g., 1234567 -> 1,234,567)
+ * The text is built in one buffer and written with a single fwrite
  * @param head: pointer to head of the list
  * @param tail: pointer to tail of the list
  */
 void print_list_formatted(Dlist *head, Dlist *tail)
 {
+    (void)tail;
+    write_number(stdout, head, 0, 1);
+}
+
+/**
+ * Convert a list to text in one buffer, optionally grouped with commas
+ * A minus sign is only added for non-zero numbers
+ * @param head: pointer to head of the list
+ * @param is_negative: 1 if the number is negative, 0 otherwise
+ * @param grouped: 1 to insert a comma every 3 digits (1,234,567)
+ * @param length: receives the text length without '\0' (may be NULL)
+ * @return: newly allocated string (caller frees), NULL if out of memory
+ */
+char *format_list(Dlist *head, int is_negative, int grouped, size_t *length)
+{
+    size_t digits = (head == NULL) ? 1 : (size_t)get_list_length(head); // Empty list prints "0"
+    size_t commas = grouped ? (digits - 1) / 3 : 0;
+    int minus = (is_negative && !is_zero(head)) ? 1 : 0; // Never print "-0"
+    size_t total = digits + commas + (size_t)minus;
+    char *text = malloc(total + 1);
+    if (text == NULL)
+        return NULL; // Out of memory
+    TRACE_BEGIN("format_list", "digits", digits);
+
+    char *out = text; // Write position in the buffer
+    if (minus)
+        *out++ = '-';
     if (head == NULL)
-    {
-        printf("0"); // Print zero if list is empty
-        return;
-    }
+        *out++ = '0';
 
-    // Count total digits first
-    int total_digits = 0; // Initialize counter
-    Dlist *temp = head; // Temporary pointer
-    while (temp != NULL) // Count all digits
+    // The first group holds 1-3 digits, every later group exactly 3
+    size_t group = grouped ? (digits - 1) % 3 + 1 : digits;
+    while (head != NULL)
     {
-        total_digits++;
-        temp = temp->next; // Move to next node
+        for (size_t i = 0; i < group && head != NULL; i++)
+        {
+            *out++ = (char)('0' + head->data);
+            head = head->next; // Move to next node
+        }
+        if (head != NULL)
+            *out++ = ','; // Only reached when grouped
+        group = 3;
     }
+    *out = '\0';
+    if (length != NULL)
+        *length = total;
+    TRACE_END();
+    return text;
+}
 
-    // Print with grouping (single pass through list)
-    int position = 0; // Current position in list
-    temp = head; // Pointer to current node
-    while (temp != NULL) // Process all nodes
+/**
+ * Write a number with one fwrite (digit by digit only if memory runs out)
+ * @param out: destination stream
+ * @param head: pointer to head of the list
+ * @param is_negative: 1 if the number is negative, 0 otherwise
+ * @param grouped: 1 to insert a comma every 3 digits
+ * @return: SUCCESS or FAILURE (write error)
+ */
+int write_number(FILE *out, Dlist *head, int is_negative, int grouped)
+{
+    size_t length = 0;
+    char *text = format_list(head, is_negative, grouped, &length);
+    if (text == NULL)
     {
-        printf("%d", temp->data); // Print current digit
-        position++; // Increment position counter
-        temp = temp->next; // Move to next node
-        
-        // Add comma after every 3 digits (except for the last group)
-        if (temp != NULL && (total_digits - position) % 3 == 0) // Check if comma needed
+        // No room for a buffer: stream the digits instead
+        int digits_left = get_list_length(head);
+        if (is_negative && !is_zero(head))
+            fputc('-', out);
+        if (head == NULL)
+            fputc('0', out);
+        for (; head != NULL; head = head->next)
         {
-            printf(","); // Add comma separator for readability
+            fputc('0' + head->data, out);
+            if (grouped && --digits_left > 0 && digits_left % 3 == 0)
+                fputc(',', out);
         }
+        return ferror(out) ? FAILURE : SUCCESS;
     }
+    TRACE_BEGIN("fwrite", "bytes", length);
+    size_t written = fwrite(text, 1, length, out);
+    TRACE_END();
+    free(text);
+    return (written == length) ? SUCCESS : FAILURE;
+}
+
+/**
+ * Convert a list to a plain string (no digit grouping)
+ * A minus sign is only added for non-zero numbers
+ * @param head: pointer to head of the list
+ * @param is_negative: 1 if the number is negative, 0 otherwise
+ * @return: newly allocated string (caller frees), NULL if out of memory
+ */
+char *list_to_string(Dlist *head, int is_negative)
+{
+    return format_list(head, is_negative, 0, NULL);
 }
 
 /**
@@ -286,9 +370,33 @@ void print_padded_line(int max_width, int content_width)
 {
     int padding = max_width - content_width;
     if (padding < 0) padding = 0; // Ensure non-negative
-    for (int i = 0; i < padding; i++)
-        printf(" ");
-    printf("  ║\n"); // 2 spaces before border
+    printf("%*s  ║\n", padding, ""); // Padding, then 2 spaces before border
+}
+
+/**
+ * Print one horizontal border row as a single string
+ * @param left: left corner or connector
+ * @param width: total width of content (not including border characters)
+ * @param right: right corner or connector
+ */
+static void print_border_row(const char *left, int width, const char *right)
+{
+    static const char line[] = "═"; // 3 bytes in UTF-8
+    size_t count = (size_t)(width + 2); // +2 for padding on each side
+    size_t left_length = strlen(left), right_length = strlen(right);
+    char *row = malloc(left_length + count * (sizeof(line) - 1) + right_length + 2);
+    if (row == NULL)
+        return; // Only decoration is lost
+    char *out = row;
+    memcpy(out, left, left_length);
+    out += left_length;
+    for (size_t i = 0; i < count; i++, out += sizeof(line) - 1)
+        memcpy(out, line, sizeof(line) - 1);
+    memcpy(out, right, right_length);
+    out += right_length;
+    *out++ = '\n';
+    fwrite(row, 1, (size_t)(out - row), stdout);
+    free(row);
 }
 
 /**
@@ -297,10 +405,7 @@ void print_padded_line(int max_width, int content_width)
  */
 void print_border_top(int width)
 {
-    printf("╔"); // Top-left corner
-    for (int i = 0; i < width + 2; i++) // +2 for padding on each side
-        printf("═");
-    printf("╗\n"); // Top-right corner
+    print_border_row("╔", width, "╗"); // Top corners
 }
 
 /**
@@ -309,10 +414,7 @@ void print_border_top(int width)
  */
 void print_border_middle(int width)
 {
-    printf("╠"); // Middle-left connector
-    for (int i = 0; i < width + 2; i++)
-        printf("═");
-    printf("╣\n"); // Middle-right connector
+    print_border_row("╠", width, "╣"); // Middle connectors
 }
 
 /**
@@ -321,10 +423,7 @@ void print_border_middle(int width)
  */
 void print_border_bottom(int width)
 {
-    printf("╚"); // Bottom-left corner
-    for (int i = 0; i < width + 2; i++)
-        printf("═");
-    printf("╝\n"); // Bottom-right corner
+    print_border_row("╚", width, "╝"); // Bottom corners
 }
 
 /**
@@ -342,6 +441,48 @@ void print_border_line(int width, const char *label, int label_width)
     // The caller should print content and then close with "  ║\n"
 }
 
+/* ============================================================================
+ * INPUT VALIDATION
+ * ============================================================================ */
+
+/**
+ * Validate if a string represents a valid number
+ * Valid formats: "123", "-456", "0", "-0"
+ * Invalid: "abc", "12.34", "", "-"
+ * 
+ *  string to validate
+ *  1 if valid, 0 if invalid
+ */
+int is_valid_number(const char *str)
+{
+    return check_number(str, NULL);
+}
+
+/**
+ * Validate "[-]digits" and locate the first offending byte
+ * Digits are checked 16 bytes at a time (scan_digits_string), no strlen
+ * @param str: string to validate
+ * @param bad_offset: receives the offset of the first invalid byte when
+ *                    invalid ('\0' position for "" and "-"); may be NULL
+ * @return: 1 if valid, 0 if invalid
+ */
+int check_number(const char *str, size_t *bad_offset)
+{
+    if (str == NULL)
+        return 0;
+
+    // Allow optional minus sign at the beginning
+    size_t i = (str[0] == '-') ? 1 : 0;
+
+    // At least one digit, and nothing but digits up to the terminator
+    size_t end = i + scan_digits_string(str + i);
+    if (end > i && str[end] == '\0')
+        return 1;
+    if (bad_offset != NULL)
+        *bad_offset = end;
+    return 0;
+}
+
 /* ============================================================================
  * INPUT PARSING
  * Convert string representation of number to double linked list
@@ -353,7 +494,8 @@ void print_border_line(int width, const char *label, int label_width)
  * @param head: pointer to head pointer (will be created)
  * @param tail: pointer to tail pointer (will be created)
  * @param data: string representation of number (e.g., "123" or "-456")
- * @return: sign of the number (+1 for positive, -1 for negative)
+ * @return: sign of the number (+1 for positive, -1 for negative); the list is
+ *          left empty if memory ran out
  */
 int stored_num(Dlist **head, Dlist **tail, char *data)
 {
@@ -380,7 +522,11 @@ int stored_num(Dlist **head, Dlist **tail, char *data)
     // Convert each character digit to integer and store in list
     while (data[i] != '\0') // Process all remaining characters
     {
-        dl_insert_last(head, tail, data[i] - '0');  // Convert '0'-'9' to 0-9 and store
+        if (dl_insert_last(head, tail, data[i] - '0') == FAILURE) // Convert '0'-'9' to 0-9 and store
+        {
+            dl_delete_list(head, tail); // Out of memory: leave the list empty
+            return sign;
+        }
         i++; // Move to next character
     }
 
@@ -393,6 +539,75 @@ int stored_num(Dlist **head, Dlist **tail, char *data)
     return sign;  // Return the sign (+1 or -1) for later use
 }
 
+/**
+ * Validate and store a number from a buffer (no strlen, no copy)
+ * Validation is vectorized (scan_digits) and runs before any node is allocated
+ * The buffer does not need a '\0'; trailing spaces and newlines are ignored
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @param data: characters of the number ("[-]digits")
+ * @param length: number of bytes in data
+ * @param sign: receives +1 or -1
+ * @param bad_offset: receives the offset of the first invalid byte on failure (may be NULL)
+ * @return: SUCCESS, FAILURE if invalid, MEMORY_ERROR if the digits do not fit
+ *          in memory or the memory budget (list is left empty)
+ */
+int stored_num_buffer(Dlist **head, Dlist **tail, const char *data, size_t length,
+                      int *sign, size_t *bad_offset)
+{
+    size_t i = 0; // Index for traversing the buffer
+    *head = NULL;
+    *tail = NULL;
+    *sign = 1;
+
+    // Ignore trailing whitespace (files usually end with a newline)
+    while (length > 0 && (data[length - 1] == '\n' || data[length - 1] == '\r' ||
+                          data[length - 1] == ' ' || data[length - 1] == '\t'))
+        length--;
+
+    if (length > 0 && data[0] == '-')
+    {
+        *sign = -1; // Negative number
+        i++;
+    }
+    if (i >= length) // Empty, or just a minus sign
+    {
+        if (bad_offset != NULL)
+            *bad_offset = i;
+        return FAILURE;
+    }
+
+    // Skip leading zeros (keep the last digit so "000" stores as 0)
+    while (i + 1 < length && data[i] == '0')
+        i++;
+
+    // Validate the whole buffer first (vectorized), so bad input allocates nothing
+    size_t end = i + scan_digits(data + i, length - i);
+    if (end != length)
+    {
+        if (bad_offset != NULL)
+            *bad_offset = end; // Offending byte
+        return FAILURE;
+    }
+
+    // Fail fast if the nodes cannot fit in the memory budget
+    if (mem_check((length - i) * MEM_NODE_BYTES) == FAILURE)
+        return MEMORY_ERROR;
+
+    // Convert: every byte is known to be a digit
+    for (; i < length; i++)
+    {
+        if (dl_insert_last(head, tail, data[i] - '0') == FAILURE)
+        {
+            if (bad_offset != NULL)
+                *bad_offset = i; // Where memory ran out
+            dl_delete_list(head, tail);
+            return MEMORY_ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
 /* ============================================================================
  * UTILITY FUNCTIONS
  * Helper functions for number manipulation
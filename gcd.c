@@ -0,0 +1,813 @@
+#include "apc.h"
+
+/* ============================================================================
+ * GREATEST COMMON DIVISOR
+ * gcd and extended gcd on base 2^32 limbs, in three tiers:
+ *
+ * - Both values within 64 bits: binary GCD (Stein) on machine words.
+ * - Below THRESHOLD_HGCD limbs: Lehmer. Euclid's algorithm runs on the
+ *   leading 64 bits of both values, collecting its quotients in a 2x2
+ *   cofactor matrix for as long as Jebelean's condition proves the full
+ *   values would have had the same quotients; one linear pass then applies
+ *   about 30 bits of progress to the full values at once.
+ * - From THRESHOLD_HGCD limbs up: half-GCD. The matrix that halves the top
+ *   half of a and b (found recursively) also takes the full values down a
+ *   quarter; a second such matrix, for the top of what is left, halves them.
+ *   Each level costs a few limb_mul products, so gcd is O(M(n) log n)
+ *   instead of quadratic.
+ *
+ * Every step multiplies (a, b) by an integer matrix of determinant +-1, which
+ * keeps the gcd whatever the matrix. A matrix that takes a value negative or
+ * fails to shrink a is fixed up or dropped for an exact division step, so
+ * the approximations decide the speed, never the answer.
+ * ============================================================================ */
+
+#define LEHMER_COFACTOR_LIMIT ((__int128)1 << 62)  // Keeps u*x + v*y within 128 bits
+
+/* ----------------------------------------------------------------------------
+ * gcd_num: signed number on binary limbs (values, cofactors, matrix entries)
+ * ---------------------------------------------------------------------------- */
+typedef struct gcd_num
+{
+    limb_t *d;      // Magnitude, least significant limb first
+    size_t n;       // Limbs in use, normalized (0 for zero)
+    size_t alloc;   // Limbs allocated (counted against the memory budget)
+    int sign;       // +1 or -1 (zero is +1)
+} gcd_num;
+
+/* ----------------------------------------------------------------------------
+ * gcd_matrix: (a'; b') = m (a; b)
+ * ---------------------------------------------------------------------------- */
+typedef struct gcd_matrix
+{
+    gcd_num m[2][2];
+} gcd_matrix;
+
+/* ============================================================================
+ * SIGNED LIMB NUMBERS
+ * ============================================================================ */
+
+static void num_init(gcd_num *x)
+{
+    x->d = NULL;
+    x->n = 0;
+    x->alloc = 0;
+    x->sign = 1;
+}
+
+static void num_free(gcd_num *x)
+{
+    free(x->d);
+    mem_uncharge(x->alloc * sizeof(limb_t));
+    num_init(x);
+}
+
+/**
+ * Make room for n limbs (contents kept)
+ * @return: SUCCESS, or FAILURE if out of memory or over the memory budget
+ */
+static int num_reserve(gcd_num *x, size_t n)
+{
+    if (n <= x->alloc)
+        return SUCCESS;
+    n += n / 4 + 4; // Values shrink and cofactors grow a little at a time
+    size_t grow = (n - x->alloc) * sizeof(limb_t);
+    if (mem_charge(grow) == FAILURE)
+        return FAILURE;
+    limb_t *d = realloc(x->d, n * sizeof(limb_t));
+    if (d == NULL)
+    {
+        mem_uncharge(grow);
+        return FAILURE;
+    }
+    x->d = d;
+    x->alloc = n;
+    return SUCCESS;
+}
+
+static int num_set(gcd_num *x, const limb_t *d, size_t n, int sign)
+{
+    n = limb_normalize(d, n);
+    if (num_reserve(x, n) == FAILURE)
+        return FAILURE;
+    if (n > 0)
+        memmove(x->d, d, n * sizeof(limb_t));
+    x->n = n;
+    x->sign = (n == 0) ? 1 : sign;
+    return SUCCESS;
+}
+
+static int num_set_word(gcd_num *x, uint64_t value)
+{
+    limb_t d[2] = { (limb_t)value, (limb_t)(value >> 32) };
+    return num_set(x, d, 2, 1);
+}
+
+static void num_swap(gcd_num *x, gcd_num *y)
+{
+    gcd_num t = *x;
+    *x = *y;
+    *y = t;
+}
+
+static void num_negate(gcd_num *x)
+{
+    if (x->n > 0)
+        x->sign = -x->sign;
+}
+
+/**
+ * Value of a number of at most two limbs
+ */
+static uint64_t num_word(const gcd_num *x)
+{
+    uint64_t value = (x->n > 0) ? x->d[0] : 0;
+    if (x->n > 1)
+        value |= (uint64_t)x->d[1] << 32;
+    return value;
+}
+
+static int num_cmp(const gcd_num *x, const gcd_num *y)
+{
+    return limb_cmp(x->d, x->n, y->d, y->n);
+}
+
+/**
+ * r = a + b (r may be a or b)
+ */
+static int num_add(gcd_num *r, const gcd_num *a, const gcd_num *b)
+{
+    const gcd_num *big = a, *small = b;
+    if (num_cmp(a, b) < 0)
+    {
+        big = b;
+        small = a;
+    }
+    size_t n = big->n;
+    int sign = big->sign, same_sign = (a->sign == b->sign);
+    if (num_reserve(r, n + 1) == FAILURE) // big and small see a moved r through their pointer
+        return FAILURE;
+    if (same_sign)
+    {
+        r->d[n] = limb_add(r->d, big->d, n, small->d, small->n, LIMB_BINARY_BASE);
+        r->n = limb_normalize(r->d, n + 1);
+    }
+    else
+    {
+        limb_sub(r->d, big->d, n, small->d, small->n, LIMB_BINARY_BASE);
+        r->n = limb_normalize(r->d, n);
+    }
+    r->sign = (r->n == 0) ? 1 : sign;
+    return SUCCESS;
+}
+
+/**
+ * x = x * B^p (B = 2^32)
+ */
+static int num_shift_up(gcd_num *x, size_t p)
+{
+    if (x->n == 0 || p == 0)
+        return SUCCESS;
+    if (num_reserve(x, x->n + p) == FAILURE)
+        return FAILURE;
+    memmove(x->d + p, x->d, x->n * sizeof(limb_t));
+    memset(x->d, 0, p * sizeof(limb_t));
+    x->n += p;
+    return SUCCESS;
+}
+
+/**
+ * r = a * b (r must differ from a and b)
+ */
+static int num_mul(gcd_num *r, const gcd_num *a, const gcd_num *b)
+{
+    if (a->n == 0 || b->n == 0)
+    {
+        r->n = 0;
+        r->sign = 1;
+        return SUCCESS;
+    }
+    if (num_reserve(r, a->n + b->n) == FAILURE ||
+        limb_mul(r->d, a->d, a->n, b->d, b->n, LIMB_BINARY_BASE) == FAILURE)
+        return FAILURE;
+    r->n = limb_normalize(r->d, a->n + b->n);
+    r->sign = a->sign * b->sign;
+    return SUCCESS;
+}
+
+/**
+ * r = u*x + v*y for word sized u, v (r must differ from x and y)
+ * One pass with a 128-bit accumulator; a negative total comes out in two's
+ * complement and is negated at the end
+ */
+static int num_lincomb(gcd_num *r, const gcd_num *x, int64_t u, const gcd_num *y, int64_t v)
+{
+    size_t n = ((x->n > y->n) ? x->n : y->n) + 3; // Two limbs of growth, one of sign
+    if (num_reserve(r, n) == FAILURE)
+        return FAILURE;
+    STATS_ADD(limb_ops, x->n + y->n);
+    int64_t su = (x->sign < 0) ? -u : u;
+    int64_t sv = (y->sign < 0) ? -v : v;
+    __int128 acc = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i < x->n)
+            acc += (__int128)su * x->d[i];
+        if (i < y->n)
+            acc += (__int128)sv * y->d[i];
+        r->d[i] = (limb_t)acc;
+        acc >>= 32; // Arithmetic shift keeps the sign
+    }
+    r->sign = 1;
+    if (acc < 0)
+    {
+        limb_t carry = 1;
+        for (size_t i = 0; i < n; i++)
+        {
+            limb_t t = (limb_t)~r->d[i] + carry;
+            carry = (t < carry);
+            r->d[i] = t;
+        }
+        r->sign = -1;
+    }
+    r->n = limb_normalize(r->d, n);
+    if (r->n == 0)
+        r->sign = 1;
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * COFACTOR MATRICES
+ * ============================================================================ */
+
+static void matrix_init(gcd_matrix *M)
+{
+    for (int i = 0; i < 4; i++)
+        num_init(&M->m[i / 2][i % 2]);
+}
+
+static void matrix_free(gcd_matrix *M)
+{
+    for (int i = 0; i < 4; i++)
+        num_free(&M->m[i / 2][i % 2]);
+}
+
+static int matrix_identity(gcd_matrix *M)
+{
+    int status = SUCCESS;
+    for (int i = 0; i < 4 && status == SUCCESS; i++)
+        status = num_set_word(&M->m[i / 2][i % 2], (i == 0 || i == 3) ? 1 : 0);
+    return status;
+}
+
+static void matrix_swap_rows(gcd_matrix *M)
+{
+    num_swap(&M->m[0][0], &M->m[1][0]);
+    num_swap(&M->m[0][1], &M->m[1][1]);
+}
+
+/**
+ * M = S M for a matrix of word sized entries
+ * @param tmp: 2 scratch numbers
+ */
+static int matrix_mul_small(gcd_matrix *M, int64_t S[2][2], gcd_num *tmp)
+{
+    for (int j = 0; j < 2; j++)
+    {
+        if (num_lincomb(&tmp[0], &M->m[0][j], S[0][0], &M->m[1][j], S[0][1]) == FAILURE ||
+            num_lincomb(&tmp[1], &M->m[0][j], S[1][0], &M->m[1][j], S[1][1]) == FAILURE)
+            return FAILURE;
+        num_swap(&tmp[0], &M->m[0][j]);
+        num_swap(&tmp[1], &M->m[1][j]);
+    }
+    return SUCCESS;
+}
+
+/**
+ * (x; y) = R (x; y) for two numbers or two matrix entries
+ * @param tmp: 3 scratch numbers
+ */
+static int matrix_apply(gcd_matrix *R, gcd_num *x, gcd_num *y, gcd_num *tmp)
+{
+    if (num_mul(&tmp[0], &R->m[0][0], x) == FAILURE ||
+        num_mul(&tmp[1], &R->m[0][1], y) == FAILURE ||
+        num_add(&tmp[0], &tmp[0], &tmp[1]) == FAILURE ||
+        num_mul(&tmp[1], &R->m[1][0], x) == FAILURE ||
+        num_mul(&tmp[2], &R->m[1][1], y) == FAILURE ||
+        num_add(&tmp[1], &tmp[1], &tmp[2]) == FAILURE)
+        return FAILURE;
+    num_swap(&tmp[0], x);
+    num_swap(&tmp[1], y);
+    return SUCCESS;
+}
+
+/**
+ * M = R M
+ * @param tmp: 3 scratch numbers
+ */
+static int matrix_mul(gcd_matrix *M, gcd_matrix *R, gcd_num *tmp)
+{
+    for (int j = 0; j < 2; j++)
+    {
+        if (matrix_apply(R, &M->m[0][j], &M->m[1][j], tmp) == FAILURE)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * EUCLID STEPS
+ * ============================================================================ */
+
+/**
+ * Binary GCD of two words
+ */
+static uint64_t gcd_word(uint64_t a, uint64_t b)
+{
+    if (a == 0 || b == 0)
+        return a | b;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do
+    {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+        {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+/**
+ * Lehmer matrix: Euclid on the leading 64 bits of a >= b > 0 (same shift for
+ * both), stopped before the first quotient Jebelean's condition cannot
+ * vouch for. With cofactors u, v the truncation error of a remainder is
+ * below max(|u|, |v|) units, so the quotient is exact while
+ *   r >= max(|u2|, |v2|) and y - r >= max(|u2 - u1|, |v2 - v1|)
+ * @param S: receives the cofactors, (x; y) = S (a; b) after the steps
+ * @return: number of steps (0 if the leading bits decide nothing)
+ */
+static int lehmer_matrix(const gcd_num *a, const gcd_num *b, int64_t S[2][2])
+{
+    // Step 1: Leading 64 bits (exact values when a has two limbs or less)
+    size_t n = a->n;
+    int exact = (n <= 2);
+    uint64_t x, y;
+    if (exact)
+    {
+        x = num_word(a);
+        y = num_word(b);
+    }
+    else
+    {
+        int shift = __builtin_clz(a->d[n - 1]);
+        unsigned __int128 ta = ((unsigned __int128)a->d[n - 1] << 64) |
+                               ((uint64_t)a->d[n - 2] << 32) | a->d[n - 3];
+        unsigned __int128 tb = 0;
+        for (size_t i = n; i-- > n - 3;)
+            tb = (tb << 32) | ((i < b->n) ? b->d[i] : 0);
+        x = (uint64_t)((ta << shift) >> 32);
+        y = (uint64_t)((tb << shift) >> 32);
+    }
+
+    // Step 2: Euclid on words while every quotient is certain
+    __int128 u0 = 1, v0 = 0, u1 = 0, v1 = 1;
+    int steps = 0;
+    while (y != 0)
+    {
+        uint64_t q = x / y, r = x - q * y;
+        __int128 u2 = u0 - (__int128)q * u1, v2 = v0 - (__int128)q * v1; // Signs alternate
+        __int128 size = (u2 < 0) ? -u2 : u2, other = (v2 < 0) ? -v2 : v2;
+        if (other > size)
+            size = other;
+        if (size >= LEHMER_COFACTOR_LIMIT)
+            break;
+        // |u2 - u1| = |u2| + |u1| because the signs alternate
+        __int128 gap = size + ((u1 < 0) ? -u1 : u1);
+        other = ((v2 < 0) ? -v2 : v2) + ((v1 < 0) ? -v1 : v1);
+        if (other > gap)
+            gap = other;
+        if (!exact && ((__int128)r < size || (__int128)(y - r) < gap))
+            break;
+        u0 = u1; v0 = v1;
+        u1 = u2; v1 = v2;
+        x = y;
+        y = r;
+        steps++;
+    }
+    S[0][0] = (int64_t)u0; S[0][1] = (int64_t)v0;
+    S[1][0] = (int64_t)u1; S[1][1] = (int64_t)v1;
+    return steps;
+}
+
+/**
+ * One step on a >= b > 0: a Lehmer step when the leading bits decide some
+ * quotients, otherwise one exact division (a, b) = (b, a mod b)
+ * Always makes progress: a shrinks, or b becomes 0
+ * @param M: if not NULL, M = S M for the step's matrix S
+ * @param tmp: 3 scratch numbers
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int gcd_step(gcd_num *a, gcd_num *b, gcd_matrix *M, gcd_num *tmp)
+{
+    int64_t S[2][2];
+    if (a->n - b->n <= 1 && lehmer_matrix(a, b, S) > 0)
+    {
+        if (num_lincomb(&tmp[0], a, S[0][0], b, S[0][1]) == FAILURE ||
+            num_lincomb(&tmp[1], a, S[1][0], b, S[1][1]) == FAILURE)
+            return FAILURE;
+        // Jebelean's condition makes these no-ops; they keep the pair ordered regardless
+        for (int i = 0; i < 2; i++)
+        {
+            if (tmp[i].sign < 0)
+            {
+                tmp[i].sign = 1;
+                S[i][0] = -S[i][0];
+                S[i][1] = -S[i][1];
+            }
+        }
+        if (num_cmp(&tmp[0], &tmp[1]) < 0)
+        {
+            num_swap(&tmp[0], &tmp[1]);
+            for (int j = 0; j < 2; j++)
+            {
+                int64_t t = S[0][j];
+                S[0][j] = S[1][j];
+                S[1][j] = t;
+            }
+        }
+        if (num_cmp(&tmp[0], a) < 0)
+        {
+            num_swap(&tmp[0], a);
+            num_swap(&tmp[1], b);
+            return (M != NULL) ? matrix_mul_small(M, S, tmp) : SUCCESS;
+        }
+    }
+
+    // Exact division: q -> tmp[0], a mod b -> tmp[1]
+    if (num_reserve(&tmp[0], a->n) == FAILURE || num_reserve(&tmp[1], b->n) == FAILURE ||
+        limb_divmod(tmp[0].d, tmp[1].d, a->d, a->n, b->d, b->n, LIMB_BINARY_BASE) == FAILURE)
+        return FAILURE;
+    tmp[0].n = limb_normalize(tmp[0].d, a->n - b->n + 1);
+    tmp[0].sign = 1;
+    tmp[1].n = limb_normalize(tmp[1].d, b->n);
+    tmp[1].sign = 1;
+    num_swap(a, b);
+    num_swap(b, &tmp[1]);
+
+    // Rows of M: (row1, row0 - q row1)
+    for (int j = 0; M != NULL && j < 2; j++)
+    {
+        if (num_mul(&tmp[2], &tmp[0], &M->m[1][j]) == FAILURE)
+            return FAILURE;
+        num_negate(&tmp[2]);
+        if (num_add(&M->m[0][j], &M->m[0][j], &tmp[2]) == FAILURE)
+            return FAILURE;
+    }
+    if (M != NULL)
+        matrix_swap_rows(M);
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * HALF-GCD
+ * ============================================================================ */
+
+static int hgcd(gcd_num *a, gcd_num *b, gcd_matrix *M, size_t threshold);
+
+/**
+ * Reduce a >= b with the matrix R half-GCD finds for their limbs above p
+ * The recursion already leaves R (top_a; top_b) behind, so only the low p
+ * limbs still need R: a' = (R top)_0 B^p + (R low)_0, and likewise b'
+ * The matrix is dropped (nothing changes) if it does not shrink a
+ * @param M: if not NULL, M = R M for the matrix R applied
+ * @param tmp: 3 scratch numbers
+ */
+static int hgcd_reduce(gcd_num *a, gcd_num *b, size_t p, gcd_matrix *M, size_t threshold, gcd_num *tmp)
+{
+    gcd_num top_a, top_b, low_a, low_b;
+    gcd_matrix R;
+    num_init(&top_a);
+    num_init(&top_b);
+    num_init(&low_a);
+    num_init(&low_b);
+    matrix_init(&R);
+
+    // Step 1: Matrix of the top limbs
+    int status = matrix_identity(&R);
+    if (status == SUCCESS && a->n > p)
+        status = num_set(&top_a, a->d + p, a->n - p, 1);
+    if (status == SUCCESS && b->n > p)
+        status = num_set(&top_b, b->d + p, b->n - p, 1);
+    if (status == SUCCESS && top_b.n > 0)
+        status = hgcd(&top_a, &top_b, &R, threshold);
+
+    // Step 2: Apply it to the low limbs and add the reduced tops above them
+    if (status == SUCCESS)
+        status = num_set(&low_a, a->d, (a->n < p) ? a->n : p, 1);
+    if (status == SUCCESS)
+        status = num_set(&low_b, b->d, (b->n < p) ? b->n : p, 1);
+    if (status == SUCCESS)
+        status = matrix_apply(&R, &low_a, &low_b, tmp);
+    if (status == SUCCESS)
+        status = num_shift_up(&top_a, p);
+    if (status == SUCCESS)
+        status = num_shift_up(&top_b, p);
+    if (status == SUCCESS)
+        status = num_add(&top_a, &top_a, &low_a);
+    if (status == SUCCESS)
+        status = num_add(&top_b, &top_b, &low_b);
+    if (status == SUCCESS)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            gcd_num *value = (i == 0) ? &top_a : &top_b;
+            if (value->sign < 0)
+            {
+                value->sign = 1;
+                num_negate(&R.m[i][0]);
+                num_negate(&R.m[i][1]);
+            }
+        }
+        if (num_cmp(&top_a, &top_b) < 0)
+        {
+            num_swap(&top_a, &top_b);
+            matrix_swap_rows(&R);
+        }
+        if (num_cmp(&top_a, a) < 0)
+        {
+            num_swap(&top_a, a);
+            num_swap(&top_b, b);
+            if (M != NULL)
+                status = matrix_mul(M, &R, tmp);
+        }
+    }
+
+    num_free(&top_a);
+    num_free(&top_b);
+    num_free(&low_a);
+    num_free(&low_b);
+    matrix_free(&R);
+    return status;
+}
+
+/**
+ * Half-GCD: reduce a >= b > 0 until b has at most n/2 + 1 limbs
+ * (n = limbs of a on entry), by two recursive top-half reductions with a
+ * division step between them, then Lehmer steps for what is left
+ * @param M: if not NULL, M = S M for every step S taken
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int hgcd(gcd_num *a, gcd_num *b, gcd_matrix *M, size_t threshold)
+{
+    size_t n = a->n, target = n / 2 + 1;
+    if (b->n <= target)
+        return SUCCESS;
+    gcd_num tmp[3];
+    for (int i = 0; i < 3; i++)
+        num_init(&tmp[i]);
+    int status = SUCCESS;
+    TRACE_BEGIN("hgcd", "limbs", n);
+
+    if (n >= threshold)
+    {
+        // Step 1: The top half's matrix takes a and b to about 3n/4 limbs
+        status = hgcd_reduce(a, b, n / 2, M, threshold, tmp);
+
+        // Step 2: One division, in case a large quotient stopped the recursion
+        if (status == SUCCESS && b->n > target)
+            status = gcd_step(a, b, M, tmp);
+
+        // Step 3: The top 2 (a->n - target) limbs decide the way down to target
+        if (status == SUCCESS && b->n > target)
+        {
+            size_t keep = 2 * (a->n - target);
+            status = hgcd_reduce(a, b, (a->n > keep) ? a->n - keep : 0, M, threshold, tmp);
+        }
+    }
+
+    // Step 4: Lehmer steps the rest of the way
+    while (status == SUCCESS && b->n > target)
+        status = gcd_step(a, b, M, tmp);
+
+    TRACE_END();
+    for (int i = 0; i < 3; i++)
+        num_free(&tmp[i]);
+    return status;
+}
+
+/**
+ * Run the gcd on a >= b: afterwards a = gcd and b = 0
+ * @param M: if not NULL, accumulates the cofactors ((a; b) = M (a0; b0))
+ */
+static int gcd_run(gcd_num *a, gcd_num *b, gcd_matrix *M)
+{
+    size_t threshold = get_threshold(THRESHOLD_HGCD);
+    gcd_num tmp[3];
+    for (int i = 0; i < 3; i++)
+        num_init(&tmp[i]);
+    int status = SUCCESS;
+    TRACE_BEGIN("gcd", "limbs", a->n);
+
+    while (status == SUCCESS && b->n > 0)
+    {
+        if (M == NULL && a->n <= 2) // Words: binary GCD finishes it
+        {
+            status = num_set_word(a, gcd_word(num_word(a), num_word(b)));
+            b->n = 0;
+            break;
+        }
+        if (b->n >= threshold)
+            status = hgcd(a, b, M, threshold);
+        if (status == SUCCESS && b->n > 0)
+            status = gcd_step(a, b, M, tmp);
+    }
+
+    TRACE_END();
+    for (int i = 0; i < 3; i++)
+        num_free(&tmp[i]);
+    return status;
+}
+
+/* ============================================================================
+ * INTERFACES
+ * ============================================================================ */
+
+/**
+ * g = gcd(|A|, |B|) and, when s is not NULL, cofactors with s|A| + t|B| = g
+ * @return: SUCCESS, or FAILURE if out of memory (or over the memory budget)
+ */
+static int gcd_core(const limb_t *A, size_t an, const limb_t *B, size_t bn,
+                    gcd_num *g, gcd_num *s, gcd_num *t)
+{
+    an = limb_normalize(A, an);
+    bn = limb_normalize(B, bn);
+    int swapped = (limb_cmp(A, an, B, bn) < 0); // Run on (larger, smaller)
+    gcd_num a, b;
+    gcd_matrix M;
+    num_init(&a);
+    num_init(&b);
+    matrix_init(&M);
+
+    int status = num_set(&a, swapped ? B : A, swapped ? bn : an, 1);
+    if (status == SUCCESS)
+        status = num_set(&b, swapped ? A : B, swapped ? an : bn, 1);
+    if (status == SUCCESS && s != NULL)
+        status = matrix_identity(&M);
+    if (status == SUCCESS)
+        status = gcd_run(&a, &b, (s != NULL) ? &M : NULL);
+
+    // gcd = M00 * larger + M01 * smaller
+    if (status == SUCCESS && s != NULL)
+    {
+        num_swap(s, &M.m[0][swapped]);
+        num_swap(t, &M.m[0][!swapped]);
+        if (a.n == 0) // gcd(0, 0): no cofactors
+        {
+            s->n = 0;
+            t->n = 0;
+            s->sign = t->sign = 1;
+        }
+    }
+    if (status == SUCCESS)
+        num_swap(g, &a);
+
+    num_free(&a);
+    num_free(&b);
+    matrix_free(&M);
+    return status;
+}
+
+/**
+ * g = gcd(a, b) on base 2^32 limbs
+ * @param g: result, max(an, bn) limbs (at least one)
+ * @param gn: receives the normalized length of g
+ * @return: SUCCESS, or FAILURE if out of memory (or over the memory budget)
+ */
+int limb_gcd(limb_t *g, size_t *gn, const limb_t *a, size_t an, const limb_t *b, size_t bn)
+{
+    gcd_num result;
+    num_init(&result);
+    int status = gcd_core(a, an, b, bn, &result, NULL, NULL);
+    if (status == SUCCESS)
+    {
+        if (result.n > 0)
+            memcpy(g, result.d, result.n * sizeof(limb_t));
+        *gn = result.n;
+    }
+    num_free(&result);
+    return status;
+}
+
+/**
+ * Write a signed limb number as a digit list
+ */
+static int num_to_list(const gcd_num *x, Dlist **head, Dlist **tail, int *sign)
+{
+    if (sign != NULL)
+        *sign = x->sign;
+    return binary_to_list(x->d, x->n, head, tail);
+}
+
+/**
+ * Shared body of gcd_number and xgcd_number
+ */
+static int gcd_lists(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+                     gcd_num *g, gcd_num *s, gcd_num *t)
+{
+    // Fail fast if the values, cofactors and matrix products cannot fit
+    size_t digits = (size_t)get_list_length(head1) + (size_t)get_list_length(head2);
+    if (mem_check(digits * MEM_NODE_BYTES + (digits / 9 + 8) * 24 * sizeof(limb_t)) == FAILURE)
+        return FAILURE;
+
+    size_t count1 = 0, count2 = 0;
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_BINARY_BASE);
+    TRACE_BEGIN("to_limbs", NULL, 0);
+    limb_t *limbs1 = list_to_binary(head1, tail1, &cache, &count1);
+    limb_t *limbs2 = list_to_binary(head2, tail2, &cache, &count2);
+    TRACE_END();
+    radix_cache_free(&cache);
+
+    int status = (limbs1 != NULL && limbs2 != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+        status = gcd_core(limbs1, count1, limbs2, count2, g, s, t);
+    free(limbs1);
+    free(limbs2);
+    return status;
+}
+
+/**
+ * Greatest common divisor of two numbers stored in double linked lists
+ * (signs are ignored; gcd(0, 0) = 0)
+ *
+ * @param head1: head of the first number
+ * @param tail1: tail of the first number
+ * @param head2: head of the second number
+ * @param tail2: tail of the second number
+ * @param head3: pointer to head pointer of result (will be created)
+ * @param tail3: pointer to tail pointer of result (will be created)
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (result left empty)
+ */
+int gcd_number(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+               Dlist **head3, Dlist **tail3)
+{
+    gcd_num g;
+    num_init(&g);
+    int status = gcd_lists(head1, tail1, head2, tail2, &g, NULL, NULL);
+    if (status == SUCCESS)
+        status = num_to_list(&g, head3, tail3, NULL);
+    num_free(&g);
+    return status;
+}
+
+/**
+ * Extended gcd: g = gcd(a, b) and s, t with s*a + t*b = g
+ * (s and t are the cofactors of the remainder sequence, |s| <= |b| / g)
+ *
+ * @param head1, tail1, sign1: first number a
+ * @param head2, tail2, sign2: second number b
+ * @param g_head, g_tail: receive g (always >= 0)
+ * @param s_head, s_tail, s_sign: receive s
+ * @param t_head, t_tail, t_sign: receive t
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (lists left empty)
+ */
+int xgcd_number(Dlist *head1, Dlist *tail1, int sign1, Dlist *head2, Dlist *tail2, int sign2,
+                Dlist **g_head, Dlist **g_tail, Dlist **s_head, Dlist **s_tail, int *s_sign,
+                Dlist **t_head, Dlist **t_tail, int *t_sign)
+{
+    gcd_num g, s, t;
+    num_init(&g);
+    num_init(&s);
+    num_init(&t);
+    int status = gcd_lists(head1, tail1, head2, tail2, &g, &s, &t);
+
+    // s|a| + t|b| = g, so the signs of a and b move onto s and t
+    if (status == SUCCESS)
+    {
+        if (sign1 == -1)
+            num_negate(&s);
+        if (sign2 == -1)
+            num_negate(&t);
+        status = num_to_list(&g, g_head, g_tail, NULL);
+    }
+    if (status == SUCCESS)
+        status = num_to_list(&s, s_head, s_tail, s_sign);
+    if (status == SUCCESS)
+        status = num_to_list(&t, t_head, t_tail, t_sign);
+    if (status == FAILURE)
+    {
+        dl_delete_list(g_head, g_tail);
+        dl_delete_list(s_head, s_tail);
+    }
+    num_free(&g);
+    num_free(&s);
+    num_free(&t);
+    return status;
+}
@@ -0,0 +1,224 @@
+#include "apc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INGEST_X86 1
+#endif
+
+/* ============================================================================
+ * VECTORIZED INGEST
+ * Operand validation and ASCII -> limb conversion, 16 to 64 bytes at a time.
+ *
+ * Validation is a range compare: after subtracting '0', a byte is a digit
+ * exactly when it is <= 9 as an unsigned value. One movemask per vector gives
+ * a bit per byte, so the first offending byte is found with a count of
+ * trailing zeros instead of a branch per character.
+ *
+ * Conversion multiplies neighbouring digits together in three multiply-add
+ * steps (x10 + y, x100 + y, x10000 + y), turning 16 digits into two base 10^8
+ * limbs without any per-digit work.
+ *
+ * The widest code path the CPU supports is picked at run time (AVX2, then
+ * SSE4.1/SSE2, then plain C), so one binary runs everywhere.
+ * ============================================================================ */
+
+/* ============================================================================
+ * VALIDATION
+ * ============================================================================ */
+
+/**
+ * Scalar reference for scan_digits
+ */
+static size_t scan_digits_scalar(const char *data, size_t length, size_t i)
+{
+    while (i < length && (unsigned char)(data[i] - '0') <= 9)
+        i++;
+    return i;
+}
+
+#ifdef INGEST_X86
+/**
+ * Bit mask of the non-digit bytes in one 16-byte vector
+ */
+static inline unsigned bad_mask_sse2(__m128i bytes)
+{
+    __m128i value = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    __m128i good = _mm_cmpeq_epi8(_mm_max_epu8(value, _mm_set1_epi8(9)), _mm_set1_epi8(9));
+    return ~(unsigned)_mm_movemask_epi8(good) & 0xFFFF;
+}
+
+/**
+ * scan_digits with SSE2, 16 bytes per step
+ */
+static size_t scan_digits_sse2(const char *data, size_t length)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        unsigned bad = bad_mask_sse2(_mm_loadu_si128((const __m128i *)(data + i)));
+        if (bad != 0)
+            return i + (size_t)__builtin_ctz(bad);
+    }
+    return scan_digits_scalar(data, length, i);
+}
+
+/**
+ * scan_digits with AVX2, 64 bytes (two vectors) per step
+ */
+__attribute__((target("avx2")))
+static size_t scan_digits_avx2(const char *data, size_t length)
+{
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64)
+    {
+        __m256i low = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i *)(data + i)), zero);
+        __m256i high = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i *)(data + i + 32)), zero);
+        __m256i good_low = _mm256_cmpeq_epi8(_mm256_max_epu8(low, nine), nine);
+        __m256i good_high = _mm256_cmpeq_epi8(_mm256_max_epu8(high, nine), nine);
+        uint64_t good = (uint32_t)_mm256_movemask_epi8(good_low) |
+                        ((uint64_t)(uint32_t)_mm256_movemask_epi8(good_high) << 32);
+        if (good != UINT64_MAX)
+            return i + (size_t)__builtin_ctzll(~good);
+    }
+    return i + scan_digits_sse2(data + i, length - i);
+}
+#endif
+
+/**
+ * Find the first byte of a buffer that is not a decimal digit
+ * @param data: bytes to check (no '\0' needed)
+ * @param length: number of bytes
+ * @return: offset of the first non-digit, or length if all are digits
+ */
+size_t scan_digits(const char *data, size_t length)
+{
+#ifdef INGEST_X86
+    if (__builtin_cpu_supports("avx2"))
+        return scan_digits_avx2(data, length);
+    return scan_digits_sse2(data, length);
+#else
+    return scan_digits_scalar(data, length, 0);
+#endif
+}
+
+/**
+ * Find the first non-digit of a '\0' terminated string without strlen
+ * The terminator is itself a non-digit, so the scan stops there. Vector loads
+ * are 16-byte aligned and never cross into the next page, so reading past
+ * the terminator inside the last block is safe.
+ * @param str: string to check
+ * @return: offset of the first non-digit (str[offset] == '\0' if all are digits)
+ */
+size_t scan_digits_string(const char *str)
+{
+    size_t i = 0;
+#ifdef INGEST_X86
+    // Step 1: Scalar bytes up to the first aligned block
+    while (((uintptr_t)(str + i) & 15) != 0)
+    {
+        if ((unsigned char)(str[i] - '0') > 9)
+            return i;
+        i++;
+    }
+    // Step 2: Whole aligned blocks
+    for (;;)
+    {
+        unsigned bad = bad_mask_sse2(_mm_load_si128((const __m128i *)(str + i)));
+        if (bad != 0)
+            return i + (size_t)__builtin_ctz(bad);
+        i += 16;
+    }
+#else
+    while ((unsigned char)(str[i] - '0') <= 9)
+        i++;
+    return i;
+#endif
+}
+
+/* ============================================================================
+ * CONVERSION
+ * ============================================================================ */
+
+/**
+ * Value of up to 8 ASCII digits
+ */
+static limb_t digits_value(const char *digits, size_t n)
+{
+    limb_t value = 0;
+    for (size_t i = 0; i < n; i++)
+        value = value * 10 + (limb_t)(digits[i] - '0');
+    return value;
+}
+
+#ifdef INGEST_X86
+/**
+ * Convert 16 ASCII digits to two limbs with SSSE3 multiply-adds
+ * @param digits: 16 digits, most significant first
+ * @param high: receives the value of digits[0..7]
+ * @param low: receives the value of digits[8..15]
+ */
+__attribute__((target("sse4.1")))
+static inline void convert16_sse41(const char *digits, limb_t *high, limb_t *low)
+{
+    __m128i value = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)digits), _mm_set1_epi8('0'));
+    __m128i pairs = _mm_maddubs_epi16(value, _mm_set1_epi16(0x010A));     // 10*d0 + d1
+    __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));    // 100*p0 + p1
+    __m128i packed = _mm_packus_epi32(quads, quads);                      // 4 x 16 bits
+    __m128i eights = _mm_madd_epi16(packed, _mm_set1_epi32(0x00012710)); // 10000*q0 + q1
+    *high = (limb_t)_mm_cvtsi128_si32(eights);
+    *low = (limb_t)_mm_extract_epi32(eights, 1);
+}
+
+/**
+ * Whole 8-digit limbs of digits_to_limbs, two per step
+ * @return: number of digits consumed
+ */
+__attribute__((target("sse4.1")))
+static size_t convert_limbs_sse41(const char *digits, size_t n, limb_t *limbs, size_t index)
+{
+    size_t pos = 0;
+    while (pos + 16 <= n)
+    {
+        convert16_sse41(digits + pos, &limbs[index - 1], &limbs[index - 2]);
+        index -= 2;
+        pos += 16;
+    }
+    return pos;
+}
+#endif
+
+/**
+ * Convert validated ASCII digits to base 10^8 limbs
+ * @param digits: n digits, most significant first
+ * @param n: number of digits
+ * @param limbs: receives (n + 7) / 8 limbs, least significant first
+ */
+void digits_to_limbs(const char *digits, size_t n, limb_t *limbs)
+{
+    size_t count = (n + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS;
+    size_t pos = n % LIMB_DECIMAL_DIGITS; // Digits of the partial top limb
+    size_t index = count;
+
+    // Step 1: The top limb takes the n % 8 leading digits
+    if (pos != 0)
+        limbs[--index] = digits_value(digits, pos);
+
+    // Step 2: Full limbs, 16 digits per vector step
+#ifdef INGEST_X86
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        size_t done = convert_limbs_sse41(digits + pos, n - pos, limbs, index);
+        index -= done / LIMB_DECIMAL_DIGITS;
+        pos += done;
+    }
+#endif
+
+    // Step 3: Whatever is left, one limb at a time
+    while (index > 0)
+    {
+        limbs[--index] = digits_value(digits + pos, LIMB_DECIMAL_DIGITS);
+        pos += LIMB_DECIMAL_DIGITS;
+    }
+}
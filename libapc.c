@@ -0,0 +1,1050 @@
+#include "apc.h"
+#include "libapc.h"
+
+/* ============================================================================
+ * LIBAPC IMPLEMENTATION
+ * Wraps the Dlist arithmetic behind opaque, sign-carrying handles
+ * ============================================================================ */
+
+/* ----------------------------------------------------------------------------
+ * apc_digits: a magnitude shared by reference count (copy-on-write)
+ * Once installed the digits are never written: apc_copy, apc_neg and apc_abs
+ * take one more reference, and an operation that changes a number builds the
+ * new digits in fresh lists and drops its reference to the old ones, which
+ * the other holders keep. The count is atomic, so handles sharing digits may
+ * live in different threads.
+ * ---------------------------------------------------------------------------- */
+typedef struct apc_digits
+{
+    size_t refs;    // Handles pointing here
+    Dlist *head;    // Most significant digit
+    Dlist *tail;    // Least significant digit
+} apc_digits;
+
+/* ----------------------------------------------------------------------------
+ * apc_num: a signed number
+ * The magnitude is a Dlist exactly as produced by stored_num (never empty,
+ * no leading zeros); sign is +1 or -1 (zero is always stored with +1).
+ * head and tail mirror digits->head and digits->tail for the readers below.
+ * ---------------------------------------------------------------------------- */
+struct apc_num
+{
+    int sign;               // +1 or -1
+    Dlist *head;            // Most significant digit
+    Dlist *tail;            // Least significant digit
+    apc_digits *digits;     // Shared storage of head..tail
+};
+
+/* ----------------------------------------------------------------------------
+ * apc_rat: a fraction, kept in the core's rational form (see rational.c)
+ * ---------------------------------------------------------------------------- */
+struct apc_rat
+{
+    rational value;
+};
+
+/**
+ * Drop one reference to a magnitude, freeing it with the last one
+ * @param digits: storage to release (NULL is ignored)
+ */
+static void digits_release(apc_digits *digits)
+{
+    if (digits == NULL || __atomic_sub_fetch(&digits->refs, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+    dl_delete_list(&digits->head, &digits->tail);
+    free(digits);
+}
+
+/**
+ * Point a number at a shared magnitude (one more reference)
+ * The old digits are released; zero is normalized to a positive sign
+ * @param num: number to update
+ * @param digits: magnitude to share
+ * @param sign: sign of the new value (+1 or -1)
+ */
+static void share_value(apc_num *num, apc_digits *digits, int sign)
+{
+    __atomic_add_fetch(&digits->refs, 1, __ATOMIC_RELAXED);
+    digits_release(num->digits); // After the add: num may already share digits
+    num->digits = digits;
+    num->head = digits->head;
+    num->tail = digits->tail;
+    num->sign = is_zero(digits->head) ? 1 : sign; // Never keep "-0"
+}
+
+/**
+ * Replace the value of a number with an already built magnitude
+ * Other handles sharing the old digits keep them
+ * @param num: number to update
+ * @param head: head of new magnitude (ownership is taken)
+ * @param tail: tail of new magnitude
+ * @param sign: sign of the new value (+1 or -1)
+ * @return: APC_OK, or APC_ERR_NOMEM (the new digits are freed, num is unchanged)
+ */
+static int set_value(apc_num *num, Dlist *head, Dlist *tail, int sign)
+{
+    apc_digits *digits = malloc(sizeof(apc_digits));
+    if (digits == NULL)
+    {
+        dl_delete_list(&head, &tail);
+        return APC_ERR_NOMEM;
+    }
+    digits->refs = 0; // share_value takes the only reference
+    digits->head = head;
+    digits->tail = tail;
+    share_value(num, digits, sign);
+    return APC_OK;
+}
+
+/**
+ * Create a new number with value 0
+ * @param num: receives the new handle
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_init(apc_num **num)
+{
+    if (num == NULL)
+        return APC_ERR_INVALID;
+
+    *num = calloc(1, sizeof(apc_num));
+    if (*num == NULL)
+        return APC_ERR_NOMEM;
+
+    Dlist *head = NULL, *tail = NULL;
+    int status = dl_insert_last(&head, &tail, 0); // Start as "0"
+    if (status == FAILURE || set_value(*num, head, tail, 1) != APC_OK) // set_value frees head on failure
+    {
+        if (status == FAILURE)
+            dl_delete_list(&head, &tail);
+        free(*num);
+        *num = NULL;
+        return APC_ERR_NOMEM;
+    }
+    return APC_OK;
+}
+
+/**
+ * Release a number (its digits go with the last handle sharing them)
+ * @param num: number to free (NULL is ignored)
+ */
+void apc_free(apc_num *num)
+{
+    if (num == NULL)
+        return;
+    digits_release(num->digits);
+    free(num);
+}
+
+/**
+ * Copy the value of one number into another, in O(1): dest shares the
+ * digits of src until either is given a new value
+ * @param dest: number to overwrite
+ * @param src: number to copy
+ * @return: APC_OK or APC_ERR_INVALID
+ */
+int apc_copy(apc_num *dest, const apc_num *src)
+{
+    if (dest == NULL || src == NULL)
+        return APC_ERR_INVALID;
+    share_value(dest, src->digits, src->sign);
+    return APC_OK;
+}
+
+/**
+ * dest = -src, in O(1) (shares the digits of src)
+ * @return: APC_OK or APC_ERR_INVALID
+ */
+int apc_neg(apc_num *dest, const apc_num *src)
+{
+    if (dest == NULL || src == NULL)
+        return APC_ERR_INVALID;
+    share_value(dest, src->digits, -src->sign);
+    return APC_OK;
+}
+
+/**
+ * dest = |src|, in O(1) (shares the digits of src)
+ * @return: APC_OK or APC_ERR_INVALID
+ */
+int apc_abs(apc_num *dest, const apc_num *src)
+{
+    if (dest == NULL || src == NULL)
+        return APC_ERR_INVALID;
+    share_value(dest, src->digits, 1);
+    return APC_OK;
+}
+
+/**
+ * Set a number from its decimal text
+ * @param num: number to overwrite
+ * @param str: "[-]digits" (leading zeros allowed)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_PARSE or APC_ERR_NOMEM
+ */
+int apc_parse(apc_num *num, const char *str)
+{
+    if (num == NULL || str == NULL)
+        return APC_ERR_INVALID;
+    if (!is_valid_number(str))
+        return APC_ERR_PARSE;
+
+    Dlist *head = NULL, *tail = NULL;
+    int sign = stored_num(&head, &tail, (char *)str); // stored_num only reads the string
+    if (head == NULL)
+        return APC_ERR_NOMEM;
+    return set_value(num, head, tail, sign);
+}
+
+/**
+ * Set a number from a text file (memory mapped, trailing newline allowed)
+ * or from a binary .apcn file written by apc_save
+ * @param num: number to overwrite
+ * @param path: file holding "[-]digits"
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO, APC_ERR_PARSE or APC_ERR_NOMEM
+ */
+int apc_parse_file(apc_num *num, const char *path)
+{
+    if (num == NULL || path == NULL)
+        return APC_ERR_INVALID;
+
+    Dlist *head = NULL, *tail = NULL;
+    int sign = 1;
+    int status = load_number_file(path, &head, &tail, &sign, NULL);
+    if (status == FILE_OPEN_ERROR)
+        return APC_ERR_IO;
+    if (status == MEMORY_ERROR)
+        return APC_ERR_NOMEM;
+    if (status == FAILURE)
+        return APC_ERR_PARSE;
+    return set_value(num, head, tail, sign);
+}
+
+/**
+ * Save a number as a binary .apcn file (reload it with apc_parse_file)
+ * @param num: number to save
+ * @param path: destination file
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_IO
+ */
+int apc_save(const apc_num *num, const char *path)
+{
+    if (num == NULL || path == NULL)
+        return APC_ERR_INVALID;
+    if (save_number(path, num->head, num->tail, num->sign) != SUCCESS)
+        return APC_ERR_IO;
+    return APC_OK;
+}
+
+/**
+ * Number of characters apc_format will write (sign + digits, no '\0')
+ * @param num: number to measure
+ * @return: text length, 0 for a NULL handle
+ */
+size_t apc_format_length(const apc_num *num)
+{
+    if (num == NULL)
+        return 0;
+    size_t length = (size_t)get_list_length(num->head);
+    if (num->sign == -1)
+        length++; // Minus sign (zero is never stored negative)
+    return length;
+}
+
+/**
+ * Write a number as plain decimal text
+ * @param num: number to format
+ * @param buf: destination buffer
+ * @param size: size of buf in bytes (needs apc_format_length(num) + 1)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_BUFFER
+ */
+int apc_format(const apc_num *num, char *buf, size_t size)
+{
+    if (num == NULL || buf == NULL)
+        return APC_ERR_INVALID;
+    if (size < apc_format_length(num) + 1)
+        return APC_ERR_BUFFER;
+
+    size_t pos = 0;
+    if (num->sign == -1)
+        buf[pos++] = '-';
+    for (Dlist *node = num->head; node != NULL; node = node->next)
+        buf[pos++] = (char)('0' + node->data);
+    buf[pos] = '\0';
+    return APC_OK;
+}
+
+/**
+ * Sign of a number
+ * @param num: number to inspect
+ * @return: -1 if negative, 0 if zero (or NULL), +1 if positive
+ */
+int apc_sign(const apc_num *num)
+{
+    if (num == NULL || is_zero(num->head))
+        return 0;
+    return num->sign;
+}
+
+/**
+ * Human readable message for a status code
+ * @param status: value returned by an apc_* function
+ * @return: static message string
+ */
+const char *apc_strerror(int status)
+{
+    switch (status)
+    {
+        case APC_OK:           return "success";
+        case APC_ERR_NOMEM:    return "out of memory (or over the memory limit)";
+        case APC_ERR_PARSE:    return "not a valid number";
+        case APC_ERR_DIV_ZERO: return "division by zero";
+        case APC_ERR_INVALID:  return "invalid argument";
+        case APC_ERR_BUFFER:   return "buffer too small";
+        case APC_ERR_IO:       return "cannot read file";
+        default:               return "unknown error";
+    }
+}
+
+/* ============================================================================
+ * BINARY WORDS
+ * ============================================================================ */
+
+/**
+ * Export the magnitude of a number as base 2^32 words
+ * @param num: number to export
+ * @param words: receives a new array, least significant word first (free() it)
+ * @param count: receives the number of words (0 for zero)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_export(const apc_num *num, uint32_t **words, size_t *count)
+{
+    if (num == NULL || words == NULL || count == NULL)
+        return APC_ERR_INVALID;
+
+    // Step 1: Digits -> decimal limbs (linear)
+    size_t decimal_count = 0;
+    limb_t *decimal = list_to_limbs(num->head, num->tail, &decimal_count);
+    if (decimal == NULL)
+        return APC_ERR_NOMEM;
+
+    // Step 2: Decimal limbs -> binary limbs (divide and conquer)
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_BINARY_BASE);
+    int status = radix_convert(decimal, decimal_count, LIMB_DECIMAL_BASE, &cache, words, count);
+    radix_cache_free(&cache);
+    free(decimal);
+    return (status == SUCCESS) ? APC_OK : APC_ERR_NOMEM;
+}
+
+/**
+ * Set a number from base 2^32 words
+ * @param num: number to overwrite
+ * @param words: magnitude, least significant word first (may be NULL if count is 0)
+ * @param count: number of words
+ * @param sign: +1 or -1
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_import(apc_num *num, const uint32_t *words, size_t count, int sign)
+{
+    if (num == NULL || (words == NULL && count > 0) || (sign != 1 && sign != -1))
+        return APC_ERR_INVALID;
+
+    // Step 1: Binary limbs -> decimal limbs (divide and conquer)
+    limb_t zero = 0;
+    limb_t *decimal = NULL;
+    size_t decimal_count = 0;
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_DECIMAL_BASE);
+    int status = radix_convert((count > 0) ? words : &zero, count, LIMB_BINARY_BASE, &cache,
+                               &decimal, &decimal_count);
+    radix_cache_free(&cache);
+    if (status == FAILURE)
+        return APC_ERR_NOMEM;
+
+    // Step 2: Decimal limbs -> digits (linear)
+    Dlist *head = NULL, *tail = NULL;
+    status = limbs_to_list(decimal, decimal_count, &head, &tail);
+    free(decimal);
+    if (status == FAILURE)
+        return APC_ERR_NOMEM;
+    return set_value(num, head, tail, sign);
+}
+
+/* ============================================================================
+ * ARITHMETIC
+ * The Dlist routines may swap the head/tail pointers they are given, so they
+ * always receive local copies of the operand pointers; operand digits are
+ * only read. Results are built in fresh lists and installed last, which makes
+ * result == a or result == b safe.
+ * ============================================================================ */
+
+/**
+ * Signed addition: result = a + sign_b * |b| (sign rules of main.c, Step 5)
+ * @param result: number receiving the sum
+ * @param a: first operand
+ * @param b: second operand
+ * @param sign_b: sign applied to b (b->sign, or -b->sign for subtraction)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+static int add_signed(apc_num *result, const apc_num *a, const apc_num *b, int sign_b)
+{
+    if (result == NULL || a == NULL || b == NULL)
+        return APC_ERR_INVALID;
+
+    Dlist *head1 = a->head, *tail1 = a->tail; // Local copies (may be swapped)
+    Dlist *head2 = b->head, *tail2 = b->tail;
+    Dlist *head3 = NULL, *tail3 = NULL;
+    int result_sign;
+
+    if (a->sign == sign_b) // Same sign: add magnitudes, keep the sign
+    {
+        if (add_number(&head1, &tail1, &head2, &tail2, &head3, &tail3) == FAILURE)
+            return APC_ERR_NOMEM;
+        result_sign = a->sign;
+    }
+    else // Different signs: subtract smaller magnitude from larger
+    {
+        int is_negative = sub_number(&head1, &tail1, &head2, &tail2, &head3, &tail3, NULL, NULL);
+        if (is_negative == FAILURE)
+            return APC_ERR_NOMEM;
+        result_sign = (a->sign == 1) ? (is_negative ? -1 : 1)
+                                     : (is_negative ? 1 : -1);
+    }
+
+    return set_value(result, head3, tail3, result_sign);
+}
+
+/**
+ * result = a + b
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_add(apc_num *result, const apc_num *a, const apc_num *b)
+{
+    if (b == NULL)
+        return APC_ERR_INVALID;
+    return add_signed(result, a, b, b->sign);
+}
+
+/**
+ * result = a - b
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_sub(apc_num *result, const apc_num *a, const apc_num *b)
+{
+    if (b == NULL)
+        return APC_ERR_INVALID;
+    return add_signed(result, a, b, -b->sign);
+}
+
+/**
+ * result = a * b
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_mul(apc_num *result, const apc_num *a, const apc_num *b)
+{
+    if (result == NULL || a == NULL || b == NULL)
+        return APC_ERR_INVALID;
+
+    Dlist *head1 = a->head, *tail1 = a->tail;
+    Dlist *head2 = b->head, *tail2 = b->tail;
+    Dlist *head3 = NULL, *tail3 = NULL;
+
+    if (mul_number(&head1, &tail1, &head2, &tail2, &head3, &tail3) == FAILURE)
+    {
+        dl_delete_list(&head3, &tail3);
+        return APC_ERR_NOMEM;
+    }
+    return set_value(result, head3, tail3, (a->sign == b->sign) ? 1 : -1);
+}
+
+/**
+ * Truncating division: a = quotient * b + remainder, remainder has the sign of a
+ * @param quotient: receives a / b (may be NULL)
+ * @param remainder: receives a % b (may be NULL, must differ from quotient)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_divmod(apc_num *quotient, apc_num *remainder, const apc_num *a, const apc_num *b)
+{
+    if (a == NULL || b == NULL || (quotient != NULL && quotient == remainder))
+        return APC_ERR_INVALID;
+    if (is_zero(b->head))
+        return APC_ERR_DIV_ZERO;
+
+    Dlist *head1 = a->head, *tail1 = a->tail;
+    Dlist *head2 = b->head, *tail2 = b->tail;
+    Dlist *head3 = NULL, *tail3 = NULL;
+    Dlist *remainder_head = NULL, *remainder_tail = NULL;
+    int sign_a = a->sign, sign_b = b->sign; // Read before a or b is overwritten
+
+    if (div_number(&head1, &tail1, &head2, &tail2, &head3, &tail3,
+                   &remainder_head, &remainder_tail, '/') == FAILURE)
+    {
+        dl_delete_list(&head3, &tail3);
+        dl_delete_list(&remainder_head, &remainder_tail);
+        return APC_ERR_NOMEM; // Zero divisor was rejected above
+    }
+
+    int status = APC_OK;
+    if (quotient != NULL)
+        status = set_value(quotient, head3, tail3, (sign_a == sign_b) ? 1 : -1);
+    else
+        dl_delete_list(&head3, &tail3);
+
+    if (remainder != NULL && set_value(remainder, remainder_head, remainder_tail, sign_a) != APC_OK)
+        status = APC_ERR_NOMEM;
+    else if (remainder == NULL)
+        dl_delete_list(&remainder_head, &remainder_tail);
+    return status;
+}
+
+/**
+ * Fixed-point quotient: result = a / b * 10^scale, rounded to an integer,
+ * i.e. the digits of a / b to scale places (long quotients use a reciprocal)
+ * @param round: APC_ROUND_DOWN ... APC_ROUND_HALF_EVEN
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_div_scaled(apc_num *result, const apc_num *a, const apc_num *b, size_t scale, int round)
+{
+    if (result == NULL || a == NULL || b == NULL || round < APC_ROUND_DOWN || round > APC_ROUND_HALF_EVEN)
+        return APC_ERR_INVALID;
+    if (is_zero(b->head))
+        return APC_ERR_DIV_ZERO;
+
+    fixed_value x = { a->head, a->tail, a->sign, 0 }, y = { b->head, b->tail, b->sign, 0 }, r;
+    fixed_init(&r);
+    if (fixed_op(&r, &x, '/', &y, scale, (round_mode)round) == FAILURE)
+        return APC_ERR_NOMEM;
+    return set_value(result, r.head, r.tail, r.sign);
+}
+
+/**
+ * Shared body of apc_powmod and apc_powmod_sec
+ */
+static int powmod_signed(apc_num *result, const apc_num *base, const apc_num *exp,
+                         const apc_num *mod, int constant_time)
+{
+    if (result == NULL || base == NULL || exp == NULL || mod == NULL)
+        return APC_ERR_INVALID;
+    if (is_zero(mod->head))
+        return APC_ERR_DIV_ZERO;
+    if (exp->sign == -1 || mod->sign == -1)
+        return APC_ERR_INVALID;
+    if (constant_time && (mod->tail->data & 1) == 0)
+        return APC_ERR_INVALID; // Montgomery form needs an odd modulus
+
+    Dlist *head3 = NULL, *tail3 = NULL;
+    if (powmod_number(base->head, base->tail, base->sign, exp->head, exp->tail,
+                      mod->head, mod->tail, constant_time, &head3, &tail3) == FAILURE)
+    {
+        dl_delete_list(&head3, &tail3);
+        return APC_ERR_NOMEM;
+    }
+    return set_value(result, head3, tail3, 1);
+}
+
+/**
+ * result = base^exp mod mod, in [0, mod) (Montgomery + sliding window for odd mod)
+ * @param exp: must not be negative
+ * @param mod: must be positive
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_powmod(apc_num *result, const apc_num *base, const apc_num *exp, const apc_num *mod)
+{
+    return powmod_signed(result, base, exp, mod, 0);
+}
+
+/**
+ * Same as apc_powmod, with timing and memory accesses independent of the
+ * exponent bits (for secret exponents)
+ * @param mod: must be positive and odd
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_powmod_sec(apc_num *result, const apc_num *base, const apc_num *exp, const apc_num *mod)
+{
+    return powmod_signed(result, base, exp, mod, 1);
+}
+
+/**
+ * result = gcd(|a|, |b|), 0 only if both are 0 (Lehmer, half-GCD when large)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_gcd(apc_num *result, const apc_num *a, const apc_num *b)
+{
+    if (result == NULL || a == NULL || b == NULL)
+        return APC_ERR_INVALID;
+
+    Dlist *head3 = NULL, *tail3 = NULL;
+    if (gcd_number(a->head, a->tail, b->head, b->tail, &head3, &tail3) == FAILURE)
+    {
+        dl_delete_list(&head3, &tail3);
+        return APC_ERR_NOMEM;
+    }
+    return set_value(result, head3, tail3, 1);
+}
+
+/**
+ * Extended gcd: g = gcd(|a|, |b|) and cofactors with s*a + t*b = g
+ * @param g, s, t: three distinct handles (may be a or b)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_xgcd(apc_num *g, apc_num *s, apc_num *t, const apc_num *a, const apc_num *b)
+{
+    if (g == NULL || s == NULL || t == NULL || a == NULL || b == NULL ||
+        g == s || g == t || s == t)
+        return APC_ERR_INVALID;
+
+    Dlist *g_head = NULL, *g_tail = NULL, *s_head = NULL, *s_tail = NULL, *t_head = NULL, *t_tail = NULL;
+    int s_sign = 1, t_sign = 1;
+    if (xgcd_number(a->head, a->tail, a->sign, b->head, b->tail, b->sign, &g_head, &g_tail,
+                    &s_head, &s_tail, &s_sign, &t_head, &t_tail, &t_sign) == FAILURE)
+    {
+        dl_delete_list(&g_head, &g_tail);
+        dl_delete_list(&s_head, &s_tail);
+        dl_delete_list(&t_head, &t_tail);
+        return APC_ERR_NOMEM;
+    }
+    int status = set_value(g, g_head, g_tail, 1);
+    if (set_value(s, s_head, s_tail, s_sign) != APC_OK)
+        status = APC_ERR_NOMEM;
+    if (set_value(t, t_head, t_tail, t_sign) != APC_OK)
+        status = APC_ERR_NOMEM;
+    return status;
+}
+
+/**
+ * root = k-th root of n truncated toward zero (the floor for n >= 0) and
+ * rem = n - root^k, by Newton iteration with precision doubling
+ * @param rem: may be NULL; otherwise distinct from root
+ * @param k: 1 to 4294967295; n may be negative only for odd k
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_iroot(apc_num *root, apc_num *rem, const apc_num *n, unsigned long k)
+{
+    if (root == NULL || n == NULL || root == rem || k == 0 || k > UINT32_MAX)
+        return APC_ERR_INVALID;
+    if (n->sign == -1 && k % 2 == 0)
+        return APC_ERR_INVALID;
+
+    Dlist *root_head = NULL, *root_tail = NULL, *rem_head = NULL, *rem_tail = NULL;
+    int root_sign = 1, rem_sign = 1;
+    if (root_number(n->head, n->tail, n->sign, (uint32_t)k, &root_head, &root_tail, &root_sign,
+                    (rem != NULL) ? &rem_head : NULL, &rem_tail, &rem_sign) == FAILURE)
+    {
+        dl_delete_list(&root_head, &root_tail);
+        dl_delete_list(&rem_head, &rem_tail);
+        return APC_ERR_NOMEM;
+    }
+    int status = set_value(root, root_head, root_tail, root_sign);
+    if (rem != NULL && set_value(rem, rem_head, rem_tail, rem_sign) != APC_OK)
+        status = APC_ERR_NOMEM;
+    return status;
+}
+
+/**
+ * root = floor(sqrt(n)) and rem = n - root^2
+ * @param rem: may be NULL; otherwise distinct from root
+ * @return: APC_OK, APC_ERR_INVALID (negative n) or APC_ERR_NOMEM
+ */
+int apc_isqrt(apc_num *root, apc_num *rem, const apc_num *n)
+{
+    return apc_iroot(root, rem, n, 2);
+}
+
+/**
+ * Store a digit list produced by one of the factorial functions
+ */
+static int fact_result(apc_num *result, int status, Dlist *head, Dlist *tail)
+{
+    if (status == FAILURE)
+    {
+        dl_delete_list(&head, &tail);
+        return APC_ERR_NOMEM;
+    }
+    return set_value(result, head, tail, 1);
+}
+
+/**
+ * result = n!
+ * @return: APC_OK, APC_ERR_INVALID (n > 4294967295) or APC_ERR_NOMEM
+ */
+int apc_factorial(apc_num *result, unsigned long n)
+{
+    if (result == NULL || n > FACT_MAX_N)
+        return APC_ERR_INVALID;
+    Dlist *head = NULL, *tail = NULL;
+    int status = factorial_number(n, &head, &tail);
+    return fact_result(result, status, head, tail);
+}
+
+/**
+ * result = C(n, k), 0 when k > n
+ * @return: APC_OK, APC_ERR_INVALID (n or k > 4294967295) or APC_ERR_NOMEM
+ */
+int apc_binomial(apc_num *result, unsigned long n, unsigned long k)
+{
+    if (result == NULL || n > FACT_MAX_N || k > FACT_MAX_N)
+        return APC_ERR_INVALID;
+    Dlist *head = NULL, *tail = NULL;
+    int status = binomial_number(n, k, &head, &tail);
+    return fact_result(result, status, head, tail);
+}
+
+/**
+ * result = n#, the product of the primes <= n
+ * @return: APC_OK, APC_ERR_INVALID (n > 4294967295) or APC_ERR_NOMEM
+ */
+int apc_primorial(apc_num *result, unsigned long n)
+{
+    if (result == NULL || n > FACT_MAX_N)
+        return APC_ERR_INVALID;
+    Dlist *head = NULL, *tail = NULL;
+    int status = primorial_number(n, &head, &tail);
+    return fact_result(result, status, head, tail);
+}
+
+/* ============================================================================
+ * RATIONALS
+ * ============================================================================ */
+
+/**
+ * Create a new fraction with value 0 (0/1)
+ * @param q: receives the new handle
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_init(apc_rat **q)
+{
+    if (q == NULL)
+        return APC_ERR_INVALID;
+    *q = calloc(1, sizeof(apc_rat));
+    if (*q == NULL)
+        return APC_ERR_NOMEM;
+    rat_init(&(*q)->value);
+    if (rat_parse(&(*q)->value, "0", 1, NULL) != SUCCESS)
+    {
+        free(*q);
+        *q = NULL;
+        return APC_ERR_NOMEM;
+    }
+    return APC_OK;
+}
+
+/**
+ * Release a fraction
+ * @param q: fraction to free (NULL is ignored)
+ */
+void apc_rat_free(apc_rat *q)
+{
+    if (q == NULL)
+        return;
+    rat_free(&q->value);
+    free(q);
+}
+
+/**
+ * Set a fraction from its text
+ * @param q: fraction to overwrite (unchanged on error)
+ * @param str: "[-]p" or "[-]p/[-]q" (leading zeros allowed, q nonzero)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_PARSE, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_rat_parse(apc_rat *q, const char *str)
+{
+    if (q == NULL || str == NULL)
+        return APC_ERR_INVALID;
+    rational parsed;
+    rat_init(&parsed);
+    int status = rat_parse(&parsed, str, strlen(str), NULL);
+    if (status == FAILURE)
+        return APC_ERR_PARSE;
+    if (status == ZERO_DENOMINATOR)
+        return APC_ERR_DIV_ZERO;
+    if (status != SUCCESS)
+        return APC_ERR_NOMEM;
+    rat_free(&q->value);
+    q->value = parsed;
+    return APC_OK;
+}
+/**
+ * q = num / den
+ * @param q: fraction to overwrite
+ * @param num: numerator
+ * @param den: denominator (nonzero; its sign moves to the numerator)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_rat_set(apc_rat *q, const apc_num *num, const apc_num *den)
+{
+    if (q == NULL || num == NULL || den == NULL)
+        return APC_ERR_INVALID;
+    if (is_zero(den->head))
+        return APC_ERR_DIV_ZERO;
+    rational value;
+    rat_init(&value);
+    if (copy_list(num->head, &value.num_head, &value.num_tail) != SUCCESS ||
+        copy_list(den->head, &value.den_head, &value.den_tail) != SUCCESS)
+    {
+        rat_free(&value);
+        return APC_ERR_NOMEM;
+    }
+    value.sign = (is_zero(num->head) || num->sign == den->sign) ? 1 : -1;
+    value.reduced_length = (size_t)get_list_length(num->head) + (size_t)get_list_length(den->head);
+    rat_free(&q->value);
+    q->value = value;
+    return APC_OK;
+}
+
+/**
+ * Reduce a fraction to lowest terms now (otherwise done when it is read)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_normalize(apc_rat *q)
+{
+    if (q == NULL)
+        return APC_ERR_INVALID;
+    return (rat_normalize(&q->value) == SUCCESS) ? APC_OK : APC_ERR_NOMEM;
+}
+
+/**
+ * Numerator and denominator in lowest terms (q is reduced first)
+ * @param num: receives the signed numerator (may be NULL)
+ * @param den: receives the positive denominator (may be NULL)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_get(apc_rat *q, apc_num *num, apc_num *den)
+{
+    if (q == NULL || (num != NULL && num == den))
+        return APC_ERR_INVALID;
+    if (rat_normalize(&q->value) != SUCCESS)
+        return APC_ERR_NOMEM;
+
+    Dlist *num_head = NULL, *num_tail = NULL, *den_head = NULL, *den_tail = NULL;
+    if ((num != NULL && copy_list(q->value.num_head, &num_head, &num_tail) != SUCCESS) ||
+        (den != NULL && copy_list(q->value.den_head, &den_head, &den_tail) != SUCCESS))
+    {
+        dl_delete_list(&num_head, &num_tail);
+        dl_delete_list(&den_head, &den_tail);
+        return APC_ERR_NOMEM;
+    }
+    int status = APC_OK;
+    if (num != NULL)
+        status = set_value(num, num_head, num_tail, q->value.sign); // set_value frees the list on failure
+    if (den != NULL && status == APC_OK)
+        status = set_value(den, den_head, den_tail, 1);
+    else
+        dl_delete_list(&den_head, &den_tail);
+    return status;
+}
+
+/**
+ * Number of characters apc_rat_format will write (q is reduced first)
+ * @return: text length, 0 for a NULL handle or if the reduction ran out of memory
+ */
+size_t apc_rat_format_length(apc_rat *q)
+{
+    if (q == NULL || rat_normalize(&q->value) != SUCCESS)
+        return 0;
+    size_t length = (size_t)get_list_length(q->value.num_head);
+    if (q->value.sign == -1)
+        length++;
+    if (!(q->value.den_head->next == NULL && q->value.den_head->data == 1))
+        length += 1 + (size_t)get_list_length(q->value.den_head); // "/" and the denominator
+    return length;
+}
+
+/**
+ * Write a fraction in lowest terms as "p/q", or "p" when q = 1
+ * @param buf: destination buffer
+ * @param size: size of buf in bytes (needs apc_rat_format_length(q) + 1)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_NOMEM or APC_ERR_BUFFER
+ */
+int apc_rat_format(apc_rat *q, char *buf, size_t size)
+{
+    if (q == NULL || buf == NULL)
+        return APC_ERR_INVALID;
+    if (rat_normalize(&q->value) != SUCCESS)
+        return APC_ERR_NOMEM;
+    if (size < apc_rat_format_length(q) + 1)
+        return APC_ERR_BUFFER;
+
+    size_t pos = 0;
+    if (q->value.sign == -1)
+        buf[pos++] = '-';
+    for (Dlist *node = q->value.num_head; node != NULL; node = node->next)
+        buf[pos++] = (char)('0' + node->data);
+    if (!(q->value.den_head->next == NULL && q->value.den_head->data == 1))
+    {
+        buf[pos++] = '/';
+        for (Dlist *node = q->value.den_head; node != NULL; node = node->next)
+            buf[pos++] = (char)('0' + node->data);
+    }
+    buf[pos] = '\0';
+    return APC_OK;
+}
+
+/**
+ * result = a op b, built aside and installed last (result may be a or b)
+ */
+static int rat_status(apc_rat *result, const apc_rat *a, char op, const apc_rat *b)
+{
+    if (result == NULL || a == NULL || b == NULL)
+        return APC_ERR_INVALID;
+    if (op == '/' && is_zero(b->value.num_head))
+        return APC_ERR_DIV_ZERO;
+    rational value;
+    rat_init(&value);
+    if (rat_op(&value, &a->value, op, &b->value) != SUCCESS)
+        return APC_ERR_NOMEM;
+    rat_free(&result->value);
+    result->value = value;
+    return APC_OK;
+}
+
+/**
+ * result = a + b (equal denominators are not multiplied out)
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_add(apc_rat *result, const apc_rat *a, const apc_rat *b)
+{
+    return rat_status(result, a, '+', b);
+}
+
+/**
+ * result = a - b
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_sub(apc_rat *result, const apc_rat *a, const apc_rat *b)
+{
+    return rat_status(result, a, '-', b);
+}
+
+/**
+ * result = a * b
+ * @return: APC_OK, APC_ERR_INVALID or APC_ERR_NOMEM
+ */
+int apc_rat_mul(apc_rat *result, const apc_rat *a, const apc_rat *b)
+{
+    return rat_status(result, a, 'x', b);
+}
+
+/**
+ * result = a / b
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_DIV_ZERO or APC_ERR_NOMEM
+ */
+int apc_rat_div(apc_rat *result, const apc_rat *a, const apc_rat *b)
+{
+    return rat_status(result, a, '/', b);
+}
+
+/* ============================================================================
+ * OUT-OF-CORE FILE ARITHMETIC
+ * ============================================================================ */
+
+/**
+ * Map a stream_* status to a library status code
+ */
+static int stream_status(int status)
+{
+    if (status == SUCCESS)
+        return APC_OK;
+    if (status == FILE_OPEN_ERROR)
+        return APC_ERR_IO;
+    return APC_ERR_PARSE; // Invalid operand (or I/O error part way through)
+}
+
+/**
+ * out_path = contents of path1 + contents of path2, computed chunk by chunk
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO or APC_ERR_PARSE
+ */
+int apc_file_add(const char *path1, const char *path2, const char *out_path)
+{
+    if (path1 == NULL || path2 == NULL || out_path == NULL)
+        return APC_ERR_INVALID;
+    return stream_status(stream_add_sub(path1, '+', path2, out_path));
+}
+
+/**
+ * out_path = contents of path1 - contents of path2, computed chunk by chunk
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO or APC_ERR_PARSE
+ */
+int apc_file_sub(const char *path1, const char *path2, const char *out_path)
+{
+    if (path1 == NULL || path2 == NULL || out_path == NULL)
+        return APC_ERR_INVALID;
+    return stream_status(stream_add_sub(path1, '-', path2, out_path));
+}
+
+/**
+ * Compare two numbers stored in files without loading them
+ * @param result: receives -1, 0 or +1
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO or APC_ERR_PARSE
+ */
+int apc_file_compare(const char *path1, const char *path2, int *result)
+{
+    if (path1 == NULL || path2 == NULL || result == NULL)
+        return APC_ERR_INVALID;
+    return stream_status(stream_compare(path1, path2, result));
+}
+
+/* ============================================================================
+ * REDUCTIONS
+ * ============================================================================ */
+
+/**
+ * result = sum or product of the whitespace separated numbers in a text file
+ */
+static int reduce_status(apc_num *result, const char *path, char op)
+{
+    if (result == NULL || path == NULL)
+        return APC_ERR_INVALID;
+    Dlist *head = NULL, *tail = NULL;
+    int sign = 1;
+    size_t count = 0, bad_line = 0;
+    int status = reduce_file(path, op, &head, &tail, &sign, &count, &bad_line);
+    if (status == FILE_OPEN_ERROR)
+        return APC_ERR_IO;
+    if (status == FAILURE)
+        return APC_ERR_PARSE;
+    if (status != SUCCESS)
+        return APC_ERR_NOMEM;
+    return set_value(result, head, tail, sign);
+}
+
+/**
+ * result = sum of the numbers in a text file ("-" reads stdin; empty file: 0)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO, APC_ERR_PARSE or APC_ERR_NOMEM
+ */
+int apc_sum_file(apc_num *result, const char *path)
+{
+    return reduce_status(result, path, '+');
+}
+
+/**
+ * result = product of the numbers in a text file ("-" reads stdin; empty file: 1)
+ * @return: APC_OK, APC_ERR_INVALID, APC_ERR_IO, APC_ERR_PARSE or APC_ERR_NOMEM
+ */
+int apc_product_file(apc_num *result, const char *path)
+{
+    return reduce_status(result, path, 'x');
+}
+
+/* ============================================================================
+ * MEMORY BUDGET
+ * ============================================================================ */
+
+/**
+ * Limit the memory all numbers and operations may use together
+ * @param bytes: limit in bytes, 0 for none
+ */
+void apc_set_mem_limit(size_t bytes)
+{
+    mem_set_limit(bytes);
+}
+
+/**
+ * Memory counted against the budget
+ * @param live: receives the bytes in use now (may be NULL)
+ * @param peak: receives the most bytes in use at once so far (may be NULL)
+ */
+void apc_mem_usage(size_t *live, size_t *peak)
+{
+    if (live != NULL)
+        *live = mem_live();
+    if (peak != NULL)
+        *peak = mem_peak();
+}
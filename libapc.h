@@ -0,0 +1,165 @@
+#ifndef LIBAPC_H
+#define LIBAPC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * LIBAPC - ARBITRARY PRECISION CALCULATOR LIBRARY
+ * In-process API over the same arithmetic used by ./a.out
+ *
+ * Numbers are opaque handles (apc_num). Every function reports problems through
+ * its return value (APC_OK or a negative APC_ERR_* code) and never prints.
+ *
+ * Thread safety: different handles may be used from different threads at the
+ * same time (also handles sharing digits after apc_copy, whose reference
+ * counts are atomic); a single handle must not be written by one thread
+ * while another thread uses it. Besides the handles the library keeps this
+ * process-wide state, all of it safe to reach from any thread:
+ * - memory budget: live and peak bytes and the limit, atomics. The limit is
+ *   read from APC_MEM_LIMIT on first use and changed by apc_set_mem_limit,
+ *   the only process-wide setting this API has.
+ * - algorithm thresholds: read from apc_thresholds.h and the
+ *   APC_*_THRESHOLD variables on first use, read-only afterwards (threads
+ *   racing the first call all store the same values).
+ * - large buffers: the NUMA placement, read once from APC_NUMA, and the
+ *   huge-page counters, atomics.
+ * - digit node pool: slabs of free nodes behind one mutex, and a cache of
+ *   at most a few thousand free nodes per thread. Emptied slabs are unmapped.
+ * - tracing and statistics: the trace switch is only turned on by
+ *   ./a.out --trace and stays off in the library; the counters of a
+ *   make STATS=1 build are atomics and thread-local variables.
+ * No call forks. apc_factorial, apc_binomial and apc_primorial may run
+ * helper threads for a large product tree, and join them before returning.
+ *
+ * Typical use:
+ *   apc_num *a, *b, *r;
+ *   apc_init(&a); apc_init(&b); apc_init(&r);
+ *   apc_parse(a, "123456789"); apc_parse(b, "-42");
+ *   apc_mul(r, a, b);
+ *   char text[64]; apc_format(r, text, sizeof(text));
+ *   apc_free(a); apc_free(b); apc_free(r);
+ * ============================================================================ */
+
+/* ============================================================================
+ * STATUS CODES
+ * ============================================================================ */
+#define APC_OK             0   // Success
+#define APC_ERR_NOMEM     -1   // Memory allocation failed
+#define APC_ERR_PARSE     -2   // Text is not "[-]digits"
+#define APC_ERR_DIV_ZERO  -3   // Division by zero
+#define APC_ERR_INVALID   -4   // NULL handle or other invalid argument
+#define APC_ERR_BUFFER    -5   // Output buffer too small
+#define APC_ERR_IO        -6   // File could not be opened or mapped
+
+/* ============================================================================
+ * ROUNDING MODES (apc_div_scaled)
+ * ============================================================================ */
+#define APC_ROUND_DOWN       0  // Toward zero
+#define APC_ROUND_UP         1  // Away from zero
+#define APC_ROUND_FLOOR      2  // Toward minus infinity
+#define APC_ROUND_CEILING    3  // Toward plus infinity
+#define APC_ROUND_HALF_UP    4  // Nearest, ties away from zero
+#define APC_ROUND_HALF_DOWN  5  // Nearest, ties toward zero
+#define APC_ROUND_HALF_EVEN  6  // Nearest, ties to even
+
+/* ============================================================================
+ * TYPE DEFINITIONS
+ * ============================================================================ */
+typedef struct apc_num apc_num;  // Opaque signed arbitrary precision integer
+typedef struct apc_rat apc_rat;  // Opaque exact fraction of two such integers
+
+/* ============================================================================
+ * LIFETIME, PARSING AND FORMATTING
+ * ============================================================================ */
+int apc_init(apc_num **num);                          // Create a new number with value 0
+void apc_free(apc_num *num);                          // Release a number (NULL is ignored)
+int apc_copy(apc_num *dest, const apc_num *src);      // dest = src, O(1) (digits shared copy-on-write)
+int apc_neg(apc_num *dest, const apc_num *src);       // dest = -src, O(1)
+int apc_abs(apc_num *dest, const apc_num *src);       // dest = |src|, O(1)
+int apc_parse(apc_num *num, const char *str);         // Set from "[-]digits"
+int apc_parse_file(apc_num *num, const char *path);   // Set from a "[-]digits" or binary .apcn file
+int apc_save(const apc_num *num, const char *path);   // Write as a binary .apcn file
+size_t apc_format_length(const apc_num *num);         // Characters apc_format writes (without '\0')
+int apc_format(const apc_num *num, char *buf, size_t size);  // Plain decimal text, '\0' terminated
+int apc_sign(const apc_num *num);                     // -1, 0 or +1
+const char *apc_strerror(int status);                 // Message for a status code
+
+/* ============================================================================
+ * BINARY WORDS
+ * Magnitude as 32-bit words, least significant first (for hashing, crypto or
+ * handing numbers to other libraries); conversion is subquadratic
+ * ============================================================================ */
+int apc_export(const apc_num *num, uint32_t **words, size_t *count);  // New array (free() it), count 0 for zero
+int apc_import(apc_num *num, const uint32_t *words, size_t count, int sign);  // Set from words, sign +1/-1
+
+/* ============================================================================
+ * ARITHMETIC
+ * result may be the same handle as an operand
+ * ============================================================================ */
+int apc_add(apc_num *result, const apc_num *a, const apc_num *b);   // result = a + b
+int apc_sub(apc_num *result, const apc_num *a, const apc_num *b);   // result = a - b
+int apc_mul(apc_num *result, const apc_num *a, const apc_num *b);   // result = a * b
+int apc_divmod(apc_num *quotient, apc_num *remainder,
+               const apc_num *a, const apc_num *b);   // Truncating division; either output may be NULL
+int apc_div_scaled(apc_num *result, const apc_num *a, const apc_num *b,
+                   size_t scale, int round);   // a / b * 10^scale, rounded (fixed point, scale places)
+int apc_powmod(apc_num *result, const apc_num *base,
+               const apc_num *exp, const apc_num *mod);   // base^exp mod mod, in [0, mod)
+int apc_powmod_sec(apc_num *result, const apc_num *base,
+                   const apc_num *exp, const apc_num *mod);   // Same, constant time in exp (odd mod)
+int apc_gcd(apc_num *result, const apc_num *a, const apc_num *b);   // gcd(|a|, |b|) >= 0
+int apc_xgcd(apc_num *g, apc_num *s, apc_num *t,
+             const apc_num *a, const apc_num *b);   // s*a + t*b = g (three distinct outputs)
+int apc_isqrt(apc_num *root, apc_num *rem, const apc_num *n);   // floor(sqrt(n)), rem = n - root^2 (may be NULL)
+int apc_iroot(apc_num *root, apc_num *rem, const apc_num *n,
+              unsigned long k);   // k-th root toward zero, rem = n - root^k (may be NULL)
+int apc_factorial(apc_num *result, unsigned long n);   // n! (n <= 4294967295)
+int apc_binomial(apc_num *result, unsigned long n, unsigned long k);   // C(n, k), 0 when k > n
+int apc_primorial(apc_num *result, unsigned long n);   // Product of the primes <= n
+
+/* ============================================================================
+ * RATIONALS
+ * Exact fractions. Results are reduced to lowest terms lazily (when they have
+ * grown to twice their operands' reduced size), and always before they are
+ * read: apc_rat_get, apc_rat_format_length and apc_rat_format reduce first.
+ * result may be the same handle as an operand.
+ * ============================================================================ */
+int apc_rat_init(apc_rat **q);                        // Create a new fraction with value 0
+void apc_rat_free(apc_rat *q);                        // Release a fraction (NULL is ignored)
+int apc_rat_parse(apc_rat *q, const char *str);       // Set from "[-]p" or "[-]p/[-]q"
+int apc_rat_set(apc_rat *q, const apc_num *num,
+                const apc_num *den);                  // q = num / den
+int apc_rat_get(apc_rat *q, apc_num *num, apc_num *den);  // Lowest terms, den > 0 (either may be NULL)
+int apc_rat_normalize(apc_rat *q);                    // Reduce to lowest terms now
+size_t apc_rat_format_length(apc_rat *q);             // Characters apc_rat_format writes (without '\0')
+int apc_rat_format(apc_rat *q, char *buf, size_t size);   // "p/q", or "p" for an integer
+int apc_rat_add(apc_rat *result, const apc_rat *a, const apc_rat *b);   // result = a + b
+int apc_rat_sub(apc_rat *result, const apc_rat *a, const apc_rat *b);   // result = a - b
+int apc_rat_mul(apc_rat *result, const apc_rat *a, const apc_rat *b);   // result = a * b
+int apc_rat_div(apc_rat *result, const apc_rat *a, const apc_rat *b);   // result = a / b
+
+/* ============================================================================
+ * OUT-OF-CORE FILE ARITHMETIC
+ * Operands and result stay in "[-]digits" text files; memory use is bounded
+ * ============================================================================ */
+int apc_file_add(const char *path1, const char *path2, const char *out_path);  // out = a + b
+int apc_file_sub(const char *path1, const char *path2, const char *out_path);  // out = a - b
+int apc_file_compare(const char *path1, const char *path2, int *result);       // -1, 0 or +1
+
+/* ============================================================================
+ * REDUCTIONS
+ * Whitespace separated numbers in a text file ("-" reads stdin)
+ * ============================================================================ */
+int apc_sum_file(apc_num *result, const char *path);       // Sum of the numbers in a text file
+int apc_product_file(apc_num *result, const char *path);   // Product of them (product tree)
+
+/* ============================================================================
+ * MEMORY BUDGET
+ * Process wide: digits and work buffers of every handle count against one
+ * limit. An operation that would pass it fails with APC_ERR_NOMEM up front.
+ * ============================================================================ */
+void apc_set_mem_limit(size_t bytes);                 // 0 = no limit (default, or APC_MEM_LIMIT)
+void apc_mem_usage(size_t *live, size_t *peak);       // Bytes in use now / at most (either may be NULL)
+
+#endif // LIBAPC_H
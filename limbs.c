@@ -0,0 +1,585 @@
+#include "apc.h"
+
+/* ============================================================================
+ * LIMB ARITHMETIC
+ * Numbers as little endian arrays of 32-bit limbs (least significant first)
+ * in one of two bases:
+ *   LIMB_DECIMAL_BASE (10^8) - 8 decimal digits per limb, cheap to print
+ *   LIMB_BINARY_BASE  (2^32) - machine words, needed by Montgomery / binary GCD
+ *
+ * Like the result_array in mul_number, these arrays are working storage for
+ * the heavy algorithms; results are turned back into Dlists by the callers.
+ *
+ * Each routine is written once as a static inline *_impl taking the base and
+ * dispatched through a wrapper that calls it with a constant base, so the
+ * compiler turns every / and % by the base into shifts or multiplications.
+ * ============================================================================ */
+
+/* ============================================================================
+ * BASIC HELPERS
+ * ============================================================================ */
+
+/**
+ * Length of a limb array without its zero top limbs
+ * @param a: limbs
+ * @param n: current length
+ * @return: normalized length (0 for zero)
+ */
+size_t limb_normalize(const limb_t *a, size_t n)
+{
+    while (n > 0 && a[n - 1] == 0)
+        n--;
+    return n;
+}
+
+/**
+ * Compare two normalized limb numbers
+ * @return: -1, 0 or 1 for a <, ==, > b
+ */
+int limb_cmp(const limb_t *a, size_t an, const limb_t *b, size_t bn)
+{
+    if (an != bn)
+        return (an > bn) ? 1 : -1;
+    while (an-- > 0)
+    {
+        if (a[an] != b[an])
+            return (a[an] > b[an]) ? 1 : -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * LINEAR OPERATIONS
+ * ============================================================================ */
+
+/**
+ * r = a + b (an >= bn), r has an limbs
+ * @return: carry out of the top limb (0 or 1)
+ */
+static inline limb_t limb_add_impl(limb_t *r, const limb_t *a, size_t an,
+                                   const limb_t *b, size_t bn, const uint64_t base)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++)
+    {
+        uint64_t t = (uint64_t)a[i] + b[i] + carry;
+        carry = (t >= base);
+        r[i] = (limb_t)(carry ? t - base : t);
+    }
+    for (; i < an; i++)
+    {
+        uint64_t t = (uint64_t)a[i] + carry;
+        carry = (t >= base);
+        r[i] = (limb_t)(carry ? t - base : t);
+    }
+    return (limb_t)carry;
+}
+
+/**
+ * r = a - b (a >= b as numbers is not required; an >= bn), r has an limbs
+ * @return: borrow out of the top limb (0 or 1)
+ */
+static inline limb_t limb_sub_impl(limb_t *r, const limb_t *a, size_t an,
+                                   const limb_t *b, size_t bn, const uint64_t base)
+{
+    int64_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++)
+    {
+        int64_t t = (int64_t)a[i] - b[i] - borrow;
+        borrow = (t < 0);
+        r[i] = (limb_t)(borrow ? t + (int64_t)base : t);
+    }
+    for (; i < an; i++)
+    {
+        int64_t t = (int64_t)a[i] - borrow;
+        borrow = (t < 0);
+        r[i] = (limb_t)(borrow ? t + (int64_t)base : t);
+    }
+    return (limb_t)borrow;
+}
+
+/**
+ * r = a * m + add (m < base, add < base), r has n limbs
+ * @return: carry limb
+ */
+static inline limb_t limb_mul_1_impl(limb_t *r, const limb_t *a, size_t n, limb_t m,
+                                     limb_t add, const uint64_t base)
+{
+    uint64_t carry = add;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t t = (uint64_t)a[i] * m + carry;
+        r[i] = (limb_t)(t % base);
+        carry = t / base;
+    }
+    return (limb_t)carry;
+}
+
+/**
+ * r += a * m (m < base), over n limbs of r
+ * @return: carry limb to add at r[n]
+ */
+static inline limb_t limb_addmul_1_impl(limb_t *r, const limb_t *a, size_t n, limb_t m,
+                                        const uint64_t base)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t t = (uint64_t)a[i] * m + r[i] + carry; // <= (base-1)^2 + 2(base-1) < 2^64
+        r[i] = (limb_t)(t % base);
+        carry = t / base;
+    }
+    return (limb_t)carry;
+}
+
+/**
+ * r -= a * m (m < base), over n limbs of r
+ * @return: amount still to subtract from r[n]
+ */
+static inline limb_t limb_submul_1_impl(limb_t *r, const limb_t *a, size_t n, limb_t m,
+                                        const uint64_t base)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t product = (uint64_t)a[i] * m + carry;
+        uint64_t low = product % base;
+        carry = product / base;
+        if (r[i] < low)
+        {
+            r[i] = (limb_t)(r[i] + base - low);
+            carry++;
+        }
+        else
+            r[i] = (limb_t)(r[i] - low);
+    }
+    return (limb_t)carry;
+}
+
+/**
+ * q = a / d (d < base), q has n limbs (may be the same array as a)
+ * @return: remainder
+ */
+static inline limb_t limb_divmod_1_impl(limb_t *q, const limb_t *a, size_t n, limb_t d,
+                                        const uint64_t base)
+{
+    uint64_t rem = 0;
+    for (size_t i = n; i-- > 0;)
+    {
+        uint64_t t = rem * base + a[i];
+        q[i] = (limb_t)(t / d);
+        rem = t % d;
+    }
+    return (limb_t)rem;
+}
+
+// Wrappers: choose a constant base so each body is compiled for it
+#define LIMB_DISPATCH(call_dec, call_bin) \
+    ((base) == LIMB_BINARY_BASE ? (call_bin) : (call_dec))
+
+limb_t limb_add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, uint64_t base)
+{
+    return LIMB_DISPATCH(limb_add_impl(r, a, an, b, bn, LIMB_DECIMAL_BASE),
+                         limb_add_impl(r, a, an, b, bn, LIMB_BINARY_BASE));
+}
+
+limb_t limb_sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, uint64_t base)
+{
+    return LIMB_DISPATCH(limb_sub_impl(r, a, an, b, bn, LIMB_DECIMAL_BASE),
+                         limb_sub_impl(r, a, an, b, bn, LIMB_BINARY_BASE));
+}
+
+limb_t limb_mul_1(limb_t *r, const limb_t *a, size_t n, limb_t m, limb_t add, uint64_t base)
+{
+    return LIMB_DISPATCH(limb_mul_1_impl(r, a, n, m, add, LIMB_DECIMAL_BASE),
+                         limb_mul_1_impl(r, a, n, m, add, LIMB_BINARY_BASE));
+}
+
+limb_t limb_addmul_1(limb_t *r, const limb_t *a, size_t n, limb_t m, uint64_t base)
+{
+    return LIMB_DISPATCH(limb_addmul_1_impl(r, a, n, m, LIMB_DECIMAL_BASE),
+                         limb_addmul_1_impl(r, a, n, m, LIMB_BINARY_BASE));
+}
+
+limb_t limb_divmod_1(limb_t *q, const limb_t *a, size_t n, limb_t d, uint64_t base)
+{
+    return LIMB_DISPATCH(limb_divmod_1_impl(q, a, n, d, LIMB_DECIMAL_BASE),
+                         limb_divmod_1_impl(q, a, n, d, LIMB_BINARY_BASE));
+}
+
+/**
+ * Add a carry limb into r starting at position i, propagating upwards
+ * (r must be long enough to absorb it)
+ */
+static void limb_add_carry(limb_t *r, size_t n, size_t i, limb_t carry, uint64_t base)
+{
+    while (carry != 0 && i < n)
+    {
+        uint64_t t = (uint64_t)r[i] + carry;
+        carry = (t >= base);
+        r[i] = (limb_t)(carry ? t - base : t);
+        i++;
+    }
+}
+
+/* ============================================================================
+ * MULTIPLICATION
+ * Schoolbook below the Karatsuba threshold (THRESHOLD_KARATSUBA limbs),
+ * Karatsuba above it
+ * ============================================================================ */
+
+#define DECIMAL_COLUMN_LIMIT 1024 // (10^8 - 1)^2 * 1024 + carry < 2^64
+
+/**
+ * Schoolbook product r = a * b, r has an + bn limbs
+ */
+static void limb_mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn,
+                              uint64_t base)
+{
+    STATS_ADD(limb_ops, an * bn);
+    if (base == LIMB_DECIMAL_BASE && bn <= DECIMAL_COLUMN_LIMIT)
+    {
+        // Product scanning: a column of bn products (< 10^16 each) fits in
+        // 64 bits, so carries are resolved once per column, not per product
+        uint64_t carry = 0;
+        for (size_t k = 0; k < an + bn - 1; k++)
+        {
+            size_t first = (k >= an) ? k - an + 1 : 0;
+            size_t last = (k < bn) ? k : bn - 1;
+            uint64_t column = carry;
+            for (size_t j = first; j <= last; j++)
+                column += (uint64_t)a[k - j] * b[j];
+            r[k] = (limb_t)(column % LIMB_DECIMAL_BASE);
+            carry = column / LIMB_DECIMAL_BASE;
+        }
+        r[an + bn - 1] = (limb_t)carry;
+        return;
+    }
+    memset(r, 0, (an + bn) * sizeof(limb_t));
+    for (size_t j = 0; j < bn; j++)
+    {
+        if (b[j] != 0)
+            r[an + j] = limb_addmul_1(r + j, a, an, b[j], base);
+    }
+}
+
+/**
+ * Scratch limbs needed by karatsuba() for size n
+ */
+static size_t karatsuba_scratch(size_t n, size_t threshold)
+{
+    size_t total = 0;
+    while (n >= threshold)
+    {
+        size_t k = n - n / 2;       // High half size (>= low half)
+        total += 4 * (k + 1);       // sa, sb and the middle product
+        n = k + 1;                  // Size of the recursive middle product
+    }
+    return total + 1;
+}
+
+/**
+ * Karatsuba product of two n-limb numbers, r has 2n limbs
+ * a = a0 + a1*B^h, b = b0 + b1*B^h
+ * a*b = z0 + ((a0+a1)(b0+b1) - z0 - z2)*B^h + z2*B^2h
+ * @param scratch: at least karatsuba_scratch(n, threshold) limbs
+ * @param threshold: schoolbook below this size (at least 4, so halves shrink)
+ */
+static void karatsuba(limb_t *r, const limb_t *a, const limb_t *b, size_t n,
+                      limb_t *scratch, size_t threshold, uint64_t base)
+{
+    if (n < threshold)
+    {
+        limb_mul_basecase(r, a, n, b, n, base);
+        return;
+    }
+
+    TRACE_BEGIN("karatsuba", "limbs", n);
+    size_t h = n / 2;       // Low half size
+    size_t k = n - h;       // High half size (k >= h)
+    limb_t *sa = scratch;           // a0 + a1 (k + 1 limbs)
+    limb_t *sb = sa + (k + 1);      // b0 + b1 (k + 1 limbs)
+    limb_t *mid = sb + (k + 1);     // (a0+a1)(b0+b1) (2k + 2 limbs)
+    limb_t *next = mid + 2 * (k + 1);
+
+    // Step 1: Outer products straight into the result
+    karatsuba(r, a, b, h, next, threshold, base);                 // z0 -> r[0, 2h)
+    karatsuba(r + 2 * h, a + h, b + h, k, next, threshold, base); // z2 -> r[2h, 2n)
+
+    // Step 2: Middle product of the half sums
+    sa[k] = limb_add(sa, a + h, k, a, h, base);
+    sb[k] = limb_add(sb, b + h, k, b, h, base);
+    karatsuba(mid, sa, sb, k + 1, next, threshold, base);
+
+    // Step 3: mid -= z0 + z2, then add it in at B^h
+    TRACE_BEGIN("karatsuba_combine", NULL, 0);
+    size_t mid_len = 2 * (k + 1);
+    limb_sub(mid, mid, mid_len, r, 2 * h, base);
+    limb_sub(mid, mid, mid_len, r + 2 * h, 2 * k, base);
+    mid_len = limb_normalize(mid, mid_len);
+    if (mid_len > 2 * n - h)
+        mid_len = 2 * n - h; // Cannot exceed the product (top limbs are zero)
+    limb_t carry = limb_add(r + h, r + h, mid_len, mid, mid_len, base);
+    limb_add_carry(r, 2 * n, h + mid_len, carry, base);
+    TRACE_END();
+    TRACE_END();
+}
+
+/**
+ * Product r = a * b, r has an + bn limbs (must not overlap a or b)
+ * Picks schoolbook or Karatsuba; unbalanced operands are cut into
+ * square blocks so Karatsuba still applies
+ * @return: SUCCESS, or FAILURE if scratch memory could not be allocated
+ */
+int limb_mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, uint64_t base)
+{
+    if (an < bn) // Keep a as the longer operand
+    {
+        const limb_t *t = a; a = b; b = t;
+        size_t tn = an; an = bn; bn = tn;
+    }
+    if (bn == 0)
+    {
+        memset(r, 0, an * sizeof(limb_t));
+        return SUCCESS;
+    }
+    size_t threshold = get_threshold(THRESHOLD_KARATSUBA);
+    if (bn < threshold)
+    {
+        limb_mul_basecase(r, a, an, b, bn, base);
+        return SUCCESS;
+    }
+
+    size_t scratch_count = karatsuba_scratch(bn, threshold);
+    size_t scratch_bytes = (scratch_count + 2 * bn) * sizeof(limb_t);
+    limb_t *scratch = big_alloc(scratch_bytes, 0);
+    if (scratch == NULL)
+        return FAILURE;
+    TRACE_BEGIN("limb_mul", "limbs", an + bn);
+    limb_t *block = scratch + scratch_count; // One block product (2 bn limbs)
+
+    // Square blocks of a times b, accumulated at their offsets
+    memset(r, 0, (an + bn) * sizeof(limb_t));
+    size_t offset = 0;
+    for (; offset + bn <= an; offset += bn)
+    {
+        karatsuba(block, a + offset, b, bn, scratch, threshold, base);
+        limb_t carry = limb_add(r + offset, r + offset, 2 * bn, block, 2 * bn, base);
+        limb_add_carry(r, an + bn, offset + 2 * bn, carry, base);
+    }
+    int status = SUCCESS;
+    if (offset < an) // Leftover piece shorter than b
+    {
+        size_t rest = an - offset;
+        status = limb_mul(block, b, bn, a + offset, rest, base);
+        if (status == SUCCESS)
+        {
+            limb_t carry = limb_add(r + offset, r + offset, rest + bn, block, rest + bn, base);
+            limb_add_carry(r, an + bn, offset + rest + bn, carry, base);
+        }
+    }
+    big_free(scratch, scratch_bytes);
+    TRACE_END();
+    return status;
+}
+
+/**
+ * Short product r = (a * b) mod base^n, a and b n limbs each (r must not
+ * overlap them). Only the low half of the product is formed: truncated
+ * schoolbook below the Karatsuba threshold, above it Mulders' split, a full
+ * product of the low h ~ 0.7n limbs plus two short products of the rest.
+ * @return: SUCCESS, or FAILURE if scratch memory could not be allocated
+ */
+int limb_mullo(limb_t *r, const limb_t *a, const limb_t *b, size_t n, uint64_t base)
+{
+    if (n < get_threshold(THRESHOLD_KARATSUBA))
+    {
+        memset(r, 0, n * sizeof(limb_t));
+        for (size_t i = 0; i < n; i++)
+            limb_addmul_1(r + i, b, n - i, a[i], base); // Carry out of limb n is dropped
+        STATS_ADD(limb_ops, n * (n + 1) / 2);
+        return SUCCESS;
+    }
+
+    // Step 1: Full product of the low h limbs
+    size_t h = (7 * n + 9) / 10, rest = n - h;
+    size_t full_bytes = (2 * h + rest) * sizeof(limb_t);
+    limb_t *full = big_alloc(full_bytes, 0);
+    if (full == NULL)
+        return FAILURE;
+    limb_t *cross = full + 2 * h;
+    int status = limb_mul(full, a, h, b, h, base);
+    memcpy(r, full, n * sizeof(limb_t));
+
+    // Step 2: Low halves of the two cross products, added at limb h
+    if (status == SUCCESS && rest > 0)
+        status = limb_mullo(cross, a, b + h, rest, base);
+    if (status == SUCCESS && rest > 0)
+    {
+        limb_add(r + h, r + h, rest, cross, rest, base);
+        status = limb_mullo(cross, a + h, b, rest, base);
+    }
+    if (status == SUCCESS && rest > 0)
+        limb_add(r + h, r + h, rest, cross, rest, base);
+    big_free(full, full_bytes);
+    return status;
+}
+
+/* ============================================================================
+ * DIVISION
+ * ============================================================================ */
+
+/**
+ * Schoolbook long division (Knuth, TAOCP vol. 2, algorithm D)
+ * q = a / b (an - bn + 1 limbs), r = a % b (bn limbs); b normalized, bn >= 1, an >= bn
+ * q or r may be NULL when not wanted
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+int limb_divmod(limb_t *q, limb_t *r, const limb_t *a, size_t an,
+                const limb_t *b, size_t bn, uint64_t base)
+{
+    if (bn == 1)
+    {
+        limb_t *quot = (q != NULL) ? q : malloc(an * sizeof(limb_t));
+        if (quot == NULL)
+            return FAILURE;
+        limb_t rem = limb_divmod_1(quot, a, an, b[0], base);
+        if (r != NULL)
+            r[0] = rem;
+        if (quot != q)
+            free(quot);
+        return SUCCESS;
+    }
+
+    // Step 1: Normalize so the top divisor limb is at least base / 2
+    limb_t d = (limb_t)(base / ((uint64_t)b[bn - 1] + 1));
+    size_t u_bytes = (an + 1 + bn) * sizeof(limb_t);
+    limb_t *u = big_alloc(u_bytes, 0); // Scaled dividend, then scaled divisor
+    if (u == NULL)
+        return FAILURE;
+    TRACE_BEGIN("limb_divmod", "limbs", an);
+    limb_t *v = u + an + 1;
+    u[an] = limb_mul_1(u, a, an, d, 0, base);
+    limb_mul_1(v, b, bn, d, 0, base);
+
+    // Step 2: One quotient limb per step, from the top
+    STATS_ADD(limb_ops, (an - bn + 1) * bn);
+    uint64_t v1 = v[bn - 1], v2 = v[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0;)
+    {
+        // Estimate from the top two limbs, then correct (at most twice)
+        uint64_t top = (uint64_t)u[j + bn] * base + u[j + bn - 1];
+        uint64_t qhat = top / v1;
+        uint64_t rhat = top % v1;
+        while (qhat >= base ||
+               (unsigned __int128)qhat * v2 > (unsigned __int128)rhat * base + u[j + bn - 2])
+        {
+            qhat--;
+            rhat += v1;
+            if (rhat >= base)
+                break;
+        }
+
+        // Multiply and subtract; add back if the estimate was one too big
+        limb_t borrow = LIMB_DISPATCH(limb_submul_1_impl(u + j, v, bn, (limb_t)qhat, LIMB_DECIMAL_BASE),
+                                      limb_submul_1_impl(u + j, v, bn, (limb_t)qhat, LIMB_BINARY_BASE));
+        if (u[j + bn] < borrow)
+        {
+            u[j + bn] = (limb_t)(u[j + bn] + base - borrow);
+            qhat--;
+            limb_t carry = limb_add(u + j, u + j, bn, v, bn, base);
+            u[j + bn] = (limb_t)((u[j + bn] + carry) % base);
+        }
+        else
+            u[j + bn] -= borrow;
+        if (q != NULL)
+            q[j] = (limb_t)qhat;
+    }
+
+    // Step 3: Unscale the remainder
+    if (r != NULL)
+        limb_divmod_1(r, u, bn, d, base);
+    big_free(u, u_bytes);
+    TRACE_END();
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * DECIMAL LIMBS <-> DIGIT LISTS
+ * ============================================================================ */
+
+/**
+ * Pack a digit list into decimal limbs (8 digits per limb, linear time)
+ * @param head: head of the number
+ * @param tail: tail of the number
+ * @param count: receives the normalized limb count (0 for zero)
+ * @return: new limb array (at least one limb allocated), NULL if out of memory
+ */
+limb_t *list_to_limbs(Dlist *head, Dlist *tail, size_t *count)
+{
+    size_t digits = (size_t)get_list_length(head);
+    size_t n = digits / LIMB_DECIMAL_DIGITS + 1;
+    limb_t *limbs = calloc(n, sizeof(limb_t));
+    if (limbs == NULL)
+        return NULL;
+
+    size_t i = 0;
+    limb_t scale = 1;
+    int used = 0;
+    for (Dlist *node = tail; node != NULL; node = node->prev) // Least significant first
+    {
+        limbs[i] += (limb_t)node->data * scale;
+        scale *= 10;
+        if (++used == LIMB_DECIMAL_DIGITS)
+        {
+            i++;
+            scale = 1;
+            used = 0;
+        }
+    }
+    *count = limb_normalize(limbs, n);
+    return limbs;
+}
+
+/**
+ * Unpack decimal limbs into a digit list (no leading zeros, "0" for zero)
+ * @param limbs: decimal limbs
+ * @param count: number of limbs
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @return: SUCCESS or FAILURE (out of memory, list left empty)
+ */
+int limbs_to_list(const limb_t *limbs, size_t count, Dlist **head, Dlist **tail)
+{
+    *head = NULL;
+    *tail = NULL;
+    count = limb_normalize(limbs, count);
+    if (count == 0)
+        return dl_insert_last(head, tail, 0);
+
+    for (size_t i = count; i-- > 0;) // Most significant limb first
+    {
+        char digits[LIMB_DECIMAL_DIGITS];
+        limb_t limb = limbs[i];
+        for (int d = LIMB_DECIMAL_DIGITS - 1; d >= 0; d--)
+        {
+            digits[d] = (char)(limb % 10);
+            limb /= 10;
+        }
+        int start = 0;
+        if (i == count - 1) // No leading zeros in the top limb
+            while (digits[start] == 0)
+                start++;
+        for (int d = start; d < LIMB_DECIMAL_DIGITS; d++)
+        {
+            if (dl_insert_last(head, tail, digits[d]) == FAILURE)
+            {
+                dl_delete_list(head, tail);
+                return FAILURE;
+            }
+        }
+    }
+    return SUCCESS;
+}
@@ -6,40 +6,920 @@
 #include "apc.h"
 
 /* ============================================================================
- * INPUT VALIDATION
+ * OPERAND LOADING
  * ============================================================================ */
 
 /**
- * Validate if a string represents a valid number
- * Valid formats: "123", "-456", "0", "-0"
- * Invalid: "abc", "12.34", "", "-"
- * 
- *  string to validate
- *  1 if valid, 0 if invalid
+ * Report that something did not fit in memory (or in the --mem-limit budget)
+ * @param what: what could not be stored, e.g. "the first operand"
  */
-int is_valid_number(const char *str)
+static void print_memory_error(const char *what)
 {
-    if (str == NULL || *str == '\0')
-        return 0;
-    
-    size_t i = 0;
-    
-    // Allow optional minus sign at the beginning
-    if (str[0] == '-')
-        i = 1;
-    
-    // Check if string is just a minus sign (invalid)
-    if (i >= strlen(str))
-        return 0;
-    
-    // Check that all remaining characters are digits (0-9)
-    while (str[i] != '\0')
+    printf("❌ Error: not enough memory for %s\n", what);
+    if (mem_limit() != 0)
+        printf("💡 Memory limit is %zu bytes (raise it with --mem-limit=SIZE)\n", mem_limit());
+}
+
+/**
+ * Apply --mem-limit=SIZE
+ * @param text: the SIZE part ("0" removes the limit)
+ * @return: SUCCESS, or FAILURE after printing an error
+ */
+static int apply_mem_limit(const char *text)
+{
+    size_t bytes;
+    if (parse_size(text, &bytes) == FAILURE)
     {
-        if (str[i] < '0' || str[i] > '9')
-            return 0;
-        i++;
+        printf("❌ Invalid memory limit '%s' (use bytes or a K, M or G suffix, e.g. 512M)\n", text);
+        return FAILURE;
+    }
+    mem_set_limit(bytes);
+    return SUCCESS;
+}
+
+/* Options that only some modes act on (bits of check_options' given and allowed) */
+#define OPTION_SAVE   0x01 // --save=FILE
+#define OPTION_VERIFY 0x02 // --verify
+#define OPTION_CT     0x04 // --ct
+#define OPTION_OUT    0x08 // --out=FILE
+#define OPTION_WINDOW 0x10 // --low=K / --high=K
+#define OPTION_SHARDS 0x20 // --shards=N
+#define OPTION_SCALE  0x40 // --scale=N / --round=MODE
+
+/**
+ * Refuse options the chosen mode would otherwise ignore
+ * @param given: OPTION_* bits found on the command line
+ * @param allowed: OPTION_* bits the mode honors
+ * @param mode: name of the mode, for the message
+ * @return: SUCCESS, or FAILURE after printing an error
+ */
+static int check_options(int given, int allowed, const char *mode)
+{
+    static const char *const names[] = { "--save", "--verify", "--ct", "--out", "--low/--high", "--shards",
+                                         "--scale/--round" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if ((given & ~allowed) & (1 << i))
+        {
+            printf("❌ %s cannot be used with %s\n", names[i], mode);
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Apply --numa=MODE
+ * @param text: the MODE part ("local", "interleave" or "off")
+ * @return: SUCCESS, or FAILURE after printing an error
+ */
+static int apply_numa(const char *text)
+{
+    int mode;
+    if (parse_numa_mode(text, &mode) == FAILURE)
+    {
+        printf("❌ Invalid NUMA placement '%s' (use local, interleave or off)\n", text);
+        return FAILURE;
+    }
+    big_set_numa(mode);
+    return SUCCESS;
+}
+
+/**
+ * Parse --shards=N
+ * @param text: the N part (1 to SHARD_MAX_WORKERS)
+ * @param shards: receives N
+ * @return: SUCCESS, or FAILURE after printing an error
+ */
+static int parse_shards(const char *text, int *shards)
+{
+    char *end;
+    long count = strtol(text, &end, 10);
+    if (*end != '\0' || count < 1 || count > SHARD_MAX_WORKERS)
+    {
+        printf("❌ Invalid shard count '%s' (use 1 to %d worker processes)\n", text, SHARD_MAX_WORKERS);
+        return FAILURE;
+    }
+    *shards = (int)count;
+    return SUCCESS;
+}
+
+/**
+ * Store one command line operand in a list
+ * "@path" reads the number from a file, anything else is the number itself
+ * (already checked by is_valid_number)
+ * @param arg: command line argument
+ * @param which: "first" or "second" (for error messages)
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @param sign: receives +1 or -1
+ * @return: SUCCESS, or FAILURE after printing an error
+ */
+static int load_operand(char *arg, const char *which, Dlist **head, Dlist **tail, int *sign)
+{
+    if (arg[0] != '@')
+    {
+        *sign = stored_num(head, tail, arg);
+        if (*head != NULL)
+            return SUCCESS;
+        printf("😟 Please check the %s operand\n", which);
+        print_memory_error("the operand");
+        return FAILURE;
+    }
+
+    size_t bad_offset = 0; // Position of the first invalid byte
+    int status = load_number_file(arg + 1, head, tail, sign, &bad_offset);
+    if (status == MEMORY_ERROR)
+    {
+        printf("😟 Please check the %s operand\n", which);
+        print_memory_error("the operand");
+        return FAILURE;
+    }
+    if (status == FILE_OPEN_ERROR)
+    {
+        printf("😟 Please check the %s operand\n", which);
+        printf("❌ Error: cannot read operand file '%s'\n", arg + 1);
+        return FAILURE;
+    }
+    if (status == FAILURE)
+    {
+        printf("😟 Please check the %s operand\n", which);
+        printf("❌ Error: operand file '%s' is not a valid number (byte %zu)\n", arg + 1, bad_offset);
+        printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * REPORTS
+ * ============================================================================ */
+
+/**
+ * Print --stats and --mem-report and write the --trace file
+ * Called after cleanup, so live nodes and bytes show leaks
+ * @param stats_mode: 0 = none, 1 = text, 2 = JSON
+ * @param mem_report: 1 for --mem-report
+ * @param trace_path: --trace file, or NULL
+ * @return: SUCCESS, or FAILURE if the trace file could not be written
+ */
+static int finish_reports(int stats_mode, int mem_report, const char *trace_path)
+{
+    if (stats_mode != 0)
+    {
+        stats_flush();
+        stats_print(stderr, stats_mode == 2);
+    }
+    if (mem_report)
+    {
+        // Live is measured after cleanup, so anything but 0 is a leak
+        fprintf(stderr, "💾 Memory: peak %zu bytes, live %zu bytes", mem_peak(), mem_live());
+        if (mem_limit() != 0)
+            fprintf(stderr, ", limit %zu bytes\n", mem_limit());
+        else
+            fprintf(stderr, ", no limit\n");
+
+        // Huge-page hit rate of the large buffers and node slabs
+        size_t buffers, resident, huge;
+        big_usage(&buffers, &resident, &huge);
+        if (buffers > 0)
+            fprintf(stderr, "💾 Huge pages: %zu large mappings, %zu of %zu resident bytes in huge pages (%.1f%%)\n",
+                    buffers, huge, resident, resident ? 100.0 * (double)huge / (double)resident : 0.0);
+    }
+    if (trace_path != NULL && trace_finish() == FAILURE)
+    {
+        printf("❌ Error: cannot write trace file '%s'\n", trace_path);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * STREAMING MODE
+ * ============================================================================ */
+
+/**
+ * Run --stream mode: ./a.out --stream @a (+|-) @b --out=FILE, or @a cmp @b
+ * Operands stay on disk; only a few fixed-size buffers are used
+ * @param argc: number of positional arguments (program name included)
+ * @param argv: positional arguments
+ * @param out_path: result file for + and - (from --out=FILE)
+ * @return: process exit code
+ */
+static int run_stream(int argc, char *argv[], const char *out_path)
+{
+    if (argc != 4 || argv[1][0] != '@' || argv[3][0] != '@')
+    {
+        printf("📝 Usage: ./a.out --stream @file1 (+|-) @file2 --out=FILE\n");
+        printf("📝        ./a.out --stream @file1 cmp @file2\n");
+        return 1;
+    }
+
+    int status;
+    if (strcmp(argv[2], "cmp") == 0)
+    {
+        int result = 0;
+        status = stream_compare(argv[1] + 1, argv[3] + 1, &result);
+        if (status == SUCCESS)
+            printf("%d\n", result); // -1, 0 or 1
+    }
+    else if (strcmp(argv[2], "+") == 0 || strcmp(argv[2], "-") == 0)
+    {
+        if (out_path == NULL)
+        {
+            printf("❌ Error: --stream %s needs --out=FILE for the result\n", argv[2]);
+            return 1;
+        }
+        status = stream_add_sub(argv[1] + 1, argv[2][0], argv[3] + 1, out_path);
+        if (status == SUCCESS)
+            printf("💾 Result written to '%s'\n", out_path);
+    }
+    else
+    {
+        printf("❌ Invalid streaming operation: '%s' (use +, - or cmp)\n", argv[2]);
+        return 1;
+    }
+
+    if (status == FILE_OPEN_ERROR)
+    {
+        printf("❌ Error: cannot open an operand or the output file\n");
+        return 1;
+    }
+    if (status == FAILURE)
+    {
+        printf("❌ Error: an operand file is not a valid number (or an I/O error occurred)\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * FUNCTION MODE
+ * ./a.out NAME operand... for operations that do not fit "a op b"
+ * ============================================================================ */
+
+/* ----------------------------------------------------------------------------
+ * shown_value: one signed number shown in the function box
+ * ---------------------------------------------------------------------------- */
+typedef struct shown_value
+{
+    Dlist *head, *tail;
+    int sign;           // +1 or -1
+    size_t point;       // Digits after the decimal point (0 for an integer)
+} shown_value;
+
+/* ----------------------------------------------------------------------------
+ * apc_function: a named operation and its operands
+ * ---------------------------------------------------------------------------- */
+typedef struct apc_function
+{
+    const char *name;       // First positional argument
+    int operands;           // Operands that follow it
+    const char *usage;      // Operand names for the usage line
+} apc_function;
+
+static const apc_function functions[] = {
+    { "powmod", 3, "BASE EXPONENT MODULUS [--ct]" },
+    { "gcd", 2, "A B" },
+    { "xgcd", 2, "A B" },
+    { "isqrt", 1, "N" },
+    { "iroot", 2, "N K" },
+    { "factorial", 1, "N" },
+    { "binomial", 2, "N K" },
+    { "primorial", 1, "N" },
+};
+
+/**
+ * Look up a function by name
+ * @return: its entry, or NULL if name is not a function
+ */
+static const apc_function *find_function(const char *name)
+{
+    for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++)
+    {
+        if (strcmp(functions[i].name, name) == 0)
+            return &functions[i];
+    }
+    return NULL;
+}
+
+/**
+ * Display width of a value (minus sign only for nonzero negatives)
+ */
+static int shown_width(const shown_value *value)
+{
+    if (value->point > 0)
+        return (int)fixed_length(value->head, value->sign, value->point);
+    return get_formatted_width(value->head, 0) + ((value->sign == -1 && !is_zero(value->head)) ? 1 : 0);
+}
+
+/**
+ * Print a value with digit grouping (decimals as "int.frac", ungrouped)
+ */
+static void print_shown(const shown_value *value)
+{
+    if (value->point > 0)
+    {
+        write_fixed(stdout, value->head, value->sign, value->point);
+        return;
+    }
+    if (value->sign == -1 && !is_zero(value->head))
+        printf("-");
+    print_list_formatted(value->head, value->tail);
+}
+
+/**
+ * Print "NAME(operands)" and the result lines in the calculator box
+ * @param name: function name
+ * @param args: operands (NULL to show the name alone)
+ * @param arg_count: number of operands
+ * @param labels: label of each result line, e.g. "🎯 RESULT: "
+ * @param results: result values
+ * @param result_count: number of result lines
+ */
+static void print_function_box(const char *name, const shown_value *args, int arg_count,
+                               const char *const *labels, const shown_value *results, int result_count)
+{
+    // Step 1: Widest line decides the box width
+    int border_prefix = get_string_display_width("║  ");
+    int operation_width = border_prefix + get_string_display_width("📊 OPERATION: ") +
+                          get_string_display_width(name) + ((args != NULL) ? 2 : 0); // "(" and ")"
+    for (int i = 0; i < arg_count; i++)
+        operation_width += shown_width(&args[i]) + ((i > 0) ? 2 : 0); // ", " separators
+    int max_width = operation_width + 2; // +2 for closing "  ║"
+    for (int i = 0; i < result_count; i++)
+    {
+        int line_width = border_prefix + get_string_display_width(labels[i]) + shown_width(&results[i]) + 2;
+        if (line_width > max_width) max_width = line_width;
+    }
+    int header_title_width = get_string_display_width("🧮 APC CALCULATOR 🧮");
+    if (max_width < header_title_width + 4) max_width = header_title_width + 4;
+
+    // Step 2: Title and operation
+    printf("\n");
+    print_border_top(max_width);
+    int header_padding = (max_width - header_title_width) / 2;
+    printf("║%*s🧮 APC CALCULATOR 🧮%*s║\n", header_padding, "",
+           max_width - header_title_width - header_padding, "");
+    print_border_middle(max_width);
+    printf("║  📊 OPERATION: %s", name);
+    if (args != NULL)
+    {
+        printf("(");
+        for (int i = 0; i < arg_count; i++)
+        {
+            if (i > 0)
+                printf(", ");
+            print_shown(&args[i]);
+        }
+        printf(")");
+    }
+    print_padded_line(max_width, operation_width);
+    print_border_middle(max_width);
+
+    // Step 3: One line per result
+    for (int i = 0; i < result_count; i++)
+    {
+        printf("║  %s", labels[i]);
+        print_shown(&results[i]);
+        print_padded_line(max_width, border_prefix + get_string_display_width(labels[i]) + shown_width(&results[i]));
+    }
+    print_border_bottom(max_width);
+    printf("✨ Calculation completed successfully! ✨\n");
+}
+
+/**
+ * Read a small non-negative operand (root degree, factorial argument)
+ * @param max: largest value accepted
+ * @param out: receives the value
+ * @return: SUCCESS, or FAILURE if the value is negative or above max
+ */
+static int list_to_word(const shown_value *value, uint64_t max, uint64_t *out)
+{
+    uint64_t total = 0;
+    if (value->sign == -1)
+        return FAILURE;
+    for (Dlist *node = value->head; node != NULL; node = node->next)
+    {
+        total = total * 10 + (uint64_t)node->data;
+        if (total > max)
+            return FAILURE;
+    }
+    *out = total;
+    return SUCCESS;
+}
+
+/**
+ * Run ./a.out NAME operand...
+ * @param function: entry of the function being run
+ * @param argc: number of positional arguments (program name and NAME included)
+ * @param argv: positional arguments
+ * @param plain_mode: 1 to print only the result digits
+ * @param constant_time: 1 for --ct (constant-time powmod)
+ * @return: process exit code
+ */
+static int run_function(const apc_function *function, int argc, char *argv[],
+                        int plain_mode, int constant_time)
+{
+    static const char *which[] = { "first", "second", "third" };
+    if (argc != function->operands + 2)
+    {
+        printf("❌ Invalid input\n");
+        printf("📝 Usage: ./a.out %s %s\n", function->name, function->usage);
+        return 1;
+    }
+
+    // Step 1: Validate and load the operands
+    shown_value args[3] = { { NULL, NULL, 1, 0 }, { NULL, NULL, 1, 0 }, { NULL, NULL, 1, 0 } };
+    for (int i = 0; i < function->operands; i++)
+    {
+        size_t bad_offset = 0;
+        char *text = argv[i + 2];
+        if (text[0] != '@' && !check_number(text, &bad_offset))
+        {
+            printf("😟 Please check the %s operand\n", which[i]);
+            printf("❌ Error: '%s' is not a valid number (byte %zu)\n", text, bad_offset);
+            printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
+            for (int j = 0; j < i; j++)
+                dl_delete_list(&args[j].head, &args[j].tail);
+            return 1;
+        }
+        args[i].head = args[i].tail = NULL;
+        if (load_operand(text, which[i], &args[i].head, &args[i].tail, &args[i].sign) == FAILURE)
+        {
+            for (int j = 0; j < i; j++)
+                dl_delete_list(&args[j].head, &args[j].tail);
+            return 1;
+        }
+        if (is_zero(args[i].head))
+            args[i].sign = 1; // Never show "-0"
+    }
+
+    // Step 2: Check the domain and compute
+    static const char *const result_labels[] = { "🎯 RESULT: " };
+    static const char *const xgcd_labels[] = { "🎯 GCD: ", "🔢 S: ", "🔢 T: " };
+    static const char *const root_labels[] = { "🎯 ROOT: ", "📐 REMAINDER: " };
+    shown_value results[3] = { { NULL, NULL, 1, 0 }, { NULL, NULL, 1, 0 }, { NULL, NULL, 1, 0 } };
+    const char *const *labels = result_labels;
+    int result_count = 1;
+    const char *error = NULL;   // Domain error, reported below
+    int status = SUCCESS;
+    if (strcmp(function->name, "powmod") == 0)
+    {
+        if (args[1].sign == -1)
+            error = "the exponent must not be negative";
+        else if (is_zero(args[2].head) || args[2].sign == -1)
+            error = "the modulus must be positive";
+        else if (constant_time && (args[2].tail->data & 1) == 0)
+            error = "--ct needs an odd modulus (Montgomery form)";
+        else
+            status = powmod_number(args[0].head, args[0].tail, args[0].sign, args[1].head, args[1].tail,
+                                   args[2].head, args[2].tail, constant_time, &results[0].head, &results[0].tail);
+    }
+    else if (strcmp(function->name, "gcd") == 0)
+    {
+        status = gcd_number(args[0].head, args[0].tail, args[1].head, args[1].tail,
+                            &results[0].head, &results[0].tail);
+    }
+    else if (strcmp(function->name, "xgcd") == 0)
+    {
+        labels = xgcd_labels;
+        result_count = 3; // g, s, t
+        status = xgcd_number(args[0].head, args[0].tail, args[0].sign, args[1].head, args[1].tail, args[1].sign,
+                             &results[0].head, &results[0].tail, &results[1].head, &results[1].tail, &results[1].sign,
+                             &results[2].head, &results[2].tail, &results[2].sign);
+    }
+    else if (strcmp(function->name, "isqrt") == 0 || strcmp(function->name, "iroot") == 0)
+    {
+        uint64_t k = 2;
+        labels = root_labels;
+        result_count = 2; // root, remainder
+        if (function->operands == 2 && (list_to_word(&args[1], UINT32_MAX, &k) == FAILURE || k == 0))
+            error = "K must be between 1 and 4294967295";
+        else if (args[0].sign == -1 && k % 2 == 0)
+            error = "an even root of a negative number is not an integer";
+        else
+            status = root_number(args[0].head, args[0].tail, args[0].sign, (uint32_t)k,
+                                 &results[0].head, &results[0].tail, &results[0].sign,
+                                 &results[1].head, &results[1].tail, &results[1].sign);
+    }
+    else
+    {
+        uint64_t n = 0, k = 0;
+        if (list_to_word(&args[0], FACT_MAX_N, &n) == FAILURE ||
+            (function->operands == 2 && list_to_word(&args[1], FACT_MAX_N, &k) == FAILURE))
+            error = "N and K must be between 0 and 4294967295";
+        else if (strcmp(function->name, "factorial") == 0)
+            status = factorial_number(n, &results[0].head, &results[0].tail);
+        else if (strcmp(function->name, "binomial") == 0)
+            status = binomial_number(n, k, &results[0].head, &results[0].tail);
+        else
+            status = primorial_number(n, &results[0].head, &results[0].tail);
+    }
+
+    // Step 3: Print the result
+    int exit_code = 0;
+    if (error != NULL)
+    {
+        printf("❌ Error: %s\n", error);
+        exit_code = 1;
+    }
+    else if (status == FAILURE)
+    {
+        print_memory_error("the result");
+        exit_code = 1;
+    }
+    else if (plain_mode)
+    {
+        for (int i = 0; i < result_count; i++)
+        {
+            if (i > 0)
+                putchar(' ');
+            write_number(stdout, results[i].head, results[i].sign == -1 && !is_zero(results[i].head), 0);
+        }
+        putchar('\n');
+    }
+    else
+    {
+        print_function_box(function->name, args, function->operands, labels, results, result_count);
+    }
+
+    for (int i = 0; i < function->operands; i++)
+        dl_delete_list(&args[i].head, &args[i].tail);
+    for (int i = 0; i < result_count; i++)
+        dl_delete_list(&results[i].head, &results[i].tail);
+    return exit_code;
+}
+
+/* ============================================================================
+ * REDUCTION MODE
+ * ./a.out sum FILE and ./a.out product FILE fold a whole list of numbers
+ * ============================================================================ */
+
+/**
+ * Run ./a.out (sum|product) FILE, FILE holding whitespace separated numbers
+ * @param argc: number of positional arguments (program name included)
+ * @param argv: positional arguments
+ * @param plain_mode: 1 to print only the result digits
+ * @return: process exit code
+ */
+static int run_reduction(int argc, char *argv[], int plain_mode)
+{
+    if (argc != 3)
+    {
+        printf("❌ Invalid input\n");
+        printf("📝 Usage: ./a.out %s FILE (whitespace separated numbers, - reads stdin)\n", argv[1]);
+        return 1;
+    }
+
+    shown_value result = { NULL, NULL, 1, 0 };
+    size_t count = 0, bad_line = 0;
+    int status = reduce_file(argv[2], (strcmp(argv[1], "sum") == 0) ? '+' : 'x',
+                             &result.head, &result.tail, &result.sign, &count, &bad_line);
+    if (status == FILE_OPEN_ERROR)
+    {
+        printf("❌ Error: cannot read '%s'\n", argv[2]);
+        return 1;
+    }
+    if (status == FAILURE)
+    {
+        printf("❌ Error: line %zu of '%s' is not a list of valid numbers\n", bad_line, argv[2]);
+        printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
+        return 1;
+    }
+    if (status != SUCCESS)
+    {
+        print_memory_error("the result");
+        return 1;
+    }
+
+    if (plain_mode)
+    {
+        write_number(stdout, result.head, result.sign == -1, 0);
+        putchar('\n');
+    }
+    else
+    {
+        static const char *const labels[] = { "🎯 RESULT: " };
+        char name[64];
+        snprintf(name, sizeof(name), "%s of %zu numbers", argv[1], count);
+        print_function_box(name, NULL, 0, labels, &result, 1);
+    }
+    dl_delete_list(&result.head, &result.tail);
+    return 0;
+}
+
+/* ============================================================================
+ * WINDOW MODE
+ * ./a.out a (x|/) b --low=K or --high=K: part of the result and its length
+ * ============================================================================ */
+
+/**
+ * Run a x b or a / b showing only the last (--low) or first (--high) K digits
+ * @param argc: number of positional arguments (program name included)
+ * @param argv: positional arguments
+ * @param side: 'l' for --low, 'h' for --high
+ * @param k: window size in digits
+ * @param plain_mode: 1 to print "window digit-count" only
+ * @return: process exit code
+ */
+static int run_window(int argc, char *argv[], char side, size_t k, int plain_mode)
+{
+    if (argc != 4 || strlen(argv[2]) != 1 ||
+        (argv[2][0] != 'x' && argv[2][0] != 'X' && argv[2][0] != '/'))
+    {
+        printf("❌ Invalid input\n");
+        printf("📝 Usage: ./a.out operand1 (x|/) operand2 --low=K | --high=K\n");
+        return 1;
+    }
+    char op = (argv[2][0] == '/') ? '/' : 'x';
+
+    // Step 1: Operands
+    shown_value args[2] = { { NULL, NULL, 1, 0 }, { NULL, NULL, 1, 0 } };
+    static const char *which[] = { "first", "second" };
+    for (int i = 0; i < 2; i++)
+    {
+        char *text = argv[(i == 0) ? 1 : 3];
+        size_t bad_offset = 0;
+        args[i].head = args[i].tail = NULL;
+        if (text[0] != '@' && !check_number(text, &bad_offset))
+        {
+            printf("😟 Please check the %s operand\n", which[i]);
+            printf("❌ Error: '%s' is not a valid number (byte %zu)\n", text, bad_offset);
+            printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
+            if (i == 1)
+                dl_delete_list(&args[0].head, &args[0].tail);
+            return 1;
+        }
+        if (load_operand(text, which[i], &args[i].head, &args[i].tail, &args[i].sign) == FAILURE)
+        {
+            if (i == 1)
+                dl_delete_list(&args[0].head, &args[0].tail);
+            return 1;
+        }
     }
-    return 1;
+
+    // Step 2: Window
+    int exit_code = 0;
+    shown_value window = { NULL, NULL, 1, 0 };
+    uint64_t digits = 0;
+    if (op == '/' && is_zero(args[1].head))
+    {
+        printf("❌ Error: Division by zero is not allowed\n");
+        exit_code = 1;
+    }
+    else if (window_number(args[0].head, args[0].tail, args[1].head, args[1].tail, op, side, k,
+                           &window.head, &window.tail, &digits) == FAILURE)
+    {
+        print_memory_error("the result");
+        exit_code = 1;
+    }
+
+    // Step 3: Print it (the sign of the whole result, dropped when the window is all zeros)
+    else
+    {
+        int negative = (args[0].sign != args[1].sign) && !is_zero(window.head);
+        if (plain_mode)
+        {
+            if (negative)
+                putchar('-');
+            print_list(window.head);
+            printf(" %llu\n", (unsigned long long)digits);
+        }
+        else
+        {
+            static const char *const labels[] = { "🎯 WINDOW: ", "🔢 DIGITS: " };
+            char name[96], count_text[24];
+            snprintf(name, sizeof(name), "%s, %s %zu digits", (op == 'x') ? "product" : "quotient",
+                     (side == 'l') ? "last" : "first", k);
+            snprintf(count_text, sizeof(count_text), "%llu", (unsigned long long)digits);
+            shown_value results[2] = { { window.head, window.tail, negative ? -1 : 1, 0 }, { NULL, NULL, 1, 0 } };
+            stored_num(&results[1].head, &results[1].tail, count_text);
+            if (results[1].head == NULL)
+                print_memory_error("the result");
+            else
+                print_function_box(name, NULL, 0, labels, results, 2);
+            dl_delete_list(&results[1].head, &results[1].tail);
+        }
+    }
+    dl_delete_list(&window.head, &window.tail);
+    dl_delete_list(&args[0].head, &args[0].tail);
+    dl_delete_list(&args[1].head, &args[1].tail);
+    return exit_code;
+}
+
+/* ============================================================================
+ * RATIONAL MODE
+ * ./a.out p/q op r/s: exact fraction arithmetic, result in lowest terms
+ * ============================================================================ */
+
+/**
+ * Whether an operand is written as a fraction (a slash outside an @path)
+ */
+static int is_fraction(const char *text)
+{
+    return text[0] != '@' && strchr(text, '/') != NULL;
+}
+
+/**
+ * Run p/q op r/s (either operand may be a plain integer or an @path integer)
+ * @param argc: number of positional arguments (program name included)
+ * @param argv: positional arguments
+ * @param plain_mode: 1 to print only "p/q" (or "p" for an integer)
+ * @return: process exit code
+ */
+static int run_rational(int argc, char *argv[], int plain_mode)
+{
+    char op = (strlen(argv[2]) == 1) ? argv[2][0] : 0;
+    if (op == 'X')
+        op = 'x';
+    if (argc != 4 || (op != '+' && op != '-' && op != 'x' && op != '/'))
+    {
+        printf("❌ Invalid input\n");
+        printf("📝 Usage: ./a.out p/q operation(+,-,x,/) r/s\n");
+        return 1;
+    }
+
+    // Step 1: Operands
+    rational operands[2], result;
+    rat_init(&operands[0]);
+    rat_init(&operands[1]);
+    rat_init(&result);
+    static const char *which[] = { "first", "second" };
+    int exit_code = 0;
+    for (int i = 0; i < 2 && exit_code == 0; i++)
+    {
+        char *text = argv[(i == 0) ? 1 : 3];
+        size_t bad_offset = 0;
+        if (text[0] == '@') // Integer operand from a file: p/1
+        {
+            if (load_operand(text, which[i], &operands[i].num_head, &operands[i].num_tail, &operands[i].sign) == FAILURE)
+                exit_code = 1;
+            else if (dl_insert_last(&operands[i].den_head, &operands[i].den_tail, 1) == FAILURE)
+            {
+                print_memory_error("the operand");
+                exit_code = 1;
+            }
+            else
+                operands[i].reduced_length = (size_t)get_list_length(operands[i].num_head) + 1;
+            continue;
+        }
+        int status = rat_parse(&operands[i], text, strlen(text), &bad_offset);
+        if (status == FAILURE)
+        {
+            printf("😟 Please check the %s operand\n", which[i]);
+            printf("❌ Error: '%s' is not a valid fraction (byte %zu)\n", text, bad_offset);
+            printf("💡 Tip: Write p/q with digits (0-9) and optional minus signs (-)\n");
+            exit_code = 1;
+        }
+        else if (status == ZERO_DENOMINATOR)
+        {
+            printf("😟 Please check the %s operand\n", which[i]);
+            printf("❌ Error: '%s' has a zero denominator\n", text);
+            exit_code = 1;
+        }
+        else if (status != SUCCESS)
+        {
+            print_memory_error("the operand");
+            exit_code = 1;
+        }
+    }
+
+    // Step 2: Result, always shown in lowest terms
+    if (exit_code == 0 && op == '/' && is_zero(operands[1].num_head))
+    {
+        printf("❌ Error: Division by zero is not allowed\n");
+        exit_code = 1;
+    }
+    else if (exit_code == 0 && (rat_op(&result, &operands[0], op, &operands[1]) == FAILURE ||
+                                rat_normalize(&result) == FAILURE))
+    {
+        print_memory_error("the result");
+        exit_code = 1;
+    }
+
+    // Step 3: Print it
+    else if (exit_code == 0 && plain_mode)
+    {
+        write_number(stdout, result.num_head, result.sign == -1, 0);
+        if (!(result.den_head->next == NULL && result.den_head->data == 1))
+        {
+            putchar('/');
+            write_number(stdout, result.den_head, 0, 0);
+        }
+        putchar('\n');
+    }
+    else if (exit_code == 0)
+    {
+        static const char *const labels[] = { "🎯 NUMERATOR: ", "📐 DENOMINATOR: " };
+        static const char *const names[] = { "fraction sum", "fraction difference", "fraction product",
+                                             "fraction quotient" };
+        shown_value results[2] = { { result.num_head, result.num_tail, result.sign, 0 },
+                                   { result.den_head, result.den_tail, 1, 0 } };
+        print_function_box(names[(op == '+') ? 0 : (op == '-') ? 1 : (op == 'x') ? 2 : 3],
+                           NULL, 0, labels, results, 2);
+    }
+    rat_free(&result);
+    rat_free(&operands[0]);
+    rat_free(&operands[1]);
+    return exit_code;
+}
+
+/* ============================================================================
+ * FIXED-POINT MODE
+ * ./a.out a op b --scale=N [--round=MODE]: decimals to N places (an operand
+ * written as @path is an integer read from that file)
+ * ============================================================================ */
+
+/**
+ * Run a op b on decimal operands, the result rounded to scale places
+ * @param argc: number of positional arguments (program name included)
+ * @param argv: positional arguments
+ * @param scale: fraction digits of the result
+ * @param mode: rounding of the last place
+ * @param plain_mode: 1 to print only the result
+ * @return: process exit code
+ */
+static int run_fixed(int argc, char *argv[], size_t scale, round_mode mode, int plain_mode)
+{
+    char op = (argc == 4 && strlen(argv[2]) == 1) ? argv[2][0] : 0;
+    if (op == 'X')
+        op = 'x';
+    if (op != '+' && op != '-' && op != 'x' && op != '/')
+    {
+        printf("❌ Invalid input\n");
+        printf("📝 Usage: ./a.out operand1 operation(+,-,x,/) operand2 --scale=N [--round=MODE]\n");
+        return 1;
+    }
+
+    // Step 1: Operands
+    fixed_value operands[2], result;
+    fixed_init(&operands[0]);
+    fixed_init(&operands[1]);
+    fixed_init(&result);
+    static const char *which[] = { "first", "second" };
+    int exit_code = 0;
+    for (int i = 0; i < 2 && exit_code == 0; i++)
+    {
+        char *text = argv[(i == 0) ? 1 : 3];
+        size_t bad_offset = 0;
+        if (text[0] == '@') // Integer operand from a file
+        {
+            if (load_operand(text, which[i], &operands[i].head, &operands[i].tail, &operands[i].sign) == FAILURE)
+                exit_code = 1;
+            continue;
+        }
+        int status = fixed_parse(&operands[i], text, strlen(text), &bad_offset);
+        if (status == FAILURE)
+        {
+            printf("😟 Please check the %s operand\n", which[i]);
+            printf("❌ Error: '%s' is not a valid decimal number (byte %zu)\n", text, bad_offset);
+            printf("💡 Tip: Use digits (0-9), an optional minus sign (-) and one decimal point (.)\n");
+            exit_code = 1;
+        }
+        else if (status != SUCCESS)
+        {
+            print_memory_error("the operand");
+            exit_code = 1;
+        }
+    }
+
+    // Step 2: Result
+    if (exit_code == 0 && op == '/' && is_zero(operands[1].head))
+    {
+        printf("❌ Error: Division by zero is not allowed\n");
+        exit_code = 1;
+    }
+    else if (exit_code == 0 && fixed_op(&result, &operands[0], op, &operands[1], scale, mode) == FAILURE)
+    {
+        print_memory_error("the result");
+        exit_code = 1;
+    }
+
+    // Step 3: Print it
+    else if (exit_code == 0 && plain_mode)
+    {
+        write_fixed(stdout, result.head, result.sign, result.scale);
+        putchar('\n');
+    }
+    else if (exit_code == 0)
+    {
+        static const char *const names[] = { "sum", "difference", "product", "quotient" };
+        shown_value args[2], shown = { result.head, result.tail, result.sign, result.scale };
+        for (int i = 0; i < 2; i++)
+        {
+            shown_value arg = { operands[i].head, operands[i].tail, operands[i].sign, operands[i].scale };
+            args[i] = arg;
+        }
+        char label[96];
+        snprintf(label, sizeof(label), "🎯 RESULT (%zu places, %s): ", scale, round_mode_name(mode));
+        const char *labels[] = { label };
+        print_function_box(names[(op == '+') ? 0 : (op == '-') ? 1 : (op == 'x') ? 2 : 3], args, 2, labels, &shown, 1);
+    }
+    fixed_free(&result);
+    fixed_free(&operands[0]);
+    fixed_free(&operands[1]);
+    return exit_code;
 }
 
 /* ============================================================================
@@ -48,11 +928,272 @@ int is_valid_number(const char *str)
 
 int main(int argc, char *argv[])
 {
+    // Batch mode: ./a.out --batch FILE [--threads=N] [--trace=FILE] [--mem-limit=SIZE] [--numa=MODE]
+    // evaluates one operation per line (no --shards: its workers are threads, which must not fork)
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0)
+    {
+        int threads = 0; // 0 = one worker per online CPU
+        const char *batch_trace = NULL;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strncmp(argv[i], "--threads=", 10) == 0)
+                threads = atoi(argv[i] + 10);
+            else if (strncmp(argv[i], "--trace=", 8) == 0)
+                batch_trace = argv[i] + 8;
+            else if (strncmp(argv[i], "--mem-limit=", 12) == 0)
+            {
+                if (apply_mem_limit(argv[i] + 12) == FAILURE)
+                    return 1;
+            }
+            else if (strncmp(argv[i], "--numa=", 7) == 0)
+            {
+                if (apply_numa(argv[i] + 7) == FAILURE)
+                    return 1;
+            }
+            else
+            {
+                printf("📝 Usage: ./a.out --batch FILE [--threads=N] [--trace=FILE] [--mem-limit=SIZE] [--numa=MODE]\n");
+                return 1;
+            }
+        }
+        if (batch_trace != NULL)
+            trace_start(batch_trace);
+        if (run_batch(argv[2], threads, stdout) == FAILURE)
+        {
+            printf("❌ Error: cannot run batch file '%s'\n", argv[2]);
+            return 1;
+        }
+        if (batch_trace != NULL && trace_finish() == FAILURE)
+        {
+            printf("❌ Error: cannot write trace file '%s'\n", batch_trace);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Options (--name=value) may appear anywhere; everything else is positional
+    char *positional[5] = { argv[0], NULL, NULL, NULL, NULL }; // Program name + up to 4 inputs
+    int positional_count = 1;
+    const char *save_path = NULL;  // --save=FILE: also write the result as a binary .apcn file
+    const char *out_path = NULL;   // --out=FILE: result file for --stream
+    int stream_mode = 0;           // --stream: out-of-core add/sub/compare on @file operands
+    int plain_mode = 0;            // --plain: only the result digits, no box
+    int stats_mode = 0;            // --stats: 1 = text, 2 = JSON summary on stderr
+    const char *trace_path = NULL; // --trace=FILE: Chrome trace JSON of the calculation
+    int mem_report = 0;            // --mem-report: live and peak memory on stderr
+    int constant_time = 0;         // --ct: powmod timing independent of the exponent bits
+    char window_side = 0;          // --low=K / --high=K: 'l' or 'h', 0 for the whole result
+    int verify_mode = 0;           // --verify: check the result by residues
+    size_t window_digits = 0;      // K of --low / --high
+    long long fixed_scale = -1;    // --scale=N: decimal operands, N fraction digits (-1 = integers)
+    const char *round_name = NULL; // --round=MODE: rounding of the last place with --scale
+    int shards = 0;                // --shards=N: worker processes for a large a x b (0 = not given)
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--save=", 7) == 0)
+            save_path = argv[i] + 7;
+        else if (strncmp(argv[i], "--out=", 6) == 0)
+            out_path = argv[i] + 6;
+        else if (strcmp(argv[i], "--stream") == 0)
+            stream_mode = 1;
+        else if (strcmp(argv[i], "--plain") == 0)
+            plain_mode = 1;
+        else if (strcmp(argv[i], "--stats") == 0)
+            stats_mode = 1;
+        else if (strcmp(argv[i], "--stats=json") == 0)
+            stats_mode = 2;
+        else if (strncmp(argv[i], "--trace=", 8) == 0)
+            trace_path = argv[i] + 8;
+        else if (strncmp(argv[i], "--mem-limit=", 12) == 0)
+        {
+            if (apply_mem_limit(argv[i] + 12) == FAILURE)
+                return 1;
+        }
+        else if (strcmp(argv[i], "--mem-report") == 0)
+        {
+            mem_report = 1;
+            big_track(1); // Measure each large buffer's huge pages as it is freed
+        }
+        else if (strncmp(argv[i], "--numa=", 7) == 0)
+        {
+            if (apply_numa(argv[i] + 7) == FAILURE)
+                return 1;
+        }
+        else if (strncmp(argv[i], "--shards=", 9) == 0)
+        {
+            if (parse_shards(argv[i] + 9, &shards) == FAILURE)
+                return 1;
+        }
+        else if (strcmp(argv[i], "--ct") == 0)
+            constant_time = 1;
+        else if (strcmp(argv[i], "--verify") == 0)
+            verify_mode = 1;
+        else if (strncmp(argv[i], "--low=", 6) == 0 || strncmp(argv[i], "--high=", 7) == 0)
+        {
+            // --low=K: last K digits, --high=K: first K digits (plus the digit count)
+            const char *text = strchr(argv[i], '=') + 1;
+            char *end;
+            unsigned long long k = strtoull(text, &end, 10);
+            if (text[0] < '1' || text[0] > '9' || *end != '\0' || k > 1000000000ULL)
+            {
+                printf("❌ Invalid window size '%s' (use 1 to 1000000000 digits)\n", text);
+                return 1;
+            }
+            window_side = argv[i][2];
+            window_digits = (size_t)k;
+        }
+        else if (strncmp(argv[i], "--scale=", 8) == 0)
+        {
+            const char *text = argv[i] + 8;
+            char *end;
+            unsigned long long n = strtoull(text, &end, 10);
+            if (text[0] < '0' || text[0] > '9' || *end != '\0' || n > 1000000000ULL)
+            {
+                printf("❌ Invalid scale '%s' (use 0 to 1000000000 places)\n", text);
+                return 1;
+            }
+            fixed_scale = (long long)n;
+        }
+        else if (strncmp(argv[i], "--round=", 8) == 0)
+            round_name = argv[i] + 8;
+        else if (strncmp(argv[i], "--print=", 8) == 0)
+        {
+            // --print=FILE: show a saved binary number straight from its limbs
+            mapped_number saved;
+            int status = map_number(argv[i] + 8, &saved);
+            if (status != SUCCESS)
+            {
+                printf("❌ Error: '%s' is not a readable binary number file\n", argv[i] + 8);
+                return 1;
+            }
+            print_mapped_number(&saved, stdout);
+            unmap_number(&saved);
+            return 0;
+        }
+        else if (strncmp(argv[i], "--", 2) == 0)
+        {
+            printf("❌ Unknown option '%s'\n", argv[i]);
+            return 1;
+        }
+        else if (positional_count < 5)
+            positional[positional_count++] = argv[i];
+        else
+            positional_count++; // Too many inputs (reported below)
+    }
+    argc = positional_count;
+    argv = positional;
+    int given = (save_path != NULL ? OPTION_SAVE : 0) | (verify_mode ? OPTION_VERIFY : 0) |
+                (constant_time ? OPTION_CT : 0) | (out_path != NULL ? OPTION_OUT : 0) |
+                (window_side != 0 ? OPTION_WINDOW : 0) | (shards != 0 ? OPTION_SHARDS : 0) |
+                (fixed_scale >= 0 || round_name != NULL ? OPTION_SCALE : 0);
+
+    if (stream_mode)
+    {
+        if (check_options(given, OPTION_OUT, "--stream") == FAILURE)
+            return 1;
+        return run_stream(argc, argv, out_path);
+    }
+    if (window_side != 0)
+    {
+        if (check_options(given, OPTION_WINDOW, "--low/--high") == FAILURE)
+            return 1;
+        if (trace_path != NULL)
+            trace_start(trace_path);
+        STATS_PHASE_BEGIN(window_start);
+        int exit_code = run_window(argc, argv, window_side, window_digits, plain_mode);
+        STATS_PHASE_END(PHASE_COMPUTE, window_start);
+        if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+            exit_code = 1;
+        return exit_code;
+    }
+    if (fixed_scale >= 0 || round_name != NULL)
+    {
+        if (check_options(given, OPTION_SCALE, "--scale") == FAILURE)
+            return 1;
+        round_mode mode = ROUND_DOWN;
+        if (fixed_scale < 0)
+        {
+            printf("❌ --round=MODE needs --scale=N (the number of decimal places)\n");
+            return 1;
+        }
+        if (round_name != NULL && parse_round_mode(round_name, &mode) == FAILURE)
+        {
+            printf("❌ Invalid rounding '%s'\n", round_name);
+            printf("💡 Use down, up, floor, ceiling, half-up, half-down or half-even\n");
+            return 1;
+        }
+        if (trace_path != NULL)
+            trace_start(trace_path);
+        STATS_PHASE_BEGIN(fixed_start);
+        int exit_code = run_fixed(argc, argv, (size_t)fixed_scale, mode, plain_mode);
+        STATS_PHASE_END(PHASE_COMPUTE, fixed_start);
+        if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+            exit_code = 1;
+        return exit_code;
+    }
+    if (argc >= 2 && (strcmp(argv[1], "sum") == 0 || strcmp(argv[1], "product") == 0))
+    {
+        if (check_options(given, 0, argv[1]) == FAILURE)
+            return 1;
+        if (trace_path != NULL)
+            trace_start(trace_path);
+        STATS_PHASE_BEGIN(reduce_start);
+        int exit_code = run_reduction(argc, argv, plain_mode);
+        STATS_PHASE_END(PHASE_COMPUTE, reduce_start);
+        if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+            exit_code = 1;
+        return exit_code;
+    }
+    if (argc == 4 && (is_fraction(argv[1]) || is_fraction(argv[3])))
+    {
+        if (check_options(given, 0, "fractions") == FAILURE)
+            return 1;
+        if (trace_path != NULL)
+            trace_start(trace_path);
+        STATS_PHASE_BEGIN(rational_start);
+        int exit_code = run_rational(argc, argv, plain_mode);
+        STATS_PHASE_END(PHASE_COMPUTE, rational_start);
+        if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+            exit_code = 1;
+        return exit_code;
+    }
+    const apc_function *function = (argc >= 2) ? find_function(argv[1]) : NULL;
+    if (function != NULL)
+    {
+        if (check_options(given, (strcmp(function->name, "powmod") == 0) ? OPTION_CT : 0, function->name) == FAILURE)
+            return 1;
+        if (trace_path != NULL)
+            trace_start(trace_path);
+        STATS_PHASE_BEGIN(function_start);
+        int exit_code = run_function(function, argc, argv, plain_mode, constant_time);
+        STATS_PHASE_END(PHASE_COMPUTE, function_start);
+        if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+            exit_code = 1;
+        return exit_code;
+    }
+
+    // Only a x b shards; + - / would ignore --shards
+    int is_product = (argc == 4) && (strcmp(argv[2], "x") == 0 || strcmp(argv[2], "X") == 0);
+    if (check_options(given, OPTION_SAVE | OPTION_VERIFY | (is_product ? OPTION_SHARDS : 0),
+                      (argc == 4) ? argv[2] : "integer + - x /") == FAILURE)
+        return 1;
+
     // Step 1: Validate command line arguments - must have exactly 4 arguments (program name + 3 inputs)
     if (argc != 4)
     {
         printf("❌ Invalid input\n");
         printf("📝 Usage: ./a.out operand1 operation(+,-,x,/) operand2\n");
+        printf("💡 An operand written as @path is read from that file\n");
+        printf("💡 Options: --save=FILE stores the result in binary form, --print=FILE shows it\n");
+        printf("💡 --plain prints only the result digits (quotient and remainder for /)\n");
+        printf("💡 --verify checks the result by residues mod 9, 11 and random 62-bit primes\n");
+        printf("💡 --low=K / --high=K show only the last / first K digits of x and / (and the digit count)\n");
+        printf("💡 Huge files: --stream @a (+|-|cmp) @b [--out=FILE] works without loading them\n");
+        printf("💡 Functions: ./a.out powmod BASE EXPONENT MODULUS [--ct], gcd A B, xgcd A B,\n");
+        printf("   isqrt N, iroot N K, factorial N, binomial N K, primorial N\n");
+        printf("💡 Reductions: ./a.out sum FILE, ./a.out product FILE (- reads stdin)\n");
+        printf("💡 Fractions: ./a.out p/q operation r/s gives the exact result in lowest terms\n");
+        printf("💡 Decimals: --scale=N takes operands like 3.14 and gives N places (--round=half-even, ...)\n");
         printf("💡 Example: ./a.out 123 + 456\n");
         return 1; // Exit with error code
     }
@@ -75,17 +1216,19 @@ int main(int argc, char *argv[])
         operator = 'x';
 
     // Step 2: Validate that operands are valid numbers (only digits, optional minus sign)
-    if (!is_valid_number(operand1_string))
+    // Operands written as @path are validated while they are loaded in Step 4
+    size_t bad_offset = 0; // Position of the first invalid byte
+    if (operand1_string[0] != '@' && !check_number(operand1_string, &bad_offset))
     {
         printf("😟 Please check the first operand\n");
-        printf("❌ Error: First operand '%s' is not a valid number\n", operand1_string);
+        printf("❌ Error: First operand '%s' is not a valid number (byte %zu)\n", operand1_string, bad_offset);
         printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
         return 1; // Exit if first operand is invalid
     }
-    if (!is_valid_number(operand2_string))
+    if (operand2_string[0] != '@' && !check_number(operand2_string, &bad_offset))
     {
         printf("😟 Please check the second operand\n");
-        printf("❌ Error: Second operand '%s' is not a valid number\n", operand2_string);
+        printf("❌ Error: Second operand '%s' is not a valid number (byte %zu)\n", operand2_string, bad_offset);
         printf("💡 Tip: Use only digits (0-9) and optional minus sign (-)\n");
         return 1; // Exit if second operand is invalid
     }
@@ -105,103 +1248,130 @@ int main(int argc, char *argv[])
     Dlist *head3 = NULL, *tail3 = NULL; // Will store calculation result
 
     // Parse input strings into double linked lists (convert string to linked list)
-    int sign1 = stored_num(&head1, &tail1, operand1_string);  // Get sign: +1 for positive, -1 for negative
-    int sign2 = stored_num(&head2, &tail2, operand2_string);   // Get sign: +1 for positive, -1 for negative
+    int sign1 = 1, sign2 = 1;  // Sign of each operand: +1 for positive, -1 for negative
+    if (trace_path != NULL)
+        trace_start(trace_path);
+    STATS_PHASE_BEGIN(parse_start);
+    TRACE_BEGIN("parse", NULL, 0);
+    if (load_operand(operand1_string, "first", &head1, &tail1, &sign1) == FAILURE)
+        return 1; // Exit if first operand file is unreadable or invalid
+    if (load_operand(operand2_string, "second", &head2, &tail2, &sign2) == FAILURE)
+    {
+        dl_delete_list(&head1, &tail1);
+        return 1; // Exit if second operand file is unreadable or invalid
+    }
+    TRACE_END();
+    STATS_PHASE_END(PHASE_PARSE, parse_start);
     int result_sign = 1;  // Result sign will be calculated based on operation and input signs
 
-    // Calculate widths for dynamic borders - use actual string widths
-    // Note: get_formatted_width includes minus sign, but we print minus separately, so subtract it
-    int width1 = get_formatted_width(head1, 0) + ((sign1 == -1) ? 1 : 0); // Width without minus, then add if needed
-    int width2 = get_formatted_width(head2, 0) + ((sign2 == -1) ? 1 : 0); // Width without minus, then add if needed
-    int operator_width = get_string_display_width(" ➕ "); // Width of operator emoji with spaces
-    int border_prefix = get_string_display_width("║  "); // Width of border prefix
-    int operation_label_text = get_string_display_width("📊 OPERATION: "); // Width of label text only
-    int operation_label = border_prefix + operation_label_text; // Total label width with border
-    int operation_total = operation_label + width1 + operator_width + width2 + 2; // +2 for closing "  ║"
+    // Box layout (skipped entirely by --plain)
+    int max_width = 0;          // Content width of the box
+    int border_prefix = 0;      // Width of "║  "
+    int result_start_width = 0; // Width from start of result line
+    STATS_PHASE_BEGIN(header_start);
+    if (!plain_mode)
+    {
+        // Calculate widths for dynamic borders - use actual string widths
+        // Note: get_formatted_width includes minus sign, but we print minus separately, so subtract it
+        int width1 = get_formatted_width(head1, 0) + ((sign1 == -1) ? 1 : 0); // Width without minus, then add if needed
+        int width2 = get_formatted_width(head2, 0) + ((sign2 == -1) ? 1 : 0); // Width without minus, then add if needed
+        int operator_width = get_string_display_width(" ➕ "); // Width of operator emoji with spaces
+        border_prefix = get_string_display_width("║  "); // Width of border prefix
+        int operation_label_text = get_string_display_width("📊 OPERATION: "); // Width of label text only
+        int operation_label = border_prefix + operation_label_text; // Total label width with border
+        int operation_total = operation_label + width1 + operator_width + width2 + 2; // +2 for closing "  ║"
     
-    // Calculate result width (will be updated after calculation)
-    int result_label_text = get_string_display_width("🎯 RESULT: "); // Width of label text only
-    int result_label = border_prefix + result_label_text; // Total label width with border
-    int max_width = operation_total; // Start with operation width
+        // Calculate result width (will be updated after calculation)
+        int result_label_text = get_string_display_width("🎯 RESULT: "); // Width of label text only
+        int result_label = border_prefix + result_label_text; // Total label width with border
+        max_width = operation_total; // Start with operation width
 
-    // Display the operation being performed (for better user experience)
-    printf("\n");
-    // Print header with dynamic width (calculator title)
-    // Use max_width but ensure minimum width for title
-    int header_title_width = get_string_display_width("🧮 APC CALCULATOR 🧮");
-    int header_min_width = header_title_width + 4; // Minimum width for title with padding
-    if (max_width < header_min_width) max_width = header_min_width; // Update max_width if needed
+        // Display the operation being performed (for better user experience)
+        printf("\n");
+        // Print header with dynamic width (calculator title)
+        // Use max_width but ensure minimum width for title
+        int header_title_width = get_string_display_width("🧮 APC CALCULATOR 🧮");
+        int header_min_width = header_title_width + 4; // Minimum width for title with padding
+        if (max_width < header_min_width) max_width = header_min_width; // Update max_width if needed
     
-    print_border_top(max_width);
-    printf("║");
-    int header_padding = (max_width - header_title_width) / 2; // Center the title
-    for (int i = 0; i < header_padding; i++) printf(" ");
-    printf("🧮 APC CALCULATOR 🧮");
-    int header_right_padding = max_width - header_title_width - header_padding;
-    for (int i = 0; i < header_right_padding; i++) printf(" ");
-    printf("║\n");
-    print_border_middle(max_width);
+        print_border_top(max_width);
+        printf("║");
+        int header_padding = (max_width - header_title_width) / 2; // Center the title
+        int header_right_padding = max_width - header_title_width - header_padding;
+        printf("%*s🧮 APC CALCULATOR 🧮%*s║\n", header_padding, "", header_right_padding, "");
+        print_border_middle(max_width);
     
-    // Print operation line with dynamic width
-    printf("║  📊 OPERATION: ");
-    int current_width = operation_label; // Start with label width
-    if (sign1 == -1)
-    {
-        printf("-"); // Print minus sign if first number is negative
-        current_width += 1;
-    }
-    print_list_formatted(head1, tail1); // Print first number with formatting
-    current_width += width1;
+        // Print operation line with dynamic width
+        printf("║  📊 OPERATION: ");
+        int current_width = operation_label; // Start with label width
+        if (sign1 == -1)
+        {
+            printf("-"); // Print minus sign if first number is negative
+            current_width += 1;
+        }
+        print_list_formatted(head1, tail1); // Print first number with formatting
+        current_width += width1;
     
-    // Add emoji for operator
-    if (operator == '+')
-    {
-        printf(" ➕ ");
-        current_width += operator_width;
-    }
-    else if (operator == '-')
-    {
-        printf(" ➖ ");
-        current_width += operator_width;
-    }
-    else if (operator == 'x')
-    {
-        printf(" ✖️ ");
-        current_width += operator_width;
-    }
-    else if (operator == '/')
-    {
-        printf(" ➗ ");
-        current_width += operator_width;
-    }
-    else
-    {
-        printf(" %c ", operator);
-        current_width += 3; // " %c " is 3 chars
-    }
+        // Add emoji for operator
+        if (operator == '+')
+        {
+            printf(" ➕ ");
+            current_width += operator_width;
+        }
+        else if (operator == '-')
+        {
+            printf(" ➖ ");
+            current_width += operator_width;
+        }
+        else if (operator == 'x')
+        {
+            printf(" ✖️ ");
+            current_width += operator_width;
+        }
+        else if (operator == '/')
+        {
+            printf(" ➗ ");
+            current_width += operator_width;
+        }
+        else
+        {
+            printf(" %c ", operator);
+            current_width += 3; // " %c " is 3 chars
+        }
     
-    if (sign2 == -1)
-    {
-        printf("-"); // Print minus sign if second number is negative
-        current_width += 1;
-    }
-    print_list_formatted(head2, tail2); // Print second number with formatting
-    current_width += width2;
+        if (sign2 == -1)
+        {
+            printf("-"); // Print minus sign if second number is negative
+            current_width += 1;
+        }
+        print_list_formatted(head2, tail2); // Print second number with formatting
+        current_width += width2;
     
-    // Print padding and closing border
-    print_padded_line(max_width, current_width);
-    print_border_middle(max_width);
-    printf("║  🎯 RESULT: ");
-    int result_start_width = result_label; // Track width from start of result line
+        // Print padding and closing border
+        print_padded_line(max_width, current_width);
+        print_border_middle(max_width);
+        printf("║  🎯 RESULT: ");
+        result_start_width = result_label; // Track width from start of result line
+    }
+    STATS_PHASE_END(PHASE_FORMAT, header_start);
+
+    // Residues of the operands, before the operation may reuse their lists
+    verify_check check;
+    int verify_status = SUCCESS;    // FAILURE if --verify found a mismatch
+    uint64_t bad_modulus = 0;       // Modulus that disagreed (0: remainder too large)
+    if (verify_mode)
+        verify_begin(&check, head1, sign1, head2, sign2);
 
     // Step 5: Perform the requested operation based on operator
+    int op_status = SUCCESS; // FAILURE if the result did not fit in memory
+    STATS_PHASE_BEGIN(compute_start);
     switch (operator)
     {
         case '+':  // Addition operation
             if (sign1 == sign2) // Both numbers have same sign (both positive or both negative)
             {
                 // Both positive or both negative: add magnitudes and keep the sign
-                add_number(&head1, &tail1, &head2, &tail2, &head3, &tail3); // Perform addition
+                op_status = add_number(&head1, &tail1, &head2, &tail2, &head3, &tail3); // Perform addition
                 result_sign = sign1;  // Result has same sign as inputs
             }
             else // Numbers have different signs
@@ -209,6 +1379,8 @@ int main(int argc, char *argv[])
                 // Different signs: subtract smaller from larger (like 5 + (-3) = 5 - 3)
                 int is_negative = sub_number(&head1, &tail1, &head2, &tail2, &head3, &tail3,
                                             operand1_string, operand2_string);
+                if (is_negative == FAILURE)
+                    op_status = FAILURE;
                 // Determine result sign based on which number was larger
                 result_sign = (sign1 == 1) ? (is_negative ? -1 : 1)
                                           : (is_negative ? 1 : -1);
@@ -219,7 +1391,7 @@ int main(int argc, char *argv[])
             if (sign1 != sign2) // Numbers have different signs
             {
                 // Different signs: add magnitudes (like 5 - (-3) = 5 + 3)
-                add_number(&head1, &tail1, &head2, &tail2, &head3, &tail3); // Perform addition
+                op_status = add_number(&head1, &tail1, &head2, &tail2, &head3, &tail3); // Perform addition
                 result_sign = sign1;  // Result has sign of first number
             }
             else // Numbers have same sign
@@ -227,6 +1399,8 @@ int main(int argc, char *argv[])
                 // Same signs: subtract smaller from larger (like 5 - 3 or -5 - (-3))
                 int is_negative = sub_number(&head1, &tail1, &head2, &tail2, &head3, &tail3,
                                             operand1_string, operand2_string);
+                if (is_negative == FAILURE)
+                    op_status = FAILURE;
                 // Determine result sign based on which number is larger
                 result_sign = (sign1 == 1) ? (is_negative ? -1 : 1)
                                           : (is_negative ? 1 : -1);
@@ -235,7 +1409,8 @@ int main(int argc, char *argv[])
 
         case 'x':  // Multiplication operation
         case 'X':  // Also handle uppercase X
-            mul_number(&head1, &tail1, &head2, &tail2, &head3, &tail3); // Perform multiplication
+            // Perform multiplication (--shards: this path runs no other thread, so it may fork)
+            op_status = mul_number_sharded(&head1, &tail1, &head2, &tail2, &head3, &tail3, (shards > 0) ? shards : 1);
             // Result sign: positive if signs same, negative if signs different
             result_sign = (sign1 == sign2) ? 1 : -1;
             break;
@@ -243,10 +1418,21 @@ int main(int argc, char *argv[])
         case '/':  // Division operation
             {
                 Dlist *remainder_head = NULL, *remainder_tail = NULL; // Create containers for remainder
-                if (div_number(&head1, &tail1, &head2, &tail2, &head3, &tail3,
-                              &remainder_head, &remainder_tail, operator) == FAILURE)
+                int is_division_by_zero = is_zero(head2);
+                if (is_division_by_zero ||
+                    div_number(&head1, &tail1, &head2, &tail2, &head3, &tail3,
+                               &remainder_head, &remainder_tail, operator) == FAILURE)
                 {
-                    // Division by zero or other error: clean up all memory and exit
+                    // Division by zero or out of memory: report it, clean up all memory and exit
+                    if (!plain_mode)
+                        printf("\n");
+                    if (is_division_by_zero)
+                    {
+                        printf("❌ Division by zero error!\n");
+                        printf("⚠️ Cannot divide by zero. Please use a non-zero divisor.\n");
+                    }
+                    else
+                        print_memory_error("the quotient and remainder");
                     dl_delete_list(&head1, &tail1);
                     dl_delete_list(&head2, &tail2);
                     dl_delete_list(&head3, &tail3);
@@ -255,46 +1441,65 @@ int main(int argc, char *argv[])
                 }
                 // Result sign: positive if signs same, negative if signs different
                 result_sign = (sign1 == sign2) ? 1 : -1;
+                if (verify_mode)
+                    verify_status = verify_result(&check, '/', head3, result_sign, remainder_head, sign1,
+                                                  head2, &bad_modulus);
+                STATS_PHASE_END(PHASE_COMPUTE, compute_start);
+                STATS_PHASE_BEGIN(division_format_start);
+                TRACE_BEGIN("format", NULL, 0);
                 
-                // Calculate widths for division output
-                // Note: get_formatted_width includes minus sign, but we print minus separately
-                int quotient_has_minus = (result_sign == -1 && !is_zero(head3));
-                int quotient_width = get_formatted_width(head3, 0) + (quotient_has_minus ? 1 : 0);
-                int remainder_has_minus = (sign1 == -1 && !is_zero(remainder_head));
-                int remainder_width = get_formatted_width(remainder_head, 0) + (remainder_has_minus ? 1 : 0);
-                int remainder_label_text = get_string_display_width("📃 REMAINDER: "); // Width of label text only
-                int remainder_label = border_prefix + remainder_label_text; // Total label width with border
-                int quotient_line_width = result_start_width + quotient_width + 2; // +2 for closing "  ║"
-                int remainder_line_width = remainder_label + remainder_width + 2; // +2 for closing "  ║"
-                int division_max_width = (quotient_line_width > remainder_line_width) ? quotient_line_width : remainder_line_width;
-                if (division_max_width > max_width) max_width = division_max_width;
-                
-                // Print quotient with better formatting
-                int quotient_current_width = result_start_width;
-                // Check if result is zero (don't print negative sign for zero)
-                if (quotient_has_minus)
+                if (plain_mode)
                 {
-                    printf("-"); // Print minus only if result is negative and not zero
-                    quotient_current_width += 1;
+                    // "quotient remainder", as in batch mode
+                    write_number(stdout, head3, result_sign == -1, 0);
+                    putchar(' ');
+                    write_number(stdout, remainder_head, sign1 == -1, 0);
+                    putchar('\n');
                 }
-                print_list_formatted(head3, tail3); // Print quotient with formatting
-                quotient_current_width += get_formatted_width(head3, 0); // Add number width without minus
-                print_padded_line(max_width, quotient_current_width);
-                
-                // Print remainder
-                printf("║  📃 REMAINDER: ");
-                int remainder_current_width = remainder_label;
-                // Remainder has same sign as dividend, but don't print negative for zero
-                if (sign1 == -1 && !is_zero(remainder_head))
+                else
                 {
-                    printf("-"); // Print minus only if remainder is negative and not zero
-                    remainder_current_width += 1;
-                }
-                print_list_formatted(remainder_head, remainder_tail); // Print remainder with formatting
-                remainder_current_width += remainder_width;
-                print_padded_line(max_width, remainder_current_width);
-                print_border_bottom(max_width);
+                    // Calculate widths for division output
+                    // Note: get_formatted_width includes minus sign, but we print minus separately
+                    int quotient_has_minus = (result_sign == -1 && !is_zero(head3));
+                    int quotient_width = get_formatted_width(head3, 0) + (quotient_has_minus ? 1 : 0);
+                    int remainder_has_minus = (sign1 == -1 && !is_zero(remainder_head));
+                    int remainder_width = get_formatted_width(remainder_head, 0) + (remainder_has_minus ? 1 : 0);
+                    int remainder_label_text = get_string_display_width("📃 REMAINDER: "); // Width of label text only
+                    int remainder_label = border_prefix + remainder_label_text; // Total label width with border
+                    int quotient_line_width = result_start_width + quotient_width + 2; // +2 for closing "  ║"
+                    int remainder_line_width = remainder_label + remainder_width + 2; // +2 for closing "  ║"
+                    int division_max_width = (quotient_line_width > remainder_line_width) ? quotient_line_width : remainder_line_width;
+                    if (division_max_width > max_width) max_width = division_max_width;
                 
+                    // Print quotient with better formatting
+                    int quotient_current_width = result_start_width;
+                    // Check if result is zero (don't print negative sign for zero)
+                    if (quotient_has_minus)
+                    {
+                        printf("-"); // Print minus only if result is negative and not zero
+                        quotient_current_width += 1;
+                    }
+                    print_list_formatted(head3, tail3); // Print quotient with formatting
+                    quotient_current_width += get_formatted_width(head3, 0); // Add number width without minus
+                    print_padded_line(max_width, quotient_current_width);
+                
+                    // Print remainder
+                    printf("║  📃 REMAINDER: ");
+                    int remainder_current_width = remainder_label;
+                    // Remainder has same sign as dividend, but don't print negative for zero
+                    if (sign1 == -1 && !is_zero(remainder_head))
+                    {
+                        printf("-"); // Print minus only if remainder is negative and not zero
+                        remainder_current_width += 1;
+                    }
+                    print_list_formatted(remainder_head, remainder_tail); // Print remainder with formatting
+                    remainder_current_width += remainder_width;
+                    print_padded_line(max_width, remainder_current_width);
+                    print_border_bottom(max_width);
+
+                }                
+                TRACE_END();
+                STATS_PHASE_END(PHASE_FORMAT, division_format_start);
                 dl_delete_list(&remainder_head, &remainder_tail); // Free remainder memory
                 // Skip the normal print since we already printed above
                 operator = ' ';  // Mark that we've already printed (to skip Step 6)
@@ -311,8 +1516,30 @@ int main(int argc, char *argv[])
             return 1;
     }
 
+    if (operator != ' ')
+        STATS_PHASE_END(PHASE_COMPUTE, compute_start); // Division stopped its clock above
+    if (op_status == FAILURE)
+    {
+        if (!plain_mode)
+            printf("\n"); // Close the half printed result line
+        print_memory_error("the result");
+        dl_delete_list(&head1, &tail1);
+        dl_delete_list(&head2, &tail2);
+        dl_delete_list(&head3, &tail3);
+        return 1;
+    }
+    if (verify_mode && operator != ' ')
+        verify_status = verify_result(&check, operator, head3, result_sign, NULL, 1, NULL, &bad_modulus);
+
     // Step 6: Print the result (unless division already printed)
-    if (operator != ' ') // Division already printed, skip this step
+    STATS_PHASE_BEGIN(format_start);
+    TRACE_BEGIN("format", NULL, 0);
+    if (operator != ' ' && plain_mode)
+    {
+        write_number(stdout, head3, result_sign == -1, 0); // Digits only, one write
+        putchar('\n');
+    }
+    else if (operator != ' ') // Division already printed, skip this step
     {
         // Calculate result width and update max_width if needed
         int result_width = get_formatted_width(head3, (result_sign == -1 && !is_zero(head3)));
@@ -337,10 +1564,47 @@ int main(int argc, char *argv[])
         print_border_bottom(max_width);
         printf("✨ Calculation completed successfully! ✨\n");
     }
+    fflush(stdout); // Count the output itself, not just the buffering
+    TRACE_END();
+    STATS_PHASE_END(PHASE_FORMAT, format_start);
+    int exit_code = 0;
+
+    // Report --verify (a mismatch goes to stderr whatever the output mode)
+    if (verify_mode && verify_status == FAILURE)
+    {
+        if (bad_modulus == 0)
+            fprintf(stderr, "🚨 VERIFICATION FAILED: the remainder is not smaller than the divisor\n");
+        else
+            fprintf(stderr, "🚨 VERIFICATION FAILED: the result is wrong modulo %llu\n",
+                    (unsigned long long)bad_modulus);
+        exit_code = 2;
+    }
+    else if (verify_mode && !plain_mode)
+        printf("✅ Verified: residues mod 9, 11 and three random 62-bit primes agree\n");
+
+    // Save the result (the quotient for division) in binary form if requested
+    if (save_path != NULL)
+    {
+        if (save_number(save_path, head3, tail3, result_sign) == SUCCESS)
+        {
+            if (!plain_mode)
+                printf("💾 Result saved to '%s'\n", save_path);
+        }
+        else
+        {
+            printf("❌ Error: cannot save result to '%s'\n", save_path);
+            exit_code = 1;
+        }
+    }
+
     // Step 7: Clean up all allocated memory to prevent memory leaks
     dl_delete_list(&head1, &tail1); // Free first number
     dl_delete_list(&head2, &tail2); // Free second number
     dl_delete_list(&head3, &tail3);  // Free result
 
-    return 0; // Exit successfully
+    // Step 8: Report the counters (after cleanup, so live nodes show leaks)
+    if (finish_reports(stats_mode, mem_report, trace_path) == FAILURE)
+        exit_code = 1;
+
+    return exit_code; // 0 = success
 }
@@ -0,0 +1,137 @@
+#include "apc.h"
+
+/* ============================================================================
+ * MEMORY BUDGET
+ * Process-wide accounting of digit nodes and arithmetic buffers, with an
+ * optional ceiling (--mem-limit=SIZE, APC_MEM_LIMIT, apc_set_mem_limit).
+ *
+ * Every dl_insert_* charges MEM_NODE_BYTES and every node free returns them;
+ * the limb tiers charge their temporary arrays while they hold them. A charge
+ * that would pass the limit fails like malloc would, and the operations also
+ * compare an up-front estimate of their needs (mem_check) before starting,
+ * so a job that cannot fit stops at once instead of after minutes of work.
+ *
+ * The counters are relaxed atomics: exact under any number of threads, and
+ * no lock on the node allocation path.
+ * ============================================================================ */
+
+static size_t mem_live_bytes;   // Bytes charged and not yet released
+static size_t mem_peak_bytes;   // Highest mem_live_bytes seen
+static size_t mem_limit_bytes;  // 0 = unlimited
+static int mem_limit_loaded;    // Set once APC_MEM_LIMIT has been read
+
+/**
+ * Parse a size with an optional K, M or G suffix (powers of 1024)
+ * @param text: e.g. "4096", "512M", "2G"
+ * @param bytes: receives the size in bytes
+ * @return: SUCCESS, or FAILURE if the text is not a size
+ */
+int parse_size(const char *text, size_t *bytes)
+{
+    char *end;
+    if (text == NULL || *text < '0' || *text > '9')
+        return FAILURE;
+    unsigned long long value = strtoull(text, &end, 10);
+    unsigned shift = 0;
+    switch (*end)
+    {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || value > (SIZE_MAX >> shift))
+        return FAILURE;
+    *bytes = (size_t)(value << shift);
+    return SUCCESS;
+}
+
+/**
+ * Current limit, read from APC_MEM_LIMIT on first use
+ * @return: limit in bytes, 0 if unlimited
+ */
+size_t mem_limit(void)
+{
+    if (!__atomic_load_n(&mem_limit_loaded, __ATOMIC_ACQUIRE))
+    {
+        size_t bytes = 0;
+        if (parse_size(getenv("APC_MEM_LIMIT"), &bytes) == FAILURE)
+            bytes = 0; // Unset or malformed: unlimited
+        size_t unset = 0; // Keep a limit set meanwhile by mem_set_limit
+        __atomic_compare_exchange_n(&mem_limit_bytes, &unset, bytes, 0,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        __atomic_store_n(&mem_limit_loaded, 1, __ATOMIC_RELEASE);
+    }
+    return __atomic_load_n(&mem_limit_bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Set the limit for the rest of the process (overrides APC_MEM_LIMIT)
+ * @param bytes: new limit, 0 for unlimited
+ */
+void mem_set_limit(size_t bytes)
+{
+    __atomic_store_n(&mem_limit_loaded, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&mem_limit_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Count bytes as live
+ * @param bytes: size of the allocation about to be made
+ * @return: SUCCESS, or FAILURE (nothing counted) if it would pass the limit
+ */
+int mem_charge(size_t bytes)
+{
+    size_t limit = mem_limit();
+    size_t live = __atomic_add_fetch(&mem_live_bytes, bytes, __ATOMIC_RELAXED);
+    if (limit != 0 && live > limit)
+    {
+        __atomic_sub_fetch(&mem_live_bytes, bytes, __ATOMIC_RELAXED);
+        return FAILURE;
+    }
+    size_t peak = __atomic_load_n(&mem_peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&mem_peak_bytes, &peak, live, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ; // peak was reloaded by the failed exchange
+    return SUCCESS;
+}
+
+/**
+ * Return bytes counted by mem_charge
+ * @param bytes: same size that was charged
+ */
+void mem_uncharge(size_t bytes)
+{
+    __atomic_sub_fetch(&mem_live_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Up-front check of an operation's estimated needs (nothing is counted)
+ * @param bytes: estimated memory the operation will allocate
+ * @return: SUCCESS if it fits under the limit now, FAILURE otherwise
+ */
+int mem_check(size_t bytes)
+{
+    size_t limit = mem_limit();
+    if (limit == 0)
+        return SUCCESS;
+    size_t live = __atomic_load_n(&mem_live_bytes, __ATOMIC_RELAXED);
+    return (live <= limit && bytes <= limit - live) ? SUCCESS : FAILURE;
+}
+
+/**
+ * Bytes currently counted as live
+ */
+size_t mem_live(void)
+{
+    return __atomic_load_n(&mem_live_bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Most bytes counted as live at once since the process started
+ */
+size_t mem_peak(void)
+{
+    return __atomic_load_n(&mem_peak_bytes, __ATOMIC_RELAXED);
+}
@@ -6,10 +6,59 @@
  * (like long multiplication done by hand)
  * ============================================================================ */
 
+/**
+ * Multiply large operands on base 10^8 limbs (limb schoolbook or Karatsuba,
+ * chosen inside limb_mul by THRESHOLD_KARATSUBA)
+ * @param shards: worker processes for a product past SHARD_MIN_LIMBS (1 = none)
+ * @return: SUCCESS, or FAILURE on memory allocation error
+ */
+static int mul_limbs(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2,
+                     Dlist **head3, Dlist **tail3, int shards)
+{
+    size_t count1 = 0, count2 = 0;
+    TRACE_BEGIN("to_limbs", NULL, 0);
+    limb_t *limbs1 = list_to_limbs(head1, tail1, &count1);
+    limb_t *limbs2 = list_to_limbs(head2, tail2, &count2);
+    TRACE_END();
+    size_t product_bytes = (count1 + count2 + 1) * sizeof(limb_t);
+    limb_t *product = big_alloc(product_bytes, 0);
+    int status = (limbs1 != NULL && limbs2 != NULL && product != NULL) ? SUCCESS : FAILURE;
+    size_t shorter = (count1 < count2) ? count1 : count2;
+    if (shorter < SHARD_MIN_LIMBS)
+        shards = 1;
+    // Operands, product and Karatsuba scratch (about 6 limbs per limb of the shorter side);
+    // sharded, the scratch is in the workers and the shared segment is here instead
+    size_t charged = (2 * (count1 + count2) + 1 + 6 * shorter + 64) * sizeof(limb_t);
+    if (shards > 1)
+        charged = (2 * (count1 + count2) + 1) * sizeof(limb_t) +
+                  shard_bytes(count1 + count2 - shorter, shorter, shards);
+
+    if (status == SUCCESS)
+        status = mem_charge(charged); // FAILURE if over the memory budget
+    if (status == FAILURE)
+        charged = 0;
+    if (status == SUCCESS && shards > 1)
+        status = shard_mul(product, limbs1, count1, limbs2, count2, LIMB_DECIMAL_BASE, shards);
+    else if (status == SUCCESS)
+        status = limb_mul(product, limbs1, count1, limbs2, count2, LIMB_DECIMAL_BASE);
+    TRACE_BEGIN("to_list", NULL, 0);
+    if (status == SUCCESS)
+        status = limbs_to_list(product, count1 + count2, head3, tail3);
+    TRACE_END();
+
+    free(limbs1);
+    free(limbs2);
+    big_free(product, product_bytes);
+    mem_uncharge(charged);
+    return status;
+}
+
 /**
  * Multiply two numbers stored in double linked lists
  * Algorithm: Use intermediate array to store partial products,
  * then handle carries and convert to result list
+ * Operands whose shorter side has THRESHOLD_MUL_LIMB digits or more are
+ * multiplied on limbs instead (see mul_limbs)
  * 
  * @param head1: pointer to head pointer of first number
  * @param tail1: pointer to tail pointer of first number
@@ -17,7 +66,8 @@
  * @param tail2: pointer to tail pointer of second number
  * @param head3: pointer to head pointer of result (will be created)
  * @param tail3: pointer to tail pointer of result (will be created)
- * @return: SUCCESS on success, FAILURE on memory allocation error
+ * @return: SUCCESS on success, FAILURE on memory allocation error or if the
+ *          product would not fit in the memory budget (result left empty)
  */
 int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
                Dlist **head3, Dlist **tail3)
@@ -26,11 +76,34 @@ int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     int len1 = get_list_length(*head1); // Length of first number
     int len2 = get_list_length(*head2); // Length of second number
 
+    // Fail fast if the product (len1 + len2 digits) and its work array cannot fit in the memory budget
+    if (mem_check((size_t)(len1 + len2) * (MEM_NODE_BYTES + sizeof(int))) == FAILURE)
+        return FAILURE;
+    TRACE_BEGIN("mul_number", "digits", len1 + len2);
+
+    // Large operands: the limb tiers are faster (crossover measured by make tune)
+    if ((size_t)((len1 < len2) ? len1 : len2) >= get_threshold(THRESHOLD_MUL_LIMB))
+    {
+        int status = mul_limbs(*head1, *tail1, *head2, *tail2, head3, tail3, 1);
+        if (status == FAILURE)
+            dl_delete_list(head3, tail3); // No partial product
+        TRACE_END();
+        return status;
+    }
+
     // Step 2: Allocate array to store intermediate multiplication results
     // Result can have at most (len1 + len2) digits (e.g., 99 * 99 = 9801, 2+2=4 digits)
+    size_t charged = (size_t)(len1 + len2) * sizeof(int); // Work array, counted against the budget
+    if (mem_charge(charged) == FAILURE)
+    {
+        TRACE_END();
+        return FAILURE; // Over the memory budget
+    }
     int *result_array = calloc(len1 + len2, sizeof(int)); // Allocate and initialize to zero
     if (result_array == NULL)
     {
+        mem_uncharge(charged);
+        TRACE_END();
         return FAILURE; // Return error if memory allocation fails
     }
 
@@ -41,10 +114,12 @@ int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
     //   result[0] = 3*6, result[1] = 3*5 + 2*6, result[2] = 3*4 + 2*5 + 1*6, etc.
     int i = 0, j = 0; // Loop counters for digit positions
     Dlist *digit1_ptr = *tail1; // Start from rightmost digit of first number
+    TRACE_BEGIN("mul_schoolbook", NULL, 0);
     
     for (i = 0; digit1_ptr != NULL; digit1_ptr = digit1_ptr->prev, i++) // Loop through first number (backwards)
     {
         j = 0;
+        STATS_ADD(digit_ops, len2);
         Dlist *digit2_ptr = *tail2; // Start from rightmost digit of second number
         for (j = 0; digit2_ptr != NULL; digit2_ptr = digit2_ptr->prev, j++) // Loop through second number (backwards)
         {
@@ -54,7 +129,10 @@ int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         }
     }
 
+    TRACE_END();
+
     // Step 4: Handle carries (propagate carries from right to left)
+    TRACE_BEGIN("carry_pass", NULL, 0);
     int carry = 0; // Carry from previous position
     for (i = 0; i < len1 + len2; i++) // Process all positions in result array
     {
@@ -62,6 +140,7 @@ int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
         carry = result_array[i] / 10;     // Calculate new carry (tens place)
         result_array[i] = result_array[i] % 10;  // Keep only ones digit (0-9)
     }
+    TRACE_END();
 
     // Step 5: Find first non-zero digit (skip leading zeros in result)
     int first_digit_index = len1 + len2 - 1; // Start from most significant position
@@ -72,12 +151,43 @@ int mul_number(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
 
     // Step 6: Convert result array to double linked list
     // Insert from most significant to least significant (left to right)
-    for (; first_digit_index >= 0; first_digit_index--)
+    int status = SUCCESS;
+    for (; first_digit_index >= 0 && status == SUCCESS; first_digit_index--)
     {
-        dl_insert_last(head3, tail3, result_array[first_digit_index]); // Add each digit to result
+        status = dl_insert_last(head3, tail3, result_array[first_digit_index]); // Add each digit to result
     }
+    if (status == FAILURE)
+        dl_delete_list(head3, tail3); // Out of memory: no partial product
 
     // Step 7: Free the intermediate array (prevent memory leak)
     free(result_array);
-    return SUCCESS; // Multiplication completed successfully
+    mem_uncharge(charged);
+    TRACE_END();
+    return status; // SUCCESS once the multiplication is complete
+}
+
+/**
+ * Multiply like mul_number, spreading a large product over worker processes
+ * Forks (see shard.c), so the caller must be the only thread of the process
+ * @param shards: worker processes (1 to SHARD_MAX_WORKERS, 1 = mul_number)
+ * @return: SUCCESS, or FAILURE on memory allocation error, over the memory
+ *          budget, or if a worker failed (result left empty)
+ */
+int mul_number_sharded(Dlist **head1, Dlist **tail1, Dlist **head2, Dlist **tail2,
+                       Dlist **head3, Dlist **tail3, int shards)
+{
+    int len1 = get_list_length(*head1);
+    int len2 = get_list_length(*head2);
+    size_t shorter = (size_t)((len1 < len2) ? len1 : len2);
+    if (shards < 2 || shorter < SHARD_MIN_LIMBS * LIMB_DECIMAL_DIGITS)
+        return mul_number(head1, tail1, head2, tail2, head3, tail3);
+
+    if (mem_check((size_t)(len1 + len2) * MEM_NODE_BYTES) == FAILURE)
+        return FAILURE;
+    TRACE_BEGIN("mul_number", "digits", len1 + len2);
+    int status = mul_limbs(*head1, *tail1, *head2, *tail2, head3, tail3, shards);
+    if (status == FAILURE)
+        dl_delete_list(head3, tail3); // No partial product
+    TRACE_END();
+    return status;
 }
@@ -0,0 +1,407 @@
+#include "apc.h"
+
+/* ============================================================================
+ * MODULAR EXPONENTIATION
+ * r = a^e mod m on base 2^32 limbs (see limbs.c).
+ *
+ * Odd moduli use Montgomery arithmetic: values are kept as x*R mod m, with
+ * R = 2^(32n) for an n-limb modulus, and one CIOS pass (coarsely integrated
+ * operand scanning) multiplies and reduces together, so the loop never
+ * divides. The exponent is scanned from the top with a sliding window over a
+ * table of odd powers: bits squarings plus about bits / (k + 1) products.
+ *
+ * Constant-time mode (powmod --ct, apc_powmod_sec) uses a fixed window
+ * instead. Every window costs the same squarings and one product, the table
+ * entry is read by scanning the whole table under a mask and the final
+ * Montgomery subtraction is masked too, so neither the time taken nor the
+ * memory accessed depends on the exponent bits. It needs an odd modulus.
+ *
+ * Even moduli have no Montgomery form; they take the same sliding window with
+ * limb_mul and a Knuth D reduction after every product.
+ * ============================================================================ */
+
+#define POWMOD_CT_WINDOW 4  // Window bits of the constant-time ladder (16 entry table)
+
+/* ----------------------------------------------------------------------------
+ * powmod_ctx: modulus and scratch shared by every product of one powmod
+ * ---------------------------------------------------------------------------- */
+typedef struct powmod_ctx
+{
+    const limb_t *m;    // Modulus, n limbs, m[n - 1] != 0
+    size_t n;
+    int montgomery;     // 1: values in Montgomery form (odd m), 0: multiply + divide
+    limb_t minv;        // -m^-1 mod 2^32 (Montgomery only)
+    limb_t *scratch;    // 2n + 2 limbs
+} powmod_ctx;
+
+/* ============================================================================
+ * MODULAR PRODUCTS
+ * ============================================================================ */
+
+/**
+ * -m0^-1 mod 2^32 for odd m0 (Newton iteration)
+ */
+static limb_t mont_inverse(limb_t m0)
+{
+    limb_t inv = m0;            // Right to 3 bits: m0 * m0 = 1 mod 8
+    for (int i = 0; i < 4; i++)
+        inv *= 2 - m0 * inv;    // Each step doubles the right bits: 6, 12, 24, 48
+    return (limb_t)0 - inv;
+}
+
+/**
+ * Montgomery product r = a * b / R mod m (CIOS), a, b < m, n limbs each
+ * r may be the same array as a or b; no branch depends on the values
+ * @param t: scratch of n + 2 limbs
+ */
+static void mont_mul(limb_t *r, const limb_t *a, const limb_t *b, const limb_t *m, size_t n,
+                     limb_t minv, limb_t *t)
+{
+    STATS_ADD(limb_ops, 2 * n * n);
+    memset(t, 0, (n + 2) * sizeof(limb_t));
+    for (size_t i = 0; i < n; i++)
+    {
+        // Step 1: t += a * b[i]
+        uint64_t carry = 0, s;
+        for (size_t j = 0; j < n; j++)
+        {
+            s = (uint64_t)a[j] * b[i] + t[j] + carry;
+            t[j] = (limb_t)s;
+            carry = s >> 32;
+        }
+        s = (uint64_t)t[n] + carry;
+        t[n] = (limb_t)s;
+        t[n + 1] = (limb_t)(s >> 32);
+
+        // Step 2: t = (t + q*m) / 2^32, q chosen so the low limb cancels
+        limb_t q = t[0] * minv;
+        s = (uint64_t)q * m[0] + t[0];
+        carry = s >> 32;
+        for (size_t j = 1; j < n; j++)
+        {
+            s = (uint64_t)q * m[j] + t[j] + carry;
+            t[j - 1] = (limb_t)s;
+            carry = s >> 32;
+        }
+        s = (uint64_t)t[n] + carry;
+        t[n - 1] = (limb_t)s;
+        t[n] = t[n + 1] + (limb_t)(s >> 32);
+    }
+
+    // Step 3: t < 2m; keep t - m unless it is negative (selected by mask)
+    uint64_t borrow = 0;
+    for (size_t j = 0; j < n; j++)
+    {
+        uint64_t d = (uint64_t)t[j] - m[j] - borrow;
+        r[j] = (limb_t)d;
+        borrow = d >> 63;
+    }
+    limb_t keep_t = (limb_t)0 - (limb_t)(borrow & (t[n] ^ 1)); // All ones if t < m
+    for (size_t j = 0; j < n; j++)
+        r[j] = (t[j] & keep_t) | (r[j] & ~keep_t);
+}
+
+/**
+ * r = a * b mod m in the context's representation (r may be a or b)
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int mod_mul(powmod_ctx *ctx, limb_t *r, const limb_t *a, const limb_t *b)
+{
+    size_t n = ctx->n;
+    if (ctx->montgomery)
+    {
+        mont_mul(r, a, b, ctx->m, n, ctx->minv, ctx->scratch);
+        return SUCCESS;
+    }
+    if (limb_mul(ctx->scratch, a, n, b, n, LIMB_BINARY_BASE) == FAILURE)
+        return FAILURE;
+    return limb_divmod(NULL, r, ctx->scratch, 2 * n, ctx->m, n, LIMB_BINARY_BASE);
+}
+
+/* ============================================================================
+ * EXPONENT SCANNING
+ * ============================================================================ */
+
+/**
+ * Bit i of a limb number
+ */
+static inline limb_t exp_bit(const limb_t *e, size_t i)
+{
+    return (e[i / 32] >> (i % 32)) & 1;
+}
+
+/**
+ * Sliding window size for an exponent of the given bit length
+ * (balances the 2^(k-1) table products against bits / (k + 1) window products)
+ */
+static size_t window_bits(size_t bits)
+{
+    if (bits <= 8)   return 1;
+    if (bits <= 24)  return 2;
+    if (bits <= 80)  return 3;
+    if (bits <= 240) return 4;
+    if (bits <= 672) return 5;
+    return 6;
+}
+
+/**
+ * x = a^e (sliding window, left to right)
+ * @param x: result, holds "one" on entry
+ * @param a: base, reduced and in the context's representation
+ * @param table: 2^(k-1) + 1 entries of n limbs
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int powmod_sliding(powmod_ctx *ctx, limb_t *x, const limb_t *a,
+                          const limb_t *e, size_t bits, limb_t *table)
+{
+    size_t n = ctx->n, k = window_bits(bits);
+    size_t entries = (size_t)1 << (k - 1);
+    limb_t *a2 = table + entries * n;
+    int status = SUCCESS;
+
+    // Step 1: Odd powers a, a^3, a^5, ... a^(2^k - 1)
+    memcpy(table, a, n * sizeof(limb_t));
+    if (entries > 1)
+        status = mod_mul(ctx, a2, a, a);
+    for (size_t i = 1; status == SUCCESS && i < entries; i++)
+        status = mod_mul(ctx, table + i * n, table + (i - 1) * n, a2);
+
+    // Step 2: Zero bits square; a window of up to k bits ending in a 1 costs
+    // one squaring per bit and one product by its odd power
+    int started = 0;
+    size_t i = bits;
+    while (status == SUCCESS && i > 0)
+    {
+        if (!exp_bit(e, i - 1))
+        {
+            status = mod_mul(ctx, x, x, x);
+            i--;
+            continue;
+        }
+        size_t low = (i >= k) ? i - k : 0;
+        while (!exp_bit(e, low))
+            low++;
+        size_t value = 0;
+        for (size_t b = i; b-- > low;)
+            value = (value << 1) | exp_bit(e, b);
+        if (!started) // x is one: the first window is a table lookup
+            memcpy(x, table + (value >> 1) * n, n * sizeof(limb_t));
+        else
+        {
+            for (size_t b = low; status == SUCCESS && b < i; b++)
+                status = mod_mul(ctx, x, x, x);
+            if (status == SUCCESS)
+                status = mod_mul(ctx, x, x, table + (value >> 1) * n);
+        }
+        started = 1;
+        i = low;
+    }
+    return status;
+}
+
+/**
+ * x = a^e with a fixed POWMOD_CT_WINDOW bit window (Montgomery only)
+ * The number of products depends only on the exponent's limb count
+ * @param x: result, holds "one" on entry
+ * @param table: 2^k + 1 entries of n limbs (the last one is the selected entry)
+ */
+static void powmod_fixed(powmod_ctx *ctx, limb_t *x, const limb_t *a,
+                         const limb_t *e, size_t en, limb_t *table)
+{
+    size_t n = ctx->n, k = POWMOD_CT_WINDOW;
+    size_t entries = (size_t)1 << k;
+    limb_t *selected = table + entries * n;
+
+    // Step 1: Every power a^0 .. a^(2^k - 1)
+    memcpy(table, x, n * sizeof(limb_t));
+    memcpy(table + n, a, n * sizeof(limb_t));
+    for (size_t i = 2; i < entries; i++)
+        mod_mul(ctx, table + i * n, table + (i - 1) * n, a);
+
+    // Step 2: k squarings and one product per window, from the top
+    for (size_t w = (en * 32 + k - 1) / k; w-- > 0;)
+    {
+        size_t value = 0;
+        for (size_t b = w * k + k; b-- > w * k;)
+            value = (value << 1) | ((b < en * 32) ? exp_bit(e, b) : 0);
+        for (size_t s = 0; s < k; s++)
+            mod_mul(ctx, x, x, x);
+
+        // Read table[value] without an address that depends on it
+        memset(selected, 0, n * sizeof(limb_t));
+        for (size_t i = 0; i < entries; i++)
+        {
+            limb_t mask = (limb_t)0 - (limb_t)(i == value);
+            for (size_t j = 0; j < n; j++)
+                selected[j] |= table[i * n + j] & mask;
+        }
+        mod_mul(ctx, x, x, selected);
+    }
+}
+
+/* ============================================================================
+ * LIMB INTERFACE
+ * ============================================================================ */
+
+/**
+ * r = a^e mod m on base 2^32 limbs
+ * @param r: result, mn limbs
+ * @param a: base (an limbs, any size)
+ * @param e: exponent (en limbs)
+ * @param m: modulus (mn limbs, m[mn - 1] != 0); odd when constant_time is set
+ * @param constant_time: 1 for the fixed window ladder whose timing does not
+ *                       depend on the exponent bits
+ * @return: SUCCESS, or FAILURE if out of memory (or over the memory budget)
+ */
+int limb_powmod(limb_t *r, const limb_t *a, size_t an, const limb_t *e, size_t en,
+                const limb_t *m, size_t mn, int constant_time)
+{
+    size_t n = mn;
+    an = limb_normalize(a, an);
+    size_t bits = en * 32; // The ladder never looks at the exponent's true length
+    if (!constant_time)
+    {
+        bits = limb_normalize(e, en) * 32;
+        while (bits > 0 && !exp_bit(e, bits - 1))
+            bits--;
+    }
+    if (n == 1 && m[0] == 1)
+    {
+        r[0] = 0; // Everything is 0 mod 1
+        return SUCCESS;
+    }
+
+    powmod_ctx ctx = { m, n, (int)(m[0] & 1), 0, NULL };
+    if (constant_time && !ctx.montgomery)
+        return FAILURE; // Callers reject even moduli first
+    size_t entries = constant_time ? ((size_t)1 << POWMOD_CT_WINDOW)
+                                   : ((size_t)1 << (window_bits(bits) - 1));
+
+    // Step 1: Work arrays: base, R^2, one, x, scratch, R^2 dividend, table
+    size_t count = 4 * n + (2 * n + 2) + (2 * n + 1) + (entries + 1) * n;
+    size_t charged = count * sizeof(limb_t);
+    if (mem_charge(charged) == FAILURE)
+        return FAILURE;
+    limb_t *work = calloc(count, sizeof(limb_t));
+    if (work == NULL)
+    {
+        mem_uncharge(charged);
+        return FAILURE;
+    }
+    TRACE_BEGIN("powmod", "bits", bits);
+    limb_t *base = work, *r2 = base + n, *one = r2 + n, *x = one + n;
+    ctx.scratch = x + n;
+    limb_t *dividend = ctx.scratch + (2 * n + 2);
+    limb_t *table = dividend + (2 * n + 1);
+
+    // Step 2: base = a mod m
+    int status = SUCCESS;
+    if (an >= n)
+        status = limb_divmod(NULL, base, a, an, m, n, LIMB_BINARY_BASE);
+    else
+        memcpy(base, a, an * sizeof(limb_t));
+
+    // Step 3: Into Montgomery form with R^2 mod m: one = R mod m, base = base*R mod m
+    if (status == SUCCESS && ctx.montgomery)
+    {
+        ctx.minv = mont_inverse(m[0]);
+        dividend[2 * n] = 1; // R^2 = 2^(64n)
+        status = limb_divmod(NULL, r2, dividend, 2 * n + 1, m, n, LIMB_BINARY_BASE);
+        if (status == SUCCESS)
+        {
+            x[0] = 1;
+            mont_mul(one, x, r2, m, n, ctx.minv, ctx.scratch);
+            mont_mul(base, base, r2, m, n, ctx.minv, ctx.scratch);
+        }
+    }
+    else
+        one[0] = 1;
+
+    // Step 4: Exponentiate
+    if (status == SUCCESS)
+    {
+        memcpy(x, one, n * sizeof(limb_t));
+        if (constant_time)
+            powmod_fixed(&ctx, x, base, e, en, table);
+        else
+            status = powmod_sliding(&ctx, x, base, e, bits, table);
+    }
+
+    // Step 5: Out of Montgomery form (x * 1 / R)
+    if (status == SUCCESS && ctx.montgomery)
+    {
+        memset(one, 0, n * sizeof(limb_t));
+        one[0] = 1;
+        mont_mul(r, x, one, m, n, ctx.minv, ctx.scratch);
+    }
+    else if (status == SUCCESS)
+        memcpy(r, x, n * sizeof(limb_t));
+
+    free(work);
+    mem_uncharge(charged);
+    TRACE_END();
+    return status;
+}
+
+/* ============================================================================
+ * DIGIT LIST INTERFACE
+ * ============================================================================ */
+
+/**
+ * Modular exponentiation of numbers stored in double linked lists
+ * Result = base^exp mod mod, in [0, mod)
+ *
+ * @param base_head: head of |base|
+ * @param base_tail: tail of |base|
+ * @param base_sign: sign of the base (+1 or -1)
+ * @param exp_head: head of the exponent (must not be negative)
+ * @param exp_tail: tail of the exponent
+ * @param mod_head: head of the modulus (must not be zero or negative)
+ * @param mod_tail: tail of the modulus
+ * @param constant_time: 1 for the constant-time ladder (modulus must be odd)
+ * @param head3: pointer to head pointer of result (will be created)
+ * @param tail3: pointer to tail pointer of result (will be created)
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (result left empty)
+ */
+int powmod_number(Dlist *base_head, Dlist *base_tail, int base_sign,
+                  Dlist *exp_head, Dlist *exp_tail, Dlist *mod_head, Dlist *mod_tail,
+                  int constant_time, Dlist **head3, Dlist **tail3)
+{
+    // Fail fast if the result digits and a table of 64 modulus sized entries cannot fit
+    size_t mod_digits = (size_t)get_list_length(mod_head);
+    if (mem_check(mod_digits * MEM_NODE_BYTES + (mod_digits / 9 + 1) * 80 * sizeof(limb_t)) == FAILURE)
+        return FAILURE;
+
+    // Step 1: Operands to binary limbs
+    size_t base_count = 0, exp_count = 0, mod_count = 0;
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_BINARY_BASE);
+    TRACE_BEGIN("to_limbs", NULL, 0);
+    limb_t *base = list_to_binary(base_head, base_tail, &cache, &base_count);
+    limb_t *exp = list_to_binary(exp_head, exp_tail, &cache, &exp_count);
+    limb_t *mod = list_to_binary(mod_head, mod_tail, &cache, &mod_count);
+    TRACE_END();
+    radix_cache_free(&cache);
+    limb_t *result = (mod != NULL && mod_count > 0) ? calloc(mod_count, sizeof(limb_t)) : NULL;
+    int status = (base != NULL && exp != NULL && result != NULL) ? SUCCESS : FAILURE;
+
+    // Step 2: |base|^exp mod m; a negative base flips odd powers to m - r
+    if (status == SUCCESS)
+        status = limb_powmod(result, base, base_count, exp, exp_count, mod, mod_count, constant_time);
+    if (status == SUCCESS && base_sign == -1 && exp_count > 0 && (exp[0] & 1) &&
+        limb_normalize(result, mod_count) > 0)
+        limb_sub(result, mod, mod_count, result, mod_count, LIMB_BINARY_BASE);
+
+    // Step 3: Back to decimal digits
+    TRACE_BEGIN("to_list", NULL, 0);
+    if (status == SUCCESS)
+        status = binary_to_list(result, mod_count, head3, tail3);
+    TRACE_END();
+
+    free(base);
+    free(exp);
+    free(mod);
+    free(result);
+    return status;
+}
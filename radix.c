@@ -0,0 +1,254 @@
+#include "apc.h"
+
+/* ============================================================================
+ * RADIX CONVERSION
+ * Converts limb arrays between base 10^8 and base 2^32 (either direction).
+ *
+ * Digit-by-digit conversion (Horner's rule) is quadratic: every new source
+ * limb touches the whole partial result. Above RADIX_THRESHOLD limbs the
+ * number is split instead at h = 2^k source limbs:
+ *
+ *     value = high * S^h + low
+ *
+ * both halves are converted recursively and recombined with one product by
+ * the cached power S^h (already in the target base). With Karatsuba this
+ * costs O(M(n) log n), the same order as computing the number in the first
+ * place, so parsing and printing never dominate the arithmetic.
+ * ============================================================================ */
+
+/**
+ * Initialize an empty power cache for conversions into target_base
+ * @param cache: cache to initialize
+ * @param target_base: LIMB_DECIMAL_BASE or LIMB_BINARY_BASE
+ */
+void radix_cache_init(radix_cache *cache, uint64_t target_base)
+{
+    cache->target_base = target_base;
+    for (int i = 0; i < RADIX_MAX_LEVELS; i++)
+    {
+        cache->power[i] = NULL;
+        cache->length[i] = 0;
+    }
+}
+
+/**
+ * Release every cached power
+ * @param cache: cache to clear (can be initialized again or reused)
+ */
+void radix_cache_free(radix_cache *cache)
+{
+    for (int i = 0; i < RADIX_MAX_LEVELS; i++)
+    {
+        free(cache->power[i]);
+        cache->power[i] = NULL;
+        cache->length[i] = 0;
+    }
+}
+
+/**
+ * Get source_base^(2^level) in the target base, computing missing levels by
+ * squaring the level below
+ * @return: SUCCESS or FAILURE (out of memory)
+ */
+static int get_power(radix_cache *cache, int level, uint64_t source_base)
+{
+    if (cache->power[level] != NULL)
+        return SUCCESS;
+
+    uint64_t base = cache->target_base;
+    if (level == 0)
+    {
+        // source_base written in the target base (at most two limbs)
+        limb_t *power = malloc(2 * sizeof(limb_t));
+        if (power == NULL)
+            return FAILURE;
+        power[0] = (limb_t)(source_base % base);
+        power[1] = (limb_t)(source_base / base);
+        cache->power[0] = power;
+        cache->length[0] = limb_normalize(power, 2);
+        return SUCCESS;
+    }
+
+    if (get_power(cache, level - 1, source_base) == FAILURE)
+        return FAILURE;
+    const limb_t *half = cache->power[level - 1];
+    size_t half_length = cache->length[level - 1];
+    limb_t *power = malloc(2 * half_length * sizeof(limb_t));
+    if (power == NULL)
+        return FAILURE;
+    if (limb_mul(power, half, half_length, half, half_length, base) == FAILURE)
+    {
+        free(power);
+        return FAILURE;
+    }
+    cache->power[level] = power;
+    cache->length[level] = limb_normalize(power, 2 * half_length);
+    return SUCCESS;
+}
+
+/**
+ * Quadratic conversion for short inputs: result = result * S + src[i],
+ * most significant source limb first
+ * @return: SUCCESS or FAILURE (out of memory)
+ */
+static int convert_basecase(const limb_t *src, size_t n, uint64_t source_base, uint64_t base,
+                            limb_t **result, size_t *result_count)
+{
+    // Each source limb needs at most two target limbs (10^8 vs 2^32)
+    limb_t *r = malloc((2 * n + 1) * sizeof(limb_t));
+    if (r == NULL)
+        return FAILURE;
+
+    size_t length = 0;
+    for (size_t i = n; i-- > 0;)
+    {
+        if (source_base < base)
+        {
+            limb_t carry = limb_mul_1(r, r, length, (limb_t)source_base, src[i], base);
+            if (carry != 0)
+                r[length++] = carry;
+        }
+        else
+        {
+            // 2^32 does not fit below 10^8: shift in the limb 16 bits at a time
+            limb_t carry = limb_mul_1(r, r, length, 1u << 16, src[i] >> 16, base);
+            if (carry != 0)
+                r[length++] = carry;
+            carry = limb_mul_1(r, r, length, 1u << 16, src[i] & 0xFFFF, base);
+            if (carry != 0)
+                r[length++] = carry;
+        }
+    }
+    *result = r;
+    *result_count = length;
+    return SUCCESS;
+}
+
+/**
+ * Recursive step of radix_convert (src is normalized or has top zeros)
+ */
+static int convert_recursive(const limb_t *src, size_t n, uint64_t source_base, radix_cache *cache,
+                             limb_t **result, size_t *result_count)
+{
+    uint64_t base = cache->target_base;
+    if (n <= RADIX_THRESHOLD)
+        return convert_basecase(src, n, source_base, base, result, result_count);
+
+    // Step 1: Split at the largest power of two below n
+    int level = 0;
+    while (((size_t)2 << level) < n)
+        level++;
+    size_t h = (size_t)1 << level;
+    if (get_power(cache, level, source_base) == FAILURE)
+        return FAILURE;
+
+    // Step 2: Convert both halves
+    limb_t *low = NULL, *high = NULL;
+    size_t low_count = 0, high_count = 0;
+    if (convert_recursive(src, h, source_base, cache, &low, &low_count) == FAILURE)
+        return FAILURE;
+    if (convert_recursive(src + h, n - h, source_base, cache, &high, &high_count) == FAILURE)
+    {
+        free(low);
+        return FAILURE;
+    }
+
+    // Step 3: result = high * S^h + low (low < S^h, so it fits in the product size)
+    const limb_t *power = cache->power[level];
+    size_t power_count = cache->length[level];
+    size_t count = high_count + power_count + 1;
+    limb_t *r = malloc(count * sizeof(limb_t));
+    int status = (r == NULL) ? FAILURE : SUCCESS;
+    if (status == SUCCESS)
+    {
+        r[count - 1] = 0;
+        if (high_count == 0)
+            memset(r, 0, (count - 1) * sizeof(limb_t));
+        else
+            status = limb_mul(r, high, high_count, power, power_count, base);
+    }
+    if (status == SUCCESS)
+    {
+        limb_add(r, r, count, low, low_count, base);
+        *result = r;
+        *result_count = limb_normalize(r, count);
+    }
+    else
+        free(r);
+    free(low);
+    free(high);
+    return status;
+}
+
+/**
+ * Convert a number from source_base limbs to the cache's target base
+ * @param src: source limbs (least significant first)
+ * @param n: number of source limbs
+ * @param source_base: LIMB_DECIMAL_BASE or LIMB_BINARY_BASE
+ * @param cache: power cache for the target base (filled as needed, kept for reuse)
+ * @param result: receives a new limb array (free() it; at least one limb allocated)
+ * @param result_count: receives its normalized length (0 for zero)
+ * @return: SUCCESS or FAILURE (out of memory)
+ */
+int radix_convert(const limb_t *src, size_t n, uint64_t source_base, radix_cache *cache,
+                  limb_t **result, size_t *result_count)
+{
+    *result = NULL;
+    *result_count = 0;
+    n = limb_normalize(src, n);
+    if (n == 0)
+    {
+        *result = calloc(1, sizeof(limb_t));
+        return (*result == NULL) ? FAILURE : SUCCESS;
+    }
+    TRACE_BEGIN("radix_convert", "limbs", n);
+    int status = convert_recursive(src, n, source_base, cache, result, result_count);
+    TRACE_END();
+    return status;
+}
+
+/* ============================================================================
+ * DIGIT LISTS <-> BINARY LIMBS
+ * ============================================================================ */
+
+/**
+ * Pack a digit list into base 2^32 limbs (through decimal limbs)
+ * @param head: head of the number
+ * @param tail: tail of the number
+ * @param cache: binary target cache (may be shared by several conversions)
+ * @param count: receives the normalized limb count (0 for zero)
+ * @return: new limb array (at least one limb allocated), NULL if out of memory
+ */
+limb_t *list_to_binary(Dlist *head, Dlist *tail, radix_cache *cache, size_t *count)
+{
+    size_t decimal_count = 0;
+    limb_t *decimal = list_to_limbs(head, tail, &decimal_count);
+    if (decimal == NULL)
+        return NULL;
+    limb_t *binary = NULL;
+    int status = radix_convert(decimal, decimal_count, LIMB_DECIMAL_BASE, cache, &binary, count);
+    free(decimal);
+    return (status == SUCCESS) ? binary : NULL;
+}
+
+/**
+ * Unpack base 2^32 limbs into a digit list (no leading zeros, "0" for zero)
+ * @param limbs: binary limbs (may be NULL if count is 0)
+ * @param count: number of limbs
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @return: SUCCESS or FAILURE (out of memory, list left empty)
+ */
+int binary_to_list(const limb_t *limbs, size_t count, Dlist **head, Dlist **tail)
+{
+    limb_t *decimal = NULL;
+    size_t decimal_count = 0;
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_DECIMAL_BASE);
+    int status = radix_convert(limbs, count, LIMB_BINARY_BASE, &cache, &decimal, &decimal_count);
+    radix_cache_free(&cache);
+    if (status == SUCCESS)
+        status = limbs_to_list(decimal, decimal_count, head, tail);
+    free(decimal);
+    return status;
+}
@@ -0,0 +1,234 @@
+#include "apc.h"
+
+/* ============================================================================
+ * RATIONAL NUMBERS
+ * Exact fractions num / den over the Dlist integer core (den > 0, the sign
+ * lives in num). Results are not reduced after every operation: a gcd and
+ * two divisions cost far more than the operation itself, so a fraction is
+ * only brought to lowest terms once its size has doubled since the last
+ * reduction of its operands (RAT_REDUCE_FACTOR), when it is printed, or on
+ * request. Each reduction then pays for itself: between two of them the
+ * common factors are removed from numbers at most twice their reduced size.
+ *
+ * Operations also avoid cross-multiplication where it is not needed:
+ * equal denominators are added directly (a/d + c/d = (a + c)/d) and an
+ * integer operand only scales the other numerator (a/b + c = (a + c b)/b).
+ * ============================================================================ */
+
+/**
+ * Empty fraction (no lists yet); fill it with rat_parse or rat_op
+ */
+void rat_init(rational *q)
+{
+    q->num_head = q->num_tail = q->den_head = q->den_tail = NULL;
+    q->sign = 1;
+    q->reduced_length = 0;
+}
+
+/**
+ * Free both lists of a fraction
+ */
+void rat_free(rational *q)
+{
+    dl_delete_list(&q->num_head, &q->num_tail);
+    dl_delete_list(&q->den_head, &q->den_tail);
+    q->sign = 1;
+    q->reduced_length = 0;
+}
+
+/**
+ * Digits of numerator and denominator together
+ */
+static size_t rat_length(const rational *q)
+{
+    return (size_t)get_list_length(q->num_head) + (size_t)get_list_length(q->den_head);
+}
+
+/**
+ * Whether a magnitude is exactly 1
+ */
+static int is_one(Dlist *head)
+{
+    return head != NULL && head->next == NULL && head->data == 1;
+}
+
+/**
+ * Whether two magnitudes are equal (both without leading zeros)
+ */
+static int lists_equal(Dlist *a, Dlist *b)
+{
+    while (a != NULL && b != NULL && a->data == b->data)
+    {
+        a = a->next;
+        b = b->next;
+    }
+    return a == NULL && b == NULL;
+}
+
+/**
+ * Parse "[-]p" or "[-]p/[-]q" (leading zeros allowed)
+ * @param q: fraction to fill (freed first)
+ * @param text: the fraction
+ * @param length: bytes of text
+ * @param bad_offset: receives the first invalid byte on failure (may be NULL)
+ * @return: SUCCESS, FAILURE if invalid, ZERO_DENOMINATOR, MEMORY_ERROR
+ */
+int rat_parse(rational *q, const char *text, size_t length, size_t *bad_offset)
+{
+    rat_free(q);
+    const char *slash = memchr(text, '/', length);
+    size_t num_length = (slash != NULL) ? (size_t)(slash - text) : length;
+    int num_sign = 1, den_sign = 1;
+    int status = stored_num_buffer(&q->num_head, &q->num_tail, text, num_length, &num_sign, bad_offset);
+    if (status == SUCCESS && slash == NULL)
+        status = dl_insert_last(&q->den_head, &q->den_tail, 1) == SUCCESS ? SUCCESS : MEMORY_ERROR;
+    else if (status == SUCCESS)
+    {
+        status = stored_num_buffer(&q->den_head, &q->den_tail, slash + 1, length - num_length - 1,
+                                   &den_sign, bad_offset);
+        if (status == FAILURE && bad_offset != NULL)
+            *bad_offset += num_length + 1; // Offset within the whole text
+        if (status == SUCCESS && is_zero(q->den_head))
+            status = ZERO_DENOMINATOR;
+    }
+    if (status != SUCCESS)
+    {
+        rat_free(q);
+        return status;
+    }
+    q->sign = (is_zero(q->num_head) || num_sign == den_sign) ? 1 : -1;
+    q->reduced_length = rat_length(q); // Grows from here before a reduction is worth it
+    return SUCCESS;
+}
+
+/**
+ * h3 = a * b, or a copy of a when b is 1
+ */
+static int product(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2, Dlist **head3, Dlist **tail3)
+{
+    if (is_one(head2))
+        return copy_list(head1, head3, tail3);
+    if (is_one(head1))
+        return copy_list(head2, head3, tail3);
+    return mul_number(&head1, &tail1, &head2, &tail2, head3, tail3);
+}
+
+/**
+ * Bring a fraction to lowest terms (num / g, den / g with g = gcd)
+ * @return: SUCCESS or FAILURE (out of memory; q unchanged)
+ */
+int rat_normalize(rational *q)
+{
+    if (is_one(q->den_head))
+    {
+        q->reduced_length = rat_length(q);
+        return SUCCESS;
+    }
+    TRACE_BEGIN("rat_normalize", "digits", rat_length(q));
+    Dlist *g_head = NULL, *g_tail = NULL;
+    int status = gcd_number(q->num_head, q->num_tail, q->den_head, q->den_tail, &g_head, &g_tail);
+    if (status == SUCCESS && !is_one(g_head))
+    {
+        Dlist *num_head = NULL, *num_tail = NULL, *den_head = NULL, *den_tail = NULL;
+        Dlist *rem_head = NULL, *rem_tail = NULL;
+        Dlist *h1 = q->num_head, *t1 = q->num_tail, *h2 = g_head, *t2 = g_tail;
+        status = div_number(&h1, &t1, &h2, &t2, &num_head, &num_tail, &rem_head, &rem_tail, '/');
+        dl_delete_list(&rem_head, &rem_tail);
+        h1 = q->den_head, t1 = q->den_tail, h2 = g_head, t2 = g_tail;
+        if (status == SUCCESS)
+            status = div_number(&h1, &t1, &h2, &t2, &den_head, &den_tail, &rem_head, &rem_tail, '/');
+        dl_delete_list(&rem_head, &rem_tail);
+        if (status == SUCCESS)
+        {
+            dl_delete_list(&q->num_head, &q->num_tail);
+            dl_delete_list(&q->den_head, &q->den_tail);
+            q->num_head = num_head, q->num_tail = num_tail;
+            q->den_head = den_head, q->den_tail = den_tail;
+        }
+        else
+        {
+            dl_delete_list(&num_head, &num_tail);
+            dl_delete_list(&den_head, &den_tail);
+        }
+    }
+    dl_delete_list(&g_head, &g_tail);
+    if (status == SUCCESS)
+    {
+        q->sign = is_zero(q->num_head) ? 1 : q->sign;
+        q->reduced_length = rat_length(q);
+    }
+    TRACE_END();
+    return status;
+}
+
+/**
+ * r = a op b, reduced only if it has grown past RAT_REDUCE_FACTOR times the
+ * reduced size of its larger operand
+ * @param r: result (must not be a or b; freed first)
+ * @param op: '+', '-', 'x' or '/'
+ * @return: SUCCESS, or FAILURE on division by zero or out of memory
+ *          (callers tell these apart with is_zero, as for div_number)
+ */
+int rat_op(rational *r, const rational *a, char op, const rational *b)
+{
+    rat_free(r);
+    if (op == '/' && is_zero(b->num_head))
+        return FAILURE;
+    TRACE_BEGIN("rat_op", "digits", rat_length(a) + rat_length(b));
+
+    int status;
+    if (op == '+' || op == '-')
+    {
+        int sign_b = (op == '-') ? -b->sign : b->sign;
+        if (lists_equal(a->den_head, b->den_head))
+        {
+            // a/d + c/d = (a + c)/d
+            status = add_signed_number(a->num_head, a->num_tail, a->sign, b->num_head, b->num_tail, sign_b,
+                                       &r->num_head, &r->num_tail, &r->sign);
+            if (status == SUCCESS)
+                status = copy_list(a->den_head, &r->den_head, &r->den_tail);
+        }
+        else
+        {
+            // a/b + c/d = (a d + c b)/(b d); an integer side skips its product
+            Dlist *ad_head = NULL, *ad_tail = NULL, *cb_head = NULL, *cb_tail = NULL;
+            status = product(a->num_head, a->num_tail, b->den_head, b->den_tail, &ad_head, &ad_tail);
+            if (status == SUCCESS)
+                status = product(b->num_head, b->num_tail, a->den_head, a->den_tail, &cb_head, &cb_tail);
+            if (status == SUCCESS)
+                status = add_signed_number(ad_head, ad_tail, a->sign, cb_head, cb_tail, sign_b,
+                                           &r->num_head, &r->num_tail, &r->sign);
+            if (status == SUCCESS)
+                status = product(a->den_head, a->den_tail, b->den_head, b->den_tail, &r->den_head, &r->den_tail);
+            dl_delete_list(&ad_head, &ad_tail);
+            dl_delete_list(&cb_head, &cb_tail);
+        }
+    }
+    else
+    {
+        // a/b x c/d = (a c)/(b d); a/b / c/d = (a d)/(b c)
+        Dlist *num2_head = (op == '/') ? b->den_head : b->num_head, *num2_tail = (op == '/') ? b->den_tail : b->num_tail;
+        Dlist *den2_head = (op == '/') ? b->num_head : b->den_head, *den2_tail = (op == '/') ? b->num_tail : b->den_tail;
+        r->sign = (a->sign == b->sign) ? 1 : -1;
+        status = product(a->num_head, a->num_tail, num2_head, num2_tail, &r->num_head, &r->num_tail);
+        if (status == SUCCESS)
+            status = product(a->den_head, a->den_tail, den2_head, den2_tail, &r->den_head, &r->den_tail);
+    }
+    if (status == SUCCESS && (r->num_head == NULL || r->den_head == NULL))
+        status = FAILURE;
+    if (status == SUCCESS && is_zero(r->num_head))
+        r->sign = 1; // Never keep "-0"
+
+    // Lazy reduction: only once the result is twice the reduced size of its operands
+    if (status == SUCCESS)
+    {
+        size_t base = (a->reduced_length > b->reduced_length) ? a->reduced_length : b->reduced_length;
+        r->reduced_length = base;
+        if (rat_length(r) > RAT_REDUCE_FACTOR * base + RAT_REDUCE_SLACK)
+            status = rat_normalize(r);
+    }
+    if (status != SUCCESS)
+        rat_free(r);
+    TRACE_END();
+    return status;
+}
@@ -0,0 +1,444 @@
+#include "apc.h"
+
+/* ============================================================================
+ * REDUCTIONS
+ * Sum and product of every number in a text file (or standard input).
+ *
+ * Folding a list with add_number would allocate a fresh result list per
+ * operand and throw the old accumulator away. Here operands go straight from
+ * text to base 10^8 limbs and never become Dlists:
+ *
+ * - Sum: each limb is added into a 64-bit column of a wide accumulator
+ *   (one for positive, one for negative operands) with no carries at all.
+ *   A limb is below 2^27, so a column can take 2^36 additions before a
+ *   carry pass is needed; in practice there is one, at the end, followed by
+ *   a single subtraction of the two sides.
+ * - Product: operands are kept as limb arrays and multiplied pairwise, level
+ *   by level, so every multiplication joins neighbours of similar size and
+ *   the large products go through Karatsuba instead of a long chain of
+ *   huge-times-small steps.
+ * ============================================================================ */
+
+#define REDUCE_CARRY_INTERVAL (1ULL << 36)  // Additions a column absorbs between carry passes
+
+/* ----------------------------------------------------------------------------
+ * reduce_sum: wide accumulators of a sum (columns in base 10^8, no carries)
+ * ---------------------------------------------------------------------------- */
+typedef struct reduce_sum
+{
+    uint64_t *column[2];    // Positive [0] and negative [1] operands, least significant first
+    size_t n;               // Columns in use (both sides)
+    size_t alloc;           // Columns allocated (both sides)
+    uint64_t pending;       // Operands added since the last carry pass
+} reduce_sum;
+
+/* ----------------------------------------------------------------------------
+ * reduce_operand: one factor of a product, as decimal limbs
+ * ---------------------------------------------------------------------------- */
+typedef struct reduce_operand
+{
+    limb_t *d;      // Least significant limb first (malloc'd, charged)
+    size_t n;       // Limbs in use
+    size_t alloc;   // Limbs allocated
+} reduce_operand;
+
+/* ----------------------------------------------------------------------------
+ * reduce_product: factors read so far
+ * ---------------------------------------------------------------------------- */
+typedef struct reduce_product
+{
+    reduce_operand *factors;
+    size_t count;
+    size_t alloc;
+    int sign;           // Sign of the product so far
+    int zero;           // 1 once a zero operand was seen (factors are then dropped)
+} reduce_product;
+
+/* ============================================================================
+ * SUM
+ * ============================================================================ */
+
+/**
+ * Make room for n columns on both sides (new columns are zero)
+ */
+static int sum_reserve(reduce_sum *sum, size_t n)
+{
+    if (n <= sum->alloc)
+        return SUCCESS;
+    size_t alloc = (sum->alloc * 2 > n) ? sum->alloc * 2 : n;
+    if (mem_charge(2 * (alloc - sum->alloc) * sizeof(uint64_t)) == FAILURE)
+        return FAILURE;
+    for (int side = 0; side < 2; side++)
+    {
+        uint64_t *column = realloc(sum->column[side], alloc * sizeof(uint64_t));
+        if (column == NULL)
+        {
+            mem_uncharge(2 * (alloc - sum->alloc) * sizeof(uint64_t));
+            return FAILURE; // The side already grown keeps its old contents
+        }
+        memset(column + sum->alloc, 0, (alloc - sum->alloc) * sizeof(uint64_t));
+        sum->column[side] = column;
+    }
+    sum->alloc = alloc;
+    return SUCCESS;
+}
+
+/**
+ * Propagate the carries of both sides so that every column is below 10^8
+ * @return: SUCCESS, or FAILURE if a new top column cannot be allocated
+ */
+static int sum_carry(reduce_sum *sum)
+{
+    size_t top = sum->n;
+    for (int side = 0; side < 2; side++)
+    {
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < sum->n || carry != 0; i++)
+        {
+            if (i == sum->alloc && sum_reserve(sum, i + 1) == FAILURE)
+                return FAILURE;
+            uint64_t value = sum->column[side][i] + carry;
+            sum->column[side][i] = value % LIMB_DECIMAL_BASE;
+            carry = value / LIMB_DECIMAL_BASE;
+        }
+        if (i > top)
+            top = i;
+    }
+    sum->n = top;
+    sum->pending = 0;
+    return SUCCESS;
+}
+
+/**
+ * Add the limbs of one operand into the columns of its side
+ */
+static int sum_add(reduce_sum *sum, const limb_t *limbs, size_t n, int sign)
+{
+    if (sum->pending == REDUCE_CARRY_INTERVAL && sum_carry(sum) == FAILURE)
+        return FAILURE;
+    if (sum_reserve(sum, n) == FAILURE)
+        return FAILURE;
+    uint64_t *column = sum->column[(sign == -1) ? 1 : 0];
+    for (size_t i = 0; i < n; i++)
+        column[i] += limbs[i];
+    if (n > sum->n)
+        sum->n = n;
+    sum->pending++;
+    STATS_ADD(limb_ops, n);
+    return SUCCESS;
+}
+
+/**
+ * Final value of a sum: one carry pass, then positive side - negative side
+ */
+static int sum_finish(reduce_sum *sum, Dlist **head3, Dlist **tail3, int *sign3)
+{
+    if (sum_carry(sum) == FAILURE)
+        return MEMORY_ERROR;
+
+    // Step 1: Columns are now proper limbs
+    size_t n = sum->n;
+    reduce_operand limbs = { NULL, 0, 2 * n + 1 };
+    if (mem_charge(limbs.alloc * sizeof(limb_t)) == FAILURE)
+        return MEMORY_ERROR;
+    limbs.d = malloc(limbs.alloc * sizeof(limb_t));
+    if (limbs.d == NULL)
+    {
+        mem_uncharge(limbs.alloc * sizeof(limb_t));
+        return MEMORY_ERROR;
+    }
+    limb_t *side[2] = { limbs.d, limbs.d + n };
+    for (int s = 0; s < 2; s++)
+    {
+        for (size_t i = 0; i < n; i++)
+            side[s][i] = (limb_t)sum->column[s][i];
+    }
+
+    // Step 2: Subtract the smaller side from the larger
+    size_t pn = limb_normalize(side[0], n), nn = limb_normalize(side[1], n);
+    int larger = (limb_cmp(side[0], pn, side[1], nn) >= 0) ? 0 : 1;
+    *sign3 = (larger == 0) ? 1 : -1;
+    if (larger == 0)
+        limb_sub(side[0], side[0], pn, side[1], nn, LIMB_DECIMAL_BASE);
+    else
+        limb_sub(side[1], side[1], nn, side[0], pn, LIMB_DECIMAL_BASE);
+
+    // Step 3: Digits
+    TRACE_BEGIN("to_list", NULL, 0);
+    int status = limbs_to_list(side[larger], (larger == 0) ? pn : nn, head3, tail3);
+    TRACE_END();
+    free(limbs.d);
+    mem_uncharge(limbs.alloc * sizeof(limb_t));
+    if (status == SUCCESS && is_zero(*head3))
+        *sign3 = 1;
+    return (status == SUCCESS) ? SUCCESS : MEMORY_ERROR;
+}
+
+static void sum_free(reduce_sum *sum)
+{
+    free(sum->column[0]);
+    free(sum->column[1]);
+    mem_uncharge(2 * sum->alloc * sizeof(uint64_t));
+}
+
+/* ============================================================================
+ * PRODUCT
+ * ============================================================================ */
+
+/**
+ * Keep one operand (its limbs are moved into the list)
+ */
+static int product_push(reduce_product *product, reduce_operand op)
+{
+    if (product->count == product->alloc)
+    {
+        size_t alloc = product->alloc ? product->alloc * 2 : 64;
+        if (mem_charge((alloc - product->alloc) * sizeof(reduce_operand)) == FAILURE)
+            return FAILURE;
+        reduce_operand *factors = realloc(product->factors, alloc * sizeof(reduce_operand));
+        if (factors == NULL)
+        {
+            mem_uncharge((alloc - product->alloc) * sizeof(reduce_operand));
+            return FAILURE;
+        }
+        product->factors = factors;
+        product->alloc = alloc;
+    }
+    product->factors[product->count++] = op;
+    return SUCCESS;
+}
+
+static void operand_free(reduce_operand *op)
+{
+    free(op->d);
+    mem_uncharge(op->alloc * sizeof(limb_t));
+    op->d = NULL;
+    op->n = 0;
+    op->alloc = 0;
+}
+
+/**
+ * Multiply the factors pairwise, level by level, until one is left
+ */
+static int product_tree(reduce_product *product)
+{
+    TRACE_BEGIN("product_tree", "operands", product->count);
+    int status = SUCCESS;
+    while (product->count > 1 && status == SUCCESS)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < product->count; i += 2)
+        {
+            if (i + 1 == product->count)
+            {
+                product->factors[kept++] = product->factors[i]; // Odd one out moves up
+                continue;
+            }
+            reduce_operand *a = &product->factors[i], *b = &product->factors[i + 1];
+            reduce_operand r = { NULL, 0, a->n + b->n };
+            if (status == SUCCESS && mem_charge(r.alloc * sizeof(limb_t)) == FAILURE)
+                status = FAILURE;
+            else if (status == SUCCESS && (r.d = malloc(r.alloc * sizeof(limb_t))) == NULL)
+            {
+                mem_uncharge(r.alloc * sizeof(limb_t));
+                status = FAILURE;
+            }
+            else if (status == SUCCESS &&
+                     limb_mul(r.d, a->d, a->n, b->d, b->n, LIMB_DECIMAL_BASE) == FAILURE)
+            {
+                operand_free(&r);
+                status = FAILURE;
+            }
+            operand_free(a);
+            operand_free(b);
+            if (status == SUCCESS)
+            {
+                r.n = limb_normalize(r.d, r.alloc);
+                product->factors[kept++] = r;
+            }
+        }
+        product->count = kept;
+    }
+    TRACE_END();
+    return status;
+}
+
+/**
+ * Final value of a product
+ */
+static int product_finish(reduce_product *product, Dlist **head3, Dlist **tail3, int *sign3)
+{
+    *sign3 = 1;
+    if (product->zero || product->count == 0)
+        return (dl_insert_last(head3, tail3, product->zero ? 0 : 1) == SUCCESS) ? SUCCESS : MEMORY_ERROR;
+    if (product_tree(product) == FAILURE)
+        return MEMORY_ERROR;
+    *sign3 = product->sign;
+    TRACE_BEGIN("to_list", NULL, 0);
+    int status = limbs_to_list(product->factors[0].d, product->factors[0].n, head3, tail3);
+    TRACE_END();
+    return (status == SUCCESS) ? SUCCESS : MEMORY_ERROR;
+}
+
+static void product_free(reduce_product *product)
+{
+    for (size_t i = 0; i < product->count; i++)
+        operand_free(&product->factors[i]);
+    free(product->factors);
+    mem_uncharge(product->alloc * sizeof(reduce_operand));
+}
+
+/* ============================================================================
+ * DRIVER
+ * ============================================================================ */
+
+/**
+ * Sum or product of the whitespace separated numbers of a text file
+ * @param path: file to read ("-" reads standard input)
+ * @param op: '+' for the sum, 'x' for the product
+ * @param head3: pointer to head pointer of result (will be created)
+ * @param tail3: pointer to tail pointer of result (will be created)
+ * @param sign3: receives the sign of the result (+1 or -1)
+ * @param count: receives the number of operands read
+ * @param bad_line: receives the line of an invalid operand (1 = first line)
+ * @return: SUCCESS (an empty file gives 0 or 1), FILE_OPEN_ERROR, FAILURE
+ *          for an invalid operand, or MEMORY_ERROR
+ */
+int reduce_file(const char *path, char op, Dlist **head3, Dlist **tail3, int *sign3,
+                size_t *count, size_t *bad_line)
+{
+    *head3 = *tail3 = NULL;
+    *sign3 = 1;
+    *count = 0;
+    *bad_line = 0;
+    FILE *in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (in == NULL)
+        return FILE_OPEN_ERROR;
+
+    reduce_sum sum = { { NULL, NULL }, 0, 0, 0 };
+    reduce_product product = { NULL, 0, 0, 1, 0 };
+    limb_t *scratch = NULL;     // Limbs of the current operand (sum only)
+    size_t scratch_alloc = 0;
+    char *line = NULL;
+    size_t line_capacity = 0;
+    size_t line_number = 0;
+    int status = SUCCESS;
+
+    // Step 1: Read and fold every operand
+    TRACE_BEGIN((op == '+') ? "reduce_sum" : "reduce_product", NULL, 0);
+    while (status == SUCCESS && getline(&line, &line_capacity, in) != -1)
+    {
+        line_number++;
+        char *p = line;
+        while (status == SUCCESS)
+        {
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+                p++;
+            if (*p == '\0')
+                break;
+
+            // Validate the token: [-]digits up to whitespace
+            int sign = 1;
+            if (*p == '-')
+            {
+                sign = -1;
+                p++;
+            }
+            size_t digits = scan_digits_string(p);
+            char end = p[digits];
+            if (digits == 0 || (end != '\0' && end != ' ' && end != '\t' && end != '\r' && end != '\n'))
+            {
+                *bad_line = line_number;
+                status = FAILURE;
+                break;
+            }
+
+            // Convert it to limbs
+            size_t n = (digits + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS;
+            limb_t *limbs;
+            if (op == '+')
+            {
+                if (n > scratch_alloc)
+                {
+                    if (mem_charge((n - scratch_alloc) * sizeof(limb_t)) == FAILURE)
+                    {
+                        status = MEMORY_ERROR;
+                        break;
+                    }
+                    limb_t *grown = realloc(scratch, n * sizeof(limb_t));
+                    if (grown == NULL)
+                    {
+                        mem_uncharge((n - scratch_alloc) * sizeof(limb_t));
+                        status = MEMORY_ERROR;
+                        break;
+                    }
+                    scratch = grown;
+                    scratch_alloc = n;
+                }
+                limbs = scratch;
+            }
+            else
+            {
+                if (mem_charge(n * sizeof(limb_t)) == FAILURE)
+                {
+                    status = MEMORY_ERROR;
+                    break;
+                }
+                limbs = malloc(n * sizeof(limb_t));
+                if (limbs == NULL)
+                {
+                    mem_uncharge(n * sizeof(limb_t));
+                    status = MEMORY_ERROR;
+                    break;
+                }
+            }
+            digits_to_limbs(p, digits, limbs);
+            size_t used = limb_normalize(limbs, n);
+            (*count)++;
+            p += digits;
+
+            // Fold it in
+            if (op == '+')
+            {
+                if (sum_add(&sum, limbs, used, sign) == FAILURE)
+                    status = MEMORY_ERROR;
+            }
+            else if (used == 0 || product.zero)
+            {
+                product.zero = 1;
+                free(limbs);
+                mem_uncharge(n * sizeof(limb_t));
+            }
+            else
+            {
+                if (sign == -1)
+                    product.sign = -product.sign;
+                reduce_operand kept = { limbs, used, n };
+                if (product_push(&product, kept) == FAILURE)
+                {
+                    operand_free(&kept);
+                    status = MEMORY_ERROR;
+                }
+            }
+        }
+    }
+    if (status == SUCCESS && ferror(in))
+        status = FILE_OPEN_ERROR;
+    TRACE_END();
+    free(line);
+    free(scratch);
+    mem_uncharge(scratch_alloc * sizeof(limb_t));
+    if (in != stdin)
+        fclose(in);
+
+    // Step 2: Combine
+    if (status == SUCCESS)
+        status = (op == '+') ? sum_finish(&sum, head3, tail3, sign3)
+                             : product_finish(&product, head3, tail3, sign3);
+    sum_free(&sum);
+    product_free(&product);
+    if (status != SUCCESS)
+        dl_delete_list(head3, tail3);
+    return status;
+}
@@ -0,0 +1,514 @@
+#include "apc.h"
+#include <math.h>
+
+/* ============================================================================
+ * INTEGER ROOTS
+ * r = floor(N^(1/k)) and N - r^k on base 2^32 limbs, without dividing.
+ *
+ * Write N = u * 2^(kt) with u in [1, 2^k), so the root has t + 1 bits.
+ * Newton's iteration for the inverse root w = u^(-1/k),
+ *
+ *   w' = w + w (1 - u w^k) / k
+ *
+ * needs only products, and doubles the correct bits at every step, so each
+ * step runs at twice the precision of the one before: from a double
+ * estimate (about 48 bits) up to the bits of the root plus guard bits. The
+ * last step dominates and the whole ladder costs a few multiplications of
+ * root-sized numbers. Then r = 2^t u w^(k-1), and only the top t + 1 + guard
+ * bits of N are ever read.
+ *
+ * The estimate is within one of the root; one exact power r^k (with a
+ * second for the check one above, or a cheap 2r + 1 step for square roots)
+ * turns it into the exact floor and the remainder.
+ * ============================================================================ */
+
+#define ROOT_START_BITS 48  // Bits of the double estimate that start the iteration
+
+/* ----------------------------------------------------------------------------
+ * root_num: unsigned number on binary limbs
+ * ---------------------------------------------------------------------------- */
+typedef struct root_num
+{
+    limb_t *d;      // Least significant limb first
+    size_t n;       // Limbs in use, normalized (0 for zero)
+    size_t alloc;   // Limbs allocated (counted against the memory budget)
+} root_num;
+
+/* ============================================================================
+ * UNSIGNED LIMB NUMBERS
+ * ============================================================================ */
+
+static void rn_init(root_num *x)
+{
+    x->d = NULL;
+    x->n = 0;
+    x->alloc = 0;
+}
+
+static void rn_free(root_num *x)
+{
+    free(x->d);
+    mem_uncharge(x->alloc * sizeof(limb_t));
+    rn_init(x);
+}
+
+/**
+ * Make room for n limbs (contents kept)
+ * @return: SUCCESS, or FAILURE if out of memory or over the memory budget
+ */
+static int rn_reserve(root_num *x, size_t n)
+{
+    if (n <= x->alloc)
+        return SUCCESS;
+    size_t grow = (n - x->alloc) * sizeof(limb_t);
+    if (mem_charge(grow) == FAILURE)
+        return FAILURE;
+    limb_t *d = realloc(x->d, n * sizeof(limb_t));
+    if (d == NULL)
+    {
+        mem_uncharge(grow);
+        return FAILURE;
+    }
+    x->d = d;
+    x->alloc = n;
+    return SUCCESS;
+}
+
+static int rn_set(root_num *x, const limb_t *d, size_t n)
+{
+    n = limb_normalize(d, n);
+    if (rn_reserve(x, n) == FAILURE)
+        return FAILURE;
+    if (n > 0 && x->d != d)
+        memmove(x->d, d, n * sizeof(limb_t));
+    x->n = n;
+    return SUCCESS;
+}
+
+static int rn_set_word(root_num *x, uint64_t value)
+{
+    limb_t d[2] = { (limb_t)value, (limb_t)(value >> 32) };
+    return rn_set(x, d, 2);
+}
+
+static void rn_swap(root_num *x, root_num *y)
+{
+    root_num t = *x;
+    *x = *y;
+    *y = t;
+}
+
+static size_t rn_bits(const root_num *x)
+{
+    return (x->n == 0) ? 0 : 32 * x->n - (size_t)__builtin_clz(x->d[x->n - 1]);
+}
+
+static int rn_cmp(const root_num *x, const root_num *y)
+{
+    return limb_cmp(x->d, x->n, y->d, y->n);
+}
+
+/**
+ * r = a * 2^shift, truncated when shift < 0 (r may be a)
+ */
+static int rn_shift(root_num *r, const root_num *a, long shift)
+{
+    size_t n = a->n;
+    if (shift >= 0)
+    {
+        size_t limbs = (size_t)shift / 32;
+        int bits = (int)(shift % 32);
+        if (n == 0)
+        {
+            r->n = 0;
+            return SUCCESS;
+        }
+        if (rn_reserve(r, n + limbs + 1) == FAILURE)
+            return FAILURE;
+        const limb_t *src = a->d; // Read after the reserve: a may be r
+        limb_t *dst = r->d;
+        // Top down, so an in-place shift reads every limb before overwriting it
+        dst[n + limbs] = bits ? src[n - 1] >> (32 - bits) : 0;
+        for (size_t i = n; i-- > 1;)
+            dst[i + limbs] = bits ? (src[i] << bits) | (src[i - 1] >> (32 - bits)) : src[i];
+        dst[limbs] = src[0] << bits;
+        memset(dst, 0, limbs * sizeof(limb_t));
+        r->n = limb_normalize(dst, n + limbs + 1);
+        return SUCCESS;
+    }
+
+    size_t limbs = (size_t)(-shift) / 32;
+    int bits = (int)((-shift) % 32);
+    if (n <= limbs)
+    {
+        r->n = 0;
+        return SUCCESS;
+    }
+    n -= limbs;
+    if (rn_reserve(r, n) == FAILURE)
+        return FAILURE;
+    const limb_t *src = a->d + limbs;
+    for (size_t i = 0; i < n; i++) // Bottom up for the same reason
+        r->d[i] = bits ? (src[i] >> bits) | ((i + 1 < n) ? src[i + 1] << (32 - bits) : 0) : src[i];
+    r->n = limb_normalize(r->d, n);
+    return SUCCESS;
+}
+
+/**
+ * r = a + b (r may be a or b)
+ */
+static int rn_add(root_num *r, const root_num *a, const root_num *b)
+{
+    const root_num *big = (a->n >= b->n) ? a : b, *small = (a->n >= b->n) ? b : a;
+    size_t n = big->n;
+    if (rn_reserve(r, n + 1) == FAILURE)
+        return FAILURE;
+    r->d[n] = limb_add(r->d, big->d, n, small->d, small->n, LIMB_BINARY_BASE);
+    r->n = limb_normalize(r->d, n + 1);
+    return SUCCESS;
+}
+
+/**
+ * r = a - b for a >= b (r may be a or b)
+ */
+static int rn_sub(root_num *r, const root_num *a, const root_num *b)
+{
+    if (rn_reserve(r, a->n) == FAILURE)
+        return FAILURE;
+    limb_sub(r->d, a->d, a->n, b->d, b->n, LIMB_BINARY_BASE);
+    r->n = limb_normalize(r->d, a->n);
+    return SUCCESS;
+}
+
+/**
+ * r = a * b (r must differ from a and b)
+ */
+static int rn_mul(root_num *r, const root_num *a, const root_num *b)
+{
+    if (a->n == 0 || b->n == 0)
+    {
+        r->n = 0;
+        return SUCCESS;
+    }
+    if (rn_reserve(r, a->n + b->n) == FAILURE ||
+        limb_mul(r->d, a->d, a->n, b->d, b->n, LIMB_BINARY_BASE) == FAILURE)
+        return FAILURE;
+    r->n = limb_normalize(r->d, a->n + b->n);
+    return SUCCESS;
+}
+
+/**
+ * r = a^e, exact (e >= 1); with frac > 0, a and r are fixed point numbers
+ * with frac fractional bits and every product is truncated back to frac
+ * @param tmp: scratch number
+ */
+static int rn_pow(root_num *r, const root_num *a, uint64_t e, long frac, root_num *tmp)
+{
+    if (rn_set(r, a->d, a->n) == FAILURE)
+        return FAILURE;
+    for (int bit = 62 - __builtin_clzll(e); bit >= 0; bit--) // Left to right binary powering
+    {
+        if (rn_mul(tmp, r, r) == FAILURE || rn_shift(r, tmp, -frac) == FAILURE)
+            return FAILURE;
+        if (((e >> bit) & 1) && (rn_mul(tmp, r, a) == FAILURE || rn_shift(r, tmp, -frac) == FAILURE))
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * NEWTON ITERATION
+ * ============================================================================ */
+
+/* ----------------------------------------------------------------------------
+ * root_work: numbers of one root computation
+ * ---------------------------------------------------------------------------- */
+typedef struct root_work
+{
+    root_num w;     // Inverse root estimate, fixed point
+    root_num u;     // Top bits of N, fixed point
+    root_num v;     // Powers of w
+    root_num x;     // Products
+    root_num e;     // Newton correction
+    root_num tmp;   // Scratch of rn_pow
+} root_work;
+
+/**
+ * u = N / 2^(kt), fixed point with frac fractional bits (top bits of N only)
+ */
+static int root_scaled(root_num *u, const root_num *N, uint64_t k, size_t t, long frac)
+{
+    return rn_shift(u, N, frac - (long)(k * t));
+}
+
+/**
+ * One Newton step: w (p fractional bits) -> w (q fractional bits)
+ * @param guard: extra bits carried through the truncated power w^k
+ */
+static int root_newton_step(root_work *work, const root_num *N, uint64_t k, size_t t,
+                            long p, long q, long guard)
+{
+    long frac = q + guard;
+    root_num *w = &work->w, *v = &work->v, *x = &work->x, *e = &work->e;
+
+    // Step 1: x = u w^k, close to 1 (frac fractional bits)
+    if (rn_shift(w, w, frac - p) == FAILURE ||
+        rn_pow(v, w, k, frac, &work->tmp) == FAILURE ||
+        root_scaled(&work->u, N, k, t, frac) == FAILURE ||
+        rn_mul(x, v, &work->u) == FAILURE ||
+        rn_shift(x, x, -frac) == FAILURE)
+        return FAILURE;
+
+    // Step 2: e = |1 - x|, the sign decides the direction of the correction
+    if (rn_set_word(e, 1) == FAILURE || rn_shift(e, e, frac) == FAILURE)
+        return FAILURE;
+    int above = (rn_cmp(x, e) > 0); // u w^k > 1: w is too large
+    if ((above ? rn_sub(e, x, e) : rn_sub(e, e, x)) == FAILURE)
+        return FAILURE;
+
+    // Step 3: w +- w e / k
+    if (rn_mul(x, w, e) == FAILURE || rn_shift(x, x, -frac) == FAILURE)
+        return FAILURE;
+    if (x->n > 0)
+    {
+        limb_divmod_1(x->d, x->d, x->n, (limb_t)k, LIMB_BINARY_BASE);
+        x->n = limb_normalize(x->d, x->n);
+    }
+    if (above && rn_cmp(x, w) > 0) // Cannot happen with a sane estimate; keep w positive
+        return FAILURE;
+    if ((above ? rn_sub(w, w, x) : rn_add(w, w, x)) == FAILURE)
+        return FAILURE;
+    return rn_shift(w, w, q - frac);
+}
+
+/**
+ * Estimate of N^(1/k), within one of the root (N has nb >= k + 1 bits)
+ */
+static int root_estimate(root_work *work, const root_num *N, size_t nb, uint64_t k, root_num *r)
+{
+    size_t t = (nb - 1) / k; // 2^(kt) <= N < 2^(k(t + 1))
+
+    // Step 1: log2(u) from the top 64 bits of N
+    if (rn_shift(&work->x, N, 64 - (long)nb) == FAILURE)
+        return FAILURE;
+    uint64_t top = (uint64_t)work->x.d[0] | ((work->x.n > 1) ? (uint64_t)work->x.d[1] << 32 : 0);
+    double log2u = log2((double)top) + (double)((long)nb - 64) - (double)(k * t);
+
+    // Step 2: Short roots come straight from the double estimate
+    if (t + 1 <= ROOT_START_BITS - 8)
+        return rn_set_word(r, (uint64_t)ldexp(exp2(log2u / (double)k), (int)t));
+
+    // Step 3: Precision ladder, from the root's bits plus guard bits down to the start
+    long guard = 64 - __builtin_clzll(k) + 2;   // Truncation error of w^k is about k units
+    long scale = (long)ceil(log2u) + 1;         // w^k = 1/u: fixed point loses log2(u) bits
+    long precision[64];
+    int steps = 0;
+    precision[0] = (long)t + 1 + guard + 8;
+    while (precision[steps] > ROOT_START_BITS)
+    {
+        precision[steps + 1] = (precision[steps] + guard + 8) / 2 + 1;
+        steps++;
+    }
+
+    // Step 4: Newton from the double estimate upwards
+    TRACE_BEGIN("newton", "steps", steps);
+    long p = precision[steps];
+    int status = rn_set_word(&work->w, (uint64_t)ldexp(exp2(-log2u / (double)k), (int)p));
+    for (int i = steps - 1; i >= 0 && status == SUCCESS; i--)
+    {
+        status = root_newton_step(work, N, k, t, p, precision[i], guard + scale);
+        p = precision[i];
+    }
+    TRACE_END();
+
+    // Step 5: r = 2^t u w^(k-1)
+    long frac = p + guard + scale;
+    if (status == SUCCESS)
+        status = rn_shift(&work->w, &work->w, frac - p);
+    if (status == SUCCESS)
+        status = (k > 2) ? rn_pow(&work->v, &work->w, k - 1, frac, &work->tmp)
+                         : rn_set(&work->v, work->w.d, work->w.n);
+    if (status == SUCCESS)
+        status = root_scaled(&work->u, N, k, t, frac);
+    if (status == SUCCESS)
+        status = rn_mul(&work->x, &work->u, &work->v);
+    if (status == SUCCESS)
+        status = rn_shift(r, &work->x, (long)t - 2 * frac);
+    return status;
+}
+
+/**
+ * r = floor(N^(1/k)) and rem = N - r^k
+ */
+static int root_core(const limb_t *a, size_t an, uint64_t k, root_num *r, root_num *rem)
+{
+    root_num N, one;
+    root_work work;
+    rn_init(&N);
+    rn_init(&one);
+    rn_init(&work.w);
+    rn_init(&work.u);
+    rn_init(&work.v);
+    rn_init(&work.x);
+    rn_init(&work.e);
+    rn_init(&work.tmp);
+
+    int status = rn_set(&N, a, an);
+    size_t nb = rn_bits(&N);
+    TRACE_BEGIN("root", "bits", nb);
+    if (status == SUCCESS)
+        status = rn_set_word(&one, 1);
+
+    // Step 1: Estimate (0, N itself and 1 need none and are exact)
+    int exact = 0;
+    if (status == SUCCESS)
+    {
+        if (nb == 0 || k == 1)
+        {
+            exact = 1;
+            status = rn_set(r, N.d, N.n);
+            if (status == SUCCESS)
+                status = rn_set(rem, NULL, 0);
+        }
+        else if (k >= nb)
+        {
+            exact = 1; // 1 <= N < 2^nb <= 2^k, so the root is 1 and no power is formed
+            status = rn_set_word(r, 1);
+            if (status == SUCCESS)
+                status = rn_sub(rem, &N, &one);
+        }
+        else
+            status = root_estimate(&work, &N, nb, k, r);
+    }
+
+    // Step 2: Exact power and floor correction
+    if (status == SUCCESS && !exact && k == 2)
+    {
+        // Square roots: start one low, then step up while rem >= 2r + 1
+        if (r->n > 0 && rn_cmp(r, &one) > 0)
+            status = rn_sub(r, r, &one);
+        if (status == SUCCESS)
+            status = rn_mul(&work.v, r, r);
+        while (status == SUCCESS && rn_cmp(&work.v, &N) > 0) // Estimate off by more than one
+        {
+            status = rn_sub(r, r, &one);
+            if (status == SUCCESS)
+                status = rn_mul(&work.v, r, r);
+        }
+        if (status == SUCCESS)
+            status = rn_sub(rem, &N, &work.v);
+        while (status == SUCCESS)
+        {
+            if (rn_shift(&work.x, r, 1) == FAILURE || rn_add(&work.x, &work.x, &one) == FAILURE)
+                status = FAILURE;
+            else if (rn_cmp(rem, &work.x) < 0)
+                break;
+            else if (rn_sub(rem, rem, &work.x) == FAILURE || rn_add(r, r, &one) == FAILURE)
+                status = FAILURE;
+        }
+    }
+    else if (status == SUCCESS && !exact)
+    {
+        status = (r->n > 0) ? rn_pow(&work.v, r, k, 0, &work.tmp) : rn_set(&work.v, NULL, 0);
+        while (status == SUCCESS && rn_cmp(&work.v, &N) > 0)
+        {
+            status = rn_sub(r, r, &one);
+            if (status == SUCCESS)
+                status = (r->n > 0) ? rn_pow(&work.v, r, k, 0, &work.tmp) : rn_set(&work.v, NULL, 0);
+        }
+        while (status == SUCCESS)
+        {
+            // (r+1)^k >= 2^(k (bits(r+1) - 1)) >= 2^nb > N without forming the power
+            if (rn_add(&work.e, r, &one) == FAILURE)
+                status = FAILURE;
+            else if (rn_bits(&work.e) - 1 >= (nb + k - 1) / k)
+                break;
+            else if (rn_pow(&work.u, &work.e, k, 0, &work.tmp) == FAILURE)
+                status = FAILURE;
+            else if (rn_cmp(&work.u, &N) > 0)
+                break;
+            else
+            {
+                rn_swap(r, &work.e);
+                rn_swap(&work.v, &work.u);
+            }
+        }
+        if (status == SUCCESS)
+            status = rn_sub(rem, &N, &work.v);
+    }
+    TRACE_END();
+
+    rn_free(&N);
+    rn_free(&one);
+    rn_free(&work.w);
+    rn_free(&work.u);
+    rn_free(&work.v);
+    rn_free(&work.x);
+    rn_free(&work.e);
+    rn_free(&work.tmp);
+    return status;
+}
+
+/* ============================================================================
+ * DIGIT LIST INTERFACE
+ * ============================================================================ */
+
+/**
+ * k-th root of a number stored in a double linked list, truncated toward
+ * zero (the floor for N >= 0), with remainder N - root^k
+ *
+ * @param head1: head of N
+ * @param tail1: tail of N
+ * @param sign1: sign of N (negative only with odd k)
+ * @param k: root degree, at least 1
+ * @param root_head: pointer to head pointer of the root (will be created)
+ * @param root_tail: pointer to tail pointer of the root (will be created)
+ * @param root_sign: receives the sign of the root
+ * @param rem_head: pointer to head pointer of the remainder, NULL to skip it
+ * @param rem_tail: pointer to tail pointer of the remainder
+ * @param rem_sign: receives the sign of the remainder (that of N)
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (lists left empty)
+ */
+int root_number(Dlist *head1, Dlist *tail1, int sign1, uint32_t k,
+                Dlist **root_head, Dlist **root_tail, int *root_sign,
+                Dlist **rem_head, Dlist **rem_tail, int *rem_sign)
+{
+    // Fail fast if N, the remainder digits and the Newton numbers cannot fit
+    size_t digits = (size_t)get_list_length(head1);
+    if (mem_check(digits * MEM_NODE_BYTES + (digits / 9 + 8) * 16 * sizeof(limb_t)) == FAILURE)
+        return FAILURE;
+
+    // Step 1: N to binary limbs
+    size_t count = 0;
+    radix_cache cache;
+    radix_cache_init(&cache, LIMB_BINARY_BASE);
+    TRACE_BEGIN("to_limbs", NULL, 0);
+    limb_t *limbs = list_to_binary(head1, tail1, &cache, &count);
+    TRACE_END();
+    radix_cache_free(&cache);
+
+    // Step 2: Root of |N|; an odd root of -N is minus the root of N
+    root_num r, rem;
+    rn_init(&r);
+    rn_init(&rem);
+    int status = (limbs != NULL) ? root_core(limbs, count, k, &r, &rem) : FAILURE;
+    *root_sign = (sign1 == -1 && r.n > 0) ? -1 : 1;
+    if (rem_sign != NULL)
+        *rem_sign = (sign1 == -1 && rem.n > 0) ? -1 : 1;
+
+    // Step 3: Back to decimal digits
+    TRACE_BEGIN("to_list", NULL, 0);
+    if (status == SUCCESS)
+        status = binary_to_list(r.d, r.n, root_head, root_tail);
+    if (status == SUCCESS && rem_head != NULL)
+        status = binary_to_list(rem.d, rem.n, rem_head, rem_tail);
+    TRACE_END();
+    if (status == FAILURE)
+        dl_delete_list(root_head, root_tail);
+
+    free(limbs);
+    rn_free(&r);
+    rn_free(&rem);
+    return status;
+}
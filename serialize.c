@@ -0,0 +1,455 @@
+#include "apc.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * BINARY NUMBER FORMAT (.apcn)
+ * Stores a number as raw limbs instead of comma formatted decimal text.
+ *
+ * Layout (all fields little endian, 32 byte header):
+ *   offset  0  char[4]   magic "APCN"
+ *   offset  4  uint16    format version (APCN_VERSION)
+ *   offset  6  uint8     sign (0 = positive, 1 = negative)
+ *   offset  7  uint8     reserved (0)
+ *   offset  8  uint32    limb base (APCN_DECIMAL_BASE = 10^8 per limb)
+ *   offset 12  uint32    reserved (0)
+ *   offset 16  uint64    limb count
+ *   offset 24  uint64    checksum of the payload (see payload_checksum)
+ *   offset 32  uint32[]  limbs, least significant first, each < base
+ *
+ * The payload starts 4-byte aligned, so a mapped file can be read in place.
+ * Zero is stored as a single 0 limb; otherwise the top limb is non-zero.
+ * ============================================================================ */
+
+#define APCN_MAGIC          "APCN"
+#define APCN_HEADER_SIZE    32
+#define APCN_WRITE_LIMBS    16384   // Limbs buffered per write() call
+#define APCN_CHECKSUM_SEED  0xcbf29ce484222325ULL  // FNV-1a 64-bit offset basis
+
+/* ----------------------------------------------------------------------------
+ * apcn_header: in-memory copy of the on-disk header
+ * ---------------------------------------------------------------------------- */
+typedef struct apcn_header
+{
+    char magic[4];          // "APCN"
+    uint16_t version;       // APCN_VERSION
+    uint8_t sign;           // 0 positive, 1 negative
+    uint8_t reserved1;      // Always 0
+    uint32_t base;          // Value of one limb position
+    uint32_t reserved2;     // Always 0
+    uint64_t limb_count;    // Number of payload limbs
+    uint64_t checksum;      // payload_checksum() of the limbs
+} apcn_header;
+
+/**
+ * Check whether this machine stores integers little endian
+ * (the file layout can then be used in place without byte swapping)
+ * @return: 1 if little endian, 0 otherwise
+ */
+static int host_is_little_endian(void)
+{
+    uint16_t probe = 1;
+    return *(uint8_t *)&probe == 1;
+}
+
+/**
+ * Continue a payload checksum over more limbs
+ * FNV-1a applied per 32-bit limb (one multiply per limb, so it keeps up with I/O)
+ * @param hash: running value (start with APCN_CHECKSUM_SEED)
+ * @param limbs: limbs to add
+ * @param count: number of limbs
+ * @return: updated checksum
+ */
+static uint64_t payload_checksum(uint64_t hash, const uint32_t *limbs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        hash ^= limbs[i];
+        hash *= 0x100000001b3ULL; // FNV-1a 64-bit prime
+    }
+    return hash;
+}
+
+/**
+ * Encode the header into its 32 byte little endian file form
+ * @param header: header to encode
+ * @param bytes: destination (APCN_HEADER_SIZE bytes)
+ */
+static void encode_header(const apcn_header *header, uint8_t *bytes)
+{
+    memset(bytes, 0, APCN_HEADER_SIZE);
+    memcpy(bytes, header->magic, 4);
+    bytes[4] = (uint8_t)(header->version & 0xFF);
+    bytes[5] = (uint8_t)(header->version >> 8);
+    bytes[6] = header->sign;
+    for (int i = 0; i < 4; i++)
+        bytes[8 + i] = (uint8_t)(header->base >> (8 * i));
+    for (int i = 0; i < 8; i++)
+    {
+        bytes[16 + i] = (uint8_t)(header->limb_count >> (8 * i));
+        bytes[24 + i] = (uint8_t)(header->checksum >> (8 * i));
+    }
+}
+
+/**
+ * Decode a 32 byte file header
+ * @param bytes: header bytes from the file
+ * @param header: receives the decoded fields
+ */
+static void decode_header(const uint8_t *bytes, apcn_header *header)
+{
+    memcpy(header->magic, bytes, 4);
+    header->version = (uint16_t)(bytes[4] | (bytes[5] << 8));
+    header->sign = bytes[6];
+    header->reserved1 = bytes[7];
+    header->base = 0;
+    header->reserved2 = 0;
+    header->limb_count = 0;
+    header->checksum = 0;
+    for (int i = 0; i < 4; i++)
+        header->base |= (uint32_t)bytes[8 + i] << (8 * i);
+    for (int i = 0; i < 8; i++)
+    {
+        header->limb_count |= (uint64_t)bytes[16 + i] << (8 * i);
+        header->checksum |= (uint64_t)bytes[24 + i] << (8 * i);
+    }
+}
+
+/**
+ * Check whether a buffer starts with the binary number magic
+ * @param data: start of the file contents
+ * @param length: number of bytes available
+ * @return: 1 if the data is an .apcn file, 0 otherwise
+ */
+int is_binary_number(const void *data, size_t length)
+{
+    return length >= APCN_HEADER_SIZE && memcmp(data, APCN_MAGIC, 4) == 0;
+}
+
+/* ============================================================================
+ * SAVING
+ * ============================================================================ */
+
+/**
+ * Write every buffered byte, retrying short writes
+ * @param fd: destination file
+ * @param data: bytes to write
+ * @param length: number of bytes
+ * @return: SUCCESS or FAILURE
+ */
+static int write_all(int fd, const void *data, size_t length)
+{
+    const char *p = data;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, p, length);
+        if (written <= 0)
+            return FAILURE;
+        p += written;
+        length -= (size_t)written;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Checksum and write a block of limbs in file (little endian) order
+ * @param fd: destination file
+ * @param limbs: limbs to write (byte swapped in place on big endian hosts)
+ * @param count: number of limbs
+ * @param checksum: running payload checksum (updated)
+ * @return: SUCCESS or FAILURE
+ */
+static int flush_limbs(int fd, uint32_t *limbs, size_t count, uint64_t *checksum)
+{
+    *checksum = payload_checksum(*checksum, limbs, count); // Checksum covers limb values
+    if (!host_is_little_endian())
+        for (size_t i = 0; i < count; i++)
+            limbs[i] = __builtin_bswap32(limbs[i]);
+    return write_all(fd, limbs, count * sizeof(uint32_t));
+}
+
+/**
+ * Save a number in the binary format
+ * Digits are packed into limbs while walking the list once from the tail;
+ * the header (with the checksum) is written last
+ * @param path: destination file (created or truncated)
+ * @param head: head of the number (only used to detect zero)
+ * @param tail: tail of the number (packing starts here)
+ * @param sign: +1 or -1
+ * @return: SUCCESS, or FILE_OPEN_ERROR / FAILURE on I/O or memory errors
+ */
+int save_number(const char *path, Dlist *head, Dlist *tail, int sign)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return FILE_OPEN_ERROR;
+
+    uint32_t *buffer = malloc(APCN_WRITE_LIMBS * sizeof(uint32_t));
+    if (buffer == NULL)
+    {
+        close(fd);
+        return FAILURE;
+    }
+
+    // Step 1: Reserve room for the header
+    uint8_t header_bytes[APCN_HEADER_SIZE] = {0};
+    int status = write_all(fd, header_bytes, APCN_HEADER_SIZE);
+
+    // Step 2: Pack 8 digits per limb from the least significant end
+    uint64_t limb_count = 0;
+    uint64_t checksum = APCN_CHECKSUM_SEED;
+    size_t buffered = 0;
+    uint32_t limb = 0, scale = 1;
+    int digits_in_limb = 0;
+
+    for (Dlist *node = tail; status == SUCCESS && node != NULL; node = node->prev)
+    {
+        limb += (uint32_t)node->data * scale;
+        scale *= 10;
+        if (++digits_in_limb == APCN_DECIMAL_DIGITS || node->prev == NULL)
+        {
+            buffer[buffered++] = limb;
+            limb = 0;
+            scale = 1;
+            digits_in_limb = 0;
+            if (buffered == APCN_WRITE_LIMBS)
+            {
+                status = flush_limbs(fd, buffer, buffered, &checksum);
+                limb_count += buffered;
+                buffered = 0;
+            }
+        }
+    }
+    if (status == SUCCESS && limb_count == 0 && buffered == 0)
+        buffer[buffered++] = 0; // Empty list is stored as zero
+    if (status == SUCCESS && buffered > 0)
+    {
+        status = flush_limbs(fd, buffer, buffered, &checksum);
+        limb_count += buffered;
+    }
+
+    // Step 3: Fill in the header now that count and checksum are known
+    if (status == SUCCESS)
+    {
+        apcn_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, APCN_MAGIC, 4);
+        header.version = APCN_VERSION;
+        header.sign = (sign == -1 && !is_zero(head)) ? 1 : 0;
+        header.base = APCN_DECIMAL_BASE;
+        header.limb_count = limb_count;
+        header.checksum = checksum;
+        encode_header(&header, header_bytes);
+        if (pwrite(fd, header_bytes, APCN_HEADER_SIZE, 0) != APCN_HEADER_SIZE)
+            status = FAILURE;
+    }
+
+    free(buffer);
+    if (close(fd) != 0)
+        status = FAILURE;
+    return status;
+}
+
+/* ============================================================================
+ * LOADING (ZERO COPY)
+ * ============================================================================ */
+
+/**
+ * Map a binary number file and use its payload in place
+ * @param path: .apcn file
+ * @param num: receives the mapped view (release with unmap_number)
+ * @return: SUCCESS, FILE_OPEN_ERROR if unreadable, FAILURE if the file is
+ *          malformed, of an unknown version, or fails its checksum
+ */
+int map_number(const char *path, mapped_number *num)
+{
+    memset(num, 0, sizeof(*num));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return FILE_OPEN_ERROR;
+    struct stat info;
+    if (fstat(fd, &info) < 0)
+    {
+        close(fd);
+        return FILE_OPEN_ERROR;
+    }
+    if ((size_t)info.st_size < APCN_HEADER_SIZE)
+    {
+        close(fd);
+        return FAILURE;
+    }
+
+    size_t length = (size_t)info.st_size;
+    void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return FILE_OPEN_ERROR;
+
+    int status = map_number_buffer(map, length, num);
+    if (status != SUCCESS)
+    {
+        munmap(map, length);
+        return status;
+    }
+    num->map = map;
+    num->map_length = length;
+    return SUCCESS;
+}
+
+/**
+ * Validate an .apcn image already in memory and point a view at its payload
+ * @param data: file contents (must stay valid while num is used)
+ * @param length: number of bytes
+ * @param num: receives the view (limbs point into data; nothing is copied
+ *             except on big endian hosts, where owned is set)
+ * @return: SUCCESS or FAILURE
+ */
+int map_number_buffer(const void *data, size_t length, mapped_number *num)
+{
+    memset(num, 0, sizeof(*num));
+    if (!is_binary_number(data, length))
+        return FAILURE;
+
+    apcn_header header;
+    decode_header(data, &header);
+    if (header.version != APCN_VERSION || header.base != APCN_DECIMAL_BASE ||
+        header.sign > 1 || header.limb_count == 0 ||
+        header.limb_count > (length - APCN_HEADER_SIZE) / sizeof(uint32_t))
+        return FAILURE;
+
+    const uint32_t *limbs = (const uint32_t *)((const uint8_t *)data + APCN_HEADER_SIZE);
+    size_t count = (size_t)header.limb_count;
+
+    if (!host_is_little_endian()) // Rare: swap into an owned copy
+    {
+        uint32_t *copy = malloc(count * sizeof(uint32_t));
+        if (copy == NULL)
+            return FAILURE;
+        const uint8_t *bytes = (const uint8_t *)limbs;
+        for (size_t i = 0; i < count; i++)
+            copy[i] = (uint32_t)bytes[4 * i] | ((uint32_t)bytes[4 * i + 1] << 8) |
+                      ((uint32_t)bytes[4 * i + 2] << 16) | ((uint32_t)bytes[4 * i + 3] << 24);
+        limbs = copy;
+        num->owned = copy;
+    }
+
+    if (payload_checksum(APCN_CHECKSUM_SEED, limbs, count) != header.checksum)
+    {
+        free(num->owned);
+        num->owned = NULL;
+        return FAILURE; // Corrupted or truncated payload
+    }
+
+    num->sign = header.sign ? -1 : 1;
+    num->limbs = limbs;
+    num->count = count;
+    return SUCCESS;
+}
+
+/**
+ * Release a mapped number
+ * @param num: view returned by map_number
+ */
+void unmap_number(mapped_number *num)
+{
+    if (num->map != NULL)
+        munmap(num->map, num->map_length);
+    free(num->owned);
+    memset(num, 0, sizeof(*num));
+}
+
+/**
+ * Build a digit list from a mapped number (for use with the list arithmetic)
+ * @param num: mapped number
+ * @param head: pointer to head pointer (will be created)
+ * @param tail: pointer to tail pointer (will be created)
+ * @return: SUCCESS, FAILURE (limb out of range) or MEMORY_ERROR; list left empty on error
+ */
+int mapped_to_list(const mapped_number *num, Dlist **head, Dlist **tail)
+{
+    *head = NULL;
+    *tail = NULL;
+    size_t top = num->count;
+    while (top > 1 && num->limbs[top - 1] == 0)
+        top--; // Tolerate stray zero limbs at the top
+    if (mem_check(top * APCN_DECIMAL_DIGITS * MEM_NODE_BYTES) == FAILURE)
+        return MEMORY_ERROR; // Fail fast: the digits cannot fit in the budget
+
+    for (size_t i = top; i-- > 0;) // Most significant limb first
+    {
+        uint32_t limb = num->limbs[i];
+        if (limb >= APCN_DECIMAL_BASE)
+        {
+            dl_delete_list(head, tail);
+            return FAILURE;
+        }
+        char digits[APCN_DECIMAL_DIGITS];
+        for (int d = APCN_DECIMAL_DIGITS - 1; d >= 0; d--) // Unpack 8 digits
+        {
+            digits[d] = (char)(limb % 10);
+            limb /= 10;
+        }
+        int start = 0;
+        if (i == top - 1) // Top limb: no leading zeros (keep one for zero)
+            while (start < APCN_DECIMAL_DIGITS - 1 && digits[start] == 0)
+                start++;
+        for (int d = start; d < APCN_DECIMAL_DIGITS; d++)
+        {
+            if (dl_insert_last(head, tail, digits[d]) == FAILURE)
+            {
+                dl_delete_list(head, tail);
+                return MEMORY_ERROR;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Print a mapped number as plain decimal text straight from its limbs
+ * (no digit list is built)
+ * @param num: mapped number
+ * @param out: output stream
+ * @return: SUCCESS or FAILURE
+ */
+int print_mapped_number(const mapped_number *num, FILE *out)
+{
+    size_t top = num->count;
+    while (top > 1 && num->limbs[top - 1] == 0)
+        top--;
+
+    // Sign + digits + newline, converted in one buffer and written once
+    size_t size = top * APCN_DECIMAL_DIGITS + 3;
+    char *text = malloc(size);
+    if (text == NULL)
+        return FAILURE;
+
+    size_t pos = 0;
+    int zero = (top == 1 && num->limbs[0] == 0);
+    if (num->sign == -1 && !zero)
+        text[pos++] = '-';
+    for (size_t i = top; i-- > 0;)
+    {
+        uint32_t limb = num->limbs[i];
+        char digits[APCN_DECIMAL_DIGITS];
+        for (int d = APCN_DECIMAL_DIGITS - 1; d >= 0; d--)
+        {
+            digits[d] = (char)('0' + limb % 10);
+            limb /= 10;
+        }
+        int start = 0;
+        if (i == top - 1)
+            while (start < APCN_DECIMAL_DIGITS - 1 && digits[start] == '0')
+                start++;
+        memcpy(text + pos, digits + start, APCN_DECIMAL_DIGITS - start);
+        pos += APCN_DECIMAL_DIGITS - start;
+    }
+    text[pos++] = '\n';
+
+    int status = (fwrite(text, 1, pos, out) == pos) ? SUCCESS : FAILURE;
+    free(text);
+    return status;
+}
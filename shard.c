@@ -0,0 +1,188 @@
+#include "apc.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * SHARDED MULTIPLICATION (--shards=N)
+ * One large product spread over N worker processes. The coordinator places
+ * both operands in a POSIX shared memory segment, splits the longer one
+ * into N blocks and forks one worker per block; worker i computes
+ * block_i * b into its own slot of the segment and reports one status byte
+ * on a pipe. The coordinator then adds the block products at their offsets
+ * and propagates the carries.
+ *
+ * Each worker holds its own Karatsuba scratch, so the coordinator only
+ * needs the segment: operands, result and work spread over N memory
+ * budgets (and N address spaces). The segment and the pipes are all the
+ * workers share, which is the protocol a remote worker would speak.
+ *
+ * A forked child of a threaded process may only call async-signal-safe
+ * functions, and the workers call malloc, big_alloc and mem_charge. So
+ * nothing in the arithmetic core forks on its own: only a caller that
+ * knows it is single-threaded asks for shards (the CLI's a x b, through
+ * mul_number_sharded), never the library, batch workers or factorial.
+ * ============================================================================ */
+
+/**
+ * Shared segment bytes shard_mul needs (for the memory budget)
+ * @param an: limbs of the longer operand
+ * @param bn: limbs of the shorter operand
+ * @param shards: workers
+ * @return: bytes of operands plus block products
+ */
+size_t shard_bytes(size_t an, size_t bn, int shards)
+{
+    return (2 * an + ((size_t)shards + 1) * bn) * sizeof(limb_t);
+}
+
+/**
+ * Create and map an anonymous POSIX shared memory segment
+ * The name is unlinked at once: the mapping survives fork, the name does not
+ * @param bytes: segment size
+ * @return: mapping, or NULL
+ */
+static void *segment_create(size_t bytes)
+{
+    static unsigned sequence; // Unique names for concurrent products
+    char name[64];
+    int fd = -1;
+    for (int attempt = 0; attempt < 16 && fd < 0; attempt++)
+    {
+        snprintf(name, sizeof(name), "/apc-shard-%ld-%u", (long)getpid(),
+                 __atomic_add_fetch(&sequence, 1, __ATOMIC_RELAXED));
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno != EEXIST)
+            return NULL;
+    }
+    if (fd < 0)
+        return NULL;
+    shm_unlink(name);
+
+    void *segment = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0)
+        segment = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (segment == MAP_FAILED) ? NULL : segment;
+}
+
+/**
+ * Worker body: out = block * b, then one status byte on the pipe
+ * Runs in the forked child and never returns
+ */
+static void shard_worker(int fd, limb_t *out, const limb_t *block, size_t len,
+                         const limb_t *b, size_t bn, uint64_t base)
+{
+    // Karatsuba scratch of this block, against the worker's own budget
+    size_t scratch = 6 * ((len < bn) ? len : bn) * sizeof(limb_t);
+    char status = FAILURE;
+    if (mem_charge(scratch) == SUCCESS)
+    {
+        status = (char)limb_mul(out, block, len, b, bn, base);
+        mem_uncharge(scratch);
+    }
+    ssize_t written = write(fd, &status, 1);
+    _exit(written == 1 ? 0 : 1); // No atexit handlers or stdio flush: they belong to the parent
+}
+
+/**
+ * r = a * b on limbs, with the block products computed by worker processes
+ * @param r: an + bn limbs (must not overlap a or b)
+ * @param shards: workers to use (at most SHARD_MAX_WORKERS, at most one per limb of a)
+ * @return: SUCCESS, or FAILURE if memory, a fork or a worker failed
+ */
+int shard_mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn,
+              uint64_t base, int shards)
+{
+    if (an < bn) // Split the longer operand
+    {
+        const limb_t *t = a; a = b; b = t;
+        size_t tn = an; an = bn; bn = tn;
+    }
+    if (shards > SHARD_MAX_WORKERS)
+        shards = SHARD_MAX_WORKERS;
+    if ((size_t)shards > an)
+        shards = (int)an;
+    if (shards < 2 || bn == 0)
+        return limb_mul(r, a, an, b, bn, base);
+
+    // Step 1: Operands and one product slot per block in the shared segment
+    size_t bytes = shard_bytes(an, bn, shards);
+    limb_t *segment = segment_create(bytes);
+    if (segment == NULL)
+        return FAILURE;
+    TRACE_BEGIN("shard_mul", "shards", shards);
+    limb_t *shared_a = segment, *shared_b = segment + an, *slots = segment + an + bn;
+    memcpy(shared_a, a, an * sizeof(limb_t));
+    memcpy(shared_b, b, bn * sizeof(limb_t));
+
+    // Step 2: One worker per block (block i starts at limb i * an / shards)
+    pid_t pids[SHARD_MAX_WORKERS];
+    int pipes[SHARD_MAX_WORKERS];
+    int started = 0;
+    int status = SUCCESS;
+    fflush(NULL); // Nothing buffered may be written twice
+    for (; started < shards; started++)
+    {
+        size_t from = (size_t)started * an / (size_t)shards;
+        size_t to = (size_t)(started + 1) * an / (size_t)shards;
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            status = FAILURE;
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            shard_worker(fds[1], slots + from + (size_t)started * bn, shared_a + from, to - from,
+                         shared_b, bn, base);
+        }
+        close(fds[1]);
+        if (pid < 0)
+        {
+            close(fds[0]);
+            status = FAILURE;
+            break;
+        }
+        pids[started] = pid;
+        pipes[started] = fds[0];
+    }
+
+    // Step 3: Collect every status byte (EOF without one: the worker died)
+    for (int i = 0; i < started; i++)
+    {
+        char worker_status = FAILURE;
+        ssize_t got;
+        do
+            got = read(pipes[i], &worker_status, 1);
+        while (got < 0 && errno == EINTR);
+        if (got != 1 || worker_status != SUCCESS)
+            status = FAILURE;
+        close(pipes[i]);
+        while (waitpid(pids[i], NULL, 0) < 0 && errno == EINTR)
+            ;
+    }
+
+    // Step 4: Add the block products at their offsets; blocks are added in
+    // order, so everything above the current one is still zero and its carry
+    // lands in a single limb
+    if (status == SUCCESS)
+    {
+        memset(r, 0, (an + bn) * sizeof(limb_t));
+        for (int i = 0; i < shards; i++)
+        {
+            size_t from = (size_t)i * an / (size_t)shards;
+            size_t length = (size_t)(i + 1) * an / (size_t)shards - from + bn;
+            limb_t carry = limb_add(r + from, r + from, length, slots + from + (size_t)i * bn, length, base);
+            if (from + length < an + bn)
+                r[from + length] = carry;
+        }
+    }
+    munmap(segment, bytes);
+    TRACE_END();
+    return status;
+}
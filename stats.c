@@ -0,0 +1,134 @@
+#include "apc.h"
+#include <time.h>
+
+/* ============================================================================
+ * STATISTICS
+ * Counters for --stats. Built with -DAPC_STATS (make STATS=1) the STATS_*
+ * macros in apc.h count into thread_stats; without it they expand to nothing
+ * and only the functions below remain, reporting that nothing was counted.
+ *
+ * Most counters are thread local so the digit loops never share a cache line.
+ * Live and peak nodes are process wide atomics instead: a node may be freed
+ * by a different thread than the one that allocated it, and a peak can only
+ * be measured on the true total.
+ * ============================================================================ */
+
+static apc_stats process_stats;     // Flushed thread counters (guarded by atomics)
+
+#ifdef APC_STATS
+__thread apc_stats thread_stats;
+
+/**
+ * Count one Dlist node allocation and raise the peak if needed
+ */
+void stats_node_alloc(void)
+{
+    thread_stats.allocations++;
+    int64_t live = __atomic_add_fetch(&process_stats.live_nodes, 1, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&process_stats.peak_nodes, __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&process_stats.peak_nodes, &peak, live, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ; // peak was reloaded by the failed exchange
+}
+
+/**
+ * Count one Dlist node free
+ */
+void stats_node_free(void)
+{
+    thread_stats.frees++;
+    __atomic_sub_fetch(&process_stats.live_nodes, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+/**
+ * Whether the counters are compiled in
+ * @return: 1 with APC_STATS, 0 otherwise
+ */
+int stats_enabled(void)
+{
+#ifdef APC_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Monotonic clock for phase timing
+ * @return: nanoseconds since an arbitrary fixed point
+ */
+uint64_t stats_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Add the calling thread's counters to the process total and reset them
+ * Every thread that did work must call this before stats_print.
+ */
+void stats_flush(void)
+{
+#ifdef APC_STATS
+    __atomic_add_fetch(&process_stats.allocations, thread_stats.allocations, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&process_stats.frees, thread_stats.frees, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&process_stats.digit_ops, thread_stats.digit_ops, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&process_stats.limb_ops, thread_stats.limb_ops, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&process_stats.div_rounds, thread_stats.div_rounds, __ATOMIC_RELAXED);
+    for (int i = 0; i < PHASE_COUNT; i++)
+        __atomic_add_fetch(&process_stats.phase_ns[i], thread_stats.phase_ns[i], __ATOMIC_RELAXED);
+    memset(&thread_stats, 0, sizeof(thread_stats));
+#endif
+}
+
+/**
+ * Print the process totals (after stats_flush)
+ * @param out: stream to write to (the CLI uses stderr)
+ * @param json: nonzero for one JSON object, zero for aligned text
+ */
+void stats_print(FILE *out, int json)
+{
+    static const char *phase_names[PHASE_COUNT] = { "parse", "compute", "format" };
+    apc_stats s = process_stats; // Workers have joined, a plain copy is enough
+    uint64_t total_ns = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+        total_ns += s.phase_ns[i];
+
+    if (json)
+    {
+        fprintf(out, "{\"enabled\":%s,\"allocations\":%llu,\"frees\":%llu,"
+                     "\"live_nodes\":%lld,\"peak_nodes\":%lld,\"peak_bytes\":%lld,"
+                     "\"digit_ops\":%llu,\"limb_ops\":%llu,\"div_rounds\":%llu,\"phases_ns\":{",
+                stats_enabled() ? "true" : "false",
+                (unsigned long long)s.allocations, (unsigned long long)s.frees,
+                (long long)s.live_nodes, (long long)s.peak_nodes,
+                (long long)(s.peak_nodes * (int64_t)sizeof(Dlist)),
+                (unsigned long long)s.digit_ops, (unsigned long long)s.limb_ops,
+                (unsigned long long)s.div_rounds);
+        for (int i = 0; i < PHASE_COUNT; i++)
+            fprintf(out, "\"%s\":%llu,", phase_names[i], (unsigned long long)s.phase_ns[i]);
+        fprintf(out, "\"total\":%llu}}\n", (unsigned long long)total_ns);
+        return;
+    }
+
+    if (!stats_enabled())
+    {
+        fprintf(out, "📊 Statistics are not compiled in (rebuild with: make clean && make STATS=1)\n");
+        return;
+    }
+    fprintf(out, "📊 Statistics\n");
+    fprintf(out, "   Node allocations : %llu\n", (unsigned long long)s.allocations);
+    fprintf(out, "   Node frees       : %llu\n", (unsigned long long)s.frees);
+    fprintf(out, "   Live nodes       : %lld\n", (long long)s.live_nodes);
+    fprintf(out, "   Peak nodes       : %lld (%lld bytes)\n", (long long)s.peak_nodes,
+            (long long)(s.peak_nodes * (int64_t)sizeof(Dlist)));
+    fprintf(out, "   Digit operations : %llu\n", (unsigned long long)s.digit_ops);
+    fprintf(out, "   Limb products    : %llu\n", (unsigned long long)s.limb_ops);
+    fprintf(out, "   Division rounds  : %llu\n", (unsigned long long)s.div_rounds);
+    for (int i = 0; i < PHASE_COUNT; i++)
+        fprintf(out, "   %-7s time     : %.3f ms\n", phase_names[i], s.phase_ns[i] / 1e6);
+    fprintf(out, "   Total time       : %.3f ms\n", total_ns / 1e6);
+}
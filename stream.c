@@ -0,0 +1,563 @@
+#include "apc.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * OUT-OF-CORE STREAMING OPERATIONS
+ * Addition, subtraction and comparison on numbers stored in text files that
+ * may be larger than memory. Operands are never turned into Dlists: they are
+ * read in fixed-size chunks (backwards from the least significant end for
+ * add/sub, forwards for compare) and the result is written straight into the
+ * output file at its final position, so memory use is a few chunks.
+ *
+ * Output layout is decided before the backward pass: a short forward scan
+ * predicts the final carry of an addition, and the comparison done before a
+ * subtraction tells how many leading digits cancel. Only the rare extra
+ * leading zeros produced by a borrow need a compaction pass at the end.
+ * ============================================================================ */
+
+#define STREAM_CHUNK (1 << 20)  // Bytes per read/write (1 MiB)
+
+/* ----------------------------------------------------------------------------
+ * stream_operand: a number inside a text file
+ * Digits of the magnitude are the bytes [start, end); start == end means 0
+ * ---------------------------------------------------------------------------- */
+typedef struct stream_operand
+{
+    int fd;         // Open file
+    int sign;       // +1 or -1
+    off_t start;    // Offset of the first significant digit
+    off_t end;      // One past the last digit (trailing whitespace excluded)
+} stream_operand;
+
+/* ----------------------------------------------------------------------------
+ * stream_reader: chunked reader over part of an operand, forwards or backwards
+ * ---------------------------------------------------------------------------- */
+typedef struct stream_reader
+{
+    const stream_operand *op;   // Operand being read
+    char *buf;                  // Chunk buffer (STREAM_CHUNK bytes)
+    off_t buf_start;            // File offset of buf[0]
+    size_t buf_len;             // Valid bytes in buf
+    off_t pos;                  // Next offset to read (backwards: one past it)
+    int failed;                 // 1 after a read error
+} stream_reader;
+
+/**
+ * Read exactly length bytes at offset (retrying short reads)
+ * @return: SUCCESS or FAILURE
+ */
+static int read_at(int fd, char *buf, size_t length, off_t offset)
+{
+    while (length > 0)
+    {
+        ssize_t got = pread(fd, buf, length, offset);
+        if (got <= 0)
+            return FAILURE;
+        buf += got;
+        length -= (size_t)got;
+        offset += got;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Write exactly length bytes at offset (retrying short writes)
+ * @return: SUCCESS or FAILURE
+ */
+static int write_at(int fd, const char *buf, size_t length, off_t offset)
+{
+    while (length > 0)
+    {
+        ssize_t put = pwrite(fd, buf, length, offset);
+        if (put <= 0)
+            return FAILURE;
+        buf += put;
+        length -= (size_t)put;
+        offset += put;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Open a text operand and locate its significant digits
+ * Skips the sign and leading zeros at the front and whitespace at the back
+ * @param path: file containing "[-]digits"
+ * @param op: receives the operand description
+ * @param buf: scratch chunk buffer
+ * @return: SUCCESS, FILE_OPEN_ERROR, or FAILURE if the file holds no digits
+ */
+static int open_operand(const char *path, stream_operand *op, char *buf)
+{
+    op->fd = open(path, O_RDONLY);
+    if (op->fd < 0)
+        return FILE_OPEN_ERROR;
+    struct stat info;
+    if (fstat(op->fd, &info) < 0)
+        return FILE_OPEN_ERROR;
+    off_t size = info.st_size;
+    op->sign = 1;
+
+    // Step 1: Drop trailing whitespace (reading backwards one chunk at a time)
+    off_t end = size;
+    int done = 0;
+    while (end > 0 && !done)
+    {
+        size_t length = (end > STREAM_CHUNK) ? STREAM_CHUNK : (size_t)end;
+        if (read_at(op->fd, buf, length, end - (off_t)length) == FAILURE)
+            return FILE_OPEN_ERROR;
+        size_t i = length;
+        while (i > 0 && (buf[i - 1] == '\n' || buf[i - 1] == '\r' ||
+                         buf[i - 1] == ' ' || buf[i - 1] == '\t'))
+            i--;
+        end -= (off_t)(length - i);
+        done = (i > 0);
+    }
+
+    // Step 2: Optional minus sign, then leading zeros
+    off_t start = 0;
+    if (end > 0)
+    {
+        char first;
+        if (read_at(op->fd, &first, 1, 0) == FAILURE)
+            return FILE_OPEN_ERROR;
+        if (first == '-')
+        {
+            op->sign = -1;
+            start = 1;
+        }
+    }
+    if (start >= end)
+        return FAILURE; // Empty file or just "-"
+
+    done = 0;
+    while (start < end && !done)
+    {
+        size_t length = (end - start > STREAM_CHUNK) ? STREAM_CHUNK : (size_t)(end - start);
+        if (read_at(op->fd, buf, length, start) == FAILURE)
+            return FILE_OPEN_ERROR;
+        size_t i = 0;
+        while (i < length && buf[i] == '0')
+            i++;
+        start += (off_t)i;
+        done = (i < length);
+    }
+
+    op->start = start;
+    op->end = end;
+    return SUCCESS;
+}
+
+/**
+ * Number of significant digits of an operand (0 for zero)
+ */
+static off_t operand_length(const stream_operand *op)
+{
+    return op->end - op->start;
+}
+
+/**
+ * Next digit walking backwards from the least significant end
+ * Returns 0 once the operand is exhausted (shorter operand is zero padded)
+ * @param reader: backward reader (pos starts at op->end)
+ * @return: digit 0-9, or -1 on an invalid byte or read error
+ */
+static int next_digit_backward(stream_reader *reader)
+{
+    if (reader->pos <= reader->op->start)
+        return 0; // Exhausted: pad with zeros
+    if (reader->pos <= reader->buf_start) // Refill with the previous chunk
+    {
+        off_t from = reader->pos - STREAM_CHUNK;
+        if (from < reader->op->start)
+            from = reader->op->start;
+        reader->buf_len = (size_t)(reader->pos - from);
+        reader->buf_start = from;
+        if (read_at(reader->op->fd, reader->buf, reader->buf_len, from) == FAILURE)
+        {
+            reader->failed = 1;
+            return -1;
+        }
+    }
+    reader->pos--;
+    char c = reader->buf[reader->pos - reader->buf_start];
+    return (c >= '0' && c <= '9') ? c - '0' : -1;
+}
+
+/**
+ * Next digit walking forwards from the most significant end
+ * @param reader: forward reader (pos starts at op->start)
+ * @return: digit 0-9, or -1 on an invalid byte, read error or end of digits
+ */
+static int next_digit_forward(stream_reader *reader)
+{
+    if (reader->pos >= reader->op->end)
+        return -1;
+    if (reader->pos >= reader->buf_start + (off_t)reader->buf_len) // Refill with next chunk
+    {
+        off_t remaining = reader->op->end - reader->pos;
+        reader->buf_len = (remaining > STREAM_CHUNK) ? STREAM_CHUNK : (size_t)remaining;
+        reader->buf_start = reader->pos;
+        if (read_at(reader->op->fd, reader->buf, reader->buf_len, reader->pos) == FAILURE)
+        {
+            reader->failed = 1;
+            return -1;
+        }
+    }
+    char c = reader->buf[reader->pos - reader->buf_start];
+    reader->pos++;
+    return (c >= '0' && c <= '9') ? c - '0' : -1;
+}
+
+/**
+ * Position a reader at the start (forward) or end (backward) of an operand
+ */
+static void reader_init(stream_reader *reader, const stream_operand *op, char *buf, int backward)
+{
+    reader->op = op;
+    reader->buf = buf;
+    reader->buf_len = 0;
+    reader->failed = 0;
+    reader->pos = backward ? op->end : op->start;
+    reader->buf_start = reader->pos; // Empty buffer: first access refills
+}
+
+/* ============================================================================
+ * FORWARD SCANS
+ * ============================================================================ */
+
+/**
+ * Compare magnitudes of two operands: lengths first, then a forward scan
+ * Every digit is validated when the lengths are equal
+ * @param a: first operand
+ * @param b: second operand
+ * @param buf1: chunk buffer for a
+ * @param buf2: chunk buffer for b
+ * @param equal_prefix: receives the number of equal leading digits (may be NULL)
+ * @param result: receives -1, 0 or 1 for |a| <, ==, > |b|
+ * @return: SUCCESS, or FAILURE on an invalid digit / read error
+ */
+static int compare_magnitudes(const stream_operand *a, const stream_operand *b,
+                              char *buf1, char *buf2, off_t *equal_prefix, int *result)
+{
+    off_t len1 = operand_length(a), len2 = operand_length(b);
+    if (equal_prefix != NULL)
+        *equal_prefix = 0;
+    if (len1 != len2)
+    {
+        *result = (len1 > len2) ? 1 : -1;
+        return SUCCESS;
+    }
+
+    stream_reader r1, r2;
+    reader_init(&r1, a, buf1, 0);
+    reader_init(&r2, b, buf2, 0);
+    *result = 0;
+    for (off_t i = 0; i < len1; i++)
+    {
+        int d1 = next_digit_forward(&r1);
+        int d2 = next_digit_forward(&r2);
+        if (d1 < 0 || d2 < 0)
+            return FAILURE;
+        if (d1 != d2)
+        {
+            if (equal_prefix != NULL)
+                *equal_prefix = i;
+            *result = (d1 > d2) ? 1 : -1;
+            return SUCCESS;
+        }
+    }
+    if (equal_prefix != NULL)
+        *equal_prefix = len1;
+    return SUCCESS;
+}
+
+/**
+ * Predict whether |a| + |b| carries out of the top digit
+ * Scans from the top: a column sum > 9 decides "carry", < 9 decides "no
+ * carry", and 9 defers to the next column. Usually stops after a few digits.
+ * @return: 1 if the sum has one more digit than the longer operand, 0 if not,
+ *          -1 on an invalid digit / read error
+ */
+static int predict_carry(const stream_operand *a, const stream_operand *b, char *buf1, char *buf2)
+{
+    off_t len1 = operand_length(a), len2 = operand_length(b);
+    off_t max_len = (len1 > len2) ? len1 : len2;
+    stream_reader r1, r2;
+    reader_init(&r1, a, buf1, 0);
+    reader_init(&r2, b, buf2, 0);
+
+    for (off_t i = 0; i < max_len; i++)
+    {
+        int d1 = (i >= max_len - len1) ? next_digit_forward(&r1) : 0; // Align at the low end
+        int d2 = (i >= max_len - len2) ? next_digit_forward(&r2) : 0;
+        if (d1 < 0 || d2 < 0)
+            return -1;
+        if (d1 + d2 > 9)
+            return 1;
+        if (d1 + d2 < 9)
+            return 0;
+    }
+    return 0; // All columns sum to 9: no carry comes in from below
+}
+
+/* ============================================================================
+ * BACKWARD PASS
+ * ============================================================================ */
+
+/**
+ * Add (subtract = 0) or subtract (subtract = 1) magnitudes, least significant first,
+ * writing each result digit at out_offset + (digits - 1 - i)
+ * For subtraction |big| >= |small| must hold.
+ * @param big: first operand (larger one for subtraction)
+ * @param small: second operand
+ * @param subtract: 0 for big + small, 1 for big - small
+ * @param out_fd: output file
+ * @param out_offset: file offset of the most significant result digit
+ * @param digits: number of result digit positions to write
+ * @param top_nonzero: receives the index (from the low end) of the highest non-zero digit, -1 if zero
+ * @return: SUCCESS or FAILURE (invalid digit or I/O error)
+ */
+static int backward_pass(const stream_operand *big, const stream_operand *small, int subtract,
+                         int out_fd, off_t out_offset, off_t digits, off_t *top_nonzero,
+                         char *buf1, char *buf2, char *out_buf)
+{
+    stream_reader r1, r2;
+    reader_init(&r1, big, buf1, 1);
+    reader_init(&r2, small, buf2, 1);
+    off_t len1 = operand_length(big), len2 = operand_length(small);
+    off_t active = (len1 > len2) ? len1 : len2; // Positions fed by operand digits
+
+    int carry = 0;              // Carry (add) or borrow (subtract)
+    size_t filled = 0;          // Digits waiting in out_buf (stored at the end of out_buf)
+    off_t write_end = out_offset + digits; // File offset just after the lowest buffered digit
+    *top_nonzero = -1;
+
+    for (off_t i = 0; i < digits; i++)
+    {
+        int digit;
+        if (i < active)
+        {
+            int d1 = next_digit_backward(&r1);
+            int d2 = next_digit_backward(&r2);
+            if (d1 < 0 || d2 < 0)
+                return FAILURE;
+            if (subtract)
+            {
+                digit = d1 - d2 - carry;
+                carry = (digit < 0);
+                if (carry)
+                    digit += 10;
+            }
+            else
+            {
+                digit = d1 + d2 + carry;
+                carry = (digit > 9);
+                if (carry)
+                    digit -= 10;
+            }
+        }
+        else
+        {
+            digit = carry; // Final carry of an addition (0 for subtraction)
+            carry = 0;
+        }
+        if (digit != 0)
+            *top_nonzero = i;
+
+        out_buf[STREAM_CHUNK - 1 - filled] = (char)('0' + digit);
+        filled++;
+        if (filled == STREAM_CHUNK) // Flush the chunk to its final place
+        {
+            if (write_at(out_fd, out_buf, filled, write_end - (off_t)filled) == FAILURE)
+                return FAILURE;
+            write_end -= (off_t)filled;
+            filled = 0;
+        }
+    }
+    if (filled > 0 && write_at(out_fd, out_buf + STREAM_CHUNK - filled, filled,
+                                write_end - (off_t)filled) == FAILURE)
+        return FAILURE;
+    return SUCCESS;
+}
+
+/**
+ * Move length bytes from offset from to offset to (to < from) chunk by chunk
+ * @return: SUCCESS or FAILURE
+ */
+static int shift_left(int fd, off_t from, off_t to, off_t length, char *buf)
+{
+    while (length > 0)
+    {
+        size_t part = (length > STREAM_CHUNK) ? STREAM_CHUNK : (size_t)length;
+        if (read_at(fd, buf, part, from) == FAILURE || write_at(fd, buf, part, to) == FAILURE)
+            return FAILURE;
+        from += (off_t)part;
+        to += (off_t)part;
+        length -= (off_t)part;
+    }
+    return SUCCESS;
+}
+
+/* ============================================================================
+ * PUBLIC ENTRY POINTS
+ * ============================================================================ */
+
+/**
+ * Compare two numbers stored in text files without loading them
+ * @param path1: first number
+ * @param path2: second number
+ * @param result: receives -1, 0 or 1 for first <, ==, > second (signed comparison)
+ * @return: SUCCESS, FILE_OPEN_ERROR, or FAILURE if a file is not a valid number
+ */
+int stream_compare(const char *path1, const char *path2, int *result)
+{
+    stream_operand a = { -1, 1, 0, 0 }, b = { -1, 1, 0, 0 };
+    char *buf1 = malloc(STREAM_CHUNK), *buf2 = malloc(STREAM_CHUNK);
+    int status = (buf1 != NULL && buf2 != NULL) ? SUCCESS : FAILURE;
+
+    if (status == SUCCESS)
+        status = open_operand(path1, &a, buf1);
+    if (status == SUCCESS)
+        status = open_operand(path2, &b, buf1);
+    if (status == SUCCESS)
+    {
+        off_t len_a = operand_length(&a), len_b = operand_length(&b);
+        off_t max_len = (len_a > len_b) ? len_a : len_b;
+        int sign_a = (len_a == 0) ? 0 : a.sign, sign_b = (len_b == 0) ? 0 : b.sign;
+
+        // One forward pass: lengths decide unless equal, every digit is validated
+        int magnitude = (len_a == len_b) ? 0 : ((len_a > len_b) ? 1 : -1);
+        stream_reader r1, r2;
+        reader_init(&r1, &a, buf1, 0);
+        reader_init(&r2, &b, buf2, 0);
+        for (off_t i = 0; status == SUCCESS && i < max_len; i++)
+        {
+            int d1 = (i < len_a) ? next_digit_forward(&r1) : 0;
+            int d2 = (i < len_b) ? next_digit_forward(&r2) : 0;
+            if (d1 < 0 || d2 < 0)
+                status = FAILURE;
+            else if (magnitude == 0 && d1 != d2)
+                magnitude = (d1 > d2) ? 1 : -1; // First difference decides
+        }
+
+        if (sign_a != sign_b)
+            *result = (sign_a > sign_b) ? 1 : -1;
+        else
+            *result = (sign_a == -1) ? -magnitude : magnitude;
+    }
+
+    if (a.fd >= 0)
+        close(a.fd);
+    if (b.fd >= 0)
+        close(b.fd);
+    free(buf1);
+    free(buf2);
+    return status;
+}
+
+/**
+ * Add or subtract two numbers stored in text files, writing the result file
+ * Memory use is four STREAM_CHUNK buffers regardless of operand size
+ * @param path1: first number
+ * @param operator: '+' or '-'
+ * @param path2: second number
+ * @param out_path: result file ("[-]digits\n"), created or truncated
+ * @return: SUCCESS, FILE_OPEN_ERROR, or FAILURE (invalid operand or I/O error;
+ *          the output file is removed)
+ */
+int stream_add_sub(const char *path1, char operator, const char *path2, const char *out_path)
+{
+    stream_operand a = { -1, 1, 0, 0 }, b = { -1, 1, 0, 0 };
+    char *buf1 = malloc(STREAM_CHUNK), *buf2 = malloc(STREAM_CHUNK);
+    char *out_buf = malloc(STREAM_CHUNK);
+    int out_fd = -1;
+    int status = (buf1 != NULL && buf2 != NULL && out_buf != NULL) ? SUCCESS : FAILURE;
+
+    if (status == SUCCESS)
+        status = open_operand(path1, &a, buf1);
+    if (status == SUCCESS)
+        status = open_operand(path2, &b, buf1);
+    if (status == SUCCESS)
+    {
+        out_fd = open(out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0)
+            status = FILE_OPEN_ERROR;
+    }
+
+    if (status == SUCCESS)
+    {
+        // Step 1: Decide between adding and subtracting magnitudes (main.c, Step 5)
+        int sign_b = (operator == '-') ? -b.sign : b.sign;
+        const stream_operand *big = &a, *small = &b;
+        int subtract = (a.sign != sign_b);
+        int result_sign = a.sign;
+        off_t digits;           // Result digit positions written by the backward pass
+        off_t len_a = operand_length(&a), len_b = operand_length(&b);
+
+        if (!subtract)
+        {
+            // Step 2a: Addition - a forward scan tells whether the top carries
+            int carry = predict_carry(&a, &b, buf1, buf2);
+            if (carry < 0)
+                status = FAILURE;
+            digits = ((len_a > len_b) ? len_a : len_b) + (carry > 0);
+        }
+        else
+        {
+            // Step 2b: Subtraction - compare, keep the larger first, skip equal leading digits
+            int magnitude;
+            off_t equal_prefix;
+            status = compare_magnitudes(&a, &b, buf1, buf2, &equal_prefix, &magnitude);
+            if (magnitude < 0)
+            {
+                big = &b;
+                small = &a;
+                result_sign = sign_b;
+            }
+            digits = operand_length(big) - ((len_a == len_b) ? equal_prefix : 0);
+        }
+
+        // Step 3: Backward pass writes the digits after an optional sign byte
+        off_t top_nonzero = -1;
+        if (status == SUCCESS)
+        {
+            off_t prefix = (result_sign == -1) ? 1 : 0;
+            status = backward_pass(big, small, subtract, out_fd, prefix, digits,
+                                   &top_nonzero, buf1, buf2, out_buf);
+            if (status == SUCCESS && top_nonzero < 0) // Result is zero
+            {
+                status = write_at(out_fd, "0\n", 2, 0);
+                if (status == SUCCESS && ftruncate(out_fd, 2) != 0)
+                    status = FAILURE;
+            }
+            else if (status == SUCCESS)
+            {
+                // Step 4: Drop leading zeros left by a borrow (rare), then add sign and newline
+                off_t length = top_nonzero + 1;
+                if (length < digits)
+                    status = shift_left(out_fd, prefix + (digits - length), prefix, length, buf1);
+                if (status == SUCCESS && prefix)
+                    status = write_at(out_fd, "-", 1, 0);
+                if (status == SUCCESS)
+                    status = write_at(out_fd, "\n", 1, prefix + length);
+                if (status == SUCCESS && ftruncate(out_fd, prefix + length + 1) != 0)
+                    status = FAILURE;
+            }
+        }
+    }
+
+    if (out_fd >= 0 && close(out_fd) != 0)
+        status = FAILURE;
+    if (status != SUCCESS && out_fd >= 0)
+        unlink(out_path); // Never leave a half written result behind
+    if (a.fd >= 0)
+        close(a.fd);
+    if (b.fd >= 0)
+        close(b.fd);
+    free(buf1);
+    free(buf2);
+    free(out_buf);
+    return status;
+}
@@ -0,0 +1,392 @@
+#!/bin/sh
+# ============================================================================
+# BEHAVIOUR TESTS
+# Runs ./a.out on known inputs and compares what it prints with reference
+# values. Run from the repository root after make (make test does both).
+# Exit status 0 when every check passes, 1 otherwise.
+# ============================================================================
+
+APC=${APC:-./a.out}
+WORK=$(mktemp -d) || exit 1
+trap 'rm -rf "$WORK"' EXIT
+
+checks=0
+failures=0
+
+# check NAME EXPECTED COMMAND...: the output (stdout and stderr) must be EXPECTED
+check()
+{
+    name=$1
+    expected=$2
+    shift 2
+    actual=$("$@" 2>&1)
+    checks=$((checks + 1))
+    if [ "$actual" != "$expected" ]; then
+        failures=$((failures + 1))
+        printf '❌ %s\n   expected: %.200s\n   actual:   %.200s\n' "$name" "$expected" "$actual"
+    fi
+}
+
+# check_fails NAME MESSAGE COMMAND...: exit status 1 and MESSAGE somewhere in the output
+check_fails()
+{
+    name=$1
+    message=$2
+    shift 2
+    actual=$("$@" 2>&1)
+    status=$?
+    checks=$((checks + 1))
+    case "$actual" in
+        *"$message"*) found=1 ;;
+        *) found=0 ;;
+    esac
+    if [ $status -ne 1 ] || [ $found -ne 1 ]; then
+        failures=$((failures + 1))
+        printf '❌ %s\n   expected status 1 and: %s\n   got status %d: %.200s\n' "$name" "$message" $status "$actual"
+    fi
+}
+
+# check_file NAME EXPECTED_FILE COMMAND...: stdout must equal the file
+check_file()
+{
+    name=$1
+    expected=$2
+    shift 2
+    checks=$((checks + 1))
+    if ! "$@" > "$WORK/actual" 2>&1 || ! cmp -s "$WORK/actual" "$expected"; then
+        failures=$((failures + 1))
+        printf '❌ %s\n   output differs from %s\n' "$name" "$expected"
+    fi
+}
+
+# repeat DIGITS COUNT: DIGITS written COUNT times, no newline
+repeat()
+{
+    head -c "$2" /dev/zero | tr '\0' 'x' | sed "s/x/$1/g" | tr -d '\n'
+}
+
+# ----------------------------------------------------------------------------
+# Batch mode (--batch --threads=4): 6000 lines, past the 4 x 1024 slot reorder
+# window, with 4000-digit products and quotients for idle workers to steal
+# around and per-line errors that must not stop the run
+# ----------------------------------------------------------------------------
+big=$(repeat 9 4000)
+big_squared="$(repeat 9 3999)8$(repeat 0 3999)1"
+big_quotient="1$(repeat 0 3999)1"
+: > "$WORK/batch_lines"
+: > "$WORK/batch_expected"
+i=1
+while [ $i -le 6000 ]; do
+    case $i in
+        1500) printf '12a + 1\n' >> "$WORK/batch_lines"
+              printf 'error: invalid operand\n' >> "$WORK/batch_expected" ;;
+        3500) printf '1 / 0\n' >> "$WORK/batch_lines"
+              printf 'error: division by zero\n' >> "$WORK/batch_expected" ;;
+        *000) printf '%s x %s\n' "$big" "$big" >> "$WORK/batch_lines"
+              printf '%s\n' "$big_squared" >> "$WORK/batch_expected" ;;
+        *250) printf '%s%s / %s\n' "$big" "$big" "$big" >> "$WORK/batch_lines"
+              printf '%s 0\n' "$big_quotient" >> "$WORK/batch_expected" ;;
+        *) printf '%d + -%d0\n' $i $i >> "$WORK/batch_lines"
+           printf '%d\n' $((i - 10 * i)) >> "$WORK/batch_expected" ;;
+    esac
+    i=$((i + 1))
+done
+check_file "batch in input order" "$WORK/batch_expected"  "$APC" --batch "$WORK/batch_lines" --threads=4
+
+# ----------------------------------------------------------------------------
+# Binary .apcn files (--save, --print, @file.apcn)
+# ----------------------------------------------------------------------------
+check "save"                   "-123456789012345678901000" \
+      "$APC" --plain -123456789012345678901 x 1000 "--save=$WORK/r.apcn"
+check "print saved"            "-123456789012345678901000"  "$APC" "--print=$WORK/r.apcn"
+check "saved operand"          "-123456789012345678900999"  "$APC" --plain "@$WORK/r.apcn" + 1
+check "save zero"              "0"               "$APC" --plain 5 - 5 "--save=$WORK/zero.apcn"
+check "print saved zero"       "0"               "$APC" "--print=$WORK/zero.apcn"
+cp "$WORK/r.apcn" "$WORK/corrupt.apcn"
+printf '\007' | dd of="$WORK/corrupt.apcn" bs=1 seek=40 conv=notrunc 2>/dev/null
+check_fails "corrupt file"     "is not a readable binary number file"  "$APC" "--print=$WORK/corrupt.apcn"
+check_fails "unwritable save"  "cannot save result"  "$APC" --plain 5 x 5 "--save=$WORK/missing/r.apcn"
+
+# ----------------------------------------------------------------------------
+# Out-of-core streaming (--stream); 2.5M digits cross several 1 MiB chunks
+# ----------------------------------------------------------------------------
+repeat 9 2500000 > "$WORK/big_nines"
+printf 1 > "$WORK/one"
+printf -- -1 > "$WORK/minus_one"
+{ printf 1; repeat 0 2500000; printf '\n'; } > "$WORK/big_power"
+"$APC" --stream "@$WORK/big_nines" + "@$WORK/one" "--out=$WORK/sum" > /dev/null
+check_file "stream carry"      "$WORK/big_power"  cat "$WORK/sum"
+{ repeat 9 2500000; printf '\n'; } > "$WORK/big_nines_line"
+"$APC" --stream "@$WORK/big_power" - "@$WORK/one" "--out=$WORK/difference" > /dev/null
+check_file "stream borrow"     "$WORK/big_nines_line"  cat "$WORK/difference"
+"$APC" --stream "@$WORK/big_power" + "@$WORK/minus_one" "--out=$WORK/mixed" > /dev/null
+check_file "stream mixed signs" "$WORK/big_nines_line"  cat "$WORK/mixed"
+"$APC" --stream "@$WORK/one" - "@$WORK/big_power" "--out=$WORK/negative" > /dev/null
+{ printf -- -; repeat 9 2500000; printf '\n'; } > "$WORK/big_nines_negative"
+check_file "stream negative result" "$WORK/big_nines_negative"  cat "$WORK/negative"
+"$APC" --stream "@$WORK/big_nines" - "@$WORK/big_nines" "--out=$WORK/zero" > /dev/null
+check "stream zero"            "0"               cat "$WORK/zero"
+check "stream cmp equal"       "0"               "$APC" --stream "@$WORK/big_nines" cmp "@$WORK/big_nines"
+check "stream cmp less"        "-1"              "$APC" --stream "@$WORK/big_nines" cmp "@$WORK/big_power"
+check "stream cmp signs"       "1"               "$APC" --stream "@$WORK/one" cmp "@$WORK/minus_one"
+check_fails "stream without out" "needs --out=FILE"  "$APC" --stream "@$WORK/one" + "@$WORK/one"
+check_fails "stream literal"   "Usage"           "$APC" --stream 1 + "@$WORK/one" "--out=$WORK/x"
+
+# ----------------------------------------------------------------------------
+# Integer operators
+# ----------------------------------------------------------------------------
+check "add"                    "579"             "$APC" --plain 123 + 456
+check "add carry"              "1000000000000"   "$APC" --plain 999999999999 + 1
+check "add mixed signs"        "-2"              "$APC" --plain -5 + 3
+check "subtract below zero"    "-150"            "$APC" --plain 100 - 250
+check "subtract negatives"     "3"               "$APC" --plain -2 - -5
+check "multiply"               "121932631112635269" "$APC" --plain 123456789 x 987654321
+check "multiply upper X"       "-144"            "$APC" --plain -12 X 12
+check "multiply by zero"       "0"               "$APC" --plain 0 x -5
+check "divide"                 "3 2"             "$APC" --plain 17 / 5
+check "divide negative"        "-3 -2"           "$APC" --plain -17 / 5
+check "divide by negative"     "-3 2"            "$APC" --plain 17 / -5
+check "divide small by large"  "0 7"             "$APC" --plain 7 / 12345678901234567890
+check "divide large"           "81000000729000006633900104 1124939929531498447216119" \
+      "$APC" --plain 99999999999999999999999999999999999999999999999999 / 1234567890123456789012345
+check "leading zeros"          "42"              "$APC" --plain 00040 + 0002
+check_fails "divide by zero"   "Cannot divide by zero"  "$APC" --plain 1 / 0
+check_fails "invalid operand"  "is not a valid number (byte 2)"  "$APC" --plain 12a + 1
+check_fails "invalid operator" "Invalid operation: '%'"  "$APC" --plain 1 % 2
+check_fails "missing operand"  "Usage"           "$APC" --plain 1 +
+
+# Long operands: (10^n - 1)^2 = 9...980...01 exercises the limb tiers
+repeat 9 3000 > "$WORK/nines"
+{ repeat 9 2999; printf 8; repeat 0 2999; printf '1\n'; } > "$WORK/nines_squared"
+check_file "long multiply"     "$WORK/nines_squared"    "$APC" --plain "@$WORK/nines" x "@$WORK/nines"
+{ repeat 9 3000; printf ' 0\n'; } > "$WORK/nines_quotient"
+check_file "long divide"       "$WORK/nines_quotient"   "$APC" --plain "@$WORK/nines_squared" / "@$WORK/nines"
+
+# ----------------------------------------------------------------------------
+# Memory budget (--mem-limit, APC_MEM_LIMIT, --mem-report)
+# ----------------------------------------------------------------------------
+repeat 7 60000 > "$WORK/sevens"
+check_fails "limit on operand" "not enough memory for the operand" \
+      "$APC" --plain "@$WORK/sevens" x "@$WORK/sevens" --mem-limit=100K
+check_fails "limit on result"  "not enough memory for the result" \
+      "$APC" --plain "@$WORK/sevens" x "@$WORK/sevens" --mem-limit=5M
+check_fails "limit from environment" "Memory limit is 10240 bytes" \
+      env APC_MEM_LIMIT=10K "$APC" --plain "@$WORK/sevens" + 1
+check_fails "invalid limit"    "Invalid memory limit 'abc'"  "$APC" --plain 1 x 1 --mem-limit=abc
+check "within limit"           "144"             "$APC" --plain 12 x 12 --mem-limit=1M
+check "report shows no leak"   "💾 Memory: peak 240 bytes, live 0 bytes, limit 1048576 bytes" \
+      sh -c "\"\$0\" --plain 12 x 12 --mem-limit=1M --mem-report 2>&1 >/dev/null | head -n 1" "$APC"
+
+# ----------------------------------------------------------------------------
+# powmod (Montgomery, sliding window, --ct ladder)
+# ----------------------------------------------------------------------------
+check "powmod"                 "445"             "$APC" --plain powmod 4 13 497
+check "powmod 2^127 - 1"       "157177706870098212273838327430033220740" \
+      "$APC" --plain powmod 515377520732011331036461129765621272702107522001 1000000000000000000000000000007 \
+      170141183460469231731687303715884105727
+check "powmod even modulus"    "64922883132974933589" \
+      "$APC" --plain powmod 123456789 987654321 100000000000000000000
+check "powmod negative base"   "7"               "$APC" --plain powmod -2 5 13
+check "powmod modulus one"     "0"               "$APC" --plain powmod 3 2 1
+check "powmod --ct"            "157177706870098212273838327430033220740" \
+      "$APC" --plain powmod 515377520732011331036461129765621272702107522001 1000000000000000000000000000007 \
+      170141183460469231731687303715884105727 --ct
+check_fails "powmod negative exponent" "exponent must not be negative"  "$APC" --plain powmod 2 -1 7
+check_fails "powmod zero modulus" "modulus must be positive"  "$APC" --plain powmod 2 5 0
+check_fails "powmod --ct even" "--ct needs an odd modulus"  "$APC" --plain powmod 4 13 496 --ct
+
+# ----------------------------------------------------------------------------
+# gcd and xgcd (Lehmer / half-gcd)
+# ----------------------------------------------------------------------------
+check "gcd"                    "6"               "$APC" --plain gcd 48 -18
+check "gcd zeros"              "0"               "$APC" --plain gcd 0 0
+check "gcd large"              "991" \
+      "$APC" --plain gcd 1592475601860659363062084433510092139099503166838747699795897511 \
+      2566610120688675811178649327867419620721563897403508269355934219578227603313
+# gcd(10^600 - 1, 10^400 - 1) = 10^200 - 1, with half-GCD forced down to 4 limbs
+check "gcd half-gcd"           "$(repeat 9 200)" \
+      env APC_HGCD_THRESHOLD=4 "$APC" --plain gcd "$(repeat 9 600)" "$(repeat 9 400)"
+check "xgcd"                   "2 -9 47"         "$APC" --plain xgcd 240 46
+check "xgcd negative"          "2 9 47"          "$APC" --plain xgcd -240 46
+check "xgcd zero"              "5 0 1"           "$APC" --plain xgcd 0 5
+check_fails "gcd one operand"  "Usage"           "$APC" --plain gcd 5
+
+# ----------------------------------------------------------------------------
+# isqrt and iroot (root and remainder)
+# ----------------------------------------------------------------------------
+check "isqrt"                  "31 39"           "$APC" --plain isqrt 1000
+check "isqrt zero"             "0 0"             "$APC" --plain isqrt 0
+check "isqrt large"            "10000000000000000000000000 12345" \
+      "$APC" --plain isqrt 100000000000000000000000000000000000000000000012345
+check "iroot"                  "10 0"            "$APC" --plain iroot 1000 3
+check "iroot negative odd"     "-3 0"            "$APC" --plain iroot -27 3
+check "iroot large"            "1182576223761 15447273126432692720523325706415683841071848501435995846114184057903844080" \
+      "$APC" --plain iroot 3234476509624757991344647769100216810857203198904625400933895331391691459636928060001 7
+check "iroot largest K"        "1 0"             "$APC" --plain iroot 1 4294967295
+check "iroot largest K negative" "-1 0"          "$APC" --plain iroot -1 4294967295
+check "iroot K above bits"     "1 99"            "$APC" --plain iroot 100 10000000
+check "iroot K above bits, limit" "1 6"          "$APC" --plain iroot 7 300000000 --mem-limit=1M
+check_fails "isqrt negative"   "even root of a negative number"  "$APC" --plain isqrt -4
+check_fails "iroot even negative" "even root of a negative number"  "$APC" --plain iroot -16 2
+check_fails "iroot zero K"     "K must be between 1 and 4294967295"  "$APC" --plain iroot 16 0
+
+# ----------------------------------------------------------------------------
+# factorial, binomial and primorial (prime-power product trees)
+# ----------------------------------------------------------------------------
+check "factorial"              "2432902008176640000"  "$APC" --plain factorial 20
+check "factorial 30"           "265252859812191058636308480000000"  "$APC" --plain factorial 30
+check "factorial zero"         "1"               "$APC" --plain factorial 0
+check "factorial 1000"         "1818427119 2569" sh -c '"$0" --plain factorial 1000 | cksum' "$APC"
+check "binomial"               "126410606437752" "$APC" --plain binomial 50 25
+check "binomial 100 50"        "100891344545564193334812497256"  "$APC" --plain binomial 100 50
+check "binomial K above N"     "0"               "$APC" --plain binomial 5 9
+check "binomial 5000 2000"     "1876891459 1461" sh -c '"$0" --plain binomial 5000 2000 | cksum' "$APC"
+check "binomial near 2^32"     "4294967295"      "$APC" --plain binomial 4294967295 1
+check "binomial near 2^32, K 2" "9223372030412324865"  "$APC" --plain binomial 4294967295 2
+check "binomial near 2^32, top" "9223372030412324865"  "$APC" --plain binomial 4294967295 4294967293 --mem-limit=1M
+check "primorial"              "6469693230"      "$APC" --plain primorial 30
+check "primorial 100"          "2305567963945518424753102147331756070"  "$APC" --plain primorial 100
+check "primorial 1"            "1"               "$APC" --plain primorial 1
+check_fails "factorial negative" "must be between 0 and 4294967295"  "$APC" --plain factorial -1
+
+# ----------------------------------------------------------------------------
+# sum and product over a file (column sums, product tree)
+# ----------------------------------------------------------------------------
+printf '123456789012345678901234567890 -5\n  7\n-1000000000000000000000\t42\n' > "$WORK/list"
+check "sum"                    "123456788012345678901234567934"  "$APC" --plain sum "$WORK/list"
+check "product"                "181481479848148147984814814798300000000000000000000000" \
+      "$APC" --plain product "$WORK/list"
+check "sum stdin"              "123456788012345678901234567934" \
+      sh -c '"$0" --plain sum - < "$1"' "$APC" "$WORK/list"
+seq 1 1000 > "$WORK/one_to_thousand"
+check "product tree"           "1818427119 2569" \
+      sh -c '"$0" --plain product "$1" | cksum' "$APC" "$WORK/one_to_thousand"
+check "sum column carries"     "500500"          "$APC" --plain sum "$WORK/one_to_thousand"
+: > "$WORK/empty"
+check "sum empty"              "0"               "$APC" --plain sum "$WORK/empty"
+check "product empty"          "1"               "$APC" --plain product "$WORK/empty"
+printf '12 x3' > "$WORK/bad_list"
+check_fails "sum invalid"      "is not a list of valid numbers"  "$APC" --plain sum "$WORK/bad_list"
+check_fails "sum missing file" "cannot read"     "$APC" --plain sum "$WORK/missing"
+
+# ----------------------------------------------------------------------------
+# Digit windows (--low, --high)
+# ----------------------------------------------------------------------------
+check "low window"             "5269 18"         "$APC" --plain 123456789 x 987654321 --low=4
+check "high window"            "1219 18"         "$APC" --plain 123456789 x 987654321 --high=4
+check "low window negative"    "-08 3"           "$APC" --plain -12 x 34 --low=2
+check "low window of zeros"    "000 7"           "$APC" --plain -1001000 x 1 --low=3
+check "high window too wide"   "408 3"           "$APC" --plain 12 x 34 --high=10
+check "low window divide"      "-857 6"          "$APC" --plain -1000000 / 7 --low=3
+check "high window divide"     "14 6"            "$APC" --plain 1000000 / 7 --high=2
+check "long low window"        "00001 6000"      "$APC" --plain "@$WORK/nines" x "@$WORK/nines" --low=5
+check "long high window"       "99999 6000"      "$APC" --plain "@$WORK/nines" x "@$WORK/nines" --high=5
+check_fails "window add"       "Usage"           "$APC" --plain 12 + 34 --low=2
+check_fails "window zero"      "Invalid window size '0'"  "$APC" --plain 12 x 34 --low=0
+
+# ----------------------------------------------------------------------------
+# --verify (modular residue check) and options a mode cannot honour
+# ----------------------------------------------------------------------------
+check "verify multiply"        "408"             "$APC" --plain 12 x 34 --verify
+check "verify divide"          "-3 -2"           "$APC" --plain -17 / 5 --verify
+check "verify add"             "579"             "$APC" --plain 123 + 456 --verify
+check_file "verify long multiply" "$WORK/nines_squared" \
+      "$APC" --plain "@$WORK/nines" x "@$WORK/nines" --verify
+check_fails "verify window"    "--verify cannot be used with --low/--high"  "$APC" --plain 12 x 34 --verify --low=2
+check_fails "save window"      "--save cannot be used with --low/--high" \
+      "$APC" --plain 12 x 34 "--save=$WORK/w.apcn" --low=2
+check_fails "verify fractions" "--verify cannot be used with fractions"  "$APC" --plain 1/2 + 1/3 --verify
+check_fails "verify scale"     "--verify cannot be used with --scale"  "$APC" --plain 1 / 3 --scale=5 --verify
+check_fails "verify sum"       "--verify cannot be used with sum"  "$APC" --plain sum "$WORK/list" --verify
+check_fails "save powmod"      "--save cannot be used with powmod" \
+      "$APC" --plain powmod 4 13 497 "--save=$WORK/p.apcn"
+check_fails "ct gcd"           "--ct cannot be used with gcd"  "$APC" --plain gcd 4 6 --ct
+check_fails "verify stream"    "--verify cannot be used with --stream" \
+      "$APC" --stream "@$WORK/one" + "@$WORK/one" "--out=$WORK/x" --verify
+printf '12 x 34\n' > "$WORK/batch"
+check "batch"                  "408"             "$APC" --batch "$WORK/batch"
+check_fails "verify batch"     "--batch FILE [--threads=N]"  "$APC" --batch "$WORK/batch" --verify
+
+# ----------------------------------------------------------------------------
+# Sharded multiplication (--shards); operands over the 32768 digit cut-off
+# ----------------------------------------------------------------------------
+repeat 9 40000 > "$WORK/shard_nines"
+{ repeat 9 39999; printf 8; repeat 0 39999; printf '1\n'; } > "$WORK/shard_nines_squared"
+check_file "shards"            "$WORK/shard_nines_squared" \
+      "$APC" --plain "@$WORK/shard_nines" x "@$WORK/shard_nines" --shards=4
+{ printf -- -; repeat 1234567 6000; } > "$WORK/shard_pattern"
+"$APC" --plain "@$WORK/shard_pattern" x "@$WORK/shard_nines" --shards=1 > "$WORK/shard_single"
+check_file "shards odd count"  "$WORK/shard_single" \
+      "$APC" --plain "@$WORK/shard_pattern" x "@$WORK/shard_nines" --shards=3
+check "shards short operands"  "408"             "$APC" --plain 12 x 34 --shards=4
+check_fails "shards range"     "Invalid shard count '65'"  "$APC" --plain 12 x 34 --shards=65
+check_fails "shards add"       "--shards cannot be used with +"  "$APC" --plain 12 + 34 --shards=2
+check_fails "shards batch"     "--batch FILE [--threads=N]"  "$APC" --batch "$WORK/batch" --shards=2
+
+# ----------------------------------------------------------------------------
+# Fractions (p/q operands, exact results in lowest terms)
+# ----------------------------------------------------------------------------
+check "fraction add"           "5/6"             "$APC" --plain 1/2 + 1/3
+check "fraction multiply"      "-1/2"            "$APC" --plain -3/4 x 2/3
+check "fraction negative den"  "-3/2"            "$APC" --plain 6/-4 + 0/5
+check "fraction integer"       "1"               "$APC" --plain 1/2 + 1/2
+check "fraction zero"          "0"               "$APC" --plain 1/2 - 1/2
+check "fraction times integer" "3/2"             "$APC" --plain 2/4 x 3
+check_fails "fraction divide by zero" "Division by zero is not allowed"  "$APC" --plain 1/2 / 0
+check_fails "zero denominator" "'1/0' has a zero denominator"  "$APC" --plain 1/0 + 1
+
+# @path operands: the '/' of an absolute path must not select fractions
+printf '6\n' > "$WORK/six"
+printf -- '-4\n' > "$WORK/minus_four"
+check "path fraction operand"  "19/3"            "$APC" --plain "@$WORK/six" + 1/3
+check "fraction path operand"  "13/3"            "$APC" --plain 1/3 - "@$WORK/minus_four"
+check "path times fraction"    "3/2"             "$APC" --plain "@$WORK/six" x 1/4
+check "paths stay integer"     "-24"             "$APC" --plain "@$WORK/six" x "@$WORK/minus_four"
+check "paths divide"           "-1 2"            "$APC" --plain "@$WORK/six" / "@$WORK/minus_four"
+
+# ----------------------------------------------------------------------------
+# Fixed-point decimals (--scale, --round); each mode on ties and non-ties of both signs
+# ----------------------------------------------------------------------------
+# check_rounding MODE EXPECTED: 5/2 -5/2 7/2 -7/2 2/3 -2/3 rounded to 0 places
+check_rounding()
+{
+    mode=$1
+    expected=$2
+    actual=""
+    for operation in "5 / 2" "-5 / 2" "7 / 2" "-7 / 2" "2 / 3" "-2 / 3"; do
+        actual="$actual $("$APC" --plain $operation --scale=0 "--round=$mode" 2>&1)"
+    done
+    check "round $mode" "$expected" echo $actual
+}
+check_rounding down       "2 -2 3 -3 0 0"
+check_rounding up         "3 -3 4 -4 1 -1"
+check_rounding floor      "2 -3 3 -4 0 -1"
+check_rounding ceiling    "3 -2 4 -3 1 0"
+check_rounding half-up    "3 -3 4 -4 1 -1"
+check_rounding half-down  "2 -2 3 -3 1 -1"
+check_rounding half-even  "2 -2 4 -4 1 -1"
+check "scale divide"           "0.33333"         "$APC" --plain 1 / 3 --scale=5
+check "scale half-even"        "0.667"           "$APC" --plain 2 / 3 --scale=3 --round=half-even
+check "scale multiply tie"     "3.8"             "$APC" --plain 2.5 x 1.5 --scale=1 --round=half-even
+check "scale add tie"          "-2"              "$APC" --plain -2.5 + 0 --scale=0 --round=half-even
+check "scale decimal tie"      "1.2"             "$APC" --plain 1.25 x 1 --scale=1 --round=half-even
+check "scale negative to zero" "0.00"            "$APC" --plain -1 / 1000 --scale=2
+check "scale floor small"      "-0.01"           "$APC" --plain -1 / 1000 --scale=2 --round=floor
+check "scale padding"          "1.00"            "$APC" --plain 1.005 - 0 --scale=2 --round=half-down
+repeat 7 5000 > "$WORK/sevens_5000"
+repeat 3 2000 > "$WORK/threes_2000"
+check "scale Newton divide"    "612531295 4003" \
+      sh -c '"$0" --plain "@$1" / "@$2" --scale=1000 | cksum' "$APC" "$WORK/sevens_5000" "$WORK/threes_2000"
+check_fails "scale divide by zero" "Division by zero is not allowed"  "$APC" --plain 1 / 0 --scale=2
+check_fails "invalid rounding" "Invalid rounding 'bogus'"  "$APC" --plain 1 / 3 --scale=2 --round=bogus
+check_fails "invalid scale"    "Invalid scale '-1'"  "$APC" --plain 1 / 3 --scale=-1
+
+# ----------------------------------------------------------------------------
+# Summary
+# ----------------------------------------------------------------------------
+if [ $failures -ne 0 ]; then
+    printf '❌ %d of %d checks failed\n' $failures $checks
+    exit 1
+fi
+printf '✅ All %d checks passed\n' $checks
+exit 0
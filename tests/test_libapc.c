@@ -0,0 +1,491 @@
+#include "libapc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * LIBAPC TESTS
+ * Calls every entry point of libapc.h on known inputs and compares the
+ * results with reference values. Built and run by make test; exit status 0
+ * when every check passes, 1 otherwise.
+ * ============================================================================ */
+
+static int checks;      // Checks run
+static int failures;    // Checks that failed
+
+/**
+ * Record one check
+ * @param name: what was checked (printed on failure)
+ * @param ok: nonzero if the check passed
+ */
+static void check(const char *name, int ok)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("❌ %s\n", name);
+    }
+}
+
+/**
+ * Check the decimal text of a number
+ * @param name: what was checked
+ * @param num: number to format
+ * @param expected: its expected text
+ */
+static void check_text(const char *name, const apc_num *num, const char *expected)
+{
+    char text[512];
+    int status = apc_format(num, text, sizeof(text));
+    checks++;
+    if (status != APC_OK || strcmp(text, expected) != 0)
+    {
+        failures++;
+        printf("❌ %s\n   expected: %s\n   actual:   %s\n", name, expected,
+               (status == APC_OK) ? text : apc_strerror(status));
+    }
+}
+
+/**
+ * Parse text into a fresh handle (the tests own and free it)
+ */
+static apc_num *number(const char *text)
+{
+    apc_num *num = NULL;
+    if (apc_init(&num) != APC_OK || apc_parse(num, text) != APC_OK)
+    {
+        printf("❌ cannot create the test number %s\n", text);
+        exit(1);
+    }
+    return num;
+}
+
+/* ============================================================================
+ * INTEGERS
+ * ============================================================================ */
+
+static void test_integers(void)
+{
+    apc_num *a = number("123456789012345678901234567890");
+    apc_num *b = number("-987654321");
+    apc_num *r = number("0");
+    apc_num *q = number("0");
+
+    // Step 1: Arithmetic
+    check("add", apc_add(r, a, b) == APC_OK);
+    check_text("add", r, "123456789012345678900246913569");
+    check("sub", apc_sub(r, b, a) == APC_OK);
+    check_text("sub", r, "-123456789012345678902222222211");
+    check("mul", apc_mul(r, a, b) == APC_OK);
+    check_text("mul", r, "-121932631124828532112482853211126352690");
+    check("divmod", apc_divmod(q, r, a, b) == APC_OK);
+    check_text("divmod quotient", q, "-124999998873437499901");
+    check_text("divmod remainder", r, "574845669");
+    check("divmod without remainder", apc_divmod(q, NULL, a, b) == APC_OK);
+    check_text("divmod without remainder", q, "-124999998873437499901");
+
+    // Step 2: A result may be one of the operands
+    check("add in place", apc_add(a, a, a) == APC_OK);
+    check_text("add in place", a, "246913578024691357802469135780");
+    check("mul in place", apc_mul(b, b, b) == APC_OK);
+    check_text("mul in place", b, "975461057789971041");
+
+    // Step 3: Copies share digits but not values
+    check("copy", apc_copy(r, a) == APC_OK);
+    check("neg", apc_neg(q, r) == APC_OK);
+    check_text("neg", q, "-246913578024691357802469135780");
+    check("abs", apc_abs(r, q) == APC_OK);
+    check_text("abs", r, "246913578024691357802469135780");
+    check("add to a copy", apc_add(r, r, b) == APC_OK);
+    check_text("copy left alone", a, "246913578024691357802469135780");
+    check("sign", apc_sign(q) == -1 && apc_sign(a) == 1);
+
+    // Step 4: Text and errors
+    check("parse leading zeros", apc_parse(r, "-000120") == APC_OK);
+    check_text("parse leading zeros", r, "-120");
+    check("format length", apc_format_length(r) == 4);
+    char small[4];
+    check("buffer too small", apc_format(r, small, sizeof(small)) == APC_ERR_BUFFER);
+    check("parse error", apc_parse(r, "12x4") == APC_ERR_PARSE);
+    check("parse zero", apc_parse(r, "-0") == APC_OK && apc_sign(r) == 0);
+    check_text("negative zero", r, "0");
+    check("division by zero", apc_divmod(q, NULL, a, r) == APC_ERR_DIV_ZERO);
+    check("NULL handle", apc_add(NULL, a, a) == APC_ERR_INVALID);
+    check("strerror", strlen(apc_strerror(APC_ERR_NOMEM)) > 0);
+
+    // Step 5: Base 2^32 words
+    uint32_t *words = NULL;
+    size_t count = 0;
+    check("export", apc_parse(r, "-18446744073709551617") == APC_OK && apc_export(r, &words, &count) == APC_OK);
+    check("export words", count == 3 && words[0] == 1 && words[1] == 0 && words[2] == 1);
+    check("import", apc_import(q, words, count, -1) == APC_OK);
+    check_text("import", q, "-18446744073709551617");
+    free(words);
+
+    apc_free(a);
+    apc_free(b);
+    apc_free(r);
+    apc_free(q);
+}
+
+/* ============================================================================
+ * FILES
+ * ============================================================================ */
+
+static void test_files(void)
+{
+    char path[] = "/tmp/test_libapc_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        check("temporary file", 0);
+        return;
+    }
+    close(fd);
+    apc_num *a = number("-98765432109876543210987654321");
+    apc_num *r = number("0");
+
+    // Step 1: Binary .apcn round trip
+    check("save", apc_save(a, path) == APC_OK);
+    check("parse binary file", apc_parse_file(r, path) == APC_OK);
+    check_text("parse binary file", r, "-98765432109876543210987654321");
+
+    // Step 2: Decimal text file
+    FILE *file = fopen(path, "w");
+    if (file != NULL)
+    {
+        fputs("000123456789\n", file);
+        fclose(file);
+    }
+    check("parse text file", apc_parse_file(r, path) == APC_OK);
+    check_text("parse text file", r, "123456789");
+    check("missing file", apc_parse_file(r, "/nonexistent/number.apcn") == APC_ERR_IO);
+
+    // Step 3: Out-of-core arithmetic on text files
+    char other[] = "/tmp/test_libapc_XXXXXX";
+    fd = mkstemp(other);
+    if (fd >= 0)
+    {
+        close(fd);
+        file = fopen(other, "w");
+        if (file != NULL)
+        {
+            fputs("-999999999999999999999\n", file);
+            fclose(file);
+        }
+        char out[] = "/tmp/test_libapc_XXXXXX";
+        fd = mkstemp(out);
+        if (fd >= 0)
+            close(fd);
+        int order = 0;
+        check("file compare", apc_file_compare(path, other, &order) == APC_OK && order == 1);
+        check("file add", apc_file_add(path, other, out) == APC_OK && apc_parse_file(r, out) == APC_OK);
+        check_text("file add", r, "-999999999999876543210");
+        check("file sub", apc_file_sub(path, other, out) == APC_OK && apc_parse_file(r, out) == APC_OK);
+        check_text("file sub", r, "1000000000000123456788");
+
+        // Step 4: Reductions over a list of numbers
+        file = fopen(other, "w");
+        if (file != NULL)
+        {
+            fputs("123456789012345678901234567890 -5\n  7\n-1000000000000000000000\t42\n", file);
+            fclose(file);
+        }
+        check("sum file", apc_sum_file(r, other) == APC_OK);
+        check_text("sum file", r, "123456788012345678901234567934");
+        check("product file", apc_product_file(r, other) == APC_OK);
+        check_text("product file", r, "181481479848148147984814814798300000000000000000000000");
+        unlink(other);
+        unlink(out);
+    }
+
+    unlink(path);
+    apc_free(a);
+    apc_free(r);
+}
+
+/* ============================================================================
+ * MEMORY BUDGET
+ * ============================================================================ */
+
+static void test_memory(void)
+{
+    char *sevens = malloc(80001);
+    if (sevens == NULL)
+    {
+        check("sevens", 0);
+        return;
+    }
+    memset(sevens, '7', 80000);
+    sevens[80000] = '\0';
+    apc_num *a = number(sevens);
+    apc_num *r = number("0");
+    free(sevens);
+
+    // Step 1: Over the limit an operation fails up front and leaves its result alone
+    size_t live = 0, peak = 0;
+    apc_mem_usage(&live, &peak);
+    check("usage", live > 0 && peak >= live);
+    apc_set_mem_limit(live + 4096);
+    check("over the limit", apc_mul(r, a, a) == APC_ERR_NOMEM);
+    check_text("result untouched", r, "0");
+
+    // Step 2: Lifting it lets the same operation through
+    apc_set_mem_limit(0);
+    check("without a limit", apc_mul(r, a, a) == APC_OK && apc_format_length(r) == 160000);
+
+    apc_free(a);
+    apc_free(r);
+}
+
+/* ============================================================================
+ * MODULAR POWERS
+ * ============================================================================ */
+
+static void test_powmod(void)
+{
+    apc_num *base = number("515377520732011331036461129765621272702107522001"); // 3^100
+    apc_num *exp = number("1000000000000000000000000000007");
+    apc_num *mod = number("170141183460469231731687303715884105727");        // 2^127 - 1
+    apc_num *r = number("0");
+
+    check("powmod", apc_powmod(r, base, exp, mod) == APC_OK);
+    check_text("powmod", r, "157177706870098212273838327430033220740");
+    check("powmod_sec", apc_powmod_sec(r, base, exp, mod) == APC_OK);
+    check_text("powmod_sec", r, "157177706870098212273838327430033220740");
+    check("powmod negative exponent", apc_parse(exp, "-7") == APC_OK && apc_powmod(r, base, exp, mod) == APC_ERR_INVALID);
+
+    apc_free(base);
+    apc_free(exp);
+    apc_free(mod);
+    apc_free(r);
+}
+
+/* ============================================================================
+ * GCD
+ * ============================================================================ */
+
+static void test_gcd(void)
+{
+    apc_num *a = number("1592475601860659363062084433510092139099503166838747699795897511");
+    apc_num *b = number("-2566610120688675811178649327867419620721563897403508269355934219578227603313");
+    apc_num *g = number("0");
+    apc_num *s = number("0");
+    apc_num *t = number("0");
+
+    check("gcd", apc_gcd(g, a, b) == APC_OK);
+    check_text("gcd", g, "991");
+    check("xgcd", apc_parse(a, "240") == APC_OK && apc_parse(b, "46") == APC_OK && apc_xgcd(g, s, t, a, b) == APC_OK);
+    check_text("xgcd g", g, "2");
+    check_text("xgcd s", s, "-9");
+    check_text("xgcd t", t, "47");
+
+    apc_free(a);
+    apc_free(b);
+    apc_free(g);
+    apc_free(s);
+    apc_free(t);
+}
+
+/* ============================================================================
+ * ROOTS
+ * ============================================================================ */
+
+static void test_roots(void)
+{
+    apc_num *n = number("100000000000000000000000000000000000000000000012345");
+    apc_num *r = number("0");
+    apc_num *rem = number("0");
+
+    check("isqrt", apc_isqrt(r, rem, n) == APC_OK);
+    check_text("isqrt root", r, "10000000000000000000000000");
+    check_text("isqrt remainder", rem, "12345");
+    check("iroot", apc_parse(n, "-27") == APC_OK && apc_iroot(r, NULL, n, 3) == APC_OK);
+    check_text("iroot", r, "-3");
+    check("iroot even negative", apc_iroot(r, NULL, n, 2) == APC_ERR_INVALID);
+    check("iroot largest k", apc_parse(n, "12345678901234567890") == APC_OK
+                             && apc_iroot(r, rem, n, 4294967295UL) == APC_OK);
+    check_text("iroot largest k root", r, "1");
+    check_text("iroot largest k remainder", rem, "12345678901234567889");
+
+    apc_free(n);
+    apc_free(r);
+    apc_free(rem);
+}
+
+/* ============================================================================
+ * FACTORIALS
+ * ============================================================================ */
+
+static void test_factorials(void)
+{
+    apc_num *r = number("0");
+
+    check("factorial", apc_factorial(r, 30) == APC_OK);
+    check_text("factorial", r, "265252859812191058636308480000000");
+    check("binomial", apc_binomial(r, 100, 50) == APC_OK);
+    check_text("binomial", r, "100891344545564193334812497256");
+    check("binomial near 2^32", apc_binomial(r, 4294967295UL, 3) == APC_OK);
+    check_text("binomial near 2^32", r, "13204693733930645533088546815");
+    check("binomial K above N", apc_binomial(r, 5, 9) == APC_OK && apc_sign(r) == 0);
+    check("primorial", apc_primorial(r, 100) == APC_OK);
+    check_text("primorial", r, "2305567963945518424753102147331756070");
+
+    apc_free(r);
+}
+
+/* ============================================================================
+ * RATIONALS
+ * ============================================================================ */
+
+/**
+ * Check the "p/q" text of a fraction
+ * @param name: what was checked
+ * @param q: fraction to format (reduced first)
+ * @param expected: its expected text
+ */
+static void check_rat(const char *name, apc_rat *q, const char *expected)
+{
+    char text[512];
+    int status = apc_rat_format(q, text, sizeof(text));
+    checks++;
+    if (status != APC_OK || strcmp(text, expected) != 0)
+    {
+        failures++;
+        printf("❌ %s\n   expected: %s\n   actual:   %s\n", name, expected,
+               (status == APC_OK) ? text : apc_strerror(status));
+    }
+}
+
+static void test_rationals(void)
+{
+    apc_rat *a = NULL, *b = NULL, *sum = NULL;
+    if (apc_rat_init(&a) != APC_OK || apc_rat_init(&b) != APC_OK || apc_rat_init(&sum) != APC_OK)
+    {
+        check("rat_init", 0);
+        return;
+    }
+
+    // Step 1: The four operations, results in lowest terms
+    check("rat_parse", apc_rat_parse(a, "1/2") == APC_OK && apc_rat_parse(b, "-3/-9") == APC_OK);
+    check_rat("rat_parse", b, "1/3");
+    check("rat_add", apc_rat_add(sum, a, b) == APC_OK);
+    check_rat("rat_add", sum, "5/6");
+    check("rat_sub", apc_rat_sub(sum, b, a) == APC_OK);
+    check_rat("rat_sub", sum, "-1/6");
+    check("rat_mul", apc_rat_mul(sum, a, b) == APC_OK);
+    check_rat("rat_mul", sum, "1/6");
+    check("rat_div", apc_rat_div(sum, a, b) == APC_OK);
+    check_rat("rat_div", sum, "3/2");
+
+    // Step 2: A running sum reduced lazily still ends in lowest terms (H(30))
+    char text[32];
+    check("rat_parse zero", apc_rat_parse(sum, "0") == APC_OK);
+    for (int k = 1; k <= 30; k++)
+    {
+        snprintf(text, sizeof(text), "1/%d", k);
+        if (apc_rat_parse(a, text) != APC_OK || apc_rat_add(sum, sum, a) != APC_OK)
+            break;
+    }
+    check("rat_format_length", apc_rat_format_length(sum) == 27);
+    check_rat("harmonic sum", sum, "9304682830147/2329089562800");
+
+    // Step 3: Integer parts in and out
+    apc_num *num = number("-10");
+    apc_num *den = number("4");
+    check("rat_set", apc_rat_set(a, num, den) == APC_OK);
+    check("rat_get", apc_rat_get(a, num, den) == APC_OK);
+    check_text("rat_get numerator", num, "-5");
+    check_text("rat_get denominator", den, "2");
+    check("rat_parse zero denominator", apc_rat_parse(b, "1/0") != APC_OK);
+    check("rat_div by zero", apc_rat_parse(b, "0") == APC_OK && apc_rat_div(sum, a, b) == APC_ERR_DIV_ZERO);
+
+    apc_free(num);
+    apc_free(den);
+    apc_rat_free(a);
+    apc_rat_free(b);
+    apc_rat_free(sum);
+}
+
+/* ============================================================================
+ * FIXED POINT
+ * ============================================================================ */
+
+static void test_fixed_point(void)
+{
+    // Each mode on -5/2 (a tie) and -2/3 (not a tie) to 0 places, then 7/2
+    static const struct { int round; const char *tie; const char *other; const char *odd_tie; } modes[] = {
+        { APC_ROUND_DOWN,      "-2", "0",  "3" },
+        { APC_ROUND_UP,        "-3", "-1", "4" },
+        { APC_ROUND_FLOOR,     "-3", "-1", "3" },
+        { APC_ROUND_CEILING,   "-2", "0",  "4" },
+        { APC_ROUND_HALF_UP,   "-3", "-1", "4" },
+        { APC_ROUND_HALF_DOWN, "-2", "-1", "3" },
+        { APC_ROUND_HALF_EVEN, "-2", "-1", "4" },
+    };
+    apc_num *a = number("0");
+    apc_num *b = number("0");
+    apc_num *r = number("0");
+    char name[64];
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        snprintf(name, sizeof(name), "div_scaled mode %d", modes[i].round);
+        apc_parse(a, "-5");
+        apc_parse(b, "2");
+        check(name, apc_div_scaled(r, a, b, 0, modes[i].round) == APC_OK);
+        check_text(name, r, modes[i].tie);
+        apc_parse(a, "-2");
+        apc_parse(b, "3");
+        check(name, apc_div_scaled(r, a, b, 0, modes[i].round) == APC_OK);
+        check_text(name, r, modes[i].other);
+        apc_parse(a, "7");
+        apc_parse(b, "2");
+        check(name, apc_div_scaled(r, a, b, 0, modes[i].round) == APC_OK);
+        check_text(name, r, modes[i].odd_tie);
+    }
+
+    // The result is the quotient times 10^scale, without a decimal point
+    apc_parse(a, "22");
+    apc_parse(b, "7");
+    check("div_scaled places", apc_div_scaled(r, a, b, 20, APC_ROUND_HALF_EVEN) == APC_OK);
+    check_text("div_scaled places", r, "314285714285714285714");
+    check("div_scaled bad mode", apc_div_scaled(r, a, b, 2, 99) == APC_ERR_INVALID);
+    apc_parse(b, "0");
+    check("div_scaled by zero", apc_div_scaled(r, a, b, 2, APC_ROUND_DOWN) == APC_ERR_DIV_ZERO);
+
+    apc_free(a);
+    apc_free(b);
+    apc_free(r);
+}
+
+/* ============================================================================
+ * MAIN FUNCTION
+ * ============================================================================ */
+
+int main(void)
+{
+    test_integers();
+    test_files();
+    test_memory();
+    test_powmod();
+    test_gcd();
+    test_roots();
+    test_factorials();
+    test_rationals();
+    test_fixed_point();
+
+    size_t live = 1;
+    apc_mem_usage(&live, NULL);
+    check("no bytes left live", live == 0);
+
+    if (failures != 0)
+    {
+        printf("❌ libapc: %d of %d checks failed\n", failures, checks);
+        return 1;
+    }
+    printf("✅ libapc: all %d checks passed\n", checks);
+    return 0;
+}
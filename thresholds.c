@@ -0,0 +1,95 @@
+#include "apc.h"
+#include "apc_thresholds.h"
+
+/* ============================================================================
+ * ALGORITHM THRESHOLDS
+ * The values start from the tuned defaults in apc_thresholds.h. On first use
+ * each one may be replaced by its environment variable (APC_MUL_LIMB_THRESHOLD,
+ * APC_KARATSUBA_THRESHOLD, APC_DIV_LIMB_THRESHOLD, APC_HGCD_THRESHOLD), so a
+ * build can be retuned on another machine without recompiling.
+ *
+ * The table is written once (the environment is read at most once per
+ * thread that races the first call, always with the same result) and only
+ * read afterwards; set_threshold exists for the tuner, which is single
+ * threaded.
+ * ============================================================================ */
+
+/* ----------------------------------------------------------------------------
+ * threshold_info: name, compiled default and lower bound of one threshold
+ * ---------------------------------------------------------------------------- */
+typedef struct threshold_info
+{
+    const char *name;       // Environment variable
+    size_t fallback;        // Value from apc_thresholds.h
+    size_t minimum;         // Smallest value the algorithm accepts
+} threshold_info;
+
+static const threshold_info threshold_table[THRESHOLD_COUNT] =
+{
+    { "APC_MUL_LIMB_THRESHOLD",  APC_MUL_LIMB_THRESHOLD,  1 },
+    { "APC_KARATSUBA_THRESHOLD", APC_KARATSUBA_THRESHOLD, 4 }, // Halves must shrink
+    { "APC_DIV_LIMB_THRESHOLD",  APC_DIV_LIMB_THRESHOLD,  1 },
+    { "APC_HGCD_THRESHOLD",      APC_HGCD_THRESHOLD,      8 }, // Top halves must still be Lehmer sized
+};
+
+static size_t threshold_values[THRESHOLD_COUNT];
+static int threshold_loaded; // Set once the values above are filled in
+
+/**
+ * Fill in every threshold: environment variable if set and valid, else default
+ */
+static void load_thresholds(void)
+{
+    for (int i = 0; i < THRESHOLD_COUNT; i++)
+    {
+        size_t value = threshold_table[i].fallback;
+        const char *text = getenv(threshold_table[i].name);
+        if (text != NULL && *text != '\0')
+        {
+            char *end;
+            unsigned long long parsed = strtoull(text, &end, 10);
+            if (*end == '\0')
+                value = (size_t)parsed; // Ignore malformed overrides
+        }
+        if (value < threshold_table[i].minimum)
+            value = threshold_table[i].minimum;
+        __atomic_store_n(&threshold_values[i], value, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&threshold_loaded, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Current value of a threshold
+ * @param id: which threshold
+ * @return: the threshold (environment override applied)
+ */
+size_t get_threshold(threshold_id id)
+{
+    if (!__atomic_load_n(&threshold_loaded, __ATOMIC_ACQUIRE))
+        load_thresholds();
+    return __atomic_load_n(&threshold_values[id], __ATOMIC_RELAXED);
+}
+
+/**
+ * Replace a threshold for the rest of the process (used by the tuner)
+ * @param id: which threshold
+ * @param value: new value (raised to the algorithm's minimum)
+ */
+void set_threshold(threshold_id id, size_t value)
+{
+    if (!__atomic_load_n(&threshold_loaded, __ATOMIC_ACQUIRE))
+        load_thresholds();
+    if (value < threshold_table[id].minimum)
+        value = threshold_table[id].minimum;
+    __atomic_store_n(&threshold_values[id], value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Environment variable that overrides a threshold
+ * @param id: which threshold
+ * @return: variable name, e.g. "APC_KARATSUBA_THRESHOLD"
+ */
+const char *threshold_name(threshold_id id)
+{
+    return threshold_table[id].name;
+}
@@ -0,0 +1,207 @@
+#include "apc.h"
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * TRACING
+ * Chrome trace event JSON (chrome://tracing, ui.perfetto.dev) for --trace.
+ *
+ * Every thread records begin/end events into its own buffer, so recording
+ * takes no lock; the buffers are chained into a list the first time a thread
+ * records and are written out together by trace_finish once the work is
+ * done. When tracing is off the TRACE_* macros cost one well predicted
+ * branch on trace_active.
+ *
+ * Two limits keep a trace of a huge job loadable:
+ * - spans nested deeper than TRACE_MAX_DEPTH are not recorded (the deep
+ *   Karatsuba levels are many thousands of tiny calls),
+ * - a thread stops opening spans after TRACE_MAX_EVENTS events.
+ * An end event is only written when its begin was, so the file always nests
+ * correctly; dropped spans are counted in the trace metadata.
+ * ============================================================================ */
+
+#define TRACE_MAX_DEPTH  12          // Deepest recorded span nesting
+#define TRACE_MAX_EVENTS (1 << 20)   // Events per thread (~40 MiB)
+
+/* ----------------------------------------------------------------------------
+ * trace_event: one begin ('B') or end ('E') event
+ * ---------------------------------------------------------------------------- */
+typedef struct trace_event
+{
+    const char *name;       // Span name (string literal), NULL for 'E'
+    const char *arg_name;   // Optional argument name (string literal) or NULL
+    int64_t arg;            // Argument value
+    uint64_t ts;            // stats_clock() time in ns
+    char phase;             // 'B' or 'E'
+} trace_event;
+
+/* ----------------------------------------------------------------------------
+ * trace_thread: event buffer of one thread
+ * ---------------------------------------------------------------------------- */
+typedef struct trace_thread
+{
+    trace_event *events;
+    size_t count, capacity;
+    int depth;                  // Open spans, recorded or not
+    uint64_t recorded;          // Bit d set if the open span at depth d was recorded
+    uint64_t dropped;           // Spans not recorded (too deep or buffer full)
+    int tid;                    // Thread number in the trace (1 = first thread)
+    struct trace_thread *next;  // Registry of all threads
+} trace_thread;
+
+int trace_active;                           // Read by the TRACE_* macros
+static const char *trace_path;              // Output file of trace_finish
+static uint64_t trace_origin;               // ts 0 of the trace
+static trace_thread *trace_threads;         // Registry (lock-free push)
+static int trace_next_tid;
+static __thread trace_thread *trace_self;
+
+/**
+ * Buffer of the calling thread, created and registered on first use
+ * @return: the buffer, or NULL if out of memory
+ */
+static trace_thread *trace_thread_self(void)
+{
+    if (trace_self != NULL)
+        return trace_self;
+    trace_thread *self = calloc(1, sizeof(trace_thread));
+    if (self == NULL)
+        return NULL;
+    self->tid = __atomic_add_fetch(&trace_next_tid, 1, __ATOMIC_RELAXED);
+    self->next = __atomic_load_n(&trace_threads, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&trace_threads, &self->next, self, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ; // self->next was reloaded by the failed exchange
+    trace_self = self;
+    return self;
+}
+
+/**
+ * Make room for one more event
+ * @return: SUCCESS, or FAILURE if the buffer cannot grow
+ */
+static int trace_reserve(trace_thread *self, size_t needed)
+{
+    if (needed <= self->capacity)
+        return SUCCESS;
+    if (needed > TRACE_MAX_EVENTS)
+        return FAILURE;
+    size_t capacity = (self->capacity == 0) ? 1024 : self->capacity * 2;
+    if (capacity > TRACE_MAX_EVENTS)
+        capacity = TRACE_MAX_EVENTS;
+    trace_event *events = realloc(self->events, capacity * sizeof(trace_event));
+    if (events == NULL)
+        return FAILURE;
+    self->events = events;
+    self->capacity = capacity;
+    return SUCCESS;
+}
+
+/**
+ * Open a span (use TRACE_BEGIN)
+ * @param name: span name, a string literal
+ * @param arg_name: argument name (string literal), or NULL for none
+ * @param arg: argument value
+ */
+void trace_begin(const char *name, const char *arg_name, int64_t arg)
+{
+    trace_thread *self = trace_thread_self();
+    if (self == NULL)
+        return;
+    int depth = self->depth++;
+    if (depth >= TRACE_MAX_DEPTH ||
+        trace_reserve(self, self->count + (size_t)depth + 2) == FAILURE) // Room for every pending end
+    {
+        if (depth < 64)
+            self->recorded &= ~(1ULL << depth);
+        self->dropped++;
+        return;
+    }
+    self->recorded |= 1ULL << depth;
+    self->events[self->count++] = (trace_event){ name, arg_name, arg, stats_clock(), 'B' };
+}
+
+/**
+ * Close the innermost open span (use TRACE_END)
+ * @param arg_name: argument attached to the span at its end, or NULL
+ * @param arg: argument value
+ */
+void trace_end(const char *arg_name, int64_t arg)
+{
+    trace_thread *self = trace_self;
+    if (self == NULL || self->depth == 0)
+        return;
+    int depth = --self->depth;
+    if (depth < 64 && (self->recorded & (1ULL << depth)))
+        self->events[self->count++] = (trace_event){ NULL, arg_name, arg, stats_clock(), 'E' };
+}
+
+/**
+ * Start recording; TRACE_* calls from now on are buffered
+ * Call before any worker thread is started: the calling thread becomes
+ * thread 1 ("main") of the trace.
+ * @param path: file written by trace_finish
+ */
+void trace_start(const char *path)
+{
+    trace_path = path;
+    trace_origin = stats_clock();
+    trace_thread_self();
+    trace_active = 1;
+}
+
+/**
+ * Write every thread's events as Chrome trace JSON and stop tracing
+ * Call after all worker threads have finished.
+ * @return: SUCCESS, or FAILURE if the file could not be written
+ */
+int trace_finish(void)
+{
+    if (!trace_active)
+        return SUCCESS;
+    trace_active = 0;
+
+    FILE *out = fopen(trace_path, "w");
+    int pid = (int)getpid();
+    uint64_t dropped = 0;
+    if (out != NULL)
+        fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first = 1;
+    trace_thread *thread = trace_threads;
+    while (thread != NULL)
+    {
+        if (out != NULL)
+        {
+            fprintf(out, "%s{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\","
+                         "\"args\":{\"name\":\"%s %d\"}}",
+                    first ? "" : ",\n", pid, thread->tid,
+                    (thread->tid == 1) ? "main" : "worker", thread->tid);
+            first = 0;
+            for (size_t i = 0; i < thread->count; i++)
+            {
+                trace_event *e = &thread->events[i];
+                uint64_t ns = (e->ts > trace_origin) ? e->ts - trace_origin : 0;
+                fprintf(out, ",\n{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03u",
+                        e->phase, pid, thread->tid,
+                        (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+                if (e->name != NULL)
+                    fprintf(out, ",\"name\":\"%s\"", e->name);
+                if (e->arg_name != NULL)
+                    fprintf(out, ",\"args\":{\"%s\":%lld}", e->arg_name, (long long)e->arg);
+                fputc('}', out);
+            }
+        }
+        dropped += thread->dropped;
+        trace_thread *next = thread->next;
+        free(thread->events);
+        free(thread);
+        thread = next;
+    }
+    trace_threads = NULL;
+    trace_self = NULL; // Only the finishing thread's pointer can be reset
+    if (out == NULL)
+        return FAILURE;
+    fprintf(out, "\n],\"otherData\":{\"dropped_spans\":%llu,\"max_depth\":%d}}\n",
+            (unsigned long long)dropped, TRACE_MAX_DEPTH);
+    return (fclose(out) == 0) ? SUCCESS : FAILURE;
+}
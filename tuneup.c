@@ -0,0 +1,278 @@
+#include "apc.h"
+#include <time.h>
+
+/* ============================================================================
+ * THRESHOLD TUNER
+ * Measures the crossover points of the algorithm tiers on this machine and
+ * writes them as apc_thresholds.h:
+ *
+ *   ./apc_tune [--output=apc_thresholds.h]
+ *
+ * For every size the same operands are timed with the threshold just above
+ * the size (slower tier) and at the size (faster tier). The crossover is the
+ * first size where the faster tier wins at that size and the next two sizes,
+ * so a single noisy measurement cannot pick it.
+ *
+ * Only the top-level choice changes between the two timings: with the
+ * Karatsuba threshold set to n, an n-limb product splits once and its halves
+ * (< n limbs) go straight to schoolbook; with the half-GCD threshold set to
+ * n, an n-limb gcd takes one half-GCD level and finishes with Lehmer.
+ * ============================================================================ */
+
+#define TUNE_CONFIRM 3  // Consecutive wins needed to accept a crossover
+
+/* ----------------------------------------------------------------------------
+ * tune_case: operands for one measurement
+ * ---------------------------------------------------------------------------- */
+typedef struct tune_case
+{
+    Dlist *head1, *tail1, *head2, *tail2;   // Digit lists (mul_number / div_number)
+    limb_t *limbs1, *limbs2;                // Limbs (limb_mul / limb_gcd)
+    size_t count1, count2;
+    limb_t *product;                        // limb_mul / limb_gcd output
+} tune_case;
+
+/* ============================================================================
+ * OPERANDS AND TIMING
+ * ============================================================================ */
+
+static uint64_t tune_state = 0x5DEECE66DULL;
+
+static uint64_t next_random(void)
+{
+    uint64_t z = (tune_state += 0x9E3779B97F4A7C15ULL); // splitmix64
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Random number with exactly `digits` digits
+ */
+static int random_list(size_t digits, Dlist **head, Dlist **tail)
+{
+    *head = NULL;
+    *tail = NULL;
+    for (size_t i = 0; i < digits; i++)
+    {
+        int digit = (int)(next_random() % 10);
+        if (i == 0 && digit == 0)
+            digit = 1;
+        if (dl_insert_last(head, tail, digit) == FAILURE)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Run the operation under test once
+ * @param what: threshold whose tiers are being compared
+ */
+static void run_case(threshold_id what, tune_case *c)
+{
+    Dlist *h1 = c->head1, *t1 = c->tail1, *h2 = c->head2, *t2 = c->tail2;
+    Dlist *head3 = NULL, *tail3 = NULL, *remainder_head = NULL, *remainder_tail = NULL;
+    size_t gcd_count = 0;
+    switch (what)
+    {
+        case THRESHOLD_KARATSUBA:
+            limb_mul(c->product, c->limbs1, c->count1, c->limbs2, c->count2, LIMB_DECIMAL_BASE);
+            break;
+        case THRESHOLD_HGCD:
+            limb_gcd(c->product, &gcd_count, c->limbs1, c->count1, c->limbs2, c->count2);
+            break;
+        case THRESHOLD_MUL_LIMB:
+            mul_number(&h1, &t1, &h2, &t2, &head3, &tail3);
+            break;
+        default:
+            div_number(&h1, &t1, &h2, &t2, &head3, &tail3, &remainder_head, &remainder_tail, '/');
+            break;
+    }
+    dl_delete_list(&head3, &tail3);
+    dl_delete_list(&remainder_head, &remainder_tail);
+}
+
+/**
+ * Seconds per run: best of 7 rounds, each repeated for at least 5 ms
+ */
+static double time_case(threshold_id what, tune_case *c)
+{
+    double best = 1e30;
+    for (int round = 0; round < 7; round++)
+    {
+        int runs = 0;
+        double start = now_seconds(), elapsed;
+        do
+        {
+            run_case(what, c);
+            runs++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < 0.005);
+        if (elapsed / runs < best)
+            best = elapsed / runs;
+    }
+    return best;
+}
+
+/* ============================================================================
+ * CROSSOVER SEARCH
+ * ============================================================================ */
+
+/**
+ * Build the operands for size n of a threshold's benchmark
+ * Karatsuba: two n-limb numbers; mul: two n-digit numbers;
+ * div: a n-digit dividend over a n/2-digit divisor; gcd: two n-limb binary numbers
+ */
+static int make_case(threshold_id what, size_t n, tune_case *c)
+{
+    memset(c, 0, sizeof(*c));
+    if (what == THRESHOLD_HGCD)
+    {
+        c->limbs1 = malloc(n * sizeof(limb_t));
+        c->limbs2 = malloc(n * sizeof(limb_t));
+        c->product = malloc(n * sizeof(limb_t));
+        if (c->limbs1 == NULL || c->limbs2 == NULL || c->product == NULL)
+            return FAILURE;
+        for (size_t i = 0; i < n; i++)
+        {
+            c->limbs1[i] = (limb_t)next_random();
+            c->limbs2[i] = (limb_t)next_random();
+        }
+        c->limbs1[n - 1] |= 1; // Exactly n limbs
+        c->limbs2[n - 1] |= 1;
+        c->count1 = c->count2 = n;
+        return SUCCESS;
+    }
+    size_t digits1 = (what == THRESHOLD_KARATSUBA) ? n * LIMB_DECIMAL_DIGITS : n;
+    size_t digits2 = (what == THRESHOLD_DIV_LIMB) ? (n + 1) / 2 : digits1;
+    if (random_list(digits1, &c->head1, &c->tail1) == FAILURE ||
+        random_list(digits2, &c->head2, &c->tail2) == FAILURE)
+        return FAILURE;
+    if (what == THRESHOLD_KARATSUBA)
+    {
+        c->limbs1 = list_to_limbs(c->head1, c->tail1, &c->count1);
+        c->limbs2 = list_to_limbs(c->head2, c->tail2, &c->count2);
+        c->product = malloc((c->count1 + c->count2) * sizeof(limb_t));
+        if (c->limbs1 == NULL || c->limbs2 == NULL || c->product == NULL)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+static void free_case(tune_case *c)
+{
+    dl_delete_list(&c->head1, &c->tail1);
+    dl_delete_list(&c->head2, &c->tail2);
+    free(c->limbs1);
+    free(c->limbs2);
+    free(c->product);
+}
+
+/**
+ * Find the crossover of one threshold between low and high
+ * @return: the measured threshold (high if the faster tier never won)
+ */
+static size_t find_crossover(threshold_id what, size_t low, size_t high)
+{
+    size_t first_win = 0;
+    int wins = 0;
+    printf("%s:\n", threshold_name(what));
+    for (size_t n = low; n <= high; n += (n < 16) ? 1 : n / 8)
+    {
+        tune_case c;
+        if (make_case(what, n, &c) == FAILURE)
+        {
+            free_case(&c);
+            break;
+        }
+        set_threshold(what, n + 1);                 // Slower tier at this size
+        double slow = time_case(what, &c);
+        set_threshold(what, n);                     // Faster tier at this size
+        double fast = time_case(what, &c);
+        free_case(&c);
+
+        printf("  %6zu  %12.0f ns  %12.0f ns  %s\n", n, slow * 1e9, fast * 1e9,
+               (fast < slow) ? "<- faster" : "");
+        if (fast < slow)
+        {
+            if (wins++ == 0)
+                first_win = n;
+            if (wins == TUNE_CONFIRM)
+                return first_win;
+        }
+        else
+            wins = 0;
+    }
+    if (wins > 0)
+        return first_win;
+    printf("  ⚠️ No crossover up to %zu: the faster tier only pays off beyond the range, using %zu\n", high, high);
+    return high;
+}
+
+/* ============================================================================
+ * MAIN FUNCTION
+ * ============================================================================ */
+
+int main(int argc, char *argv[])
+{
+    const char *output = "apc_thresholds.h";
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--output=", 9) == 0)
+            output = argv[i] + 9;
+        else
+        {
+            printf("📝 Usage: %s [--output=apc_thresholds.h]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Step 1: Karatsuba first, mul_number's limb tier depends on it
+    size_t karatsuba = find_crossover(THRESHOLD_KARATSUBA, 4, 256);
+    set_threshold(THRESHOLD_KARATSUBA, karatsuba);
+    size_t mul_limb = find_crossover(THRESHOLD_MUL_LIMB, 1, 2000);
+    size_t div_limb = find_crossover(THRESHOLD_DIV_LIMB, 2, 2000);
+    size_t hgcd = find_crossover(THRESHOLD_HGCD, 16, 8000); // Its products use Karatsuba too; late crossover
+
+    // Step 2: Write the header read by thresholds.c
+    FILE *out = fopen(output, "w");
+    if (out == NULL)
+    {
+        printf("❌ Error: cannot write '%s'\n", output);
+        return 1;
+    }
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d", localtime(&now));
+    fprintf(out,
+            "#ifndef APC_THRESHOLDS_H\n"
+            "#define APC_THRESHOLDS_H\n"
+            "\n"
+            "/* ============================================================================\n"
+            " * ALGORITHM THRESHOLDS\n"
+            " * Generated by apc_tune (make tune) on %s - do not edit by hand\n"
+            " * Override at run time with the environment variable of the same name\n"
+            " * ============================================================================ */\n"
+            "#define APC_MUL_LIMB_THRESHOLD   %-5zu // Digits (shorter operand)\n"
+            "#define APC_KARATSUBA_THRESHOLD  %-5zu // Limbs\n"
+            "#define APC_DIV_LIMB_THRESHOLD   %-5zu // Digits (dividend)\n"
+            "#define APC_HGCD_THRESHOLD       %-5zu // Limbs (binary, smaller operand)\n"
+            "\n"
+            "#endif // APC_THRESHOLDS_H\n", date, mul_limb, karatsuba, div_limb, hgcd);
+    if (fclose(out) != 0)
+    {
+        printf("❌ Error: cannot write '%s'\n", output);
+        return 1;
+    }
+    printf("✅ Wrote %s (mul limb %zu digits, Karatsuba %zu limbs, div limb %zu digits, "
+           "half-GCD %zu limbs)\n", output, mul_limb, karatsuba, div_limb, hgcd);
+    printf("💡 Run make again to build with the new thresholds\n");
+    return 0;
+}
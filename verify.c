@@ -0,0 +1,191 @@
+#include "apc.h"
+#include <unistd.h>
+
+/* ============================================================================
+ * RESULT VERIFICATION
+ * A cheap, independent check of a + b, a - b, a x b and a / b: the identity
+ * the result must satisfy (c = a * b, a = q * b + r, ...) is tested modulo
+ * 9 and 11 (casting out nines and elevens) and modulo three random primes
+ * between 2^61 and 2^62, picked afresh on every run. A wrong n-digit result
+ * survives one such prime with probability below n / 2^59 (the error has
+ * few prime factors that large), and all three with the cube of that; no
+ * fixed pattern of errors can slip through every run.
+ *
+ * Residues of the operands are taken before the operation (operations may
+ * reuse their operand lists), those of the result after it. Each is one
+ * pass over the digits, nine at a time, so the check is linear.
+ * ============================================================================ */
+
+#define VERIFY_BLOCK_BASE 1000000000    // Nine digits folded in per step
+
+/**
+ * (a * b) mod m
+ */
+static uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t m)
+{
+    return (uint64_t)((unsigned __int128)a * b % m);
+}
+
+/**
+ * Deterministic Miller-Rabin for n < 2^64 (these twelve bases suffice)
+ * @return: 1 if n is prime
+ */
+static int is_prime_word(uint64_t n)
+{
+    static const uint64_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    if (n < 2)
+        return 0;
+    for (int i = 0; i < 12; i++)
+    {
+        if (n % bases[i] == 0)
+            return n == bases[i];
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0)
+    {
+        d >>= 1;
+        s++;
+    }
+    for (int i = 0; i < 12; i++)
+    {
+        // x = base^d mod n
+        uint64_t x = 1, p = bases[i];
+        for (uint64_t e = d; e > 0; e >>= 1)
+        {
+            if (e & 1)
+                x = mul_mod(x, p, n);
+            p = mul_mod(p, p, n);
+        }
+        if (x == 1 || x == n - 1)
+            continue;
+        int witness = 1;
+        for (int r = 1; r < s && witness; r++)
+        {
+            x = mul_mod(x, x, n);
+            if (x == n - 1)
+                witness = 0;
+        }
+        if (witness)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * splitmix64 step: next pseudo random word
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Residues of a signed number modulo every modulus of a check
+ * @param residues: receives one residue per modulus, in [0, modulus)
+ */
+static void residues_of(const verify_check *check, Dlist *head, int sign, uint64_t *residues)
+{
+    for (int i = 0; i < VERIFY_MODULI; i++)
+        residues[i] = 0;
+
+    // Step 1: Horner's rule, nine digits per step
+    uint64_t block = 0, scale = 1;
+    for (Dlist *node = head; node != NULL; node = node->next)
+    {
+        block = block * 10 + (uint64_t)node->data;
+        scale *= 10;
+        if (scale == VERIFY_BLOCK_BASE || node->next == NULL)
+        {
+            for (int i = 0; i < VERIFY_MODULI; i++)
+                residues[i] = (uint64_t)(((unsigned __int128)residues[i] * scale + block) % check->modulus[i]);
+            block = 0;
+            scale = 1;
+        }
+    }
+
+    // Step 2: The value is -|n| for negative numbers
+    for (int i = 0; i < VERIFY_MODULI; i++)
+    {
+        if (sign == -1 && residues[i] != 0)
+            residues[i] = check->modulus[i] - residues[i];
+    }
+}
+
+/**
+ * Pick the moduli and take the residues of both operands
+ * Call before the operation
+ */
+void verify_begin(verify_check *check, Dlist *head1, int sign1, Dlist *head2, int sign2)
+{
+    TRACE_BEGIN("verify", NULL, 0);
+    check->modulus[0] = 9;
+    check->modulus[1] = 11;
+    uint64_t state = stats_clock() ^ ((uint64_t)getpid() << 32);
+    for (int i = 2; i < VERIFY_MODULI; i++)
+    {
+        uint64_t candidate;
+        do
+            candidate = (next_random(&state) >> 2) | (1ULL << 61) | 1; // Odd, in [2^61, 2^62)
+        while (!is_prime_word(candidate));
+        check->modulus[i] = candidate;
+    }
+    residues_of(check, head1, sign1, check->a);
+    residues_of(check, head2, sign2, check->b);
+    TRACE_END();
+}
+
+/**
+ * Check a result against the operand residues taken by verify_begin
+ * @param op: '+', '-', 'x' or '/'
+ * @param head3: result (quotient for '/')
+ * @param sign3: sign of the result
+ * @param rem_head: remainder for '/' (NULL otherwise)
+ * @param rem_sign: sign of the remainder
+ * @param divisor_head: divisor for '/' (to check |remainder| < |divisor|)
+ * @param bad_modulus: receives the modulus that disagreed, or 0 if the
+ *                     remainder was not smaller than the divisor
+ * @return: SUCCESS if every check passed, FAILURE otherwise
+ */
+int verify_result(const verify_check *check, char op, Dlist *head3, int sign3,
+                  Dlist *rem_head, int rem_sign, Dlist *divisor_head, uint64_t *bad_modulus)
+{
+    TRACE_BEGIN("verify", NULL, 0);
+    uint64_t c[VERIFY_MODULI], r[VERIFY_MODULI];
+    residues_of(check, head3, sign3, c);
+    if (op == '/')
+        residues_of(check, rem_head, rem_sign, r);
+
+    int status = SUCCESS;
+    for (int i = 0; i < VERIFY_MODULI && status == SUCCESS; i++)
+    {
+        uint64_t m = check->modulus[i], a = check->a[i], b = check->b[i];
+        uint64_t lhs, rhs = c[i];
+        if (op == '+')
+            lhs = (a + b) % m;                              // a + b = c
+        else if (op == '-')
+            lhs = (a + m - b) % m;                          // a - b = c
+        else if (op == 'x')
+            lhs = mul_mod(a, b, m);                         // a * b = c
+        else
+        {
+            lhs = a;                                        // a = q * b + r
+            rhs = (mul_mod(c[i], b, m) + r[i]) % m;
+        }
+        if (lhs != rhs)
+        {
+            *bad_modulus = m;
+            status = FAILURE;
+        }
+    }
+    if (status == SUCCESS && op == '/' && is_greater_or_equal(rem_head, divisor_head))
+    {
+        *bad_modulus = 0; // |r| >= |b|: not a remainder
+        status = FAILURE;
+    }
+    TRACE_END();
+    return status;
+}
@@ -0,0 +1,358 @@
+#include "apc.h"
+
+/* ============================================================================
+ * RESULT WINDOWS
+ * The last K digits (--low=K) or the first K digits (--high=K) of a product
+ * or quotient, plus the exact digit count of the whole result, without
+ * forming the whole result.
+ *
+ * - Low digits of a product depend only on the low K digits of the
+ *   operands: one short product (limb_mullo) modulo 10^K.
+ * - High digits come from the leading digits of the operands. Truncating
+ *   them gives a lower and an upper bound on the result (each operand lies
+ *   between its truncation and its truncation plus one unit); once both
+ *   bounds have the same length and the same first K digits, so does the
+ *   exact result. Otherwise the guard digits double and the bounds are
+ *   recomputed. At full length the bounds are exact, so this always ends,
+ *   and in practice the first try (16 guard digits) decides.
+ * - The digit count is a high window of zero digits.
+ * Low digits of a quotient depend on the whole dividend; that window is cut
+ * from a full limb division.
+ * ============================================================================ */
+
+#define WINDOW_GUARD_DIGITS 16  // Extra leading digits in the first high window attempt
+
+/* ----------------------------------------------------------------------------
+ * window_bound: a bound as decimal limbs and as text
+ * ---------------------------------------------------------------------------- */
+typedef struct window_bound
+{
+    limb_t *limbs;  // Least significant first
+    size_t n;       // Limbs allocated
+    char *text;     // Digits without leading zeros ("0" for zero)
+    size_t length;  // strlen(text)
+} window_bound;
+
+/**
+ * t digits of a list as decimal limbs (padded with zero limbs to n limbs)
+ * @param from_head: 1 for the leading t digits, 0 for the trailing t digits
+ * @return: new limb array, NULL if out of memory
+ */
+static limb_t *digits_of(Dlist *head, Dlist *tail, size_t t, int from_head, size_t n)
+{
+    char *digits = malloc(t + 1);
+    limb_t *limbs = calloc(n + 1, sizeof(limb_t));
+    if (digits == NULL || limbs == NULL)
+    {
+        free(digits);
+        free(limbs);
+        return NULL;
+    }
+    if (from_head)
+    {
+        Dlist *node = head;
+        for (size_t i = 0; i < t; i++, node = node->next)
+            digits[i] = (char)('0' + node->data);
+    }
+    else
+    {
+        Dlist *node = tail;
+        for (size_t i = t; i-- > 0; node = node->prev)
+            digits[i] = (char)('0' + node->data);
+    }
+    digits_to_limbs(digits, t, limbs);
+    free(digits);
+    return limbs;
+}
+
+/**
+ * Fill in the text of a bound from its limbs
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int bound_text(window_bound *bound)
+{
+    size_t n = limb_normalize(bound->limbs, bound->n);
+    bound->text = malloc(n * LIMB_DECIMAL_DIGITS + 2);
+    if (bound->text == NULL)
+        return FAILURE;
+    if (n == 0)
+    {
+        strcpy(bound->text, "0");
+        bound->length = 1;
+        return SUCCESS;
+    }
+    size_t length = (size_t)sprintf(bound->text, "%u", bound->limbs[n - 1]);
+    for (size_t i = n - 1; i-- > 0;)
+        length += (size_t)sprintf(bound->text + length, "%08u", bound->limbs[i]);
+    bound->length = length;
+    return SUCCESS;
+}
+
+static void bound_free(window_bound *bound)
+{
+    free(bound->limbs);
+    free(bound->text);
+    bound->limbs = NULL;
+    bound->text = NULL;
+}
+
+/**
+ * a + 1 in place (a has room for one more limb)
+ */
+static void add_one(limb_t *a, size_t n)
+{
+    static const limb_t one[1] = { 1 };
+    a[n] += limb_add(a, a, n, one, 1, LIMB_DECIMAL_BASE);
+}
+
+/**
+ * Lower and upper bound of |a| x |b| or |a| / |b| from leading digits
+ * @param exact: receives 1 if no digit was dropped (the bounds are equal)
+ * @param shift: receives the number of zeros to append to both bounds
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int high_bounds(Dlist *head1, size_t la, Dlist *head2, size_t lb, char op, size_t want,
+                       window_bound *lo, window_bound *hi, int *exact, size_t *shift)
+{
+    // Step 1: How many leading digits of each operand to keep
+    size_t ta, tb;
+    if (op == 'x')
+    {
+        ta = (la < want) ? la : want;
+        tb = (lb < want) ? lb : want;
+        *shift = (la - ta) + (lb - tb);
+    }
+    else
+    {
+        // Drop at least as many dividend digits as divisor digits, so the
+        // quotient of the kept digits is the leading part of the real one
+        tb = (lb < want) ? lb : want;
+        ta = (la - lb + tb < tb + want) ? la - lb + tb : tb + want;
+        *shift = (la - ta) - (lb - tb);
+    }
+    int da = (ta < la), db = (tb < lb); // One unit lost by each truncation
+    *exact = !da && !db;
+
+    size_t an = (ta + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS;
+    size_t bn = (tb + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS;
+    limb_t *a = digits_of(head1, NULL, ta, 1, an);
+    limb_t *b = digits_of(head2, NULL, tb, 1, bn);
+    limb_t *a_up = digits_of(head1, NULL, ta, 1, an);
+    limb_t *b_up = digits_of(head2, NULL, tb, 1, bn);
+    int status = (a != NULL && b != NULL && a_up != NULL && b_up != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+    {
+        if (da)
+            add_one(a_up, an);
+        if (db)
+            add_one(b_up, bn);
+    }
+
+    // Step 2: lo from the truncations, hi from the truncations plus one unit
+    if (status == SUCCESS && op == 'x')
+    {
+        lo->n = hi->n = an + bn + 2;
+        lo->limbs = calloc(lo->n, sizeof(limb_t));
+        hi->limbs = calloc(hi->n, sizeof(limb_t));
+        if (lo->limbs == NULL || hi->limbs == NULL ||
+            limb_mul(lo->limbs, a, an, b, bn, LIMB_DECIMAL_BASE) == FAILURE ||
+            limb_mul(hi->limbs, a_up, an + 1, b_up, bn + 1, LIMB_DECIMAL_BASE) == FAILURE)
+            status = FAILURE;
+        else if (!*exact)
+        {
+            static const limb_t one[1] = { 1 };
+            limb_sub(hi->limbs, hi->limbs, hi->n, one, 1, LIMB_DECIMAL_BASE); // a*b < (a+1)(b+1)
+        }
+    }
+    else if (status == SUCCESS)
+    {
+        size_t bln = limb_normalize(b_up, bn + 1);  // lo = a / (b + 1)
+        size_t bhn = limb_normalize(b, bn);         // hi = (a + 1) / b
+        lo->n = an + 1;
+        hi->n = an + 2;
+        lo->limbs = calloc(lo->n, sizeof(limb_t));
+        hi->limbs = calloc(hi->n, sizeof(limb_t));
+        if (lo->limbs == NULL || hi->limbs == NULL)
+            status = FAILURE;
+        else
+        {
+            size_t aln = limb_normalize(a, an), ahn = limb_normalize(a_up, an + 1);
+            if (aln >= bln && limb_divmod(lo->limbs, NULL, a, aln, b_up, bln, LIMB_DECIMAL_BASE) == FAILURE)
+                status = FAILURE;
+            if (ahn >= bhn && limb_divmod(hi->limbs, NULL, a_up, ahn, b, bhn, LIMB_DECIMAL_BASE) == FAILURE)
+                status = FAILURE;
+        }
+    }
+    if (status == SUCCESS)
+        status = bound_text(lo);
+    if (status == SUCCESS)
+        status = bound_text(hi);
+    free(a);
+    free(b);
+    free(a_up);
+    free(b_up);
+    return status;
+}
+
+/**
+ * First k digits and digit count of |a| x |b| or |a| / |b| (both nonzero,
+ * la >= lb for division)
+ * @param text: receives the first min(k, digits) digits (malloc'd)
+ * @return: SUCCESS, or FAILURE if out of memory
+ */
+static int high_window(Dlist *head1, size_t la, Dlist *head2, size_t lb, char op, size_t k,
+                       char **text, uint64_t *digits)
+{
+    TRACE_BEGIN("high_window", "digits", k);
+    int status = SUCCESS;
+    for (size_t guard = WINDOW_GUARD_DIGITS; status == SUCCESS; guard *= 2)
+    {
+        window_bound lo = { NULL, 0, NULL, 0 }, hi = { NULL, 0, NULL, 0 };
+        int exact = 0;
+        size_t shift = 0;
+        status = high_bounds(head1, la, head2, lb, op, k + guard, &lo, &hi, &exact, &shift);
+
+        // The real result lies in [lo * 10^shift, (hi + 1) * 10^shift - 1]: the
+        // window is known when both ends agree on length and first k digits
+        int agree = (status == SUCCESS && lo.length == hi.length && (lo.text[0] != '0' || exact) &&
+                     ((k <= lo.length) ? memcmp(lo.text, hi.text, k) == 0
+                                       : (shift == 0 && strcmp(lo.text, hi.text) == 0)));
+        if (status == SUCCESS && (agree || exact))
+        {
+            size_t keep = (k < lo.length) ? k : lo.length;
+            lo.text[keep] = '\0';
+            *text = lo.text;
+            lo.text = NULL;
+            *digits = lo.length + shift;
+            bound_free(&lo);
+            bound_free(&hi);
+            break;
+        }
+        bound_free(&lo);
+        bound_free(&hi);
+    }
+    TRACE_END();
+    return status;
+}
+
+/**
+ * Last k digits of |a| x |b| (short product of the low k digits)
+ * @param text: receives k digits, leading zeros included (malloc'd)
+ */
+static int low_product(Dlist *tail1, size_t la, Dlist *tail2, size_t lb, size_t k, char **text)
+{
+    size_t n = (k + LIMB_DECIMAL_DIGITS - 1) / LIMB_DECIMAL_DIGITS;
+    limb_t *a = digits_of(NULL, tail1, (la < k) ? la : k, 0, n);
+    limb_t *b = digits_of(NULL, tail2, (lb < k) ? lb : k, 0, n);
+    limb_t *r = malloc(n * sizeof(limb_t));
+    *text = malloc(n * LIMB_DECIMAL_DIGITS + 1);
+    int status = (a != NULL && b != NULL && r != NULL && *text != NULL) ? SUCCESS : FAILURE;
+    TRACE_BEGIN("low_product", "digits", k);
+    if (status == SUCCESS)
+        status = limb_mullo(r, a, b, n, LIMB_DECIMAL_BASE);
+    TRACE_END();
+    if (status == SUCCESS)
+    {
+        size_t length = 0;
+        for (size_t i = n; i-- > 0;)
+            length += (size_t)sprintf(*text + length, "%08u", r[i]);
+        memmove(*text, *text + (length - k), k + 1); // Keep the low k digits
+    }
+    free(a);
+    free(b);
+    free(r);
+    return status;
+}
+
+/**
+ * |a| / |b| in full, as text (for the low window of a quotient)
+ */
+static int full_quotient(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2, char **text)
+{
+    size_t an = 0, bn = 0;
+    window_bound q = { NULL, 0, NULL, 0 };
+    limb_t *a = list_to_limbs(head1, tail1, &an);
+    limb_t *b = list_to_limbs(head2, tail2, &bn);
+    int status = (a != NULL && b != NULL) ? SUCCESS : FAILURE;
+    if (status == SUCCESS)
+    {
+        an = limb_normalize(a, an);
+        bn = limb_normalize(b, bn);
+        q.n = (an >= bn) ? an - bn + 1 : 1;
+        q.limbs = calloc(q.n, sizeof(limb_t));
+        if (q.limbs == NULL)
+            status = FAILURE;
+        else if (an >= bn)
+            status = limb_divmod(q.limbs, NULL, a, an, b, bn, LIMB_DECIMAL_BASE);
+    }
+    if (status == SUCCESS)
+        status = bound_text(&q);
+    *text = q.text;
+    q.text = NULL;
+    bound_free(&q);
+    free(a);
+    free(b);
+    return status;
+}
+
+/**
+ * Window of digits of |a| x |b| or |a| / |b| (truncated quotient), and the
+ * digit count of the whole result
+ * @param op: 'x' or '/' (b must be nonzero for '/')
+ * @param side: 'l' for the last k digits, 'h' for the first k digits
+ * @param k: window size in digits (>= 1)
+ * @param head3: pointer to head pointer of the window digits (will be created);
+ *               a low window keeps its leading zeros, and either window is
+ *               shorter than k digits only when the whole result is
+ * @param tail3: pointer to tail pointer of the window digits (will be created)
+ * @param digits: receives the digit count of the whole result
+ * @return: SUCCESS, or FAILURE on memory allocation error or if the work
+ *          would not fit in the memory budget (window left empty)
+ */
+int window_number(Dlist *head1, Dlist *tail1, Dlist *head2, Dlist *tail2, char op, char side,
+                  size_t k, Dlist **head3, Dlist **tail3, uint64_t *digits)
+{
+    *head3 = *tail3 = NULL;
+    size_t la = (size_t)get_list_length(head1), lb = (size_t)get_list_length(head2);
+
+    // Step 1: Results that are zero
+    if (is_zero(head1) || is_zero(head2) || (op == '/' && la < lb))
+    {
+        *digits = 1;
+        return dl_insert_last(head3, tail3, 0);
+    }
+
+    // Fail fast: bounds and windows use a few times k + operand-length digits
+    size_t estimate = (side == 'h') ? 8 * (k + 2 * WINDOW_GUARD_DIGITS)
+                    : (op == 'x') ? 4 * k : 2 * (la + lb);
+    if (mem_check(estimate + (k + 1) * MEM_NODE_BYTES) == FAILURE)
+        return FAILURE;
+
+    // Step 2: Digit count (and the high window itself)
+    char *text = NULL;
+    int status = high_window(head1, la, head2, lb, op, (side == 'h') ? k : 0, &text, digits);
+
+    // Step 3: Low window
+    if (status == SUCCESS && side == 'l')
+    {
+        free(text);
+        text = NULL;
+        status = (op == 'x') ? low_product(tail1, la, tail2, lb, k, &text)
+                             : full_quotient(head1, tail1, head2, tail2, &text);
+        if (status == SUCCESS)
+        {
+            // Only as many digits as the result has
+            size_t length = strlen(text), keep = (k < *digits) ? k : (size_t)*digits;
+            if (length > keep)
+                memmove(text, text + (length - keep), keep + 1);
+        }
+    }
+
+    // Step 4: Digits to a list
+    for (size_t i = 0; status == SUCCESS && text[i] != '\0'; i++)
+        status = dl_insert_last(head3, tail3, text[i] - '0');
+    free(text);
+    if (status == FAILURE)
+        dl_delete_list(head3, tail3);
+    return status;
+}